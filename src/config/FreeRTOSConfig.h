@@ -108,8 +108,10 @@ to exclude the API function. */
 #define INCLUDE_vTaskDelay				1
 #define INCLUDE_uxTaskGetStackHighWaterMark 1
 #define INCLUDE_xTaskGetIdleTaskHandle 1
+#define INCLUDE_xTimerPendFunctionCall 1
 
 #define configUSE_MUTEXES 1
+#define configUSE_COUNTING_SEMAPHORES 1
 
 #define configKERNEL_INTERRUPT_PRIORITY     255
 //#define configMAX_SYSCALL_INTERRUPT_PRIORITY 1
@@ -164,10 +166,19 @@ to exclude the API function. */
 #ifdef DEBUG_QUEUE_MONITOR
     #undef traceQUEUE_SEND
     #undef traceQUEUE_SEND_FAILED
+    #undef traceQUEUE_SEND_FROM_ISR
+    #undef traceQUEUE_SEND_FROM_ISR_FAILED
+    #undef traceQUEUE_RECEIVE
+    #undef traceQUEUE_RECEIVE_FROM_ISR
     #define traceQUEUE_SEND(xQueue) qm_traceQUEUE_SEND(xQueue)
+    #define traceQUEUE_SEND_FROM_ISR(xQueue) qm_traceQUEUE_SEND(xQueue)
     void qm_traceQUEUE_SEND(void* xQueue);
     #define traceQUEUE_SEND_FAILED(xQueue) qm_traceQUEUE_SEND_FAILED(xQueue)
+    #define traceQUEUE_SEND_FROM_ISR_FAILED(xQueue) qm_traceQUEUE_SEND_FAILED(xQueue)
     void qm_traceQUEUE_SEND_FAILED(void* xQueue);
+    #define traceQUEUE_RECEIVE(xQueue) qm_traceQUEUE_RECEIVE(xQueue)
+    #define traceQUEUE_RECEIVE_FROM_ISR(xQueue) qm_traceQUEUE_RECEIVE(xQueue)
+    void qm_traceQUEUE_RECEIVE(void* xQueue);
 #endif // DEBUG_QUEUE_MONITOR
 
 #endif /* FREERTOS_CONFIG_H */
@@ -87,6 +87,9 @@
 #define USDWRITE_TASK_PRI       0
 #define PCA9685_TASK_PRI        2
 #define CMD_HIGH_LEVEL_TASK_PRI 2
+#define PEER_BROADCAST_TASK_PRI 2
+#define TRACE_LOG_TASK_PRI      1
+#define EVENT_TRACE_TASK_PRI    1
 #define BQ_OSD_TASK_PRI         1
 #define GTGPS_DECK_TASK_PRI     1
 #define LIGHTHOUSE_TASK_PRI     3
@@ -137,6 +140,9 @@
 #define USDWRITE_TASK_NAME      "USDWRITE"
 #define PCA9685_TASK_NAME       "PCA9685"
 #define CMD_HIGH_LEVEL_TASK_NAME "CMDHL"
+#define PEER_BROADCAST_TASK_NAME "PEERBC"
+#define TRACE_LOG_TASK_NAME     "TRACELOG"
+#define EVENT_TRACE_TASK_NAME   "EVTRACE"
 #define MULTIRANGER_TASK_NAME   "MR"
 #define BQ_OSD_TASK_NAME        "BQ_OSDTASK"
 #define GTGPS_DECK_TASK_NAME    "GTGPS"
@@ -178,6 +184,9 @@
 #define USDWRITE_TASK_STACKSIZE       (3 * configMINIMAL_STACK_SIZE)
 #define PCA9685_TASK_STACKSIZE        (2 * configMINIMAL_STACK_SIZE)
 #define CMD_HIGH_LEVEL_TASK_STACKSIZE (2 * configMINIMAL_STACK_SIZE)
+#define PEER_BROADCAST_TASK_STACKSIZE configMINIMAL_STACK_SIZE
+#define TRACE_LOG_TASK_STACKSIZE      configMINIMAL_STACK_SIZE
+#define EVENT_TRACE_TASK_STACKSIZE    configMINIMAL_STACK_SIZE
 #define MULTIRANGER_TASK_STACKSIZE    (2 * configMINIMAL_STACK_SIZE)
 #define ACTIVEMARKER_TASK_STACKSIZE   configMINIMAL_STACK_SIZE
 #define AI_DECK_TASK_STACKSIZE        configMINIMAL_STACK_SIZE
@@ -29,6 +29,18 @@
 
 #define configUSE_TRACE_FACILITY	1
 
+#ifdef EVENT_TRACE
+#include "eventtrace.h"
+
+// Record the scheduler events in the event trace, see eventtrace.h. These are
+// expanded in tasks.c and queue.c.
+#define traceTASK_SWITCHED_IN() eventTraceWrite(eventTraceTaskSwitchedIn, pxCurrentTCB->uxTCBNumber)
+#define traceMOVED_TASK_TO_READY_STATE(pxTCB) eventTraceWrite(eventTraceTaskReady, (pxTCB)->uxTCBNumber)
+#define traceBLOCKING_ON_QUEUE_RECEIVE(xQueue) eventTraceWrite(eventTraceQueueBlockReceive, (xQueue)->uxQueueNumber)
+#define traceBLOCKING_ON_QUEUE_SEND(xQueue) eventTraceWrite(eventTraceQueueBlockSend, (xQueue)->uxQueueNumber)
+
+#else
+
 // ITM useful macros
 #ifndef ITM_NO_OVERFLOW
 #define ITM_SEND(CH, DATA) ((uint32_t*)0xE0000000)[CH] = DATA
@@ -54,4 +66,6 @@
 #define traceBLOCKING_ON_QUEUE_RECEIVE(xQueue) ITM_SEND(3, ITM_BLOCKING_ON_QUEUE_RECEIVE | ((xQUEUE *) xQueue)->uxQueueNumber)
 #define traceBLOCKING_ON_QUEUE_SEND(xQueue) ITM_SEND(3, ITM_BLOCKING_ON_QUEUE_SEND | ((xQUEUE *) xQueue)->uxQueueNumber)
 
+#endif // EVENT_TRACE
+
 #endif
@@ -0,0 +1,87 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * multiranger_scheduler.h: Interleaved continuous ranging of several VL53L1
+ *                          sensors sharing one I2C bus
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "vl53l1x.h"
+
+#define MR_SCHEDULER_MAX_SENSORS 5
+
+typedef struct {
+  VL53L1_Dev_t* dev;
+
+  bool isRunning;
+
+  // Latest result
+  uint16_t range_mm;
+  uint8_t rangeStatus;    // VL53L1_RANGESTATUS_xxx of the latest sample
+  uint64_t timestamp;     // Time when the data ready flag was seen [us]
+
+  // Statistics
+  uint32_t measurementCount;
+  uint32_t errorCount;
+} mrSchedulerSensor_t;
+
+typedef struct {
+  mrSchedulerSensor_t sensors[MR_SCHEDULER_MAX_SENSORS];
+  int sensorCount;
+} mrScheduler_t;
+
+/**
+ * Initialize the scheduler state. The devices must already be initialized
+ * with vl53l1xInit().
+ *
+ * @param scheduler The scheduler state
+ * @param devices Array of device pointers, one per sensor
+ * @param count Number of sensors, at most MR_SCHEDULER_MAX_SENSORS
+ */
+void mrSchedulerInit(mrScheduler_t* scheduler, VL53L1_Dev_t* devices[], const int count);
+
+/**
+ * Configure all sensors for timed (continuous) ranging and start them. The
+ * sensors then keep measuring in parallel without any further start/stop
+ * commands.
+ *
+ * @param scheduler The scheduler state
+ * @param timingBudget_us Measurement timing budget per sample [us]
+ * @param interMeasurementPeriod_ms Time between two samples [ms], must be larger than the timing budget
+ */
+void mrSchedulerStart(mrScheduler_t* scheduler, const uint32_t timingBudget_us, const uint32_t interMeasurementPeriod_ms);
+
+/**
+ * Do one pass over all sensors, read the ones that have new data and re-arm
+ * them for the next sample. One status read per sensor is done for sensors
+ * that are not ready, no blocking waits.
+ *
+ * @param scheduler The scheduler state
+ * @param now_us Current time, used as timestamp for the new samples [us]
+ * @return Bit mask with one bit set (1 << index) for every sensor that has a new sample
+ */
+uint32_t mrSchedulerPoll(mrScheduler_t* scheduler, const uint64_t now_us);
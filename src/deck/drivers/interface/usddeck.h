@@ -30,4 +30,8 @@ uint32_t usddeckFileSize(void);
 // Only works if logging is stopped
 bool usddeckRead(uint32_t offset, uint8_t* buffer, uint16_t length);
 
+// Append binary trace log data to the trace file of the current log,
+// returns false if logging is stopped or the buffer is full
+bool usddeckWriteTrace(const uint8_t* data, const uint16_t length);
+
 #endif //__USDDECK_H__
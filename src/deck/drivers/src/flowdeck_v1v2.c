@@ -92,6 +92,7 @@ static void flowdeckTask(void *param)
     vTaskDelay(10);
 
     pmw3901ReadMotion(NCS_PIN, &currentMotion);
+    const uint64_t sampleTime = usecTimestamp();
 
     // Flip motion information to comply with sensor mounting
     // (might need to be changed if mounted differently)
@@ -123,6 +124,7 @@ static void flowdeckTask(void *param)
     flowData.stdDevX = stdFlow;    
     flowData.stdDevY = stdFlow;    
     flowData.dt = 0.01;
+    flowData.timestampUs = sampleTime;
 
 #if defined(USE_MA_SMOOTHING)
       // Use MA Smoothing
@@ -153,8 +155,8 @@ static void flowdeckTask(void *param)
       // Push measurements into the estimator if flow is not disabled
       //    and the PMW flow sensor indicates motion detection
       if (!useFlowDisabled && currentMotion.motion == 0xB0) {
-        flowData.dt = (float)(usecTimestamp()-lastTime)/1000000.0f;
-        lastTime = usecTimestamp();
+        flowData.dt = (float)(sampleTime-lastTime)/1000000.0f;
+        lastTime = sampleTime;
         estimatorEnqueueFlow(&flowData);
       }
     } else {
@@ -50,6 +50,7 @@
 #include "estimator.h"
 #include "statsCnt.h"
 #include "mem.h"
+#include "usec_time.h"
 
 #include "locodeck.h"
 
@@ -437,6 +438,8 @@ static void spiRead(dwDevice_t* dev, const void *header, size_t headerLength,
   {
     portBASE_TYPE  xHigherPriorityTaskWoken = pdFALSE;
 
+    usecTimestampCapture(usecCaptureUwbIrq);
+
     NVIC_ClearPendingIRQ(EXTI_IRQChannel);
     EXTI_ClearITPendingBit(EXTI_LineN);
 
@@ -37,6 +37,7 @@
 #include "cfassert.h"
 
 #include "estimator.h"
+#include "usec_time.h"
 
 #include "physicalConstants.h"
 #include "tdoaEngineInstance.h"
@@ -173,7 +174,12 @@ static void sendLppShort(dwDevice_t *dev, lpsLppShortPacket_t *packet)
   dwStartTransmit(dev);
 }
 
+// Time the DW1000 interrupt for the packet being processed was latched
+static uint64_t rxTimestampUs;
+
 static bool rxcallback(dwDevice_t *dev) {
+  rxTimestampUs = usecTimestampGetCapture(usecCaptureUwbIrq);
+
   tdoaStats_t* stats = &tdoaEngineState.stats;
   STATS_CNT_RATE_EVENT(&stats->packetsReceived);
 
@@ -275,6 +281,7 @@ static uint32_t onEvent(dwDevice_t *dev, uwbEvent_t event) {
 
 
 static void sendTdoaToEstimatorCallback(tdoaMeasurement_t* tdoaMeasurement, const uint8_t idA, const uint8_t idB) {
+  tdoaMeasurement->timestampUs = rxTimestampUs;
   estimatorEnqueueTDOA(tdoaMeasurement);
 
   #ifdef LPS_2D_POSITION_HEIGHT
@@ -282,6 +289,7 @@ static void sendTdoaToEstimatorCallback(tdoaMeasurement_t* tdoaMeasurement, cons
   // LPS_2D_POSITION_HEIGHT contains the height (Z) that the tag will be located at
   heightMeasurement_t heightData;
   heightData.timestamp = xTaskGetTickCount();
+  heightData.timestampUs = rxTimestampUs;
   heightData.height = LPS_2D_POSITION_HEIGHT;
   heightData.stdDev = 0.0001;
   estimatorEnqueueAbsoluteHeight(&heightData);
@@ -39,6 +39,7 @@
 
 #include "stabilizer_types.h"
 #include "estimator.h"
+#include "usec_time.h"
 #include "cf_math.h"
 
 #include "physicalConstants.h"
@@ -259,6 +260,7 @@ static uint32_t rxcallback(dwDevice_t *dev) {
         dist.y = options->anchorPosition[current_anchor].y;
         dist.z = options->anchorPosition[current_anchor].z;
         dist.stdDev = 0.25;
+        dist.timestampUs = usecTimestampGetCapture(usecCaptureUwbIrq);
         estimatorEnqueueDistance(&dist);
       }
 
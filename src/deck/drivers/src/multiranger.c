@@ -33,8 +33,11 @@
 #include "log.h"
 #include "pca95x4.h"
 #include "vl53l1x.h"
+#include "multiranger_scheduler.h"
 #include "range.h"
 #include "static_mem.h"
+#include "statsCnt.h"
+#include "usec_time.h"
 
 #include "i2cdev.h"
 
@@ -59,59 +62,52 @@ NO_DMA_CCM_SAFE_ZERO_INIT static VL53L1_Dev_t devUp;
 NO_DMA_CCM_SAFE_ZERO_INIT static VL53L1_Dev_t devLeft;
 NO_DMA_CCM_SAFE_ZERO_INIT static VL53L1_Dev_t devRight;
 
-static uint16_t mrGetMeasurementAndRestart(VL53L1_Dev_t *dev)
-{
-    VL53L1_Error status = VL53L1_ERROR_NONE;
-    VL53L1_RangingMeasurementData_t rangingData;
-    uint8_t dataReady = 0;
-    uint16_t range;
-
-    while (dataReady == 0)
-    {
-        status = VL53L1_GetMeasurementDataReady(dev, &dataReady);
-        vTaskDelay(M2T(1));
-    }
-
-    status = VL53L1_GetRangingMeasurementData(dev, &rangingData);
-    range = rangingData.RangeMilliMeter;
-
-    VL53L1_StopMeasurement(dev);
-    status = VL53L1_StartMeasurement(dev);
-    status = status;
+// Sensors are started in timed ranging mode and keep measuring on their own,
+// the task only polls the data ready status and reads out finished samples.
+// Timing budget and period give 40 Hz per direction with some margin.
+#define MR_TIMING_BUDGET_US       20000
+#define MR_INTER_MEASUREMENT_MS   25
+#define MR_POLL_PERIOD_MS         2
+
+static mrScheduler_t scheduler;
+
+// Order must match the device order passed to mrSchedulerInit()
+static const rangeDirection_t sensorDirections[] = {
+    rangeFront,
+    rangeBack,
+    rangeUp,
+    rangeLeft,
+    rangeRight,
+};
 
-    return range;
-}
+static STATS_CNT_RATE_DEFINE(rangeRate, 1000);
 
 static void mrTask(void *param)
 {
-    VL53L1_Error status = VL53L1_ERROR_NONE;
+    VL53L1_Dev_t* devices[] = {&devFront, &devBack, &devUp, &devLeft, &devRight};
 
     systemWaitStart();
 
-    // Restart all sensors
-    status = VL53L1_StopMeasurement(&devFront);
-    status = VL53L1_StartMeasurement(&devFront);
-    status = VL53L1_StopMeasurement(&devBack);
-    status = VL53L1_StartMeasurement(&devBack);
-    status = VL53L1_StopMeasurement(&devUp);
-    status = VL53L1_StartMeasurement(&devUp);
-    status = VL53L1_StopMeasurement(&devLeft);
-    status = VL53L1_StartMeasurement(&devLeft);
-    status = VL53L1_StopMeasurement(&devRight);
-    status = VL53L1_StartMeasurement(&devRight);
-    status = status;
+    mrSchedulerInit(&scheduler, devices, sizeof(devices) / sizeof(devices[0]));
+    mrSchedulerStart(&scheduler, MR_TIMING_BUDGET_US, MR_INTER_MEASUREMENT_MS);
 
     TickType_t lastWakeTime = xTaskGetTickCount();
 
     while (1)
     {
-        vTaskDelayUntil(&lastWakeTime, M2T(100));
-
-        rangeSet(rangeFront, mrGetMeasurementAndRestart(&devFront)/1000.0f);
-        rangeSet(rangeBack, mrGetMeasurementAndRestart(&devBack)/1000.0f);
-        rangeSet(rangeUp, mrGetMeasurementAndRestart(&devUp)/1000.0f);
-        rangeSet(rangeLeft, mrGetMeasurementAndRestart(&devLeft)/1000.0f);
-        rangeSet(rangeRight, mrGetMeasurementAndRestart(&devRight)/1000.0f);
+        vTaskDelayUntil(&lastWakeTime, M2T(MR_POLL_PERIOD_MS));
+
+        const uint32_t updated = mrSchedulerPoll(&scheduler, usecTimestamp());
+
+        for (int i = 0; i < scheduler.sensorCount; i++)
+        {
+            if (updated & (1u << i))
+            {
+                const mrSchedulerSensor_t* sensor = &scheduler.sensors[i];
+                rangeSetWithTimestamp(sensorDirections[i], sensor->range_mm / 1000.0f, sensor->timestamp);
+                STATS_CNT_RATE_EVENT(&rangeRate);
+            }
+        }
     }
 }
 
@@ -227,3 +223,12 @@ DECK_DRIVER(multiranger_deck);
 PARAM_GROUP_START(deck)
 PARAM_ADD(PARAM_UINT8 | PARAM_RONLY, bcMultiranger, &isInit)
 PARAM_GROUP_STOP(deck)
+
+LOG_GROUP_START(mr)
+STATS_CNT_RATE_LOG_ADD(rate, &rangeRate)
+LOG_ADD(LOG_UINT32, errFront, &scheduler.sensors[0].errorCount)
+LOG_ADD(LOG_UINT32, errBack, &scheduler.sensors[1].errorCount)
+LOG_ADD(LOG_UINT32, errUp, &scheduler.sensors[2].errorCount)
+LOG_ADD(LOG_UINT32, errLeft, &scheduler.sensors[3].errorCount)
+LOG_ADD(LOG_UINT32, errRight, &scheduler.sensors[4].errorCount)
+LOG_GROUP_STOP(mr)
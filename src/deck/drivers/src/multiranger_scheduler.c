@@ -0,0 +1,116 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * multiranger_scheduler.c: Interleaved continuous ranging of several VL53L1
+ *                          sensors sharing one I2C bus
+ */
+
+#include <string.h>
+
+#include "multiranger_scheduler.h"
+
+void mrSchedulerInit(mrScheduler_t* scheduler, VL53L1_Dev_t* devices[], const int count) {
+  memset(scheduler, 0, sizeof(mrScheduler_t));
+
+  int sensorCount = count;
+  if (sensorCount > MR_SCHEDULER_MAX_SENSORS) {
+    sensorCount = MR_SCHEDULER_MAX_SENSORS;
+  }
+
+  for (int i = 0; i < sensorCount; i++) {
+    scheduler->sensors[i].dev = devices[i];
+  }
+
+  scheduler->sensorCount = sensorCount;
+}
+
+void mrSchedulerStart(mrScheduler_t* scheduler, const uint32_t timingBudget_us, const uint32_t interMeasurementPeriod_ms) {
+  for (int i = 0; i < scheduler->sensorCount; i++) {
+    mrSchedulerSensor_t* sensor = &scheduler->sensors[i];
+    VL53L1_Error status = VL53L1_ERROR_NONE;
+
+    VL53L1_StopMeasurement(sensor->dev);
+
+    status = VL53L1_SetDistanceMode(sensor->dev, VL53L1_DISTANCEMODE_MEDIUM);
+    if (status == VL53L1_ERROR_NONE) {
+      status = VL53L1_SetMeasurementTimingBudgetMicroSeconds(sensor->dev, timingBudget_us);
+    }
+    if (status == VL53L1_ERROR_NONE) {
+      status = VL53L1_SetInterMeasurementPeriodMilliSeconds(sensor->dev, interMeasurementPeriod_ms);
+    }
+    if (status == VL53L1_ERROR_NONE) {
+      status = VL53L1_StartMeasurement(sensor->dev);
+    }
+
+    sensor->isRunning = (status == VL53L1_ERROR_NONE);
+    if (!sensor->isRunning) {
+      sensor->errorCount++;
+    }
+  }
+}
+
+uint32_t mrSchedulerPoll(mrScheduler_t* scheduler, const uint64_t now_us) {
+  uint32_t updated = 0;
+
+  for (int i = 0; i < scheduler->sensorCount; i++) {
+    mrSchedulerSensor_t* sensor = &scheduler->sensors[i];
+    if (!sensor->isRunning) {
+      continue;
+    }
+
+    uint8_t dataReady = 0;
+    if (VL53L1_GetMeasurementDataReady(sensor->dev, &dataReady) != VL53L1_ERROR_NONE) {
+      sensor->errorCount++;
+      continue;
+    }
+
+    if (dataReady == 0) {
+      continue;
+    }
+
+    VL53L1_RangingMeasurementData_t rangingData;
+    VL53L1_Error status = VL53L1_GetRangingMeasurementData(sensor->dev, &rangingData);
+
+    // Re-arm the interrupt right away, the sensor keeps its own timing and
+    // the next sample is already being integrated
+    VL53L1_ClearInterruptAndStartMeasurement(sensor->dev);
+
+    if (status != VL53L1_ERROR_NONE) {
+      sensor->errorCount++;
+      continue;
+    }
+
+    sensor->rangeStatus = rangingData.RangeStatus;
+    if (rangingData.RangeMilliMeter > 0) {
+      sensor->range_mm = (uint16_t)rangingData.RangeMilliMeter;
+    } else {
+      sensor->range_mm = 0;
+    }
+    sensor->timestamp = now_us;
+    sensor->measurementCount++;
+
+    updated |= (1u << i);
+  }
+
+  return updated;
+}
@@ -115,6 +115,7 @@ static void delayMs(UINT ms);
 
 static void usdLogTask(void* prm);
 static void usdWriteTask(void* prm);
+static void usdWriteTrace(void);
 
 static STATS_CNT_RATE_DEFINE(spiWriteRate, 1000);
 static STATS_CNT_RATE_DEFINE(spiReadRate, 1000);
@@ -145,6 +146,17 @@ static TaskHandle_t xHandleWriteTask;
 static bool enableLogging;
 static uint32_t lastFileSize = 0;
 
+// Binary trace log bytes, see tracelog.h, written next to the log file
+#define USD_TRACE_BUFFER_SIZE 1024
+static uint8_t usdTraceBuffer[USD_TRACE_BUFFER_SIZE];
+static uint16_t usdTraceLength;
+static char usdTraceFilename[13];
+static SemaphoreHandle_t traceBufferMutex;
+static uint32_t traceDropCount;
+// Open from the start to the stop of logging, only used by the write task
+static FIL traceFile;
+static bool isTraceFileOpen;
+
 static xTimerHandle timer;
 static void usdTimer(xTimerHandle timer);
 
@@ -320,6 +332,7 @@ static void usdInit(DeckInfo *info)
     memoryRegisterHandler(&memDef);
 
     logFileMutex = xSemaphoreCreateMutex();
+    traceBufferMutex = xSemaphoreCreateMutex();
     /* create driver structure */
     FATFS_AddDriver(&fatDrv, 0);
     vTaskDelay(M2T(100));
@@ -589,6 +602,47 @@ uint32_t usddeckFileSize(void)
   return lastFileSize;
 }
 
+// Append binary trace log data to the buffer written to the trace file by
+// the write task, returns false and counts the drop if it does not fit
+bool usddeckWriteTrace(const uint8_t* data, const uint16_t length)
+{
+  bool result = false;
+
+  if (enableLogging && traceBufferMutex) {
+    xSemaphoreTake(traceBufferMutex, portMAX_DELAY);
+    if (usdTraceLength + length <= USD_TRACE_BUFFER_SIZE) {
+      memcpy(&usdTraceBuffer[usdTraceLength], data, length);
+      usdTraceLength += length;
+      result = true;
+    } else {
+      traceDropCount++;
+    }
+    xSemaphoreGive(traceBufferMutex);
+  }
+
+  return result;
+}
+
+static void usdWriteTrace(void)
+{
+  static uint8_t traceBytes[USD_TRACE_BUFFER_SIZE];
+  uint16_t length;
+  unsigned int bytesWritten;
+
+  xSemaphoreTake(traceBufferMutex, portMAX_DELAY);
+  length = usdTraceLength;
+  memcpy(traceBytes, usdTraceBuffer, length);
+  usdTraceLength = 0;
+  xSemaphoreGive(traceBufferMutex);
+
+  if (length > 0 && isTraceFileOpen) {
+    f_write(&traceFile, traceBytes, length, &bytesWritten);
+    STATS_CNT_RATE_MULTI_EVENT(&fatWriteRate, bytesWritten);
+    /* the file is kept open, sync to avoid loss of data during/after a crash */
+    f_sync(&traceFile);
+  }
+}
+
 // Read "length" number of bytes at "offset" into "buffer" of current file
 // Only works if logging is stopped
 bool usddeckRead(uint32_t offset, uint8_t* buffer, uint16_t length)
@@ -676,6 +730,19 @@ static void usdWriteTask(void* usdLogQueue)
 
         DEBUG_PRINT("Filename: %s\n", usdLogConfig.filename);
 
+        /* trace log file with the same number as the log file, trcNN */
+        {
+          uint8_t NUL = strlen(usdLogConfig.filename);
+          memcpy(usdTraceFilename, "trc", 3);
+          usdTraceFilename[3] = usdLogConfig.filename[NUL-2];
+          usdTraceFilename[4] = usdLogConfig.filename[NUL-1];
+          usdTraceFilename[5] = 0;
+          xSemaphoreTake(traceBufferMutex, portMAX_DELAY);
+          usdTraceLength = 0;
+          xSemaphoreGive(traceBufferMutex);
+          isTraceFileOpen = (f_open(&traceFile, usdTraceFilename, FA_CREATE_ALWAYS | FA_WRITE) == FR_OK);
+        }
+
         /* write dataset header */
         {
           uint8_t logWidth = 1 + usdLogConfig.numSlots;
@@ -767,6 +834,13 @@ static void usdWriteTask(void* usdLogQueue)
             /* close file */
             f_close(&logFile);
           }
+          usdWriteTrace();
+        }
+
+        usdWriteTrace();
+        if (isTraceFileOpen) {
+          f_close(&traceFile);
+          isTraceFileOpen = false;
         }
 
         // Update file size for fast query
@@ -839,4 +913,5 @@ LOG_GROUP_START(usd)
 STATS_CNT_RATE_LOG_ADD(spiWrBps, &spiWriteRate)
 STATS_CNT_RATE_LOG_ADD(spiReBps, &spiReadRate)
 STATS_CNT_RATE_LOG_ADD(fatWrBps, &fatWriteRate)
+LOG_ADD(LOG_UINT32, traceDrop, &traceDropCount) /* trace log writes dropped since the buffer was full */
 LOG_GROUP_STOP(usd)
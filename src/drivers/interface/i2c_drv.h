@@ -7,36 +7,7 @@
 /* ST includes */
 #include "stm32fxxx.h"
 
-#define I2C_NO_INTERNAL_ADDRESS   0xFFFF
-
-typedef enum
-{
-  i2cAck,
-  i2cNack
-} I2cStatus;
-
-typedef enum
-{
-  i2cWrite,
-  i2cRead
-} I2cDirection;
-
-/**
- * Structure used to capture the I2C message details.  The structure is then
- * queued for processing by the I2C ISR.
- */
-typedef struct _I2cMessage
-{
-	uint32_t         messageLength;		  //< How many bytes of data to send or received.
-	uint8_t          slaveAddress;		  //< The slave address of the device on the I2C bus.
-  uint8_t          nbrOfRetries;      //< The slave address of the device on the I2C bus.
-	I2cDirection     direction;         //< Direction of message
-  I2cStatus        status;            //< i2c status
-  xQueueHandle     clientQueue;       //< Queue to send received messages to.
-  bool             isInternal16bit;   //< Is internal address 16 bit. If false 8 bit.
-  uint16_t         internalAddress;   //< Internal address of device.
-  uint8_t          *buffer;           //< Pointer to the buffer from where data will be read for transmission, or into which received data will be placed.
-} I2cMessage;
+#include "i2c_queue.h"
 
 typedef struct
 {
@@ -67,12 +38,10 @@ typedef struct
 {
   const I2cDef *def;                    //< Definition of the i2c
   I2cMessage txMessage;                 //< The I2C send message
+  I2cQueue queue;                       //< Transactions of the bus, protected by critical sections
   uint32_t messageIndex;                //< Index of bytes sent/received
   uint32_t nbrOfretries;                //< Retries done
-  SemaphoreHandle_t isBusFreeSemaphore; //< Semaphore to block during transaction.
-  StaticSemaphore_t isBusFreeSemaphoreBuffer;
-  SemaphoreHandle_t isBusFreeMutex;     //< Mutex to protect bus
-  StaticSemaphore_t isBusFreeMutexBuffer;
+  bool isQueueInit;                     //< The queue is initialized once, the bus may be initialized again
   DMA_InitTypeDef DMAStruct;            //< DMA configuration structure used during transfer setup.
 } I2cDrv;
 
@@ -89,6 +58,8 @@ void i2cdrvInit(I2cDrv* i2c);
  * Send or receive a message over the I2C bus.
  *
  * The message is synchrony by semapthore and uses interrupts to transfer the message.
+ * It is queued as a transaction, see i2cdrvSubmit(), so several tasks may
+ * transfer messages on the same bus at the same time.
  *
  * @param i2c      i2c bus to use.
  * @param message	 An I2cMessage struct containing all the i2c message
@@ -97,6 +68,45 @@ void i2cdrvInit(I2cDrv* i2c);
  */
 bool i2cdrvMessageTransfer(I2cDrv* i2c, I2cMessage* message);
 
+/**
+ * Fill in a transaction of one or more chained messages.
+ *
+ * @param transaction   pointer to transaction struct that will be filled in.
+ * @param messages      messages to transfer back to back.
+ * @param messageCount  number of messages.
+ * @param callback      called from the I2C interrupt when done, may be NULL.
+ * @param arg           stored in the transaction for the callback.
+ */
+void i2cdrvCreateTransaction(I2cTransaction* transaction,
+                             I2cMessage* messages,
+                             uint32_t messageCount,
+                             I2cTransactionCallback callback,
+                             void* arg);
+
+/**
+ * Queue a transaction on the bus and return without waiting for it. The
+ * transactions of a bus are transferred in order, each one ends with a stop
+ * condition. The next one is started from a task once the stop condition is
+ * generated, by the timer task or by the next call to the driver.
+ *
+ * The completion is signaled by the callback, the done semaphore and the
+ * isDone flag of the transaction.
+ *
+ * @param i2c          i2c bus to use.
+ * @param transaction  the transaction, must not be changed until it is done.
+ */
+void i2cdrvSubmit(I2cDrv* i2c, I2cTransaction* transaction);
+
+/**
+ * Remove a transaction that is not done, for instance after a timeout. If it
+ * is in progress the bus is restarted and the next transaction is started.
+ * The transaction is not signaled as done.
+ *
+ * @param i2c          i2c bus of the transaction.
+ * @param transaction  the transaction.
+ */
+void i2cdrvCancel(I2cDrv* i2c, I2cTransaction* transaction);
+
 
 /**
  * Create a message to transfer
@@ -0,0 +1,157 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * i2c_queue.h - Queue of I2C transactions of a bus
+ */
+
+/**
+ * The transactions of a bus are transferred one at the time, in the order they
+ * are added. The queue keeps track of the transaction in progress and which of
+ * its messages is on the bus. It does not touch the hardware, the I2C driver
+ * starts the messages it returns and reports the result of each of them.
+ * The messages of a transaction are separated by a repeated start. A
+ * transaction always ends with a stop, some devices such as EEPROMs only act
+ * on the stop condition, and the next transaction is started by the driver
+ * once the stop condition has been generated.
+ *
+ * The queue is not thread safe, the driver calls it from a critical section
+ * or from the I2C interrupts.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "queue.h"
+
+#define I2C_NO_INTERNAL_ADDRESS   0xFFFF
+
+typedef enum
+{
+  i2cAck,
+  i2cNack
+} I2cStatus;
+
+typedef enum
+{
+  i2cWrite,
+  i2cRead
+} I2cDirection;
+
+/**
+ * Structure used to capture the I2C message details.  The structure is then
+ * queued for processing by the I2C ISR.
+ */
+typedef struct _I2cMessage
+{
+	uint32_t         messageLength;		  //< How many bytes of data to send or received.
+	uint8_t          slaveAddress;		  //< The slave address of the device on the I2C bus.
+  uint8_t          nbrOfRetries;      //< The slave address of the device on the I2C bus.
+	I2cDirection     direction;         //< Direction of message
+  I2cStatus        status;            //< i2c status
+  xQueueHandle     clientQueue;       //< Queue to send received messages to.
+  bool             isInternal16bit;   //< Is internal address 16 bit. If false 8 bit.
+  uint16_t         internalAddress;   //< Internal address of device.
+  uint8_t          *buffer;           //< Pointer to the buffer from where data will be read for transmission, or into which received data will be placed.
+} I2cMessage;
+
+typedef struct _I2cTransaction I2cTransaction;
+
+/**
+ * Called from the I2C interrupt when a transaction is done. Must be short and
+ * must not submit new transactions.
+ */
+typedef void (*I2cTransactionCallback)(I2cTransaction* transaction);
+
+/**
+ * A chain of messages that are transferred back to back, without any other
+ * transaction in between. The chain stops at the first message that is not
+ * acked. The transaction and its messages must be kept until it is done.
+ */
+struct _I2cTransaction
+{
+  I2cMessage*            messages;      //< Messages to transfer, status of each message is updated.
+  uint32_t               messageCount;  //< Number of messages.
+  I2cTransactionCallback callback;      //< Called when done, may be NULL.
+  SemaphoreHandle_t      doneSemaphore; //< Given when done, may be NULL.
+  void*                  arg;           //< Free to use by the owner, for instance in the callback.
+  volatile bool          isDone;        //< Set when done.
+  bool                   success;       //< True if all messages were acked.
+  I2cTransaction*        next;          //< Used by the driver to queue transactions.
+};
+
+typedef struct
+{
+  I2cTransaction* transaction;  //< Transaction in progress, NULL if the bus is idle
+  uint32_t messageIndex;        //< Index of the message in progress in the transaction
+  I2cTransaction* head;         //< Transactions waiting for the bus
+  I2cTransaction* tail;
+  bool isRestarting;            //< The bus is restarted after a cancel, do not start transactions
+} I2cQueue;
+
+void i2cQueueInit(I2cQueue* this);
+
+/**
+ * Add a transaction last in the queue. It is not started, see i2cQueueStartNext().
+ */
+void i2cQueueAdd(I2cQueue* this, I2cTransaction* transaction);
+
+/**
+ * Take the first transaction of the queue if the bus is idle.
+ *
+ * @return The first message of the transaction, to start on the bus. NULL if
+ * the bus is busy or restarting, or if the queue is empty.
+ */
+I2cMessage* i2cQueueStartNext(I2cQueue* this);
+
+/**
+ * Store the result of the message on the bus and move on to the next message
+ * of the transaction.
+ *
+ * @param status The result of the message
+ * @param done Set to the transaction if it is done, NULL otherwise. Its owner
+ * must be notified by the caller.
+ * @return The next message of the transaction, to start with a repeated start.
+ * NULL if the transaction is done, the bus must then be stopped before the
+ * next transaction is started with i2cQueueStartNext().
+ */
+I2cMessage* i2cQueueOnMessageDone(I2cQueue* this, const I2cStatus status, I2cTransaction** done);
+
+/**
+ * @return true if there are transactions waiting for the bus
+ */
+bool i2cQueueHasPending(const I2cQueue* this);
+
+/**
+ * Remove a transaction that is not done, it is not signaled as done.
+ *
+ * @return true if the transaction was in progress. The bus must then be
+ * restarted before i2cQueueOnRestarted() is called, no transaction is started
+ * until then.
+ */
+bool i2cQueueCancel(I2cQueue* this, I2cTransaction* transaction);
+
+void i2cQueueOnRestarted(I2cQueue* this);
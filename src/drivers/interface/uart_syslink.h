@@ -108,11 +108,11 @@ void uartslkSendDataIsrBlocking(uint32_t size, uint8_t* data);
 int uartslkPutchar(int ch);
 
 /**
- * Sends raw data using DMA transfer.
- * @param[in] size  Number of bytes to send
- * @param[in] data  Pointer to data
+ * Encodes a syslink packet into the transmit ring and sends it using DMA.
+ * Returns as soon as the packet is queued, only blocks if the ring is full.
+ * @param[in] slp  The packet to send
  */
-void uartslkSendDataDmaBlocking(uint32_t size, uint8_t* data);
+void uartslkSendPacket(const SyslinkPacket* slp);
 
 /**
  * Interrupt service routine handling UART interrupts.
@@ -41,12 +41,14 @@
 #include "task.h"
 #include "queue.h"
 #include "semphr.h"
+#include "timers.h"
 
 #include "stm32fxxx.h"
 // Application includes.
 #include "i2c_drv.h"
 #include "config.h"
 #include "nvicconf.h"
+#include "eventtrace.h"
 
 //DEBUG
 #ifdef I2CDRV_DEBUG_LOG_EVENTS
@@ -71,6 +73,9 @@
 
 // Defines to unlock bus
 #define I2CDEV_CLK_TS (10 * I2CDEV_LOOPS_PER_US)
+
+// Max time to wait for the stop condition before the next transaction is started
+#define I2CDEV_STOP_TIMEOUT_LOOPS (100 * I2CDEV_LOOPS_PER_US)
 #define GPIO_WAIT_FOR_HIGH(gpio, pin, timeoutcycles)\
   {\
     int i = timeoutcycles;\
@@ -103,6 +108,18 @@ static void i2cdrvDmaSetupBus(I2cDrv* i2c);
  * Start the i2c transfer
  */
 static void i2cdrvStartTransfer(I2cDrv *i2c);
+/**
+ * Start a message of the transaction in progress
+ */
+static void i2cdrvStartMessage(I2cDrv *i2c, const I2cMessage* message);
+/**
+ * Start the next pending transaction if the bus is idle. Called from tasks.
+ */
+static void i2cdrvStartIfIdle(I2cDrv *i2c);
+/**
+ * Start the next pending transaction from the timer task
+ */
+static void i2cdrvStartPending(void* i2c, uint32_t unused);
 /**
  * Try to restart a hanged buss
  */
@@ -223,19 +240,90 @@ static void i2cdrvStartTransfer(I2cDrv *i2c)
   i2c->def->i2cPort->CR1 = (I2C_CR1_START | I2C_CR1_PE);
 }
 
-static void i2cTryNextMessage(I2cDrv* i2c)
+static void i2cdrvStartMessage(I2cDrv *i2c, const I2cMessage* message)
 {
-  i2c->def->i2cPort->CR1 = (I2C_CR1_STOP | I2C_CR1_PE);
-  I2C_ITConfig(i2c->def->i2cPort, I2C_IT_EVT | I2C_IT_BUF, DISABLE);
+  memcpy((char*)&i2c->txMessage, (char*)message, sizeof(I2cMessage));
+  i2cdrvStartTransfer(i2c);
 }
 
-static void i2cNotifyClient(I2cDrv* i2c)
+static void i2cdrvStartIfIdle(I2cDrv *i2c)
+{
+  // The stop condition ending the last transaction may still be generated,
+  // CR1 must not be written until it is done. Wait for it here, in the task,
+  // with short critical sections, instead of in the interrupt.
+  int i = I2CDEV_STOP_TIMEOUT_LOOPS;
+  bool isStopPending = true;
+  while (isStopPending)
+  {
+    taskENTER_CRITICAL();
+    isStopPending = (i2c->def->i2cPort->CR1 & I2C_CR1_STOP) && i-- > 0;
+    if (!isStopPending)
+    {
+      const I2cMessage* message = i2cQueueStartNext(&i2c->queue);
+      if (message)
+      {
+        i2cdrvStartMessage(i2c, message);
+      }
+    }
+    taskEXIT_CRITICAL();
+  }
+}
+
+static void i2cdrvStartPending(void* i2c, uint32_t unused)
+{
+  i2cdrvStartIfIdle((I2cDrv*)i2c);
+}
+
+static void i2cNotifyClient(I2cTransaction* transaction)
 {
   portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
-  xSemaphoreGiveFromISR(i2c->isBusFreeSemaphore, &xHigherPriorityTaskWoken);
+
+  transaction->isDone = true;
+  if (transaction->callback)
+  {
+    transaction->callback(transaction);
+  }
+  if (transaction->doneSemaphore)
+  {
+    xSemaphoreGiveFromISR(transaction->doneSemaphore, &xHigherPriorityTaskWoken);
+  }
+
   portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
+static void i2cTryNextMessage(I2cDrv* i2c)
+{
+  I2C_ITConfig(i2c->def->i2cPort, I2C_IT_EVT | I2C_IT_BUF, DISABLE);
+
+  I2cTransaction* done;
+  const I2cMessage* next = i2cQueueOnMessageDone(&i2c->queue, i2c->txMessage.status, &done);
+  if (next)
+  {
+    // Next message of the transaction, with a repeated start
+    i2cdrvStartMessage(i2c, next);
+  }
+  else
+  {
+    // The transaction is done, the EEPROM for instance only starts its write
+    // cycle on the stop condition
+    i2c->def->i2cPort->CR1 = (I2C_CR1_STOP | I2C_CR1_PE);
+
+    // CR1 must not be written until the stop condition is generated, the
+    // next transaction is started from a task instead of waiting here
+    if (i2cQueueHasPending(&i2c->queue))
+    {
+      portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+      xTimerPendFunctionCallFromISR(i2cdrvStartPending, i2c, 0, &xHigherPriorityTaskWoken);
+      portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    }
+  }
+
+  if (done)
+  {
+    i2cNotifyClient(done);
+  }
+}
+
 static void i2cdrvTryToRestartBus(I2cDrv* i2c)
 {
   i2cdrvInitBus(i2c);
@@ -329,9 +417,6 @@ static void i2cdrvInitBus(I2cDrv* i2c)
   NVIC_Init(&NVIC_InitStructure);
 
   i2cdrvDmaSetupBus(i2c);
-
-  i2c->isBusFreeSemaphore = xSemaphoreCreateBinaryStatic(&i2c->isBusFreeSemaphoreBuffer);
-  i2c->isBusFreeMutex = xSemaphoreCreateMutexStatic(&i2c->isBusFreeMutexBuffer);
 }
 
 static void i2cdrvdevUnlockBus(GPIO_TypeDef* portSCL, GPIO_TypeDef* portSDA, uint16_t pinSCL, uint16_t pinSDA)
@@ -373,6 +458,14 @@ static void i2cdrvdevUnlockBus(GPIO_TypeDef* portSCL, GPIO_TypeDef* portSDA, uin
 
 void i2cdrvInit(I2cDrv* i2c)
 {
+  // The bus is initialized once per device on it, but the queue must not be
+  // reset while in use
+  if (!i2c->isQueueInit)
+  {
+    i2cQueueInit(&i2c->queue);
+    i2c->isQueueInit = true;
+  }
+
   i2cdrvInitBus(i2c);
 }
 
@@ -417,31 +510,78 @@ void i2cdrvCreateMessageIntAddr(I2cMessage *message,
 bool i2cdrvMessageTransfer(I2cDrv* i2c, I2cMessage* message)
 {
   bool status = false;
+  I2cTransaction transaction;
+  StaticSemaphore_t doneSemaphoreBuffer;
 
-  xSemaphoreTake(i2c->isBusFreeMutex, portMAX_DELAY); // Protect message data
-  // Copy message
-  memcpy((char*)&i2c->txMessage, (char*)message, sizeof(I2cMessage));
+  // The queue serializes the transfers on the bus, each caller waits for its
+  // own transaction
+  i2cdrvCreateTransaction(&transaction, message, 1, 0, 0);
+  transaction.doneSemaphore = xSemaphoreCreateBinaryStatic(&doneSemaphoreBuffer);
   // We can now start the ISR sending this message.
-  i2cdrvStartTransfer(i2c);
+  i2cdrvSubmit(i2c, &transaction);
   // Wait for transaction to be done
-  if (xSemaphoreTake(i2c->isBusFreeSemaphore, I2C_MESSAGE_TIMEOUT) == pdTRUE)
+  if (xSemaphoreTake(transaction.doneSemaphore, I2C_MESSAGE_TIMEOUT) == pdTRUE)
   {
-    if (i2c->txMessage.status == i2cAck)
-    {
-      status = true;
-    }
+    status = transaction.success;
+    // Start the next transaction without waiting for the timer task
+    i2cdrvStartIfIdle(i2c);
   }
   else
   {
-    i2cdrvClearDMA(i2c);
-    i2cdrvTryToRestartBus(i2c);
+    i2cdrvCancel(i2c, &transaction);
     //TODO: If bus is really hanged... fail safe
   }
-  xSemaphoreGive(i2c->isBusFreeMutex);
+  vSemaphoreDelete(transaction.doneSemaphore);
 
   return status;
 }
 
+void i2cdrvCreateTransaction(I2cTransaction* transaction,
+                             I2cMessage* messages,
+                             uint32_t messageCount,
+                             I2cTransactionCallback callback,
+                             void* arg)
+{
+  transaction->messages = messages;
+  transaction->messageCount = messageCount;
+  transaction->callback = callback;
+  transaction->doneSemaphore = 0;
+  transaction->arg = arg;
+  transaction->isDone = false;
+  transaction->success = false;
+  transaction->next = 0;
+}
+
+void i2cdrvSubmit(I2cDrv* i2c, I2cTransaction* transaction)
+{
+  ASSERT(transaction->messageCount > 0);
+
+  taskENTER_CRITICAL();
+  i2cQueueAdd(&i2c->queue, transaction);
+  taskEXIT_CRITICAL();
+
+  i2cdrvStartIfIdle(i2c);
+}
+
+void i2cdrvCancel(I2cDrv* i2c, I2cTransaction* transaction)
+{
+  taskENTER_CRITICAL();
+  const bool isInProgress = i2cQueueCancel(&i2c->queue, transaction);
+  taskEXIT_CRITICAL();
+
+  if (isInProgress)
+  {
+    i2cdrvClearDMA(i2c);
+    i2cdrvTryToRestartBus(i2c);
+
+    taskENTER_CRITICAL();
+    i2cQueueOnRestarted(&i2c->queue);
+    taskEXIT_CRITICAL();
+
+    i2cdrvStartIfIdle(i2c);
+  }
+}
+
 
 static void i2cdrvEventIsrHandler(I2cDrv* i2c)
 {
@@ -533,10 +673,13 @@ static void i2cdrvEventIsrHandler(I2cDrv* i2c)
       }
       else
       {
-        i2cNotifyClient(i2c);
-        // Are there any other messages to transact? If so stop else repeated start.
+        // Are there any other messages to transact? If so repeated start else stop.
         i2cTryNextMessage(i2c);
       }
+      // BTF is only cleared by hardware when the start or stop condition
+      // requested above is generated and the event would fire again until
+      // then. Reading DR clears it now, nothing is sent in transmitter mode.
+      (void)I2C_ReceiveData(i2c->def->i2cPort);
     }
     else // Reading. Shouldn't happen since we use DMA for reading.
     {
@@ -544,14 +687,10 @@ static void i2cdrvEventIsrHandler(I2cDrv* i2c)
       i2c->txMessage.buffer[i2c->messageIndex++] = I2C_ReceiveData(i2c->def->i2cPort);
       if(i2c->messageIndex == i2c->txMessage.messageLength)
       {
-        i2cNotifyClient(i2c);
         // Are there any other messages to transact?
         i2cTryNextMessage(i2c);
       }
     }
-    // A second BTF interrupt might occur if we don't wait for it to clear.
-    // TODO Implement better method.
-    while (i2c->def->i2cPort->CR1 & 0x0100) { ; }
   }
   // Byte received
   else if (SR1 & I2C_SR1_RXNE) // Should not happen when we use DMA for reception.
@@ -597,7 +736,6 @@ static void i2cdrvErrorIsrHandler(I2cDrv* i2c)
     {
       // Failed so notify client and try next message if any.
       i2c->txMessage.status = i2cNack;
-      i2cNotifyClient(i2c);
       i2cTryNextMessage(i2c);
     }
     I2C_ClearFlag(i2c->def->i2cPort, I2C_FLAG_AF);
@@ -630,7 +768,6 @@ static void i2cdrvDmaIsrHandler(I2cDrv* i2c)
   if (DMA_GetFlagStatus(i2c->def->dmaRxStream, i2c->def->dmaRxTCFlag)) // Tranasfer complete
   {
     i2cdrvClearDMA(i2c);
-    i2cNotifyClient(i2c);
     // Are there any other messages to transact?
     i2cTryNextMessage(i2c);
   }
@@ -639,7 +776,6 @@ static void i2cdrvDmaIsrHandler(I2cDrv* i2c)
     DMA_ClearITPendingBit(i2c->def->dmaRxStream, i2c->def->dmaRxTEFlag);
     //TODO: Best thing we could do?
     i2c->txMessage.status = i2cNack;
-    i2cNotifyClient(i2c);
     i2cTryNextMessage(i2c);
   }
 }
@@ -647,12 +783,16 @@ static void i2cdrvDmaIsrHandler(I2cDrv* i2c)
 
 void __attribute__((used)) I2C1_ER_IRQHandler(void)
 {
+  EVENT_TRACE_ISR_ENTER("i2c1 error");
   i2cdrvErrorIsrHandler(&deckBus);
+  EVENT_TRACE_ISR_EXIT("i2c1 error");
 }
 
 void __attribute__((used)) I2C1_EV_IRQHandler(void)
 {
+  EVENT_TRACE_ISR_ENTER("i2c1 event");
   i2cdrvEventIsrHandler(&deckBus);
+  EVENT_TRACE_ISR_EXIT("i2c1 event");
 }
 
 #ifdef USDDECK_USE_ALT_PINS_AND_SPI
@@ -661,20 +801,28 @@ void __attribute__((used)) DMA1_Stream5_IRQHandler(void)
 void __attribute__((used)) DMA1_Stream0_IRQHandler(void)
 #endif
 {
+  EVENT_TRACE_ISR_ENTER("i2c1 dma");
   i2cdrvDmaIsrHandler(&deckBus);
+  EVENT_TRACE_ISR_EXIT("i2c1 dma");
 }
 
 void __attribute__((used)) I2C3_ER_IRQHandler(void)
 {
+  EVENT_TRACE_ISR_ENTER("i2c3 error");
   i2cdrvErrorIsrHandler(&sensorsBus);
+  EVENT_TRACE_ISR_EXIT("i2c3 error");
 }
 
 void __attribute__((used)) I2C3_EV_IRQHandler(void)
 {
+  EVENT_TRACE_ISR_ENTER("i2c3 event");
   i2cdrvEventIsrHandler(&sensorsBus);
+  EVENT_TRACE_ISR_EXIT("i2c3 event");
 }
 
 void __attribute__((used)) DMA1_Stream2_IRQHandler(void)
 {
+  EVENT_TRACE_ISR_ENTER("i2c3 dma");
   i2cdrvDmaIsrHandler(&sensorsBus);
+  EVENT_TRACE_ISR_EXIT("i2c3 dma");
 }
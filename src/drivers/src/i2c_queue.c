@@ -0,0 +1,145 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * i2c_queue.c - Queue of I2C transactions of a bus
+ */
+
+#include "i2c_queue.h"
+
+void i2cQueueInit(I2cQueue* this)
+{
+  this->transaction = 0;
+  this->messageIndex = 0;
+  this->head = 0;
+  this->tail = 0;
+  this->isRestarting = false;
+}
+
+void i2cQueueAdd(I2cQueue* this, I2cTransaction* transaction)
+{
+  transaction->isDone = false;
+  transaction->success = false;
+  transaction->next = 0;
+
+  if (this->tail)
+  {
+    this->tail->next = transaction;
+  }
+  else
+  {
+    this->head = transaction;
+  }
+  this->tail = transaction;
+}
+
+I2cMessage* i2cQueueStartNext(I2cQueue* this)
+{
+  if (this->transaction || this->isRestarting || this->head == 0)
+  {
+    return 0;
+  }
+
+  this->transaction = this->head;
+  this->head = this->transaction->next;
+  if (this->head == 0)
+  {
+    this->tail = 0;
+  }
+  this->messageIndex = 0;
+
+  return &this->transaction->messages[0];
+}
+
+I2cMessage* i2cQueueOnMessageDone(I2cQueue* this, const I2cStatus status, I2cTransaction** done)
+{
+  *done = 0;
+
+  I2cTransaction* transaction = this->transaction;
+  if (transaction == 0)
+  {
+    // Canceled
+    return 0;
+  }
+
+  transaction->messages[this->messageIndex].status = status;
+  this->messageIndex++;
+
+  // Continue the chain unless the message failed
+  if (status == i2cAck && this->messageIndex < transaction->messageCount)
+  {
+    return &transaction->messages[this->messageIndex];
+  }
+
+  transaction->success = (status == i2cAck);
+  *done = transaction;
+  this->transaction = 0;
+
+  return 0;
+}
+
+bool i2cQueueHasPending(const I2cQueue* this)
+{
+  return this->head != 0;
+}
+
+bool i2cQueueCancel(I2cQueue* this, I2cTransaction* transaction)
+{
+  if (this->transaction == transaction)
+  {
+    // Do not start anything until the bus is restarted
+    this->transaction = 0;
+    this->isRestarting = true;
+    return true;
+  }
+
+  I2cTransaction* previous = 0;
+  I2cTransaction* pending = this->head;
+  while (pending && pending != transaction)
+  {
+    previous = pending;
+    pending = pending->next;
+  }
+
+  if (pending)
+  {
+    if (previous)
+    {
+      previous->next = pending->next;
+    }
+    else
+    {
+      this->head = pending->next;
+    }
+    if (this->tail == pending)
+    {
+      this->tail = previous;
+    }
+  }
+
+  return false;
+}
+
+void i2cQueueOnRestarted(I2cQueue* this)
+{
+  this->isRestarting = false;
+}
@@ -43,6 +43,8 @@
 #include "config.h"
 #include "queuemonitor.h"
 #include "static_mem.h"
+#include "eventtrace.h"
+#include "syslink_tx_ring.h"
 
 
 #define UARTSLK_DATA_TIMEOUT_MS 1000
@@ -58,7 +60,10 @@ static StaticSemaphore_t uartBusyBuffer;
 static xQueueHandle syslinkPacketDelivery;
 STATIC_MEM_QUEUE_ALLOC(syslinkPacketDelivery, 8, sizeof(SyslinkPacket));
 
-static uint8_t dmaBuffer[64];
+static xSemaphoreHandle txFrameFree;
+static StaticSemaphore_t txFrameFreeBuffer;
+static syslinkTxRing_t txRing; // Read by the DMA, must not be placed in CCM
+static syslinkTxFrame_t* txFrameInFlight;
 static uint8_t *outDataIsr;
 static uint8_t dataIndexIsr;
 static uint8_t dataSizeIsr;
@@ -76,6 +81,7 @@ static void uartslkHandleDataFromISR(uint8_t c, BaseType_t * const pxHigherPrior
 
 static void uartslkPauseDma();
 static void uartslkResumeDma();
+static void uartslkStartDma(syslinkTxFrame_t* frame);
 
 /**
   * Configures the UART DMA. Mainly used for FreeRTOS trace
@@ -89,7 +95,7 @@ void uartslkDmaInit(void)
 
   // USART TX DMA Channel Config
   DMA_InitStructureShare.DMA_PeripheralBaseAddr = (uint32_t)&UARTSLK_TYPE->DR;
-  DMA_InitStructureShare.DMA_Memory0BaseAddr = (uint32_t)dmaBuffer;
+  DMA_InitStructureShare.DMA_Memory0BaseAddr = 0;
   DMA_InitStructureShare.DMA_MemoryInc = DMA_MemoryInc_Enable;
   DMA_InitStructureShare.DMA_MemoryBurst = DMA_MemoryBurst_Single;
   DMA_InitStructureShare.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
@@ -119,6 +125,8 @@ void uartslkInit(void)
   waitUntilSendDone = xSemaphoreCreateBinaryStatic(&waitUntilSendDoneBuffer); // initialized as blocking
   uartBusy = xSemaphoreCreateBinaryStatic(&uartBusyBuffer); // initialized as blocking
   xSemaphoreGive(uartBusy); // but we give it because the uart isn't busy at initialization
+  txFrameFree = xSemaphoreCreateCountingStatic(SYSLINK_TX_RING_FRAME_COUNT, SYSLINK_TX_RING_FRAME_COUNT, &txFrameFreeBuffer);
+  syslinkTxRingInit(&txRing);
 
   syslinkPacketDelivery = STATIC_MEM_QUEUE_CREATE(syslinkPacketDelivery);
   DEBUG_QUEUE_MONITOR_REGISTER(syslinkPacketDelivery);
@@ -243,32 +251,53 @@ int uartslkPutchar(int ch)
     return (unsigned char)ch;
 }
 
-void uartslkSendDataDmaBlocking(uint32_t size, uint8_t* data)
+void uartslkSendPacket(const SyslinkPacket* slp)
 {
   if (isUartDmaInitialized)
   {
+    // Serializes the producers of the ring
     xSemaphoreTake(uartBusy, portMAX_DELAY);
-    // Wait for DMA to be free
-    while(DMA_GetCmdStatus(UARTSLK_DMA_STREAM) != DISABLE);
-    //Copy data in DMA buffer
-    memcpy(dmaBuffer, data, size);
-    DMA_InitStructureShare.DMA_BufferSize = size;
-    initialDMACount = size;
-    // Init new DMA stream
-    DMA_Init(UARTSLK_DMA_STREAM, &DMA_InitStructureShare);
-    // Enable the Transfer Complete interrupt
-    DMA_ITConfig(UARTSLK_DMA_STREAM, DMA_IT_TC, ENABLE);
-    /* Enable USART DMA TX Requests */
-    USART_DMACmd(UARTSLK_TYPE, USART_DMAReq_Tx, ENABLE);
-    /* Clear transfer complete */
-    USART_ClearFlag(UARTSLK_TYPE, USART_FLAG_TC);
-    /* Enable DMA USART TX Stream */
-    DMA_Cmd(UARTSLK_DMA_STREAM, ENABLE);
-    xSemaphoreTake(waitUntilSendDone, portMAX_DELAY);
+    xSemaphoreTake(txFrameFree, portMAX_DELAY);
+
+    syslinkTxFrame_t* frame = syslinkTxRingAcquire(&txRing);
+    ASSERT(frame);
+    syslinkTxFrameEncode(frame, slp);
+
+    taskENTER_CRITICAL();
+    syslinkTxRingCommit(&txRing);
+    if (txFrameInFlight == 0)
+    {
+      uartslkStartDma(syslinkTxRingPeek(&txRing));
+    }
+    taskEXIT_CRITICAL();
+
     xSemaphoreGive(uartBusy);
   }
 }
 
+static void uartslkStartDma(syslinkTxFrame_t* frame)
+{
+  txFrameInFlight = frame;
+  initialDMACount = frame->size;
+
+  DMA_InitStructureShare.DMA_Memory0BaseAddr = (uint32_t)frame->data;
+  DMA_InitStructureShare.DMA_BufferSize = frame->size;
+  // Init new DMA stream
+  DMA_Init(UARTSLK_DMA_STREAM, &DMA_InitStructureShare);
+  /* Enable USART DMA TX Requests */
+  USART_DMACmd(UARTSLK_TYPE, USART_DMAReq_Tx, ENABLE);
+
+  // Start as paused and let the resume enable the stream, unless the nRF has
+  // asked us to hold off. The pin is read after the pause is set up so that a
+  // TXEN falling edge in between is not lost.
+  remainingDMACount = frame->size;
+  dmaIsPaused = true;
+  if (GPIO_ReadInputDataBit(UARTSLK_TXEN_PORT, UARTSLK_TXEN_PIN) == Bit_RESET)
+  {
+    uartslkResumeDma();
+  }
+}
+
 static void uartslkPauseDma()
 {
   if (DMA_GetCmdStatus(UARTSLK_DMA_STREAM) == ENABLE)
@@ -294,7 +323,7 @@ static void uartslkResumeDma()
     // Update DMA counter
     DMA_SetCurrDataCounter(UARTSLK_DMA_STREAM, remainingDMACount);
     // Update memory read address
-    UARTSLK_DMA_STREAM->M0AR = (uint32_t)&dmaBuffer[initialDMACount - remainingDMACount];
+    UARTSLK_DMA_STREAM->M0AR = (uint32_t)&txFrameInFlight->data[initialDMACount - remainingDMACount];
     // Enable the Transfer Complete interrupt
     DMA_ITConfig(UARTSLK_DMA_STREAM, DMA_IT_TC, ENABLE);
     /* Clear transfer complete */
@@ -316,7 +345,19 @@ void uartslkDmaIsr(void)
   DMA_Cmd(UARTSLK_DMA_STREAM, DISABLE);
 
   remainingDMACount = 0;
-  xSemaphoreGiveFromISR(waitUntilSendDone, &xHigherPriorityTaskWoken);
+  txFrameInFlight = 0;
+  syslinkTxRingRelease(&txRing);
+  xSemaphoreGiveFromISR(txFrameFree, &xHigherPriorityTaskWoken);
+
+  // Send the next queued frame back to back
+  syslinkTxFrame_t* next = syslinkTxRingPeek(&txRing);
+  if (next)
+  {
+    while(DMA_GetCmdStatus(UARTSLK_DMA_STREAM) != DISABLE);
+    uartslkStartDma(next);
+  }
+
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
 void uartslkHandleDataFromISR(uint8_t c, BaseType_t * const pxHigherPriorityTaskWoken)
@@ -458,10 +499,14 @@ void __attribute__((used)) EXTI4_Callback(void)
 
 void __attribute__((used)) USART6_IRQHandler(void)
 {
+  EVENT_TRACE_ISR_ENTER("syslink uart");
   uartslkIsr();
+  EVENT_TRACE_ISR_EXIT("syslink uart");
 }
 
 void __attribute__((used)) DMA2_Stream7_IRQHandler(void)
 {
+  EVENT_TRACE_ISR_ENTER("syslink tx dma");
   uartslkDmaIsr();
+  EVENT_TRACE_ISR_EXIT("syslink tx dma");
 }
@@ -30,6 +30,11 @@
 
 typedef enum { ACC_MODE_PROPTEST, ACC_MODE_FLIGHT } accModes;
 
+typedef struct {
+  Axis3f value;
+  uint64_t timestamp;       // usec, when the sensor took the sample, 0 if not known
+} imuSample_t;
+
 void sensorsInit(void);
 bool sensorsTest(void);
 bool sensorsAreCalibrated(void);
@@ -53,6 +58,14 @@ bool sensorsReadAcc(Axis3f *acc);
 bool sensorsReadMag(Axis3f *mag);
 bool sensorsReadBaro(baro_t *baro);
 
+/**
+ * Read the gyro samples one by one, oldest first, until it returns false.
+ * Sensors that sample faster than the stabilizer loop, or buffer samples while
+ * the loop is late, return every sample. Other sensors return the same sample
+ * as sensorsReadGyro(), which should not be used by the same consumer.
+ */
+bool sensorsReadGyroSample(imuSample_t *sample);
+
 /**
  * Set acc mode, one of accModes enum
  */
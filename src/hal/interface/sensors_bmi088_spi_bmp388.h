@@ -38,6 +38,7 @@ bool sensorsBmi088SpiBmp388ReadGyro(Axis3f *gyro);
 bool sensorsBmi088SpiBmp388ReadAcc(Axis3f *acc);
 bool sensorsBmi088SpiBmp388ReadMag(Axis3f *mag);
 bool sensorsBmi088SpiBmp388ReadBaro(baro_t *baro);
+bool sensorsBmi088SpiBmp388ReadGyroSample(imuSample_t *sample);
 void sensorsBmi088SpiBmp388SetAccMode(accModes accMode);
 void sensorsBmi088SpiBmp388DataAvailableCallback(void);
 
@@ -81,5 +81,27 @@ bool usbGetDataBlocking(USBPacket *in);
  */
 bool usbSendData(uint32_t size, uint8_t* data);
 
+/**
+ * Streaming mode is turned on and off by the host with a vendor request to
+ * interface 0 (bmRequestType 0x41, bRequest 0x02, wValue 1 to enable, 0 to
+ * disable). It is turned off when the USB is reset. In streaming mode the CRTP packets
+ * sent to the host are not sent one per USB packet but batched as
+ * [size][header][data...] frames in transfers of up to 512 bytes, to stream
+ * full rate logs. See tools/usb/usb_stream.py for a host side reader.
+ *
+ * @return true if the host has turned on streaming mode
+ */
+bool usbIsStreaming(void);
+
+/**
+ * Queue a CRTP packet to be sent in streaming mode, does not block.
+ * @param[in] header  CRTP header
+ * @param[in] data    Pointer to the CRTP data
+ * @param[in] size    Number of data bytes
+ *
+ * @return false if the stream buffer is full, the packet is not queued
+ */
+bool usbStreamSendFrame(uint8_t header, const uint8_t* data, uint8_t size);
+
 
 #endif /* UART_H_ */
@@ -38,4 +38,25 @@ void initUsecTimer(void);
  */
 uint64_t usecTimestamp(void);
 
+/**
+ * Sources that latch a timestamp in their interrupt handler. The latched value
+ * is read later, from task context, by the code that builds the measurement.
+ */
+typedef enum {
+  usecCaptureUwbIrq,
+  usecCaptureCount,
+} usecCapture_t;
+
+/**
+ * Latch the current timestamp for a capture source. Intended to be the first
+ * thing called in the interrupt handler of the source.
+ */
+void usecTimestampCapture(const usecCapture_t capture);
+
+/**
+ * Get the latest timestamp latched for a capture source, 0 if none yet. Safe to
+ * call from a task while the source interrupt is active.
+ */
+uint64_t usecTimestampGetCapture(const usecCapture_t capture);
+
 #endif /* USEC_TIME_H_ */
@@ -61,6 +61,7 @@ static bool isInit;
 static int radiolinkSendCRTPPacket(CRTPPacket *p);
 static int radiolinkSetEnable(bool enable);
 static int radiolinkReceiveCRTPPacket(CRTPPacket *p);
+static bool radiolinkIsPacketWaiting(void);
 
 //Local RSSI variable used to enable logging of RSSI values from Radio
 static uint8_t rssi;
@@ -78,7 +79,8 @@ static struct crtpLinkOperations radiolinkOp =
   .setEnable         = radiolinkSetEnable,
   .sendPacket        = radiolinkSendCRTPPacket,
   .receivePacket     = radiolinkReceiveCRTPPacket,
-  .isConnected       = radiolinkIsConnected
+  .isConnected       = radiolinkIsConnected,
+  .isPacketWaiting   = radiolinkIsPacketWaiting,
 };
 
 void radiolinkInit(void)
@@ -202,6 +204,11 @@ static int radiolinkReceiveCRTPPacket(CRTPPacket *p)
   return -1;
 }
 
+static bool radiolinkIsPacketWaiting(void)
+{
+  return uxQueueMessagesWaiting(crtpPacketDelivery) > 0;
+}
+
 void p2pRegisterCB(P2PCallback cb)
 {
     p2p_callback = cb;
@@ -64,6 +64,7 @@ typedef struct {
   bool (*readAcc)(Axis3f *acc);
   bool (*readMag)(Axis3f *mag);
   bool (*readBaro)(baro_t *baro);
+  bool (*readGyroSample)(imuSample_t *sample);  // Optional
   void (*setAccMode)(accModes accMode);
   void (*dataAvailableCallback)(void);
 } sensorsImplementation_t;
@@ -104,6 +105,7 @@ static const sensorsImplementation_t sensorImplementations[SensorImplementation_
     .readAcc = sensorsBmi088SpiBmp388ReadAcc,
     .readMag = sensorsBmi088SpiBmp388ReadMag,
     .readBaro = sensorsBmi088SpiBmp388ReadBaro,
+    .readGyroSample = sensorsBmi088SpiBmp388ReadGyroSample,
     .setAccMode = sensorsBmi088SpiBmp388SetAccMode,
     .dataAvailableCallback = sensorsBmi088SpiBmp388DataAvailableCallback,
   },
@@ -203,6 +205,15 @@ bool sensorsReadBaro(baro_t *baro) {
   return activeImplementation->readBaro(baro);
 }
 
+bool sensorsReadGyroSample(imuSample_t *sample) {
+  if (activeImplementation->readGyroSample) {
+    return activeImplementation->readGyroSample(sample);
+  }
+
+  sample->timestamp = 0;
+  return activeImplementation->readGyro(&sample->value);
+}
+
 void sensorsSetAccMode(accModes accMode) {
   activeImplementation->setAccMode(accMode);
 }
@@ -48,12 +48,18 @@
 #include "nvicconf.h"
 #include "ledseq.h"
 #include "sound.h"
-#include "filter.h"
+#include "biquad_bank.h"
+#include "dynamic_notch.h"
+#include "gyro_bias_estimator.h"
+#include "sample_clock.h"
+#include "motors.h"
 #include "i2cdev.h"
 #include "bmi088.h"
+#include "bmi088_fifo.h"
 #include "bmp3.h"
 #include "bstdr_types.h"
 #include "static_mem.h"
+#include "eventtrace.h"
 
 /* Defines for the SPI and GPIO pins used to drive the SPI Flash */
 #define BMI088_ACC_GPIO_CS             GPIO_Pin_1
@@ -87,8 +93,6 @@
 #define BMI088_SPI_RX_DMA_FLAG_TCIF    DMA_FLAG_TCIF3
 
 #define BMI088_SPI_TX_DMA_STREAM       DMA1_Stream4
-#define BMI088_SPI_TX_DMA_IRQ          DMA1_Stream4_IRQn
-#define BMI088_SPI_TX_DMA_IRQHandler   DMA1_Stream4_IRQHandler
 #define BMI088_SPI_TX_DMA_CHANNEL      DMA_Channel_0
 #define BMI088_SPI_TX_DMA_FLAG_TCIF    DMA_FLAG_TCIF4
 
@@ -101,6 +105,20 @@
 #define SENSORS_DELAY_BARO              (SENSORS_READ_RATE_HZ/SENSORS_READ_BARO_HZ)
 #define SENSORS_DELAY_MAG               (SENSORS_READ_RATE_HZ/SENSORS_READ_MAG_HZ)
 
+#ifdef SENSORS_BMI088_FIFO
+// The gyro is oversampled and read from its FIFO, the FIFO watermark interrupt
+// runs the task at SENSORS_READ_RATE_HZ
+#define SENSORS_GYRO_RATE_HZ            2000
+#define GYRO_FIFO_WATERMARK             (SENSORS_GYRO_RATE_HZ / SENSORS_READ_RATE_HZ)
+// The gyro noise variance grows with the bandwidth, 230 Hz instead of 116 Hz
+#define GYRO_VARIANCE_SCALE             2.0f
+#else
+#define SENSORS_GYRO_RATE_HZ            SENSORS_READ_RATE_HZ
+#define GYRO_VARIANCE_SCALE             1.0f
+#endif
+// Filtered gyro samples waiting for sensorsReadGyroSample(), the newest are kept
+#define GYRO_SAMPLE_QUEUE_LENGTH        16
+
 #define SENSORS_BMI088_GYRO_FS_CFG      BMI088_GYRO_RANGE_2000_DPS
 #define SENSORS_BMI088_DEG_PER_LSB_CFG  (2.0f *2000.0f) / 65536.0f
 
@@ -112,17 +130,13 @@
 #define SENSORS_VARIANCE_MAN_TEST_TIMEOUT   M2T(1000) // Timeout in ms
 #define SENSORS_MAN_TEST_LEVEL_MAX          5.0f      // Max degrees off
 
-#define GYRO_NBR_OF_AXES                3
-#define GYRO_MIN_BIAS_TIMEOUT_MS        M2T(1*1000)
+// Number of samples the gyro mean and variance are estimated over
+#define GYRO_BIAS_WINDOW_SAMPLES        512
+// Number of samples needed before the first gyro bias is taken
+#define GYRO_BIAS_MIN_SAMPLES           200
 
-// Number of samples used in variance calculation. Changing this effects the threshold
-#define SENSORS_NBR_OF_BIAS_SAMPLES  512
-
-// Variance threshold to take zero bias for gyro
-#define GYRO_VARIANCE_BASE              10000
-#define GYRO_VARIANCE_THRESHOLD_X       (GYRO_VARIANCE_BASE)
-#define GYRO_VARIANCE_THRESHOLD_Y       (GYRO_VARIANCE_BASE)
-#define GYRO_VARIANCE_THRESHOLD_Z       (GYRO_VARIANCE_BASE)
+// Variance threshold [LSB^2] to take zero bias for gyro
+#define GYRO_VARIANCE_THRESHOLD         (GYRO_VARIANCE_SCALE * 10000.0f / GYRO_BIAS_WINDOW_SAMPLES)
 
 #define SENSORS_ACC_SCALE_SAMPLES  200
 
@@ -137,21 +151,53 @@
 #define SPI_MAX_DMA_TRANSACTION_SIZE    15
 static uint8_t spiTxBuffer[SPI_MAX_DMA_TRANSACTION_SIZE + 1];
 static uint8_t spiRxBuffer[SPI_MAX_DMA_TRANSACTION_SIZE + 1];
-static xSemaphoreHandle spiTxDMAComplete;
-static StaticSemaphore_t spiTxDMACompleteBuffer;
-static xSemaphoreHandle spiRxDMAComplete;
-static StaticSemaphore_t spiRxDMACompleteBuffer;
 
+/* A chain of full duplex SPI DMA segments, each in its own chip select
+ * period, run from the RX DMA interrupt with one notification at the end */
 typedef struct
 {
-  Axis3f     bias;
-  Axis3f     variance;
-  Axis3f     mean;
-  bool       isBiasValueFound;
-  bool       isBufferFilled;
-  Axis3i16*  bufHead;
-  Axis3i16   buffer[SENSORS_NBR_OF_BIAS_SAMPLES];
-} BiasObj;
+  GPIO_TypeDef* csPort;   // NULL if the chip select is handled by the caller
+  uint16_t csPin;
+  const uint8_t* tx;
+  uint8_t* rx;
+  uint16_t size;
+} spiDmaSegment_t;
+
+static const spiDmaSegment_t* spiDmaChain;
+static uint8_t spiDmaChainLength;
+static uint8_t spiDmaChainIndex;
+static xSemaphoreHandle spiDmaChainComplete;
+static StaticSemaphore_t spiDmaChainCompleteBuffer;
+
+/* The gyro rates and the accelerometer through the temperature registers are
+ * read in one chain. The accelerometer sends a dummy byte after the command. */
+#define IMU_GYRO_READ_SIZE    (1 + 6)
+#define IMU_ACCEL_READ_SIZE   (2 + BMI088_TEMP_MSB_REG - BMI088_ACCEL_X_LSB_REG + 2)
+#define IMU_ACCEL_DATA_INDEX  2
+#define IMU_TEMP_DATA_INDEX   (IMU_ACCEL_DATA_INDEX + BMI088_TEMP_MSB_REG - BMI088_ACCEL_X_LSB_REG)
+static uint8_t imuGyroTx[IMU_GYRO_READ_SIZE] = {BMI088_GYRO_X_LSB_REG | BMI088_SPI_RD_MASK};
+static uint8_t imuGyroRx[IMU_GYRO_READ_SIZE];
+static uint8_t imuAccelTx[IMU_ACCEL_READ_SIZE] = {BMI088_ACCEL_X_LSB_REG | BMI088_SPI_RD_MASK};
+static uint8_t imuAccelRx[IMU_ACCEL_READ_SIZE];
+static spiDmaSegment_t imuReadChain[2];
+static float imuTemperature;
+
+#ifdef SENSORS_BMI088_FIFO
+/* Gyro FIFO frames (x, y, z) are read in chunks. The watermark interrupt is an
+ * edge, the FIFO is also read after a timeout in case the edge was missed. */
+#define GYRO_FIFO_FRAME_SIZE  6
+#define GYRO_FIFO_READ_FRAMES 8
+#define GYRO_FIFO_READ_SIZE   (1 + GYRO_FIFO_READ_FRAMES * GYRO_FIFO_FRAME_SIZE)
+#define GYRO_FIFO_TIMEOUT     M2T(10)
+static uint8_t gyroFifoTx[GYRO_FIFO_READ_SIZE] = {BMI088_GYRO_FIFO_DATA_REG | BMI088_SPI_RD_MASK};
+static uint8_t gyroFifoRx[GYRO_FIFO_READ_SIZE];
+static spiDmaSegment_t gyroFifoSegment;
+static sampleClock_t gyroFifoClock;
+// Running index of the next sample read from the FIFO
+static uint32_t gyroFifoSampleIndex;
+static uint8_t gyroFifoFrameCount;
+static uint32_t gyroFifoOverrunCount;
+#endif
 
 /* initialize necessary variables */
 static struct bmi088_dev bmi088Dev;
@@ -161,6 +207,8 @@ static xQueueHandle accelerometerDataQueue;
 STATIC_MEM_QUEUE_ALLOC(accelerometerDataQueue, 1, sizeof(Axis3f));
 static xQueueHandle gyroDataQueue;
 STATIC_MEM_QUEUE_ALLOC(gyroDataQueue, 1, sizeof(Axis3f));
+static xQueueHandle gyroSampleQueue;
+STATIC_MEM_QUEUE_ALLOC(gyroSampleQueue, GYRO_SAMPLE_QUEUE_LENGTH, sizeof(imuSample_t));
 static xQueueHandle magnetometerDataQueue;
 STATIC_MEM_QUEUE_ALLOC(magnetometerDataQueue, 1, sizeof(Axis3f));
 static xQueueHandle barometerDataQueue;
@@ -177,7 +225,7 @@ static volatile uint64_t imuIntTimestamp;
 
 static Axis3i16 gyroRaw;
 static Axis3i16 accelRaw;
-NO_DMA_CCM_SAFE_ZERO_INIT static BiasObj gyroBiasRunning;
+static gyroBiasEstimator_t gyroBiasRunning;
 static Axis3f gyroBias;
 #if defined(SENSORS_GYRO_BIAS_CALCULATE_STDDEV) && defined (GYRO_BIAS_LIGHT_WEIGHT)
 static Axis3f gyroBiasStdDev;
@@ -192,9 +240,21 @@ static uint32_t accScaleSumCount = 0;
 // Low Pass filtering
 #define GYRO_LPF_CUTOFF_FREQ  80
 #define ACCEL_LPF_CUTOFF_FREQ 30
-static lpf2pData accLpf[3];
-static lpf2pData gyroLpf[3];
-static void applyAxis3fLpf(lpf2pData *data, Axis3f* in);
+// Gyro and accelerometer axes are filtered in one bank, gyro x, y, z then acc x, y, z.
+// The bank runs at the gyro rate, the accelerometer is held between its samples.
+#define IMU_FILTER_GYRO_CHANNEL 0
+#define IMU_FILTER_ACC_CHANNEL 3
+#define IMU_FILTER_LPF_STAGE 0
+#define IMU_FILTER_NOTCH_STAGE 1
+static biquadBank_t imuFilter;
+static void applyImuFilter(Axis3f* gyro, Axis3f* acc);
+
+// Notch filters on the gyro axes that follow the motor noise peaks
+#define GYRO_NOTCH_DEFAULT_Q 3.0f
+NO_DMA_CCM_SAFE_ZERO_INIT static dynamicNotch_t gyroSpectrum;
+static uint8_t gyroNotchEnable = 0;
+static float gyroNotchQ = GYRO_NOTCH_DEFAULT_Q;
+static void updateGyroNotch(const Axis3f* gyro);
 
 static bool isBarometerPresent = false;
 static uint8_t baroMeasDelayMin = SENSORS_DELAY_BARO;
@@ -211,11 +271,6 @@ static bool processGyroBiasNoBuffer(int16_t gx, int16_t gy, int16_t gz, Axis3f *
 static bool processGyroBias(int16_t gx, int16_t gy, int16_t gz,  Axis3f *gyroBiasOut);
 #endif
 static bool processAccScale(int16_t ax, int16_t ay, int16_t az);
-static void sensorsBiasObjInit(BiasObj* bias);
-static void sensorsCalculateVarianceAndMean(BiasObj* bias, Axis3f* varOut, Axis3f* meanOut);
-static void sensorsCalculateBiasMean(BiasObj* bias, Axis3i32* meanOut);
-static void sensorsAddBiasValue(BiasObj* bias, int16_t x, int16_t y, int16_t z);
-static bool sensorsFindBiasValue(BiasObj* bias);
 static void sensorsAccAlignToGravity(Axis3f* in, Axis3f* out);
 
 STATIC_MEM_TASK_ALLOC(sensorsTask, SENSORS_TASK_STACKSIZE);
@@ -243,23 +298,24 @@ static char spiReceiveByte()
   return spiSendByte(DUMMY_BYTE);
 }
 
-static void spiDMATransaction(uint8_t reg_addr, uint8_t *reg_data, uint16_t len)
+static void spiDMAStartSegment(const spiDmaSegment_t* segment)
 {
-  ASSERT(len < SPI_MAX_DMA_TRANSACTION_SIZE);
-
   // Disable peripheral before setting up for duplex DMA
   SPI_Cmd(BMI088_SPI, DISABLE);
 
-  // DMA already configured, just need to set memory addresses and read command byte
-  spiTxBuffer[0] = reg_addr;
-  BMI088_SPI_TX_DMA_STREAM->M0AR = (uint32_t)&spiTxBuffer[0];
-  BMI088_SPI_TX_DMA_STREAM->NDTR = len + 1;
+  if (segment->csPort)
+  {
+    GPIO_ResetBits(segment->csPort, segment->csPin);
+  }
+
+  // DMA already configured, just need to set memory addresses and sizes
+  BMI088_SPI_TX_DMA_STREAM->M0AR = (uint32_t)segment->tx;
+  BMI088_SPI_TX_DMA_STREAM->NDTR = segment->size;
 
-  BMI088_SPI_RX_DMA_STREAM->M0AR = (uint32_t)&spiRxBuffer[0];
-  BMI088_SPI_RX_DMA_STREAM->NDTR = len + 1;
+  BMI088_SPI_RX_DMA_STREAM->M0AR = (uint32_t)segment->rx;
+  BMI088_SPI_RX_DMA_STREAM->NDTR = segment->size;
 
-  // Enable SPI DMA Interrupts
-  DMA_ITConfig(BMI088_SPI_TX_DMA_STREAM, DMA_IT_TC, ENABLE);
+  // The RX stream is done last, only its interrupt is used
   DMA_ITConfig(BMI088_SPI_RX_DMA_STREAM, DMA_IT_TC, ENABLE);
 
   // Clear DMA Flags
@@ -278,11 +334,33 @@ static void spiDMATransaction(uint8_t reg_addr, uint8_t *reg_data, uint16_t len)
 
   // Enable peripheral to begin the transaction
   SPI_Cmd(BMI088_SPI, ENABLE);
+}
+
+static void spiDMAChain(const spiDmaSegment_t* chain, uint8_t length)
+{
+  spiDmaChain = chain;
+  spiDmaChainLength = length;
+  spiDmaChainIndex = 0;
+
+  spiDMAStartSegment(&chain[0]);
 
   // Wait for completion
   // TODO: Better error handling rather than passing up invalid data
-  xSemaphoreTake(spiTxDMAComplete, portMAX_DELAY);
-  xSemaphoreTake(spiRxDMAComplete, portMAX_DELAY);
+  xSemaphoreTake(spiDmaChainComplete, portMAX_DELAY);
+}
+
+static void spiDMATransaction(uint8_t reg_addr, uint8_t *reg_data, uint16_t len)
+{
+  ASSERT(len < SPI_MAX_DMA_TRANSACTION_SIZE);
+
+  spiTxBuffer[0] = reg_addr;
+  const spiDmaSegment_t segment = {
+    .csPort = 0,
+    .tx = spiTxBuffer,
+    .rx = spiRxBuffer,
+    .size = len + 1,
+  };
+  spiDMAChain(&segment, 1);
 
   // Copy the data (discarding the dummy byte) into the buffer
   // TODO: Avoid this memcpy either by figuring out how to configure the STM SPI to discard the byte or handle it higher up
@@ -500,14 +578,34 @@ static void spiDMAInit(void)
   NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
   NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
 
-  NVIC_InitStructure.NVIC_IRQChannel = BMI088_SPI_TX_DMA_IRQ;
-  NVIC_Init(&NVIC_InitStructure);
-
   NVIC_InitStructure.NVIC_IRQChannel = BMI088_SPI_RX_DMA_IRQ;
   NVIC_Init(&NVIC_InitStructure);
 
-  spiTxDMAComplete = xSemaphoreCreateBinaryStatic(&spiTxDMACompleteBuffer);
-  spiRxDMAComplete = xSemaphoreCreateBinaryStatic(&spiRxDMACompleteBuffer);
+  spiDmaChainComplete = xSemaphoreCreateBinaryStatic(&spiDmaChainCompleteBuffer);
+
+  imuReadChain[0] = (spiDmaSegment_t){
+    .csPort = BMI088_GYR_GPIO_CS_PORT,
+    .csPin = BMI088_GYR_GPIO_CS,
+    .tx = imuGyroTx,
+    .rx = imuGyroRx,
+    .size = IMU_GYRO_READ_SIZE,
+  };
+  imuReadChain[1] = (spiDmaSegment_t){
+    .csPort = BMI088_ACC_GPIO_CS_PORT,
+    .csPin = BMI088_ACC_GPIO_CS,
+    .tx = imuAccelTx,
+    .rx = imuAccelRx,
+    .size = IMU_ACCEL_READ_SIZE,
+  };
+#ifdef SENSORS_BMI088_FIFO
+  gyroFifoSegment = (spiDmaSegment_t){
+    .csPort = BMI088_GYR_GPIO_CS_PORT,
+    .csPin = BMI088_GYR_GPIO_CS,
+    .tx = gyroFifoTx,
+    .rx = gyroFifoRx,
+    .size = GYRO_FIFO_READ_SIZE,
+  };
+#endif
 }
 
 static uint16_t sensorsGyroGet(Axis3i16* dataOut)
@@ -515,11 +613,149 @@ static uint16_t sensorsGyroGet(Axis3i16* dataOut)
   return bmi088_get_gyro_data((struct bmi088_sensor_data*)dataOut, &bmi088Dev);
 }
 
-static void sensorsAccelGet(Axis3i16* dataOut)
+static inline int16_t sensorsInt16(const uint8_t* lsb)
+{
+  return (int16_t)((uint16_t)lsb[1] << 8 | lsb[0]);
+}
+
+static void sensorsDecodeAccel(Axis3i16* accelOut, float* temperatureOut)
 {
-  bmi088_get_accel_data((struct bmi088_sensor_data*)dataOut, &bmi088Dev);
+  accelOut->x = sensorsInt16(&imuAccelRx[IMU_ACCEL_DATA_INDEX]);
+  accelOut->y = sensorsInt16(&imuAccelRx[IMU_ACCEL_DATA_INDEX + 2]);
+  accelOut->z = sensorsInt16(&imuAccelRx[IMU_ACCEL_DATA_INDEX + 4]);
+
+  // 11 bit two's complement, 0.125 degrees per LSB, 0 at 23 degrees
+  int16_t temperature = (int16_t)(imuAccelRx[IMU_TEMP_DATA_INDEX] << 3 | imuAccelRx[IMU_TEMP_DATA_INDEX + 1] >> 5);
+  if (temperature > 1023)
+  {
+    temperature -= 2048;
+  }
+  *temperatureOut = temperature * 0.125f + 23.0f;
 }
 
+/* Read the gyro, the accelerometer and the temperature in one DMA chain */
+static void sensorsImuRead(Axis3i16* gyroOut, Axis3i16* accelOut, float* temperatureOut)
+{
+  spiDMAChain(imuReadChain, 2);
+
+  gyroOut->x = sensorsInt16(&imuGyroRx[1]);
+  gyroOut->y = sensorsInt16(&imuGyroRx[3]);
+  gyroOut->z = sensorsInt16(&imuGyroRx[5]);
+
+  sensorsDecodeAccel(accelOut, temperatureOut);
+}
+
+/* Remove the bias and scale to deg/s */
+static void sensorsScaleGyro(const Axis3i16* raw, Axis3f* gyro)
+{
+#ifdef GYRO_BIAS_LIGHT_WEIGHT
+  gyroBiasFound = processGyroBiasNoBuffer(raw->x, raw->y, raw->z, &gyroBias);
+#else
+  gyroBiasFound = processGyroBias(raw->x, raw->y, raw->z, &gyroBias);
+#endif
+  gyro->x = (raw->x - gyroBias.x) * SENSORS_BMI088_DEG_PER_LSB_CFG;
+  gyro->y = (raw->y - gyroBias.y) * SENSORS_BMI088_DEG_PER_LSB_CFG;
+  gyro->z = (raw->z - gyroBias.z) * SENSORS_BMI088_DEG_PER_LSB_CFG;
+}
+
+/* Calibrate the scale when the platform is still, scale to Gs and align to gravity */
+static void sensorsScaleAcc(const Axis3i16* raw, Axis3f* acc)
+{
+  Axis3f accScaled;
+
+  if (gyroBiasFound)
+  {
+     processAccScale(raw->x, raw->y, raw->z);
+  }
+  accScaled.x = raw->x * SENSORS_BMI088_G_PER_LSB_CFG / accScale;
+  accScaled.y = raw->y * SENSORS_BMI088_G_PER_LSB_CFG / accScale;
+  accScaled.z = raw->z * SENSORS_BMI088_G_PER_LSB_CFG / accScale;
+  sensorsAccAlignToGravity(&accScaled, acc);
+}
+
+static void sensorsQueueGyroSample(const imuSample_t* sample)
+{
+  // Drop the oldest sample if nobody reads them
+  if (pdTRUE != xQueueSend(gyroSampleQueue, sample, 0))
+  {
+    imuSample_t oldest;
+    xQueueReceive(gyroSampleQueue, &oldest, 0);
+    xQueueSend(gyroSampleQueue, sample, 0);
+  }
+}
+
+#ifdef SENSORS_BMI088_FIFO
+/* Read all samples in the gyro FIFO and the accelerometer and temperature once.
+ * Every gyro sample is filtered, timestamped and queued, the newest one is the
+ * decimated output in sensorData. Returns false if the FIFO was empty or had
+ * overrun. */
+static bool sensorsImuReadFifo(const bool isWatermark)
+{
+  uint8_t status = 0;
+  bmi088_get_gyro_regs(BMI088_GYRO_FIFO_STAT_REG, &status, 1, &bmi088Dev);
+  if (BMI088_GET_BITSLICE(status, BMI088_GYRO_FIFO_OVERRUN))
+  {
+    // Samples were lost and their times are unknown. Setting the mode clears
+    // the flag and empties the FIFO, so the batch is dropped and the sample
+    // clock starts over from the next watermark interrupt.
+    gyroFifoOverrunCount++;
+    bmi088_set_gyro_fifo_mode(BMI088_GYRO_STREAM_OP_MODE, &bmi088Dev);
+    sampleClockReset(&gyroFifoClock);
+    return false;
+  }
+
+  const uint8_t frameCount = BMI088_GET_BITSLICE(status, BMI088_GYRO_FIFO_COUNTER);
+  if (frameCount == 0)
+  {
+    return false;
+  }
+  gyroFifoFrameCount = frameCount;
+
+  if (isWatermark)
+  {
+    // The interrupt fired when the FIFO reached the watermark after the last read
+    sampleClockAddAnchor(&gyroFifoClock, gyroFifoSampleIndex + GYRO_FIFO_WATERMARK - 1, imuIntTimestamp);
+  }
+
+  Axis3f acc;
+  spiDMAChain(&imuReadChain[1], 1);
+  sensorsDecodeAccel(&accelRaw, &imuTemperature);
+  sensorsScaleAcc(&accelRaw, &acc);
+
+  imuSample_t sample = {.timestamp = 0};
+  uint8_t frame = 0;
+  while (frame < frameCount)
+  {
+    const uint8_t chunk = (frameCount - frame < GYRO_FIFO_READ_FRAMES) ? frameCount - frame : GYRO_FIFO_READ_FRAMES;
+    gyroFifoSegment.size = 1 + chunk * GYRO_FIFO_FRAME_SIZE;
+    spiDMAChain(&gyroFifoSegment, 1);
+
+    for (uint8_t i = 0; i < chunk; i++)
+    {
+      const uint8_t* data = &gyroFifoRx[1 + i * GYRO_FIFO_FRAME_SIZE];
+      gyroRaw.x = sensorsInt16(&data[0]);
+      gyroRaw.y = sensorsInt16(&data[2]);
+      gyroRaw.z = sensorsInt16(&data[4]);
+
+      sensorsScaleGyro(&gyroRaw, &sample.value);
+      updateGyroNotch(&sample.value);
+      sensorData.acc = acc;
+      applyImuFilter(&sample.value, &sensorData.acc);
+
+      sample.timestamp = sampleClockTimestamp(&gyroFifoClock, gyroFifoSampleIndex);
+      gyroFifoSampleIndex++;
+      sensorsQueueGyroSample(&sample);
+    }
+    frame += chunk;
+  }
+
+  sensorData.gyro = sample.value;
+  sensorData.interruptTimestamp = sample.timestamp;
+
+  return true;
+}
+#endif
+
 static void sensorsScaleBaro(baro_t* baroScaled, float pressure,
                              float temperature)
 {
@@ -549,6 +785,11 @@ bool sensorsBmi088SpiBmp388ReadBaro(baro_t *baro)
   return (pdTRUE == xQueueReceive(barometerDataQueue, baro, 0));
 }
 
+bool sensorsBmi088SpiBmp388ReadGyroSample(imuSample_t *sample)
+{
+  return (pdTRUE == xQueueReceive(gyroSampleQueue, sample, 0));
+}
+
 void sensorsBmi088SpiBmp388Acquire(sensorData_t *sensors, const uint32_t tick)
 {
   sensorsReadGyro(&sensors->gyro);
@@ -567,44 +808,40 @@ static void sensorsTask(void *param)
 {
   systemWaitStart();
 
-  Axis3f accScaled;
   /* wait an additional second the keep bus free
    * this is only required by the z-ranger, since the
    * configuration will be done after system start-up */
   //vTaskDelayUntil(&lastWakeTime, M2T(1500));
   while (1)
   {
+#ifdef SENSORS_BMI088_FIFO
+    const bool isWatermark = (pdTRUE == xSemaphoreTake(sensorsDataReady, GYRO_FIFO_TIMEOUT));
+    if (!sensorsImuReadFifo(isWatermark))
+    {
+      continue;
+    }
+#else
     if (pdTRUE == xSemaphoreTake(sensorsDataReady, portMAX_DELAY))
     {
       sensorData.interruptTimestamp = imuIntTimestamp;
 
       /* get data from chosen sensors */
-      sensorsGyroGet(&gyroRaw);
-      sensorsAccelGet(&accelRaw);
+      sensorsImuRead(&gyroRaw, &accelRaw, &imuTemperature);
 
-      /* calibrate if necessary */
-#ifdef GYRO_BIAS_LIGHT_WEIGHT
-      gyroBiasFound = processGyroBiasNoBuffer(gyroRaw.x, gyroRaw.y, gyroRaw.z, &gyroBias);
-#else
-      gyroBiasFound = processGyroBias(gyroRaw.x, gyroRaw.y, gyroRaw.z, &gyroBias);
-#endif
-      if (gyroBiasFound)
-      {
-         processAccScale(accelRaw.x, accelRaw.y, accelRaw.z);
-      }
-      /* Gyro */
-      sensorData.gyro.x =  (gyroRaw.x - gyroBias.x) * SENSORS_BMI088_DEG_PER_LSB_CFG;
-      sensorData.gyro.y =  (gyroRaw.y - gyroBias.y) * SENSORS_BMI088_DEG_PER_LSB_CFG;
-      sensorData.gyro.z =  (gyroRaw.z - gyroBias.z) * SENSORS_BMI088_DEG_PER_LSB_CFG;
-      applyAxis3fLpf((lpf2pData*)(&gyroLpf), &sensorData.gyro);
-
-      /* Acelerometer */
-      accScaled.x = accelRaw.x * SENSORS_BMI088_G_PER_LSB_CFG / accScale;
-      accScaled.y = accelRaw.y * SENSORS_BMI088_G_PER_LSB_CFG / accScale;
-      accScaled.z = accelRaw.z * SENSORS_BMI088_G_PER_LSB_CFG / accScale;
-      sensorsAccAlignToGravity(&accScaled, &sensorData.acc);
-      applyAxis3fLpf((lpf2pData*)(&accLpf), &sensorData.acc);
+      /* calibrate if necessary and scale */
+      sensorsScaleGyro(&gyroRaw, &sensorData.gyro);
+      sensorsScaleAcc(&accelRaw, &sensorData.acc);
+
+      updateGyroNotch(&sensorData.gyro);
+      applyImuFilter(&sensorData.gyro, &sensorData.acc);
+
+      const imuSample_t gyroSample = {
+        .value = sensorData.gyro,
+        .timestamp = sensorData.interruptTimestamp,
+      };
+      sensorsQueueGyroSample(&gyroSample);
     }
+#endif
 
     if (isBarometerPresent)
     {
@@ -666,9 +903,14 @@ static void sensorsDeviceInit(void)
     bmi088Dev.gyro_cfg.power = BMI088_GYRO_PM_NORMAL;
     rslt |= bmi088_set_gyro_power_mode(&bmi088Dev);
     /* set bandwidth and range of gyro */
+#ifdef SENSORS_BMI088_FIFO
+    bmi088Dev.gyro_cfg.bw = BMI088_GYRO_BW_230_ODR_2000_HZ;
+    bmi088Dev.gyro_cfg.odr = BMI088_GYRO_BW_230_ODR_2000_HZ;
+#else
     bmi088Dev.gyro_cfg.bw = BMI088_GYRO_BW_116_ODR_1000_HZ;
-    bmi088Dev.gyro_cfg.range = SENSORS_BMI088_GYRO_FS_CFG;
     bmi088Dev.gyro_cfg.odr = BMI088_GYRO_BW_116_ODR_1000_HZ;
+#endif
+    bmi088Dev.gyro_cfg.range = SENSORS_BMI088_GYRO_FS_CFG;
     rslt |= bmi088_set_gyro_meas_conf(&bmi088Dev);
 
     intConfig.gyro_int_channel = BMI088_INT_CHANNEL_3;
@@ -676,8 +918,21 @@ static void sensorsDeviceInit(void)
     intConfig.gyro_int_pin_3_cfg.enable_int_pin = 1;
     intConfig.gyro_int_pin_3_cfg.lvl = 1;
     intConfig.gyro_int_pin_3_cfg.output_mode = 0;
+#ifdef SENSORS_BMI088_FIFO
+    /* Buffer the samples in the FIFO, keeping the newest ones if it is full,
+     * and interrupt when it reaches the watermark */
+    rslt = bmi088_set_gyro_fifo_mode(BMI088_GYRO_STREAM_OP_MODE, &bmi088Dev);
+    rslt |= bmi088_set_gyro_fifo_data_sel(BMI088_GYRO_ALL_INT_DATA, &bmi088Dev);
+    rslt |= bmi088_set_gyro_fifo_wm(GYRO_FIFO_WATERMARK, &bmi088Dev);
+    rslt |= bmi088_set_gyro_fifo_wm_int(&intConfig, &bmi088Dev, BMI088_ENABLE);
+    /* The FIFO interrupt is enabled separately from the watermark */
+    uint8_t intCtrl = BMI088_SET_BITSLICE(0, BMI088_GYRO_FIFO_EN, BMI088_ENABLE);
+    rslt |= bmi088_set_gyro_regs(BMI088_GYRO_INT_CTRL_REG, &intCtrl, 1, &bmi088Dev);
+    sampleClockInit(&gyroFifoClock, 1000000.0f / SENSORS_GYRO_RATE_HZ);
+#else
     /* Setting the interrupt configuration */
     rslt = bmi088_set_gyro_int_config(&intConfig, &bmi088Dev);
+#endif
 
     bmi088Dev.delay_ms(50);
     struct bmi088_sensor_data gyr;
@@ -785,11 +1040,14 @@ static void sensorsDeviceInit(void)
   }
 
   // Init second order filer for accelerometer and gyro
+  biquadBankInit(&imuFilter, 6, IMU_FILTER_NOTCH_STAGE + DYNAMIC_NOTCH_MAX_PEAKS);
   for (uint8_t i = 0; i < 3; i++)
   {
-    lpf2pInit(&gyroLpf[i], 1000, GYRO_LPF_CUTOFF_FREQ);
-    lpf2pInit(&accLpf[i],  1000, ACCEL_LPF_CUTOFF_FREQ);
+    biquadBankSetLowPass(&imuFilter, IMU_FILTER_GYRO_CHANNEL + i, IMU_FILTER_LPF_STAGE, SENSORS_GYRO_RATE_HZ, GYRO_LPF_CUTOFF_FREQ);
+    biquadBankSetLowPass(&imuFilter, IMU_FILTER_ACC_CHANNEL + i, IMU_FILTER_LPF_STAGE, SENSORS_GYRO_RATE_HZ, ACCEL_LPF_CUTOFF_FREQ);
   }
+  // The spectrum is analysed at the loop rate
+  dynamicNotchInit(&gyroSpectrum, SENSORS_GYRO_RATE_HZ, SENSORS_GYRO_RATE_HZ / SENSORS_READ_RATE_HZ);
 
   cosPitch = cosf(configblockGetCalibPitch() * (float) M_PI / 180);
   sinPitch = sinf(configblockGetCalibPitch() * (float) M_PI / 180);
@@ -803,6 +1061,7 @@ static void sensorsTaskInit(void)
 {
   accelerometerDataQueue = STATIC_MEM_QUEUE_CREATE(accelerometerDataQueue);
   gyroDataQueue = STATIC_MEM_QUEUE_CREATE(gyroDataQueue);
+  gyroSampleQueue = STATIC_MEM_QUEUE_CREATE(gyroSampleQueue);
   magnetometerDataQueue = STATIC_MEM_QUEUE_CREATE(magnetometerDataQueue);
   barometerDataQueue = STATIC_MEM_QUEUE_CREATE(barometerDataQueue);
 
@@ -846,7 +1105,7 @@ void sensorsBmi088SpiBmp388Init(void)
   spiInit();
   spiDMAInit();
 
-  sensorsBiasObjInit(&gyroBiasRunning);
+  gyroBiasEstimatorInit(&gyroBiasRunning, GYRO_BIAS_WINDOW_SAMPLES, GYRO_BIAS_MIN_SAMPLES, GYRO_VARIANCE_THRESHOLD);
   sensorsDeviceInit();
   sensorsInterruptInit();
   sensorsTaskInit();
@@ -970,133 +1229,39 @@ static bool processGyroBiasNoBuffer(int16_t gx, int16_t gy, int16_t gz, Axis3f *
 }
 #else
 /**
- * Calculates the bias first when the gyro variance is below threshold. Requires a buffer
- * but calibrates platform first when it is stable.
+ * Calculates the bias first when the gyro variance is below threshold, then
+ * keeps tracking it while the platform is still and the motors are stopped.
+ * Requires no buffer.
  */
 static bool processGyroBias(int16_t gx, int16_t gy, int16_t gz, Axis3f *gyroBiasOut)
 {
-  sensorsAddBiasValue(&gyroBiasRunning, gx, gy, gz);
+  const bool wasBiasFound = gyroBiasRunning.isBiasFound;
+  const float sample[GYRO_BIAS_ESTIMATOR_AXES] = {gx, gy, gz};
 
-  if (!gyroBiasRunning.isBiasValueFound)
+  // A steady rotation in flight has a low variance and would be taken as drift
+  bool areMotorsStopped = true;
+  for (int i = 0; i < NBR_OF_MOTORS; i++)
   {
-    sensorsFindBiasValue(&gyroBiasRunning);
-    if (gyroBiasRunning.isBiasValueFound)
+    if (motorsGetRatio(i) != 0)
     {
-      soundSetEffect(SND_CALIB);
-      ledseqRun(&seq_calibrated);
+      areMotorsStopped = false;
     }
   }
+  gyroBiasEstimatorSetTracking(&gyroBiasRunning, areMotorsStopped);
 
-  gyroBiasOut->x = gyroBiasRunning.bias.x;
-  gyroBiasOut->y = gyroBiasRunning.bias.y;
-  gyroBiasOut->z = gyroBiasRunning.bias.z;
-
-  return gyroBiasRunning.isBiasValueFound;
-}
-#endif
-
-static void sensorsBiasObjInit(BiasObj* bias)
-{
-  bias->isBufferFilled = false;
-  bias->bufHead = bias->buffer;
-}
-
-/**
- * Calculates the variance and mean for the bias buffer.
- */
-static void sensorsCalculateVarianceAndMean(BiasObj* bias, Axis3f* varOut, Axis3f* meanOut)
-{
-  uint32_t i;
-  int64_t sum[GYRO_NBR_OF_AXES] = {0};
-  int64_t sumSq[GYRO_NBR_OF_AXES] = {0};
-
-  for (i = 0; i < SENSORS_NBR_OF_BIAS_SAMPLES; i++)
+  if (gyroBiasEstimatorAdd(&gyroBiasRunning, sample) && !wasBiasFound)
   {
-    sum[0] += bias->buffer[i].x;
-    sum[1] += bias->buffer[i].y;
-    sum[2] += bias->buffer[i].z;
-    sumSq[0] += bias->buffer[i].x * bias->buffer[i].x;
-    sumSq[1] += bias->buffer[i].y * bias->buffer[i].y;
-    sumSq[2] += bias->buffer[i].z * bias->buffer[i].z;
+    soundSetEffect(SND_CALIB);
+    ledseqRun(&seq_calibrated);
   }
 
-  varOut->x = (sumSq[0] - ((int64_t)sum[0] * sum[0]) / SENSORS_NBR_OF_BIAS_SAMPLES);
-  varOut->y = (sumSq[1] - ((int64_t)sum[1] * sum[1]) / SENSORS_NBR_OF_BIAS_SAMPLES);
-  varOut->z = (sumSq[2] - ((int64_t)sum[2] * sum[2]) / SENSORS_NBR_OF_BIAS_SAMPLES);
-
-  meanOut->x = (float)sum[0] / SENSORS_NBR_OF_BIAS_SAMPLES;
-  meanOut->y = (float)sum[1] / SENSORS_NBR_OF_BIAS_SAMPLES;
-  meanOut->z = (float)sum[2] / SENSORS_NBR_OF_BIAS_SAMPLES;
-}
-
-/**
- * Calculates the mean for the bias buffer.
- */
-static void __attribute__((used)) sensorsCalculateBiasMean(BiasObj* bias, Axis3i32* meanOut)
-{
-  uint32_t i;
-  int32_t sum[GYRO_NBR_OF_AXES] = {0};
-
-  for (i = 0; i < SENSORS_NBR_OF_BIAS_SAMPLES; i++)
-  {
-    sum[0] += bias->buffer[i].x;
-    sum[1] += bias->buffer[i].y;
-    sum[2] += bias->buffer[i].z;
-  }
-
-  meanOut->x = sum[0] / SENSORS_NBR_OF_BIAS_SAMPLES;
-  meanOut->y = sum[1] / SENSORS_NBR_OF_BIAS_SAMPLES;
-  meanOut->z = sum[2] / SENSORS_NBR_OF_BIAS_SAMPLES;
-}
-
-/**
- * Adds a new value to the variance buffer and if it is full
- * replaces the oldest one. Thus a circular buffer.
- */
-static void sensorsAddBiasValue(BiasObj* bias, int16_t x, int16_t y, int16_t z)
-{
-  bias->bufHead->x = x;
-  bias->bufHead->y = y;
-  bias->bufHead->z = z;
-  bias->bufHead++;
-
-  if (bias->bufHead >= &bias->buffer[SENSORS_NBR_OF_BIAS_SAMPLES])
-  {
-    bias->bufHead = bias->buffer;
-    bias->isBufferFilled = true;
-  }
-}
-
-/**
- * Checks if the variances is below the predefined thresholds.
- * The bias value should have been added before calling this.
- * @param bias  The bias object
- */
-static bool sensorsFindBiasValue(BiasObj* bias)
-{
-  static int32_t varianceSampleTime;
-  bool foundBias = false;
-
-  if (bias->isBufferFilled)
-  {
-    sensorsCalculateVarianceAndMean(bias, &bias->variance, &bias->mean);
-
-    if (bias->variance.x < GYRO_VARIANCE_THRESHOLD_X &&
-        bias->variance.y < GYRO_VARIANCE_THRESHOLD_Y &&
-        bias->variance.z < GYRO_VARIANCE_THRESHOLD_Z &&
-        (varianceSampleTime + GYRO_MIN_BIAS_TIMEOUT_MS < xTaskGetTickCount()))
-    {
-      varianceSampleTime = xTaskGetTickCount();
-      bias->bias.x = bias->mean.x;
-      bias->bias.y = bias->mean.y;
-      bias->bias.z = bias->mean.z;
-      foundBias = true;
-      bias->isBiasValueFound = true;
-    }
-  }
+  gyroBiasOut->x = gyroBiasRunning.bias[0];
+  gyroBiasOut->y = gyroBiasRunning.bias[1];
+  gyroBiasOut->z = gyroBiasRunning.bias[2];
 
-  return foundBias;
+  return gyroBiasRunning.isBiasFound;
 }
+#endif
 
 bool sensorsBmi088SpiBmp388ManufacturingTest(void)
 {
@@ -1162,7 +1327,8 @@ void sensorsBmi088SpiBmp388SetAccMode(accModes accMode)
       }
       for (uint8_t i = 0; i < 3; i++)
       {
-        lpf2pInit(&accLpf[i],  1000, 500);
+        biquadBankSetLowPass(&imuFilter, IMU_FILTER_ACC_CHANNEL + i, IMU_FILTER_LPF_STAGE, SENSORS_GYRO_RATE_HZ, 500);
+        biquadBankResetChannel(&imuFilter, IMU_FILTER_ACC_CHANNEL + i, 0.0f);
       }
       break;
     case ACC_MODE_FLIGHT:
@@ -1177,50 +1343,56 @@ void sensorsBmi088SpiBmp388SetAccMode(accModes accMode)
       }
       for (uint8_t i = 0; i < 3; i++)
       {
-        lpf2pInit(&accLpf[i],  1000, ACCEL_LPF_CUTOFF_FREQ);
+        biquadBankSetLowPass(&imuFilter, IMU_FILTER_ACC_CHANNEL + i, IMU_FILTER_LPF_STAGE, SENSORS_GYRO_RATE_HZ, ACCEL_LPF_CUTOFF_FREQ);
+        biquadBankResetChannel(&imuFilter, IMU_FILTER_ACC_CHANNEL + i, 0.0f);
       }
       break;
   }
 }
 
-static void applyAxis3fLpf(lpf2pData *data, Axis3f* in)
+static void applyImuFilter(Axis3f* gyro, Axis3f* acc)
 {
+  float samples[6];
+
+  for (uint8_t i = 0; i < 3; i++) {
+    samples[IMU_FILTER_GYRO_CHANNEL + i] = gyro->axis[i];
+    samples[IMU_FILTER_ACC_CHANNEL + i] = acc->axis[i];
+  }
+
+  biquadBankApply(&imuFilter, samples);
+
   for (uint8_t i = 0; i < 3; i++) {
-    in->axis[i] = lpf2pApply(&data[i], in->axis[i]);
+    gyro->axis[i] = samples[IMU_FILTER_GYRO_CHANNEL + i];
+    acc->axis[i] = samples[IMU_FILTER_ACC_CHANNEL + i];
   }
 }
 
-void sensorsBmi088SpiBmp388DataAvailableCallback(void)
+static void updateGyroNotch(const Axis3f* gyro)
 {
-  portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
-  imuIntTimestamp = usecTimestamp();
-  xSemaphoreGiveFromISR(sensorsDataReady, &xHigherPriorityTaskWoken);
+  // The spectrum is always analysed so that the peaks can be logged, the
+  // notch filters are only moved to the peaks when enabled
+  const int axis = dynamicNotchAddSample(&gyroSpectrum, gyro->axis);
+  if (axis < 0) {
+    return;
+  }
 
-  if (xHigherPriorityTaskWoken)
-  {
-    portYIELD();
+  if (gyroNotchEnable) {
+    dynamicNotchRetune(&gyroSpectrum, axis, &imuFilter, IMU_FILTER_GYRO_CHANNEL + axis,
+                       IMU_FILTER_NOTCH_STAGE, SENSORS_GYRO_RATE_HZ, gyroNotchQ);
+  } else {
+    for (uint8_t i = 0; i < DYNAMIC_NOTCH_MAX_PEAKS; i++) {
+      biquadBankSetPassThrough(&imuFilter, IMU_FILTER_GYRO_CHANNEL + axis, IMU_FILTER_NOTCH_STAGE + i);
+    }
   }
 }
 
-void __attribute__((used)) BMI088_SPI_TX_DMA_IRQHandler(void)
+void sensorsBmi088SpiBmp388DataAvailableCallback(void)
 {
   portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
-
-  // Stop and cleanup DMA stream
-  DMA_ITConfig(BMI088_SPI_TX_DMA_STREAM, DMA_IT_TC, DISABLE);
-  DMA_ClearITPendingBit(BMI088_SPI_TX_DMA_STREAM, BMI088_SPI_TX_DMA_FLAG_TCIF);
-
-  // Clear stream flags
-  DMA_ClearFlag(BMI088_SPI_TX_DMA_STREAM,BMI088_SPI_TX_DMA_FLAG_TCIF);
-
-  // Disable SPI DMA requests
-  SPI_I2S_DMACmd(BMI088_SPI, SPI_I2S_DMAReq_Tx, DISABLE);
-
-  // Disable streams
-  DMA_Cmd(BMI088_SPI_TX_DMA_STREAM, DISABLE);
-
-  // Give the semaphore, allowing the SPI transaction to complete
-  xSemaphoreGiveFromISR(spiTxDMAComplete, &xHigherPriorityTaskWoken);
+  EVENT_TRACE_ISR_ENTER("bmi088 data ready");
+  imuIntTimestamp = usecTimestamp();
+  xSemaphoreGiveFromISR(sensorsDataReady, &xHigherPriorityTaskWoken);
+  EVENT_TRACE_ISR_EXIT("bmi088 data ready");
 
   if (xHigherPriorityTaskWoken)
   {
@@ -1231,6 +1403,7 @@ void __attribute__((used)) BMI088_SPI_TX_DMA_IRQHandler(void)
 void __attribute__((used)) BMI088_SPI_RX_DMA_IRQHandler(void)
 {
   portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+  EVENT_TRACE_ISR_ENTER("bmi088 spi rx dma");
 
   // Stop and cleanup DMA stream
   DMA_ITConfig(BMI088_SPI_RX_DMA_STREAM, DMA_IT_TC, DISABLE);
@@ -1238,15 +1411,34 @@ void __attribute__((used)) BMI088_SPI_RX_DMA_IRQHandler(void)
 
   // Clear stream flags
   DMA_ClearFlag(BMI088_SPI_RX_DMA_STREAM, BMI088_SPI_RX_DMA_FLAG_TCIF);
+  // The TX stream completed before the last byte was received
+  DMA_ClearFlag(BMI088_SPI_TX_DMA_STREAM, BMI088_SPI_TX_DMA_FLAG_TCIF);
 
   // Disable SPI DMA requests
-  SPI_I2S_DMACmd(BMI088_SPI, SPI_I2S_DMAReq_Rx, DISABLE);
+  SPI_I2S_DMACmd(BMI088_SPI, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, DISABLE);
 
   // Disable streams
   DMA_Cmd(BMI088_SPI_RX_DMA_STREAM, DISABLE);
+  DMA_Cmd(BMI088_SPI_TX_DMA_STREAM, DISABLE);
+
+  const spiDmaSegment_t* segment = &spiDmaChain[spiDmaChainIndex];
+  if (segment->csPort)
+  {
+    GPIO_SetBits(segment->csPort, segment->csPin);
+  }
 
-  // Give the semaphore, allowing the SPI transaction to complete
-  xSemaphoreGiveFromISR(spiRxDMAComplete, &xHigherPriorityTaskWoken);
+  spiDmaChainIndex++;
+  if (spiDmaChainIndex < spiDmaChainLength)
+  {
+    spiDMAStartSegment(&spiDmaChain[spiDmaChainIndex]);
+  }
+  else
+  {
+    // Give the semaphore, allowing the SPI transaction to complete
+    xSemaphoreGiveFromISR(spiDmaChainComplete, &xHigherPriorityTaskWoken);
+  }
+
+  EVENT_TRACE_ISR_EXIT("bmi088 spi rx dma");
 
   if (xHigherPriorityTaskWoken)
   {
@@ -1254,6 +1446,48 @@ void __attribute__((used)) BMI088_SPI_RX_DMA_IRQHandler(void)
   }
 }
 
+/**
+ * Temperature [degrees C] of the BMI088 accelerometer, read with the IMU data
+ */
+LOG_GROUP_START(imu_sensors)
+LOG_ADD(LOG_FLOAT, temp, &imuTemperature)
+LOG_GROUP_STOP(imu_sensors)
+
+#ifdef SENSORS_BMI088_FIFO
+// Gyro samples read from the FIFO, more than the watermark when the task is late
+LOG_GROUP_START(gyroFifo)
+LOG_ADD(LOG_UINT8, frames, &gyroFifoFrameCount)         // samples in the last read
+LOG_ADD(LOG_UINT32, overruns, &gyroFifoOverrunCount)    // times samples were lost
+LOG_ADD(LOG_FLOAT, period, &gyroFifoClock.period)       // estimated sample period [us]
+LOG_GROUP_STOP(gyroFifo)
+#endif
+
 PARAM_GROUP_START(imu_sensors)
 PARAM_ADD(PARAM_UINT8 | PARAM_RONLY, BMP388, &isBarometerPresent)
 PARAM_GROUP_STOP(imu_sensors)
+
+PARAM_GROUP_START(dynNotch)
+PARAM_ADD(PARAM_UINT8, enable, &gyroNotchEnable)                // set true to move gyro notch filters to the tracked peaks
+PARAM_ADD(PARAM_FLOAT, q, &gyroNotchQ)                          // notch quality factor, center frequency / bandwidth
+PARAM_ADD(PARAM_FLOAT, minFreq, &gyroSpectrum.minFreq)          // frequency range [Hz] of tracked peaks
+PARAM_ADD(PARAM_FLOAT, maxFreq, &gyroSpectrum.maxFreq)
+PARAM_ADD(PARAM_FLOAT, threshold, &gyroSpectrum.threshold)      // min ratio of peak power to median power of the range
+PARAM_GROUP_STOP(dynNotch)
+
+// Frequencies [Hz] of the tracked gyro noise peaks, 0 when not tracked
+LOG_GROUP_START(dynNotch)
+LOG_ADD(LOG_FLOAT, x1, &gyroSpectrum.peakFreq[0][0])
+LOG_ADD(LOG_FLOAT, x2, &gyroSpectrum.peakFreq[0][1])
+LOG_ADD(LOG_FLOAT, y1, &gyroSpectrum.peakFreq[1][0])
+LOG_ADD(LOG_FLOAT, y2, &gyroSpectrum.peakFreq[1][1])
+LOG_ADD(LOG_FLOAT, z1, &gyroSpectrum.peakFreq[2][0])
+LOG_ADD(LOG_FLOAT, z2, &gyroSpectrum.peakFreq[2][1])
+LOG_GROUP_STOP(dynNotch)
+
+// Gyro bias [LSB], tracked while the platform is still
+LOG_GROUP_START(gyroBias)
+LOG_ADD(LOG_FLOAT, x, &gyroBiasRunning.bias[0])
+LOG_ADD(LOG_FLOAT, y, &gyroBiasRunning.bias[1])
+LOG_ADD(LOG_FLOAT, z, &gyroBiasRunning.bias[2])
+LOG_ADD(LOG_UINT8, isStill, &gyroBiasRunning.isStill)
+LOG_GROUP_STOP(gyroBias)
@@ -48,7 +48,7 @@
 #include "nvicconf.h"
 #include "ledseq.h"
 #include "sound.h"
-#include "filter.h"
+#include "biquad_bank.h"
 #include "static_mem.h"
 
 /**
@@ -136,9 +136,12 @@ static float accScale = 1;
 // Low Pass filtering
 #define GYRO_LPF_CUTOFF_FREQ  80
 #define ACCEL_LPF_CUTOFF_FREQ 30
-static lpf2pData accLpf[3];
-static lpf2pData gyroLpf[3];
-static void applyAxis3fLpf(lpf2pData *data, Axis3f* in);
+// Gyro and accelerometer axes are filtered in one bank, gyro x, y, z then acc x, y, z
+#define IMU_FILTER_GYRO_CHANNEL 0
+#define IMU_FILTER_ACC_CHANNEL 3
+#define IMU_FILTER_LPF_STAGE 0
+static biquadBank_t imuFilter;
+static void applyImuFilter(Axis3f* gyro, Axis3f* acc);
 
 static bool isBarometerPresent = false;
 static bool isMagnetometerPresent = false;
@@ -317,13 +320,13 @@ void processAccGyroMeasurements(const uint8_t *buffer)
   sensorData.gyro.x = -(gyroRaw.x - gyroBias.x) * SENSORS_DEG_PER_LSB_CFG;
   sensorData.gyro.y =  (gyroRaw.y - gyroBias.y) * SENSORS_DEG_PER_LSB_CFG;
   sensorData.gyro.z =  (gyroRaw.z - gyroBias.z) * SENSORS_DEG_PER_LSB_CFG;
-  applyAxis3fLpf((lpf2pData*)(&gyroLpf), &sensorData.gyro);
 
   accScaled.x = -(accelRaw.x) * SENSORS_G_PER_LSB_CFG / accScale;
   accScaled.y =  (accelRaw.y) * SENSORS_G_PER_LSB_CFG / accScale;
   accScaled.z =  (accelRaw.z) * SENSORS_G_PER_LSB_CFG / accScale;
   sensorsAccAlignToGravity(&accScaled, &sensorData.acc);
-  applyAxis3fLpf((lpf2pData*)(&accLpf), &sensorData.acc);
+
+  applyImuFilter(&sensorData.gyro, &sensorData.acc);
 }
 
 static void sensorsDeviceInit(void)
@@ -382,10 +385,11 @@ static void sensorsDeviceInit(void)
   // Set digital low-pass bandwidth for gyro
   mpu6500SetDLPFMode(MPU6500_DLPF_BW_98);
   // Init second order filer for accelerometer
+  biquadBankInit(&imuFilter, 6, 1);
   for (uint8_t i = 0; i < 3; i++)
   {
-    lpf2pInit(&gyroLpf[i], 1000, GYRO_LPF_CUTOFF_FREQ);
-    lpf2pInit(&accLpf[i],  1000, ACCEL_LPF_CUTOFF_FREQ);
+    biquadBankSetLowPass(&imuFilter, IMU_FILTER_GYRO_CHANNEL + i, IMU_FILTER_LPF_STAGE, 1000, GYRO_LPF_CUTOFF_FREQ);
+    biquadBankSetLowPass(&imuFilter, IMU_FILTER_ACC_CHANNEL + i, IMU_FILTER_LPF_STAGE, 1000, ACCEL_LPF_CUTOFF_FREQ);
   }
 #endif
 
@@ -890,7 +894,8 @@ void sensorsMpu9250Lps25hSetAccMode(accModes accMode)
       mpu6500SetAccelDLPF(MPU6500_ACCEL_DLPF_BW_460);
       for (uint8_t i = 0; i < 3; i++)
       {
-        lpf2pInit(&accLpf[i],  1000, 500);
+        biquadBankSetLowPass(&imuFilter, IMU_FILTER_ACC_CHANNEL + i, IMU_FILTER_LPF_STAGE, 1000, 500);
+        biquadBankResetChannel(&imuFilter, IMU_FILTER_ACC_CHANNEL + i, 0.0f);
       }
       break;
     case ACC_MODE_FLIGHT:
@@ -898,16 +903,27 @@ void sensorsMpu9250Lps25hSetAccMode(accModes accMode)
       mpu6500SetAccelDLPF(MPU6500_ACCEL_DLPF_BW_41);
       for (uint8_t i = 0; i < 3; i++)
       {
-        lpf2pInit(&accLpf[i],  1000, ACCEL_LPF_CUTOFF_FREQ);
+        biquadBankSetLowPass(&imuFilter, IMU_FILTER_ACC_CHANNEL + i, IMU_FILTER_LPF_STAGE, 1000, ACCEL_LPF_CUTOFF_FREQ);
+        biquadBankResetChannel(&imuFilter, IMU_FILTER_ACC_CHANNEL + i, 0.0f);
       }
       break;
   }
 }
 
-static void applyAxis3fLpf(lpf2pData *data, Axis3f* in)
+static void applyImuFilter(Axis3f* gyro, Axis3f* acc)
 {
+  float samples[6];
+
+  for (uint8_t i = 0; i < 3; i++) {
+    samples[IMU_FILTER_GYRO_CHANNEL + i] = gyro->axis[i];
+    samples[IMU_FILTER_ACC_CHANNEL + i] = acc->axis[i];
+  }
+
+  biquadBankApply(&imuFilter, samples);
+
   for (uint8_t i = 0; i < 3; i++) {
-    in->axis[i] = lpf2pApply(&data[i], in->axis[i]);
+    gyro->axis[i] = samples[IMU_FILTER_GYRO_CHANNEL + i];
+    acc->axis[i] = samples[IMU_FILTER_ACC_CHANNEL + i];
   }
 }
 
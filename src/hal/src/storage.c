@@ -29,15 +29,32 @@
 #include "storage.h"
 
 #include "kve/kve.h"
+#include "kve/kve_index.h"
+#include "kve/kve_cache.h"
+
+#include <string.h>
 
 #include "FreeRTOS.h"
 #include "semphr.h"
 
 #include "i2cdev.h"
 #include "eeprom.h"
+#include "static_mem.h"
+#include "log.h"
 
 #define TRACE_MEMORY_ACCESS 0
 
+// Keep a RAM copy of the partition and write back the modified EEPROM pages
+// once at the end of each store, delete or format. Set to 0 to write through
+// to the EEPROM.
+#ifndef STORAGE_WRITE_BACK_CACHE
+#define STORAGE_WRITE_BACK_CACHE 1
+#endif
+
+// Max number of keys in the RAM index, must be a power of 2. If the table
+// holds more keys, lookups fall back to searching the EEPROM.
+#define STORAGE_INDEX_CAPACITY (128)
+
 #if !TRACE_MEMORY_ACCESS
 #define DEBUG_MODULE "STORAGE"
 #endif
@@ -103,6 +120,67 @@ static size_t writeEeprom(size_t address, const void* data, size_t length)
   }
 }
 
+NO_DMA_CCM_SAFE_ZERO_INIT static kveIndexEntry_t indexEntries[STORAGE_INDEX_CAPACITY];
+static kveIndex_t kveIndex;
+
+#if STORAGE_WRITE_BACK_CACHE
+
+NO_DMA_CCM_SAFE_ZERO_INIT static uint8_t cacheData[KVE_PARTITION_LENGTH];
+static uint32_t cacheLoadedBlocks[KVE_CACHE_BITFIELD_LENGTH(KVE_PARTITION_LENGTH, KVE_CACHE_BLOCK_SIZE)];
+static uint32_t cacheDirtyPages[KVE_CACHE_BITFIELD_LENGTH(KVE_PARTITION_LENGTH, KVE_CACHE_PAGE_SIZE)];
+static kveCache_t cache;
+
+// The cache data is in CCM which can not be used for DMA, reads go through a
+// bounce buffer
+static uint8_t bounceBuffer[KVE_CACHE_BLOCK_SIZE];
+
+static size_t readEepromToCache(size_t address, void* data, size_t length)
+{
+  size_t done = 0;
+
+  while (done < length) {
+    size_t chunk = length - done;
+    if (chunk > sizeof(bounceBuffer)) {
+      chunk = sizeof(bounceBuffer);
+    }
+
+    if (readEeprom(address + done, bounceBuffer, chunk) != chunk) {
+      break;
+    }
+    memcpy((uint8_t*)data + done, bounceBuffer, chunk);
+    done += chunk;
+  }
+
+  return done;
+}
+
+static size_t readCache(size_t address, void* data, size_t length)
+{
+  return kveCacheRead(&cache, address, data, length);
+}
+
+static size_t writeCache(size_t address, const void* data, size_t length)
+{
+  return kveCacheWrite(&cache, address, data, length);
+}
+
+static void flushCache(void)
+{
+  if (!kveCacheFlush(&cache)) {
+    DEBUG_PRINT("Error: failed to write back cache\n");
+  }
+}
+
+static kveMemory_t kve = {
+  .memorySize = KVE_PARTITION_LENGTH,
+  .read = readCache,
+  .write = writeCache,
+  .flush = flushCache,
+  .index = &kveIndex,
+};
+
+#else
+
 static void flushEeprom(void)
 {
   // NOP for now, lets fix the EEPROM write first!
@@ -113,8 +191,11 @@ static kveMemory_t kve = {
   .read = readEeprom,
   .write = writeEeprom,
   .flush = flushEeprom,
+  .index = &kveIndex,
 };
 
+#endif
+
 // Public API
 
 static bool isInit = false;
@@ -123,6 +204,14 @@ void storageInit()
 {
   storageMutex = xSemaphoreCreateMutex();
 
+#if STORAGE_WRITE_BACK_CACHE
+  kveCacheInit(&cache, cacheData, KVE_PARTITION_LENGTH, cacheLoadedBlocks, cacheDirtyPages, readEepromToCache, writeEeprom);
+#endif
+
+  // Walk the table once, after this all key lookups are done in RAM
+  kveIndexInit(&kveIndex, indexEntries, STORAGE_INDEX_CAPACITY);
+  kveBuildIndex(&kve);
+
   isInit = true;
 }
 
@@ -192,3 +281,12 @@ bool storageDelete(char* key)
 
   return result;
 }
+
+LOG_GROUP_START(storage)
+LOG_ADD(LOG_UINT8, indexValid, &kveIndex.isValid)
+LOG_ADD(LOG_UINT32, indexCount, &kveIndex.count)
+#if STORAGE_WRITE_BACK_CACHE
+LOG_ADD(LOG_UINT32, cacheLoads, &cache.loadCount)
+LOG_ADD(LOG_UINT32, cacheWrites, &cache.writeBackCount)
+#endif
+LOG_GROUP_STOP(storage)
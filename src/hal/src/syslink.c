@@ -46,14 +46,17 @@
 
 #ifdef UART2_LINK_COMM
 #include "uart2.h"
+#include "syslink_tx_ring.h"
 #endif
 
 static bool isInit = false;
-static uint8_t sendBuffer[SYSLINK_MTU + 6];
 
 static void syslinkRouteIncommingPacket(SyslinkPacket *slp);
 
-static xSemaphoreHandle syslinkAccess;
+#ifdef UART2_LINK_COMM
+static syslinkTxFrame_t uart2Frame;
+static xSemaphoreHandle uart2Access;
+#endif
 
 STATIC_MEM_TASK_ALLOC_STACK_NO_DMA_CCM_SAFE(syslinkTask, SYSLINK_TASK_STACKSIZE);
 
@@ -118,11 +121,10 @@ void syslinkInit()
     return;
   }
 
-  vSemaphoreCreateBinary(syslinkAccess);
-
   STATIC_MEM_TASK_CREATE(syslinkTask, syslinkTask, SYSLINK_TASK_NAME, NULL, SYSLINK_TASK_PRI);
 
   #ifdef UART2_LINK_COMM
+  vSemaphoreCreateBinary(uart2Access);
   uart2Init(512000);
   STATIC_MEM_TASK_CREATE(uart2Task, uart2Task, UART2_TASK_NAME, NULL, UART2_TASK_PRI);
   #endif
@@ -135,55 +137,41 @@ bool syslinkTest()
   return isInit;
 }
 
-int syslinkSendPacket(SyslinkPacket *slp)
+#ifdef UART2_LINK_COMM
+static void syslinkSendPacketUart2(SyslinkPacket *slp)
 {
-  int i = 0;
-  int dataSize;
-  uint8_t cksum[2] = {0};
-
-  xSemaphoreTake(syslinkAccess, portMAX_DELAY);
+  xSemaphoreTake(uart2Access, portMAX_DELAY);
+  syslinkTxFrameEncode(&uart2Frame, slp);
+  uart2SendDataDmaBlocking(uart2Frame.size, uart2Frame.data);
+  xSemaphoreGive(uart2Access);
+}
+#endif
 
+int syslinkSendPacket(SyslinkPacket *slp)
+{
   ASSERT(slp->length <= SYSLINK_MTU);
 
-  sendBuffer[0] = SYSLINK_START_BYTE1;
-  sendBuffer[1] = SYSLINK_START_BYTE2;
-  sendBuffer[2] = slp->type;
-  sendBuffer[3] = slp->length;
-
-  memcpy(&sendBuffer[4], slp->data, slp->length);
-  dataSize = slp->length + 6;
-  // Calculate checksum delux
-  for (i = 2; i < dataSize - 2; i++)
-  {
-    cksum[0] += sendBuffer[i];
-    cksum[1] += cksum[0];
-  }
-  sendBuffer[dataSize-2] = cksum[0];
-  sendBuffer[dataSize-1] = cksum[1];
-
   #ifdef UART2_LINK_COMM
   uint8_t groupType;
   groupType = slp->type & SYSLINK_GROUP_MASK;
   switch (groupType)
   {
   case SYSLINK_RADIO_GROUP:
-    uart2SendDataDmaBlocking(dataSize, sendBuffer);
+    syslinkSendPacketUart2(slp);
     break;
   case SYSLINK_PM_GROUP:
-    uartslkSendDataDmaBlocking(dataSize, sendBuffer);
+    uartslkSendPacket(slp);
     break;
   case SYSLINK_OW_GROUP:
-    uartslkSendDataDmaBlocking(dataSize, sendBuffer);
+    uartslkSendPacket(slp);
     break;
   default:
     DEBUG_PRINT("Unknown packet:%X.\n", slp->type);
     break;
   }
   #else
-  uartslkSendDataDmaBlocking(dataSize, sendBuffer);
+  uartslkSendPacket(slp);
   #endif
 
-  xSemaphoreGive(syslinkAccess);
-
   return 0;
 }
@@ -47,6 +47,8 @@
 
 #include "crtp.h"
 #include "static_mem.h"
+#include "usb_stream_ring.h"
+#include "log.h"
 
 
 NO_DMA_CCM_SAFE_ZERO_INIT __ALIGN_BEGIN USB_OTG_CORE_HANDLE    USB_OTG_dev __ALIGN_END ;
@@ -60,6 +62,18 @@ STATIC_MEM_QUEUE_ALLOC(usbDataRx, 5, sizeof(USBPacket)); /* Buffer USB packets (
 static xQueueHandle usbDataTx;
 STATIC_MEM_QUEUE_ALLOC(usbDataTx, 1, sizeof(USBPacket)); /* Buffer USB packets (max 64 bytes) */
 
+/* Streaming mode, CRTP packets are batched in the stream ring, see usb.h */
+#define USB_REQUEST_STREAM          0x02
+#define USB_STREAM_RING_SIZE        2048
+#define USB_STREAM_MAX_TRANSFER     512
+
+static uint8_t streamBuffer[USB_STREAM_RING_SIZE];
+static usbStreamRing_t streamRing;
+static bool isStreaming = false;
+static uint32_t streamTransferSize = 0;
+static uint32_t streamBytes = 0;
+static uint32_t streamFull = 0;
+
 /* Endpoints */
 #define IN_EP                       0x81  /* EP1 for data IN */
 #define OUT_EP                      0x01  /* EP1 for data OUT */
@@ -158,10 +172,53 @@ static void resetUSB(void) {
   }
 
   USB_OTG_FlushTxFifo(&USB_OTG_dev, IN_EP);
+
+  isStreaming = false;
+  streamTransferSize = 0;
+  usbStreamRingDiscard(&streamRing);
+}
+
+/* Start a transfer on the IN endpoint if there is anything to send, called
+ * from the USB interrupt only
+ */
+static bool startInTransfer(void *pdev, portBASE_TYPE *xTaskWokenByReceive)
+{
+  if (isStreaming)
+  {
+    uint8_t* data;
+    streamTransferSize = usbStreamRingPeek(&streamRing, &data, USB_STREAM_MAX_TRANSFER, USB_RX_TX_PACKET_SIZE);
+    if (streamTransferSize > 0)
+    {
+      DCD_EP_Tx (pdev, IN_EP, data, streamTransferSize);
+      return true;
+    }
+
+    return false;
+  }
+
+  // Drop what was left when streaming was turned off
+  usbStreamRingDiscard(&streamRing);
+
+  if (xQueueReceiveFromISR(usbDataTx, &outPacket, xTaskWokenByReceive) == pdTRUE)
+  {
+    DCD_EP_Tx (pdev,
+              IN_EP,
+              (uint8_t*)outPacket.data,
+              outPacket.size);
+    return true;
+  }
+
+  return false;
 }
 
 static uint8_t usbd_cf_Setup(void *pdev , USB_SETUP_REQ  *req)
 {
+  if ((req->bmRequest & USB_REQ_TYPE_MASK) == USB_REQ_TYPE_VENDOR &&
+      req->bRequest == USB_REQUEST_STREAM) {
+    isStreaming = (req->wValue != 0);
+    return USBD_OK;
+  }
+
   command = req->wIndex;
   if (command == 0x01) {
     crtpSetLink(usblinkGetLink());
@@ -226,17 +283,15 @@ static uint8_t  usbd_cf_DataIn (void *pdev, uint8_t epnum)
 {
   portBASE_TYPE xTaskWokenByReceive = pdFALSE;
 
-  doingTransfer = false;
-
-  if (xQueueReceiveFromISR(usbDataTx, &outPacket, &xTaskWokenByReceive) == pdTRUE)
+  if (streamTransferSize > 0)
   {
-    doingTransfer = true;
-    DCD_EP_Tx (pdev,
-              IN_EP,
-              (uint8_t*)outPacket.data,
-              outPacket.size);
+    usbStreamRingConsume(&streamRing, streamTransferSize);
+    streamBytes += streamTransferSize;
+    streamTransferSize = 0;
   }
 
+  doingTransfer = startInTransfer(pdev, &xTaskWokenByReceive);
+
   portYIELD_FROM_ISR(xTaskWokenByReceive);
 
   return USBD_OK;
@@ -247,14 +302,7 @@ static uint8_t  usbd_cf_SOF (void *pdev)
   portBASE_TYPE xTaskWokenByReceive = pdFALSE;
 
   if (!doingTransfer) {
-    if (xQueueReceiveFromISR(usbDataTx, &outPacket, &xTaskWokenByReceive) == pdTRUE)
-    {
-      doingTransfer = true;
-      DCD_EP_Tx (pdev,
-                IN_EP,
-                (uint8_t*)outPacket.data,
-                outPacket.size);
-    }
+    doingTransfer = startInTransfer(pdev, &xTaskWokenByReceive);
   }
 
   portYIELD_FROM_ISR(xTaskWokenByReceive);
@@ -374,6 +422,8 @@ void USBD_USR_DeviceDisconnected(void)
 
 void usbInit(void)
 {
+  usbStreamRingInit(&streamRing, streamBuffer, USB_STREAM_RING_SIZE);
+
   USBD_Init(&USB_OTG_dev,
             USB_OTG_FS_CORE_ID,
             &USR_desc,
@@ -409,3 +459,27 @@ bool usbSendData(uint32_t size, uint8_t* data)
   // Dont' block when sending
   return (xQueueSend(usbDataTx, &outStage, M2T(100)) == pdTRUE);
 }
+
+bool usbIsStreaming(void)
+{
+  return isStreaming;
+}
+
+bool usbStreamSendFrame(uint8_t header, const uint8_t* data, uint8_t size)
+{
+  if (!usbStreamRingWriteFrame(&streamRing, header, data, size))
+  {
+    streamFull++;
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * USB streaming mode statistics
+ */
+LOG_GROUP_START(usbStream)
+LOG_ADD(LOG_UINT32, bytes, &streamBytes)  // Number of bytes sent in streaming mode
+LOG_ADD(LOG_UINT32, full, &streamFull)    // Number of packets that had to wait for room in the stream ring
+LOG_GROUP_STOP(usbStream)
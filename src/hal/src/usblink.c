@@ -51,6 +51,7 @@ static uint8_t sendBuffer[64];
 static int usblinkSendPacket(CRTPPacket *p);
 static int usblinkSetEnable(bool enable);
 static int usblinkReceiveCRTPPacket(CRTPPacket *p);
+static bool usblinkIsPacketWaiting(void);
 
 STATIC_MEM_TASK_ALLOC(usblinkTask, USBLINK_TASK_STACKSIZE);
 
@@ -59,6 +60,7 @@ static struct crtpLinkOperations usblinkOp =
   .setEnable         = usblinkSetEnable,
   .sendPacket        = usblinkSendPacket,
   .receivePacket     = usblinkReceiveCRTPPacket,
+  .isPacketWaiting   = usblinkIsPacketWaiting,
 };
 
 /* Radio task handles the CRTP packet transfers as well as the radio link
@@ -92,12 +94,23 @@ static int usblinkReceiveCRTPPacket(CRTPPacket *p)
   return -1;
 }
 
+static bool usblinkIsPacketWaiting(void)
+{
+  return uxQueueMessagesWaiting(crtpPacketDelivery) > 0;
+}
+
 static int usblinkSendPacket(CRTPPacket *p)
 {
   int dataSize;
 
   ASSERT(p->size < SYSLINK_MTU);
 
+  if (usbIsStreaming())
+  {
+    ledseqRun(&seq_linkDown);
+    return usbStreamSendFrame(p->header, p->data, p->size);
+  }
+
   sendBuffer[0] = p->header;
 
   if (p->size <= CRTP_MAX_DATA_SIZE)
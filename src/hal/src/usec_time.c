@@ -25,15 +25,34 @@
  * usec_time.c - microsecond-resolution timer and timestamps.
  */
 
+#include <stdbool.h>
+
 #include "usec_time.h"
 
 #include "nvicconf.h"
 #include "stm32fxxx.h"
 
+static bool isInit = false;
 static uint32_t usecTimerHighCount;
 
+// A capture is written by its interrupt handler and read by a task. The sequence
+// number is incremented around each write so that the reader can detect a torn
+// read of the 64 bit timestamp and retry.
+typedef struct {
+  uint32_t sequence;
+  uint64_t timestamp;
+} usecCaptureLatch_t;
+
+static usecCaptureLatch_t captureLatches[usecCaptureCount];
+
 void initUsecTimer(void)
 {
+  // The timer is the common time base for sample timestamps, restarting it
+  // would make time jump backwards for everyone else
+  if (isInit) {
+    return;
+  }
+
   usecTimerHighCount = 0;
 
   TIM_TimeBaseInitTypeDef  TIM_TimeBaseStructure;
@@ -61,6 +80,8 @@ void initUsecTimer(void)
   DBGMCU_APB1PeriphConfig(DBGMCU_TIM7_STOP, ENABLE);
   TIM_ITConfig(TIM7, TIM_IT_Update, ENABLE);
   TIM_Cmd(TIM7, ENABLE);
+
+  isInit = true;
 }
 
 uint64_t usecTimestamp(void)
@@ -80,6 +101,32 @@ uint64_t usecTimestamp(void)
   return (((uint64_t)high) << 16) + TIM7->CNT;
 }
 
+void usecTimestampCapture(const usecCapture_t capture)
+{
+  usecCaptureLatch_t* latch = &captureLatches[capture];
+  const uint64_t now = usecTimestamp();
+
+  __atomic_add_fetch(&latch->sequence, 1, __ATOMIC_SEQ_CST);
+  latch->timestamp = now;
+  __atomic_add_fetch(&latch->sequence, 1, __ATOMIC_SEQ_CST);
+}
+
+uint64_t usecTimestampGetCapture(const usecCapture_t capture)
+{
+  usecCaptureLatch_t* latch = &captureLatches[capture];
+  uint32_t sequence0;
+  uint32_t sequence;
+  uint64_t timestamp;
+
+  do {
+    __atomic_load(&latch->sequence, &sequence0, __ATOMIC_SEQ_CST);
+    timestamp = latch->timestamp;
+    __atomic_load(&latch->sequence, &sequence, __ATOMIC_SEQ_CST);
+  } while (sequence != sequence0 || (sequence & 1));
+
+  return timestamp;
+}
+
 void __attribute__((used)) TIM7_IRQHandler(void)
 {
   TIM_ClearITPendingBit(TIM7, TIM_IT_Update);
@@ -82,6 +82,12 @@ typedef struct collision_avoidance_params_s
   // Using Dykstra's algorithm.
   int voronoiProjectionMaxIters;
 
+  // Max number of neighbors used to construct our Voronoi cell. Neighbors
+  // that are too far away to affect the cell within the horizon are always
+  // left out, of the rest only the nearest ones are used. This bounds the
+  // cost of the projection in large swarms. If zero or negative, no limit.
+  int maxNeighbors;
+
 } collision_avoidance_params_t;
 
 
@@ -95,6 +101,9 @@ typedef struct collision_avoidance_state_s
   // state as a setpoint.
   struct vec lastFeasibleSetPosition;
 
+  // Number of neighbors used to construct the cell in the last update.
+  int neighborCount;
+
 } collision_avoidance_state_t;
 
 
@@ -27,7 +27,7 @@
 #define __CONTROLLER_INDI_H__
 
 #include "stabilizer_types.h"
-#include "filter.h"
+#include "biquad_bank.h"
 #include "math3d.h"
 #include "log.h"
 #include "param.h"
@@ -84,8 +84,11 @@ struct IndiVariables {
   struct FloatRates u_act_dyn;
   float rate_d[3];
 
-  Butterworth2LowPass u[3];
-  Butterworth2LowPass rate[3];
+  // Rates p, q, r on channels 0-2 and actuators on channels 3-5
+  biquadBank_t filters;
+  float rate_filt[3];
+  float rate_filt_prev[3];
+  float u_filt[3];
   struct FloatRates g1;
   float g2;
 
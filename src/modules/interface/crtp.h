@@ -45,6 +45,7 @@ typedef enum {
   CRTP_PORT_LOCALIZATION     = 0x06,
   CRTP_PORT_SETPOINT_GENERIC = 0x07,
   CRTP_PORT_SETPOINT_HL      = 0x08,
+  CRTP_PORT_TRACE            = 0x0B,
   CRTP_PORT_PLATFORM         = 0x0D,
   CRTP_PORT_LINK             = 0x0F,
 } CRTPPort;
@@ -76,6 +77,16 @@ typedef struct _CRTPPacket
 
 typedef void (*CrtpCallback)(CRTPPacket *);
 
+/**
+ * What to do with a received packet when packets of its port are waiting to
+ * be handled and there is no room for it
+ */
+typedef enum {
+  CRTP_OVERFLOW_DROP_NEW = 0,       //< Drop the received packet
+  CRTP_OVERFLOW_DROP_OLDEST,        //< Drop the oldest waiting packet
+  CRTP_OVERFLOW_COALESCE_LATEST,    //< Only keep the latest packet, even if there is room
+} CRTPOverflowPolicy;
+
 /**
  * Initialize the CRTP stack
  */
@@ -90,6 +101,19 @@ bool crtpTest(void);
  */
 void crtpInitTaskQueue(CRTPPort taskId);
 
+/**
+ * Set what to do with received packets when the queue of a port is full
+ *
+ * For ports with a callback, a policy other than drop new makes packets wait
+ * while the link has more packets to deliver, and the policy is applied to
+ * the waiting packets of the port. Coalesce latest only removes a packet with
+ * the same channel.
+ *
+ * @param[in] portId The CRTP port
+ * @param[in] policy The overflow policy
+ */
+void crtpSetPortOverflowPolicy(CRTPPort portId, CRTPOverflowPolicy policy);
+
 /**
  * Register a callback to be called for a particular port.
  *
@@ -105,7 +129,9 @@ void crtpRegisterPortCB(int port, CrtpCallback cb);
 /**
  * Put a packet in the TX task
  *
- * If the TX stack is full, the oldest lowest priority packet is dropped
+ * Packets are queued per traffic class, see crtp_tx_scheduler.h. If the queue
+ * of the class is full the packet is dropped, or for telemetry, the oldest
+ * telemetry packet is dropped.
  *
  * @param[in] p CRTPPacket to send
  */
@@ -146,6 +172,14 @@ int crtpReceivePacketWait(CRTPPort taskId, CRTPPacket *p, int wait);
  */
 int crtpGetFreeTxQueuePackets(void);
 
+/**
+ * Get the number of free tx packets in the queue used by a port
+ *
+ * @param[in] port The CRTP port
+ * @return Number of free packets
+ */
+int crtpGetFreeTxQueuePacketsForPort(CRTPPort port);
+
 /**
  * Wait for a packet to arrive for the specified taskID
  *
@@ -156,6 +190,23 @@ int crtpGetFreeTxQueuePackets(void);
  */
 int crtpReceivePacketBlock(CRTPPort taskId, CRTPPacket *p);
 
+/**
+ * Wait for a packet to arrive for the specified taskID, without copying it.
+ * The packet must be released with crtpReleasePacket() when done.
+ *
+ * @param[in]  taskId The id of the CRTP task
+ *
+ * @return The received packet
+ */
+CRTPPacket* crtpReceivePacketRefBlock(CRTPPort taskId);
+
+/**
+ * Release a packet received with crtpReceivePacketRefBlock()
+ *
+ * @param[in]  p The packet
+ */
+void crtpReleasePacket(CRTPPacket *p);
+
 /**
  * Function pointer structure to be filled by the CRTP link to permits CRTP to
  * use manu link
@@ -167,6 +218,8 @@ struct crtpLinkOperations
   int (*receivePacket)(CRTPPacket *pk);
   bool (*isConnected)(void);
   int (*reset)(void);
+  // True if receivePacket() would return a packet without waiting, optional
+  bool (*isPacketWaiting)(void);
 };
 
 void crtpSetLink(struct crtpLinkOperations * lk);
@@ -71,6 +71,9 @@ void crtpCommanderHighLevelTellState(const state_t *state);
 // True if we have landed or emergency-stopped.
 bool crtpCommanderHighLevelIsStopped();
 
+// True if a command sent to groupMask applies to this CF, see COMMAND_SET_GROUP_MASK.
+bool crtpCommanderHighLevelIsInGroup(uint8_t groupMask);
+
 // Public API - can be used from an app
 
 /**
@@ -0,0 +1,84 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * crtp_packet_pool.h - Pool of reference counted CRTP packet buffers
+ */
+
+/**
+ * Received packets are stored in buffers from a fixed pool and handed over by
+ * pointer, so that a packet is not copied into every queue it passes. Each
+ * owner of a pointer holds a reference, the buffer returns to the pool when
+ * the last reference is released.
+ *
+ * The pool does no locking, the caller must serialize the calls.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "crtp.h"
+
+// The port queues share the pool, with the five queued ports of the
+// firmware (param, log, mem, info and high level commander) each queue may
+// hold 10 packets, see crtpInitTaskQueue()
+#define CRTP_PACKET_POOL_SIZE 64
+
+typedef struct {
+  CRTPPacket packets[CRTP_PACKET_POOL_SIZE];
+  uint8_t refCount[CRTP_PACKET_POOL_SIZE];
+
+  // Indexes of the free buffers
+  uint8_t freeList[CRTP_PACKET_POOL_SIZE];
+  uint8_t freeCount;
+
+  // Statistics
+  uint8_t minFreeCount;
+  uint32_t allocFailCount;
+} crtpPacketPool_t;
+
+void crtpPacketPoolInit(crtpPacketPool_t* this);
+
+/**
+ * Take a buffer from the pool, with one reference
+ *
+ * @return The buffer or NULL if the pool is empty
+ */
+CRTPPacket* crtpPacketPoolAlloc(crtpPacketPool_t* this);
+
+/**
+ * Add a reference to a buffer
+ */
+void crtpPacketPoolRef(crtpPacketPool_t* this, CRTPPacket* p);
+
+/**
+ * Release a reference to a buffer, the buffer is returned to the pool when
+ * there are no references left
+ */
+void crtpPacketPoolRelease(crtpPacketPool_t* this, CRTPPacket* p);
+
+/**
+ * Check if a pointer is a buffer of the pool
+ */
+bool crtpPacketPoolContains(const crtpPacketPool_t* this, const CRTPPacket* p);
@@ -0,0 +1,84 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * crtp_rx_backlog.h - Received packets waiting to be passed to a port callback
+ */
+
+/**
+ * Packets of ports with a callback are normally handled as soon as they are
+ * received. While the link has more packets waiting, packets of ports with an
+ * overflow policy are kept in the backlog instead, and the policy is applied
+ * to them. A setpoint that is superseded by a newer one before the burst is
+ * over is then never handled.
+ *
+ * The backlog only stores pointers, the caller holds a reference to the
+ * packets in it.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "crtp.h"
+
+#define CRTP_RX_BACKLOG_SIZE 8
+// Packets of a port with the drop oldest policy that are kept
+#define CRTP_RX_BACKLOG_PORT_LIMIT 4
+
+typedef enum {
+  CRTP_RX_BACKLOG_ADDED,      //< Nothing was removed
+  CRTP_RX_BACKLOG_COALESCED,  //< The previous packet of the port and channel was removed
+  CRTP_RX_BACKLOG_DROPPED,    //< The oldest packet of the port was removed
+  CRTP_RX_BACKLOG_FULL,       //< The oldest packet was removed to make room, it must be handled now
+} crtpRxBacklogResult_t;
+
+typedef struct {
+  // In the order they were received
+  CRTPPacket* packets[CRTP_RX_BACKLOG_SIZE];
+  uint8_t count;
+} crtpRxBacklog_t;
+
+void crtpRxBacklogInit(crtpRxBacklog_t* this);
+
+/**
+ * Add a packet last in the backlog
+ *
+ * Coalesce latest removes the packet with the same port and channel, if any.
+ * Drop oldest removes the oldest packet of the port if there already are
+ * CRTP_RX_BACKLOG_PORT_LIMIT of them. Packets are not dropped to make room,
+ * the oldest packet is handed back instead.
+ *
+ * @param this The backlog
+ * @param p The packet
+ * @param policy The overflow policy of the port of the packet
+ * @param removed Set to the removed packet, if any
+ * @return What was done with the removed packet
+ */
+crtpRxBacklogResult_t crtpRxBacklogAdd(crtpRxBacklog_t* this, CRTPPacket* p, const CRTPOverflowPolicy policy, CRTPPacket** removed);
+
+/**
+ * Take the oldest packet
+ *
+ * @return The packet or NULL if the backlog is empty
+ */
+CRTPPacket* crtpRxBacklogTake(crtpRxBacklog_t* this);
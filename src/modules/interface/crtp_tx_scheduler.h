@@ -0,0 +1,136 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * crtp_tx_scheduler.h - Traffic classes and scheduling of outgoing CRTP packets
+ */
+
+/**
+ * Outgoing packets are sorted into traffic classes by port, each class has its
+ * own queue. Classes with weight 0 are served with strict priority, in class
+ * order. The other classes share the remaining link capacity by weighted round
+ * robin, a class with weight 4 may send 4 packets for every packet of a class
+ * with weight 1 when both have packets waiting.
+ *
+ * When the queue of a class is full a new packet is rejected, or for classes
+ * that drop oldest (telemetry), replaces the oldest packet of the class.
+ *
+ * The scheduler does no locking, the caller must serialize the calls.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "crtp.h"
+
+typedef enum {
+  CRTP_TX_CLASS_CONTROL = 0,  // Link, platform, setpoints and localization
+  CRTP_TX_CLASS_PARAM_MEM,    // Parameters and memory
+  CRTP_TX_CLASS_CONSOLE,
+  CRTP_TX_CLASS_TELEMETRY,    // Log blocks
+  CRTP_TX_CLASS_COUNT,
+} crtpTxClass_t;
+
+// Total number of packets of all classes
+#define CRTP_TX_SCHEDULER_SIZE 120
+
+typedef struct {
+  uint8_t depth;
+  // 0 for strict priority
+  uint8_t weight;
+  bool dropOldest;
+} crtpTxClassConfig_t;
+
+typedef struct {
+  uint16_t first;
+  uint8_t depth;
+  uint8_t weight;
+  bool dropOldest;
+
+  uint8_t head;
+  uint8_t count;
+  uint8_t credit;
+
+  // Statistics
+  uint32_t dropCount;
+  uint32_t sentCount;
+  // Time in queue (ms) of the packets
+  uint16_t maxLatency;
+  float averageLatency;
+} crtpTxClassQueue_t;
+
+typedef struct {
+  crtpTxClassQueue_t classes[CRTP_TX_CLASS_COUNT];
+  CRTPPacket packets[CRTP_TX_SCHEDULER_SIZE];
+  uint32_t timestamps[CRTP_TX_SCHEDULER_SIZE];
+} crtpTxScheduler_t;
+
+/**
+ * Initialize the scheduler with empty queues
+ *
+ * @param this The scheduler
+ * @param config Configuration of each class, the total depth must not be
+ *        larger than CRTP_TX_SCHEDULER_SIZE
+ */
+void crtpTxSchedulerInit(crtpTxScheduler_t* this, const crtpTxClassConfig_t config[CRTP_TX_CLASS_COUNT]);
+
+/**
+ * Get the traffic class of a port
+ */
+crtpTxClass_t crtpTxSchedulerClassOf(const CRTPPort port);
+
+/**
+ * Add a packet to the queue of a class
+ *
+ * @param this The scheduler
+ * @param txClass The traffic class
+ * @param p The packet
+ * @param now_ms Current time
+ * @return true if the packet was queued, false if the queue was full. A
+ *         packet is always queued in a class that drops oldest.
+ */
+bool crtpTxSchedulerPush(crtpTxScheduler_t* this, const crtpTxClass_t txClass, const CRTPPacket* p, const uint32_t now_ms);
+
+/**
+ * Take the next packet to send
+ *
+ * @param this The scheduler
+ * @param p Set to the packet
+ * @param txClass Set to the class of the packet
+ * @param now_ms Current time, used for the latency statistics
+ * @return true if a packet was taken, false if all queues are empty
+ */
+bool crtpTxSchedulerPop(crtpTxScheduler_t* this, CRTPPacket* p, crtpTxClass_t* txClass, const uint32_t now_ms);
+
+/**
+ * Number of free places in the queue of a class
+ */
+int crtpTxSchedulerFree(const crtpTxScheduler_t* this, const crtpTxClass_t txClass);
+
+/**
+ * Remove all packets of a class, the packets are not counted as dropped
+ *
+ * @return The number of packets removed
+ */
+int crtpTxSchedulerFlush(crtpTxScheduler_t* this, const crtpTxClass_t txClass);
@@ -0,0 +1,92 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * eventtrace.h - Timeline of task switches, interrupts and user markers
+ */
+
+/**
+ * Build with EVENT_TRACE=1 to record task switches, tasks made ready, tasks
+ * blocking on queues, instrumented interrupts and user markers with a cycle
+ * counter timestamp. Recording is started and stopped with the
+ * eventTrace.enable parameter.
+ *
+ * Events go to a RAM ring, see trace_ring.h. By default recording stops when
+ * the ring is full and the recording is read through the memory subsystem
+ * (MEM_TYPE_EVENT_TRACE) over radio or USB. With EVENT_TRACE_ON_SEGGER_RTT=1
+ * the ring is instead streamed continuously to Segger RTT up buffer 2.
+ * tools/trace/events_to_perfetto.py converts a recording to a Chrome/Perfetto
+ * JSON trace.
+ *
+ * Interrupt and marker names are placed in the .trace_fmt section, like the
+ * trace log format strings, and are only stored in the elf file. Use the
+ * macros in pairs within the same task or interrupt.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Record tag: bits 20-23 event type, bits 0-19 id. The record is the header
+// followed by the cycle counter and, for some types, extra words.
+#define EVENT_TRACE_TYPE_SHIFT 20
+#define EVENT_TRACE_ID_MASK 0xfffff
+
+typedef enum {
+  eventTraceTaskSwitchedIn = 0,  // id: task number
+  eventTraceTaskReady,           // id: task number
+  eventTraceTaskName,            // id: task number, extra words: name
+  eventTraceIsrEnter,            // id: name
+  eventTraceIsrExit,             // id: name
+  eventTraceQueueBlockReceive,   // id: queue number
+  eventTraceQueueBlockSend,      // id: queue number
+  eventTraceMark,                // id: name
+  eventTraceBegin,               // id: name
+  eventTraceEnd,                 // id: name
+  eventTraceStart,               // extra words: cycle counter frequency
+} eventTraceType_t;
+
+void eventTraceInit(void);
+bool eventTraceTest(void);
+
+/**
+ * Record an event, use the macros below instead of calling this directly
+ *
+ * Can be called from any task or interrupt.
+ */
+void eventTraceWrite(const eventTraceType_t type, const uint32_t id);
+
+#if defined(EVENT_TRACE) && !defined(UNIT_TEST_MODE)
+  #define EVENT_TRACE_NAMED(TYPE, NAME) do { \
+      static const char eventTraceName[] __attribute__((section(".trace_fmt"), used)) = NAME; \
+      eventTraceWrite(TYPE, (uint32_t)(uintptr_t)eventTraceName); \
+    } while (0)
+#else
+  #define EVENT_TRACE_NAMED(TYPE, NAME)
+#endif
+
+#define EVENT_TRACE_ISR_ENTER(NAME) EVENT_TRACE_NAMED(eventTraceIsrEnter, NAME)
+#define EVENT_TRACE_ISR_EXIT(NAME) EVENT_TRACE_NAMED(eventTraceIsrExit, NAME)
+#define EVENT_TRACE_MARK(NAME) EVENT_TRACE_NAMED(eventTraceMark, NAME)
+#define EVENT_TRACE_BEGIN(NAME) EVENT_TRACE_NAMED(eventTraceBegin, NAME)
+#define EVENT_TRACE_END(NAME) EVENT_TRACE_NAMED(eventTraceEnd, NAME)
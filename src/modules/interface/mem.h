@@ -41,6 +41,7 @@ typedef enum {
   MEM_TYPE_USD    = 0x16,
   MEM_TYPE_LEDMEM = 0x17,
   MEM_TYPE_APP    = 0x18,
+  MEM_TYPE_EVENT_TRACE = 0x19,
 } MemoryType_t;
 
 #define MEMORY_SERIAL_LENGTH 8
@@ -0,0 +1,79 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * motor_mixer.h - Allocation of thrust and torques to the motors
+ */
+
+/**
+ * The mixer maps collective thrust and roll, pitch and yaw torques to the
+ * four motors through the allocation matrix of the frame, in any unit where
+ * the motor output ranges from 0 to maxOutput (PWM or Newton).
+ *
+ * If the motors can not deliver the command, it is desaturated in priority
+ * order so that roll and pitch torques are preserved first:
+ *   1. roll and pitch are scaled down together if their spread alone does
+ *      not fit the motor range, keeping their ratio
+ *   2. the collective thrust is lowered to fit roll, pitch and yaw. It is
+ *      never raised, so at low thrust the motors that would go below 0 are
+ *      clipped and the torques are not fully applied
+ *   3. the yaw torque is scaled down if it still does not fit
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define MOTOR_MIXER_MOTOR_COUNT 4
+
+// Saturation flags, set for each stage of the desaturation that changed the command
+#define MOTOR_MIXER_SAT_ROLL_PITCH (1 << 0)
+#define MOTOR_MIXER_SAT_THRUST     (1 << 1)
+#define MOTOR_MIXER_SAT_YAW        (1 << 2)
+// Set if a motor was clipped at 0 because the thrust was too low for the torques
+#define MOTOR_MIXER_SAT_CLIPPED    (1 << 3)
+
+typedef struct {
+  float roll[MOTOR_MIXER_MOTOR_COUNT];
+  float pitch[MOTOR_MIXER_MOTOR_COUNT];
+  float yaw[MOTOR_MIXER_MOTOR_COUNT];
+} motorMixerMatrix_t;
+
+// QUAD_FORMATION_X, arms at 45 degrees from the x axis
+extern const motorMixerMatrix_t motorMixerQuadX;
+// QUAD_FORMATION_NORMAL, arms along the x and y axes
+extern const motorMixerMatrix_t motorMixerQuadNormal;
+
+/**
+ * Mix a command into motor outputs
+ *
+ * @param matrix The allocation matrix of the frame
+ * @param thrust Collective thrust, per motor
+ * @param roll Roll torque command
+ * @param pitch Pitch torque command
+ * @param yaw Yaw torque command
+ * @param maxOutput The maximum motor output
+ * @param output The motor outputs, in the range 0 to maxOutput
+ * @return Saturation flags, 0 if the command was applied unchanged
+ */
+uint8_t motorMixerMix(const motorMixerMatrix_t* matrix, const float thrust, const float roll, const float pitch,
+                      const float yaw, const float maxOutput, float output[MOTOR_MIXER_MOTOR_COUNT]);
@@ -0,0 +1,90 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * motor_thrust_model.h - Thrust to PWM mapping of the motors
+ */
+
+/**
+ * The thrust of one motor is modeled as a quadratic function of the
+ * effective PWM, that is the PWM ratio scaled by the battery voltage:
+ *
+ *   thrust = a * u^2 + b * u,  u = pwm * vbat / vNominal
+ *
+ * a and b are fitted at the nominal voltage, see tools/param_est. The inverse
+ * is precomputed in a table over the thrust range, so a lookup is a linear
+ * interpolation and a scaling by the battery voltage, without any square root.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define MOTOR_THRUST_MODEL_TABLE_SIZE 65
+
+// Below this voltage the battery measurement is not trusted for compensation
+#define MOTOR_THRUST_MODEL_MIN_VOLTAGE 2.5f
+
+typedef struct {
+  float pwmToThrustA;
+  float pwmToThrustB;
+  float nominalVoltage;
+
+  // Thrust at full PWM and nominal voltage [N]
+  float maxThrust;
+  float tableStepInv;
+  float pwmTable[MOTOR_THRUST_MODEL_TABLE_SIZE];
+} motorThrustModel_t;
+
+/**
+ * Initialize the model and build the lookup table. The maximum thrust, a + b,
+ * and the nominal voltage must be positive, otherwise the model is left
+ * unchanged.
+ *
+ * @param this The model
+ * @param pwmToThrustA Quadratic coefficient [N]
+ * @param pwmToThrustB Linear coefficient [N]
+ * @param nominalVoltage The battery voltage the coefficients were fitted at [V]
+ * @return true if the model was initialized, false if the parameters are invalid
+ */
+bool motorThrustModelInit(motorThrustModel_t* this, const float pwmToThrustA, const float pwmToThrustB, const float nominalVoltage);
+
+/**
+ * PWM ratio needed to produce a thrust
+ *
+ * @param this The model
+ * @param thrust Thrust of one motor [N]
+ * @param batteryVoltage Battery voltage [V], no compensation if below MOTOR_THRUST_MODEL_MIN_VOLTAGE
+ * @return PWM ratio, 0 to 1
+ */
+float motorThrustModelPwm(const motorThrustModel_t* this, const float thrust, const float batteryVoltage);
+
+/**
+ * Thrust produced at a PWM ratio, the forward model
+ *
+ * @param this The model
+ * @param pwm PWM ratio, 0 to 1
+ * @param batteryVoltage Battery voltage [V], no compensation if below MOTOR_THRUST_MODEL_MIN_VOLTAGE
+ * @return Thrust of one motor [N]
+ */
+float motorThrustModelThrust(const motorThrustModel_t* this, const float pwm, const float batteryVoltage);
@@ -34,6 +34,13 @@
 void paramInit(void);
 bool paramTest(void);
 
+/** Apply the values of all persistent parameters from the storage
+ *
+ * Should be called once after all modules have been initialized, so that the
+ * stored values are not overwritten by the module defaults.
+ */
+void paramStoredInit(void);
+
 /* Public API to access param variables */
 
 /** Variable identifier.
@@ -0,0 +1,101 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * param_broadcast.h - Group parameter updates broadcasted to a swarm
+ */
+
+/**
+ * A broadcast parameter set packet carries a group mask, an activation delay
+ * and a bulk payload of (id, value) entries, see param_bulk.h. The packet is
+ * only used by the CFs in the group, using the same group concept as the
+ * high level commander. All CFs receive a broadcast at the same time, the
+ * activation delay lets them apply the new values on the same tick even if
+ * the packet is resent a few times to make up for lost packets.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "param_bulk.h"
+
+// Group mask and activation delay
+#define PARAM_BROADCAST_HEADER_SIZE 3
+#define PARAM_BROADCAST_PAYLOAD_SIZE 32
+
+typedef enum {
+  paramBroadcastNotInGroup,
+  paramBroadcastInvalid,
+  paramBroadcastScheduled,
+  paramBroadcastDuplicate,
+} paramBroadcastResult_t;
+
+typedef struct {
+  bool isPending;
+  uint32_t activationTime;
+  uint8_t payloadLength;
+  uint8_t payload[PARAM_BROADCAST_PAYLOAD_SIZE];
+  paramBulkEntry_t entries[PARAM_BULK_MAX_ENTRIES];
+  int entryCount;
+} paramBroadcast_t;
+
+void paramBroadcastInit(paramBroadcast_t* this);
+
+/**
+ * Handle a broadcast parameter set packet
+ *
+ * The packet is [groupMask, delay (uint16 ms), (id, value)...]. The entries
+ * are validated as a whole, if one of them is not accepted by valueSize the
+ * packet is dropped. An identical packet received while the previous one is
+ * still pending does not move the activation time.
+ *
+ * @param this The broadcast state
+ * @param data The packet payload
+ * @param length The length of the payload
+ * @param valueSize Callback giving the size of a writable parameter
+ * @param now_ms The current time
+ * @return The outcome of the packet
+ */
+paramBroadcastResult_t paramBroadcastHandle(paramBroadcast_t* this, const uint8_t* data, int length,
+                                            paramBulkValueSize_t valueSize, const uint32_t now_ms);
+
+/**
+ * Get the pending entries if their activation time has been reached. The
+ * pending set is cleared when returned.
+ *
+ * @param this The broadcast state
+ * @param now_ms The current time
+ * @param entries Set to the entries to apply
+ * @return The number of entries to apply, 0 if none are due
+ */
+int paramBroadcastGetDue(paramBroadcast_t* this, const uint32_t now_ms, const paramBulkEntry_t** entries);
+
+/**
+ * Time until the pending entries are due
+ *
+ * @param this The broadcast state
+ * @param now_ms The current time
+ * @return Time to activation in ms, 0 if due and UINT32_MAX if nothing is pending
+ */
+uint32_t paramBroadcastTimeToActivation(const paramBroadcast_t* this, const uint32_t now_ms);
@@ -0,0 +1,97 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * param_bulk.h - Encoding and decoding of bulk parameter packets
+ */
+
+/**
+ * A bulk packet payload is a sequence of entries, each made of a 16 bit
+ * parameter id followed by the raw value of the parameter. The value size is
+ * not transmitted, it is given by the type of the parameter in the TOC. A
+ * bulk read request only contains the ids.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "crtp.h"
+
+// The first byte of a bulk packet is the command
+#define PARAM_BULK_MAX_PAYLOAD_SIZE (CRTP_MAX_DATA_SIZE - 1)
+// Smallest possible entry is a 16 bit id and a 1 byte value
+#define PARAM_BULK_MAX_ENTRIES (PARAM_BULK_MAX_PAYLOAD_SIZE / 3)
+
+typedef struct {
+  uint16_t id;
+  uint8_t size;
+  const uint8_t* value;
+} paramBulkEntry_t;
+
+/**
+ * Callback giving the value size of a parameter
+ *
+ * @param id The parameter id
+ * @return The size of the value in bytes, or a negative value if the id is unknown
+ */
+typedef int (*paramBulkValueSize_t)(uint16_t id);
+
+/**
+ * Append one (id, value) entry to a bulk payload
+ *
+ * @param buffer The payload buffer
+ * @param length The current length of the payload
+ * @param maxLength The size of the buffer
+ * @param id The parameter id
+ * @param value The raw value of the parameter
+ * @param size The size of the value
+ * @return The new length of the payload, or -1 if the entry does not fit
+ */
+int paramBulkAppend(uint8_t* buffer, int length, int maxLength, uint16_t id, const void* value, int size);
+
+/**
+ * Decode all (id, value) entries of a bulk write payload. Nothing is decoded
+ * partially, either all entries are valid or an error is returned.
+ *
+ * @param buffer The payload
+ * @param length The length of the payload
+ * @param valueSize Callback giving the value size of a parameter
+ * @param entries Decoded entries, the values point into the buffer
+ * @param maxEntries The size of the entries array
+ * @param failedEntry Set to the index of the faulty entry on error, may be NULL
+ * @return The number of entries, or -ENOENT for an unknown id, -EINVAL for a
+ *         truncated payload and -E2BIG if there are more than maxEntries entries
+ */
+int paramBulkDecode(const uint8_t* buffer, int length, paramBulkValueSize_t valueSize,
+                    paramBulkEntry_t* entries, int maxEntries, int* failedEntry);
+
+/**
+ * Decode the ids of a bulk read request
+ *
+ * @param buffer The payload
+ * @param length The length of the payload
+ * @param ids Decoded ids
+ * @param maxIds The size of the ids array
+ * @return The number of ids, or -EINVAL for a truncated payload and -E2BIG if
+ *         there are more than maxIds ids
+ */
+int paramBulkDecodeIds(const uint8_t* buffer, int length, uint16_t* ids, int maxIds);
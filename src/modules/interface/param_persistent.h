@@ -0,0 +1,130 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ * param_persistent.h - Persistent parameters stored in the key/value storage
+ */
+
+/**
+ * A persistent parameter is stored with the key "prm/<group>.<name>". The
+ * stored value is the type of the parameter followed by the raw value, so a
+ * value is only restored if the type still matches the TOC.
+ *
+ * The answer to a get all request is a sequence of packets, each holding a
+ * sequence number followed by (id, value) entries encoded as in a bulk
+ * packet. The sequence number counts modulo 128, the last packet has
+ * PARAM_PERSISTENT_GET_ALL_LAST set in the sequence byte.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "crtp.h"
+
+#define PARAM_PERSISTENT_PREFIX_STRING "prm/"
+#define PARAM_PERSISTENT_KEY_MAX_LENGTH (sizeof(PARAM_PERSISTENT_PREFIX_STRING) + 2 * CRTP_MAX_DATA_SIZE)
+
+// Type followed by the largest value
+#define PARAM_PERSISTENT_MAX_STORED_SIZE (1 + 8)
+
+#define PARAM_PERSISTENT_GET_ALL_LAST 0x80
+#define PARAM_PERSISTENT_GET_ALL_SEQUENCE_MASK 0x7f
+// The first two bytes of a get all packet are the command and the sequence byte
+#define PARAM_PERSISTENT_GET_ALL_PAYLOAD_SIZE (CRTP_MAX_DATA_SIZE - 2)
+
+typedef struct {
+  uint8_t sequence;
+  uint8_t length;
+  uint8_t payload[PARAM_PERSISTENT_GET_ALL_PAYLOAD_SIZE];
+} paramPersistentGetAll_t;
+
+/**
+ * Callback sending one packet of a get all answer
+ *
+ * @param sequence The sequence byte, including PARAM_PERSISTENT_GET_ALL_LAST
+ * @param payload The (id, value) entries
+ * @param length The length of the payload
+ */
+typedef void (*paramPersistentSend_t)(uint8_t sequence, const uint8_t* payload, uint8_t length);
+
+/**
+ * Build the storage key of a parameter
+ *
+ * @param key Buffer of PARAM_PERSISTENT_KEY_MAX_LENGTH bytes
+ * @param group The group name
+ * @param name The parameter name
+ * @return false if the key does not fit in the buffer
+ */
+bool paramPersistentKey(char* key, const char* group, const char* name);
+
+/**
+ * Store the value of a parameter
+ *
+ * @param group The group name
+ * @param name The parameter name
+ * @param type The type of the parameter, as in the TOC
+ * @param value The raw value
+ * @param size The size of the value, up to 8 bytes
+ * @return true if the value was stored
+ */
+bool paramPersistentStore(const char* group, const char* name, uint8_t type, const void* value, uint8_t size);
+
+/**
+ * Fetch the stored value of a parameter
+ *
+ * @param group The group name
+ * @param name The parameter name
+ * @param type The type of the parameter, as in the TOC
+ * @param value Set to the raw value if found, size bytes
+ * @param size The size of the value, up to 8 bytes
+ * @return true if a value of the same type and size is stored
+ */
+bool paramPersistentFetch(const char* group, const char* name, uint8_t type, void* value, uint8_t size);
+
+/**
+ * Remove the stored value of a parameter
+ *
+ * @return true if a value was stored and has been removed
+ */
+bool paramPersistentClear(const char* group, const char* name);
+
+/**
+ * Start a get all answer
+ */
+void paramPersistentGetAllInit(paramPersistentGetAll_t* this);
+
+/**
+ * Add an entry to a get all answer. The current packet is sent first if the
+ * entry does not fit in it.
+ *
+ * @param this The answer
+ * @param id The parameter id
+ * @param value The raw value
+ * @param size The size of the value
+ * @param send Callback sending a packet
+ */
+void paramPersistentGetAllAdd(paramPersistentGetAll_t* this, uint16_t id, const void* value, uint8_t size, paramPersistentSend_t send);
+
+/**
+ * Send the last packet of a get all answer, also when it is empty
+ */
+void paramPersistentGetAllFinish(paramPersistentGetAll_t* this, paramPersistentSend_t send);
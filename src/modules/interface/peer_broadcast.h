@@ -0,0 +1,52 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * peer_broadcast.h - Broadcast of the own state to other Crazyflies over P2P
+ */
+
+/**
+ * The own position, velocity, attitude and intent (the position set point) is
+ * broadcast in a TDMA slot given by the radio address, see
+ * peer_broadcast_core.h. Received states are passed to the peer localization,
+ * so that collision avoidance keeps working without the ground link.
+ *
+ * The module registers the P2P callback of the radio link, an app that
+ * registers its own callback will stop the reception of peer states.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "stabilizer_types.h"
+
+// Header byte of the P2P packets carrying peer states
+#define PEER_BROADCAST_P2P_PORT 0x0E
+
+void peerBroadcastInit();
+bool peerBroadcastTest();
+
+/**
+ * Called from the stabilizer loop with the latest state and set point
+ */
+void peerBroadcastTellState(const state_t *state, const setpoint_t *setpoint);
@@ -0,0 +1,127 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * peer_broadcast_core.h - Encoding and TDMA timing of the peer state broadcast
+ */
+
+/**
+ * Each Crazyflie periodically broadcasts its own state to its neighbours over
+ * P2P. The position and attitude use the same compact encoding as the packed
+ * external pose from the ground (extPosePackedItem), extended with velocity
+ * and the position the Crazyflie is heading for.
+ *
+ * To avoid collisions on air, time is divided in frames of slotCount slots and
+ * each Crazyflie only transmits in the slot given by the last byte of its radio
+ * address, modulo slotCount. Crazyflies with ids that are equal modulo
+ * slotCount share a slot and collide, the default of 16 slots thus only
+ * supports swarms with ids 0-15. For larger swarms, raise the slotCount
+ * parameter on all Crazyflies (up to 255, at the cost of a longer frame).
+ *
+ * The frames of a swarm are aligned to the Crazyflie with the lowest id heard
+ * recently, the others adjust their frame start when they receive a packet
+ * from it. If it goes silent, the own clock is used again.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PEER_BROADCAST_DEFAULT_SLOT_COUNT 16
+#define PEER_BROADCAST_DEFAULT_SLOT_LENGTH 5 // ms
+#define PEER_BROADCAST_REFERENCE_TIMEOUT 1000 // ms
+
+#define PEER_BROADCAST_FLAG_INTENT_VALID 0x01
+
+// One broadcast item, 25 bytes
+typedef struct {
+  uint8_t id; // last 8 bit of the Crazyflie address
+  uint8_t slot; // TDMA slot of the sender
+  int16_t x; // mm
+  int16_t y; // mm
+  int16_t z; // mm
+  int16_t vx; // mm / sec
+  int16_t vy; // mm / sec
+  int16_t vz; // mm / sec
+  uint32_t quat; // compressed quaternion, see quatcompress.h
+  int16_t intentX; // mm
+  int16_t intentY; // mm
+  int16_t intentZ; // mm
+  uint8_t flags;
+} __attribute__((packed)) peerBroadcastItem_t;
+
+typedef struct {
+  uint8_t id;
+  uint8_t slot;
+  float position[3]; // m
+  float velocity[3]; // m / sec
+  float quat[4]; // x, y, z, w
+  float intent[3]; // m
+  bool isIntentValid;
+} peerBroadcastState_t;
+
+typedef struct {
+  uint8_t ownId;
+  uint8_t slotCount;
+  uint8_t slotLength; // ms
+
+  // The Crazyflie the frames are aligned to, ownId when free running
+  uint8_t referenceId;
+  uint32_t referenceLastSeen;
+
+  uint32_t frameStart;
+} peerTdma_t;
+
+/**
+ * Encode a state, values that do not fit are saturated
+ */
+void peerBroadcastEncode(const peerBroadcastState_t* state, peerBroadcastItem_t* item);
+
+/**
+ * Decode a state from received data
+ *
+ * @return false if the data is too short to hold an item
+ */
+bool peerBroadcastDecode(const uint8_t* data, const uint8_t size, peerBroadcastState_t* state);
+
+void peerTdmaInit(peerTdma_t* this, const uint8_t ownId, const uint32_t now);
+
+/**
+ * The slot a Crazyflie transmits in
+ */
+uint8_t peerTdmaSlotOf(const peerTdma_t* this, const uint8_t id);
+
+/**
+ * Time of the start of the next own slot, strictly after now
+ */
+uint32_t peerTdmaNextSlotStart(peerTdma_t* this, const uint32_t now);
+
+/**
+ * Align the frames to a received packet, if it comes from the Crazyflie with
+ * the lowest id heard recently
+ *
+ * @param senderSlot The slot the packet was sent in
+ * @param rxTime The time the packet was received
+ * @return true if the frame start was updated
+ */
+bool peerTdmaOnReceive(peerTdma_t* this, const uint8_t senderId, const uint8_t senderSlot, const uint32_t rxTime);
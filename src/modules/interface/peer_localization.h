@@ -4,40 +4,56 @@
 #include <stdbool.h>
 #include "math3d.h"
 #include "stabilizer_types.h"
+#include "peer_localization_table.h"
 
-// This module tracks the positions of other Crazyflies. Currently, only motion
-// capture localization is supported. Mocap setups transmit position
-// measurements on the radio in broadcast mode, so we can obtain the positions
-// of other Crazyflies on the same radio "for free". In the future, other
-// methods of peer localization such as peer-to-peer sharing could be added.
-
-// The maximum number of other Crazyflie ID's to track. This constant may be
-// needed for static allocations in other modules, e.g. collision avoidance.
-#define PEER_LOCALIZATION_MAX_NEIGHBORS 10
+// This module tracks the positions of other Crazyflies. Mocap setups transmit
+// position measurements on the radio in broadcast mode, so we can obtain the
+// positions of other Crazyflies on the same radio "for free". Crazyflies can
+// also share their states peer-to-peer, see peer_broadcast.h.
+//
+// Peers that have not been heard from for peerLoc.maxAge ms are forgotten.
 
 // Initialize and test the module.
 void peerLocalizationInit();
 bool peerLocalizationTest();
 
-typedef struct peerLocalizationOtherPosition_s {
-  uint8_t id;  // CF id
-  point_t pos; // position and timestamp (millisecs)
-} peerLocalizationOtherPosition_t;
-
 // Tell the peer localization system the position of another Crazyflie.
 // Should be called when the position is already known with high accuracy,
-// e.g. when a motion capture measurement packet is received.
+// e.g. when a motion capture measurement packet is received. The velocity is
+// computed from consecutive positions.
 bool peerLocalizationTellPosition(int id, positionMeasurement_t const *pos);
 
+// Tell the peer localization system the position and velocity of another
+// Crazyflie, e.g. when it is received from the Crazyflie itself.
+bool peerLocalizationTellState(int id, positionMeasurement_t const *pos, velocity_t const *vel);
+
 // Returns true if we have a position value for the given radio ID.
 bool peerLocalizationIsIDActive(uint8_t id);
 
 // Returns the position value for the given radio ID, or NULL if none exists.
-// Performs a linear search.
 peerLocalizationOtherPosition_t *peerLocalizationGetPositionByID(uint8_t id);
 
-// Returns the position value based on index, uncorrelated with radio ID. More
-// efficient if iterating over all peers is needed.
+// Returns the position value based on index, uncorrelated with radio ID. The
+// entry may be free (id == 0) or expired, prefer the iterator below.
 peerLocalizationOtherPosition_t *peerLocalizationGetPositionByIdx(uint8_t idx);
 
+// Iterates over the active peers only:
+//
+//   peerLocalizationIterator_t it;
+//   peerLocalizationIteratorInit(&it);
+//   peerLocalizationOtherPosition_t *other;
+//   while ((other = peerLocalizationIteratorNext(&it))) { ... }
+typedef struct {
+  uint8_t index;
+  uint32_t time;
+} peerLocalizationIterator_t;
+
+void peerLocalizationIteratorInit(peerLocalizationIterator_t *it);
+peerLocalizationOtherPosition_t *peerLocalizationIteratorNext(peerLocalizationIterator_t *it);
+
+// Returns the position of a peer extrapolated with its velocity to the given
+// time (ms), at most PEER_LOCALIZATION_MAX_PREDICTION ms after its latest
+// update.
+void peerLocalizationPredictPosition(peerLocalizationOtherPosition_t const *other, uint32_t time, point_t *pos);
+
 #endif // __PEER_LOCALIZATION_H__
@@ -0,0 +1,108 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * peer_localization_table.h - Table of the latest known states of other Crazyflies
+ */
+
+/**
+ * Entries are stored in a fixed array and found through a table indexed by
+ * id, the last byte of the radio address, so that lookup and update do not
+ * depend on the number of peers. Entries that have not been updated for
+ * maxAge ms are expired and their slot is reused.
+ *
+ * Each entry holds a velocity, either given with the position or computed
+ * from consecutive positions, which is used to predict the position at a
+ * later time.
+ *
+ * The table does no locking and does not read the time, all functions take
+ * the current time (ms) as an argument.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "stabilizer_types.h"
+
+// The maximum number of other Crazyflie ID's to track. This constant may be
+// needed for static allocations in other modules, e.g. collision avoidance.
+#ifndef PEER_LOCALIZATION_MAX_NEIGHBORS
+#define PEER_LOCALIZATION_MAX_NEIGHBORS 10
+#endif
+
+#define PEER_LOCALIZATION_DEFAULT_MAX_AGE 5000 // ms
+
+// Velocities are only computed from positions received closer than this
+#define PEER_LOCALIZATION_MAX_VELOCITY_DT 500 // ms
+
+// Predictions are limited to this time after the latest update
+#define PEER_LOCALIZATION_MAX_PREDICTION 200 // ms
+
+typedef struct peerLocalizationOtherPosition_s {
+  uint8_t id;  // CF id, 0 for a free entry
+  point_t pos; // position and timestamp (millisecs)
+  velocity_t vel; // m/s
+} peerLocalizationOtherPosition_t;
+
+typedef struct {
+  peerLocalizationOtherPosition_t entries[PEER_LOCALIZATION_MAX_NEIGHBORS];
+
+  // Index + 1 of the entry of each id, 0 if the id has no entry
+  uint8_t entryOfId[256];
+
+  uint32_t maxAge; // ms
+} peerLocalizationTable_t;
+
+void peerLocalizationTableInit(peerLocalizationTable_t* this);
+
+/**
+ * Update the position of a peer, adding it if it is not in the table
+ *
+ * @param id The id of the peer, 0 is not a valid id
+ * @param vel The velocity, or NULL to compute it from the previous position
+ * @param now Current time (ms)
+ * @return false if the id is not valid or the table is full
+ */
+bool peerLocalizationTableUpdate(peerLocalizationTable_t* this, const uint8_t id, const float x, const float y, const float z, const velocity_t* vel, const uint32_t now);
+
+/**
+ * Find the entry of a peer
+ *
+ * @return The entry or NULL if the peer is not in the table or expired
+ */
+peerLocalizationOtherPosition_t* peerLocalizationTableFind(peerLocalizationTable_t* this, const uint8_t id, const uint32_t now);
+
+/**
+ * Iterate over the active entries, expired entries are removed on the way
+ *
+ * @param index Position of the iteration, start at 0
+ * @return The next active entry or NULL when there are no more
+ */
+peerLocalizationOtherPosition_t* peerLocalizationTableNext(peerLocalizationTable_t* this, uint8_t* index, const uint32_t now);
+
+/**
+ * Predict the position of a peer at a time after its latest update, using
+ * its velocity
+ */
+void peerLocalizationTablePredict(const peerLocalizationOtherPosition_t* other, const uint32_t time, point_t* pos);
@@ -36,7 +36,7 @@
 
 #include "controller_indi.h"
 #include "stabilizer_types.h"
-#include "filter.h"
+#include "biquad_bank.h"
 #include "math3d.h"
 #include "log.h"
 #include "param.h"
@@ -55,9 +55,9 @@ struct Angles {
 
 struct IndiOuterVariables {
 
-  Butterworth2LowPass ddxi[3];
-  Butterworth2LowPass ang[3];
-  Butterworth2LowPass thr[3];
+  // Linear acceleration x, y, z on channels 0-2 and attitude phi, theta, psi on channels 3-5
+  biquadBank_t filters;
+  biquadBank_t thrustFilter;
 
   float filt_cutoff;
   float act_dyn_posINDI;
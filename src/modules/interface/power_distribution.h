@@ -33,6 +33,7 @@ bool powerDistributionTest(void);
 void powerDistribution(const control_t *control);
 void powerStop();
 void setFeedForward();
+// Battery compensated PWM (0 - UINT16_MAX) for a thrust of one motor [N], see motor_thrust_model.h
 float thrust2pwm(float thrust);
 void powerDistributionForceTorque(const control_t *control);
 void setFlip(bool val);
@@ -32,15 +32,22 @@
 
 #ifdef DEBUG_QUEUE_MONITOR
   #include "queue.h"
+  #include "queuemonitor_stats.h"
 
   void queueMonitorInit();
   #define DEBUG_QUEUE_MONITOR_REGISTER(queue) qmRegisterQueue(queue, __FILE__, #queue)
+  // Queues that are not FreeRTOS queues get a slot of statistics that the
+  // owner updates itself, see queuemonitor_stats.h
+  #define DEBUG_QUEUE_MONITOR_REGISTER_STATS(stats, queueName) stats = qmRegisterStats(__FILE__, queueName)
 
   void qm_traceQUEUE_SEND(void* xQueue);
   void qm_traceQUEUE_SEND_FAILED(void* xQueue);
+  void qm_traceQUEUE_RECEIVE(void* xQueue);
   void qmRegisterQueue(xQueueHandle* xQueue, char* fileName, char* queueName);
+  qmStats_t* qmRegisterStats(char* fileName, char* queueName);
 #else
   #define DEBUG_QUEUE_MONITOR_REGISTER(queue)
+  #define DEBUG_QUEUE_MONITOR_REGISTER_STATS(stats, queueName)
 #endif // DEBUG_QUEUE_MONITOR
 
 #endif // __QUEUE_MONITOR_H__
\ No newline at end of file
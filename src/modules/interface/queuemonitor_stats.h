@@ -0,0 +1,113 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * queuemonitor_stats.h - Wait time and fill level statistics of a queue
+ */
+
+/**
+ * The statistics of one monitored queue, fed from the FreeRTOS queue trace
+ * hooks by queuemonitor.c. The enqueue time of each item is kept in a small
+ * ring in the same order as the items in the queue, so the wait time is known
+ * when the item is received without changing the items themselves.
+ *
+ * If the queue holds more items than the ring, the newest items are counted
+ * as untracked and are not measured. The number of items is checked against
+ * the queue on every send, so items removed without a receive (a queue reset)
+ * only cost a few measurements. An overwrite replaces the newest item and its
+ * timestamp, it is not counted as an extra item.
+ *
+ * Wait times are sorted in log scale buckets, each bucket is 4 times wider
+ * than the previous one.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define QM_STATS_TIMESTAMP_COUNT 32
+
+#define QM_STATS_BUCKET_COUNT 8
+// Upper limit of the first bucket, us
+#define QM_STATS_FIRST_BUCKET_LIMIT 16
+#define QM_STATS_BUCKET_SHIFT 2
+
+typedef struct {
+  // Enqueue times, us, of the oldest items in the queue
+  uint32_t timestamps[QM_STATS_TIMESTAMP_COUNT];
+  uint8_t first;
+  uint8_t count;
+  // Items in the queue after the tracked ones
+  uint32_t untrackedCount;
+
+  uint32_t sendCount;
+  uint32_t fullCount;
+  uint32_t receiveCount;
+  uint16_t highWater;
+
+  // Bucket i holds wait times below QM_STATS_FIRST_BUCKET_LIMIT << 2i us,
+  // the last one everything above
+  uint32_t histogram[QM_STATS_BUCKET_COUNT];
+  uint32_t maxWait;
+} qmStats_t;
+
+void qmStatsInit(qmStats_t* this);
+
+/**
+ * Reset the counters, histogram and high water mark but keep track of the
+ * items in the queue
+ */
+void qmStatsResetCounters(qmStats_t* this);
+
+/**
+ * An item is about to be added to the back of the queue
+ *
+ * @param now Current time, us
+ * @param waiting Number of items in the queue before this one is added
+ */
+void qmStatsOnSend(qmStats_t* this, const uint32_t now, const uint32_t waiting);
+
+/**
+ * The newest item in a full queue is about to be overwritten, xQueueOverwrite()
+ *
+ * @param now Current time, us
+ * @param waiting Number of items in the queue
+ */
+void qmStatsOnOverwrite(qmStats_t* this, const uint32_t now, const uint32_t waiting);
+
+/**
+ * An item could not be added since the queue was full
+ */
+void qmStatsOnSendFailed(qmStats_t* this);
+
+/**
+ * An item was removed from the front of the queue
+ *
+ * @param now Current time, us
+ */
+void qmStatsOnReceive(qmStats_t* this, const uint32_t now);
+
+/**
+ * Get the histogram bucket of a wait time
+ */
+int qmStatsBucketOf(const uint32_t wait);
@@ -27,6 +27,9 @@
 
 #pragma once
 
+#include <stdint.h>
+#include <stdbool.h>
+
 typedef enum {
     rangeFront=0,
     rangeBack,
@@ -45,6 +48,17 @@ typedef enum {
  */
 void rangeSet(rangeDirection_t direction, float range_m);
 
+/**
+ * Set the range for a certain direction together with the time the range was
+ * sampled. Use this when the driver knows the sample time better than the
+ * time of the call.
+ *
+ * @param direction Direction of the range
+ * @param range_m Distance to an object in meter
+ * @param timestamp Time when the range was sampled (in micro seconds, see usecTimestamp())
+ */
+void rangeSetWithTimestamp(rangeDirection_t direction, float range_m, uint64_t timestamp);
+
 /**
  * Get the range for a certain direction
  *
@@ -53,6 +67,14 @@ void rangeSet(rangeDirection_t direction, float range_m);
  */
 float rangeGet(rangeDirection_t direction);
 
+/**
+ * Get the time when the range for a certain direction was sampled
+ *
+ * @param direction Direction of the range
+ * @return Time of the latest sample (in micro seconds, see usecTimestamp()), 0 if no range has been set
+ */
+uint64_t rangeGetTimestamp(rangeDirection_t direction);
+
 /**
  * Enqueue a range measurement for distance to the ground in the current estimator.
  *
@@ -33,6 +33,8 @@
 
 /* Data structure used by the stabilizer subsystem.
  * All have a timestamp to be set when the data is calculated.
+ * Measurements also have timestampUs, the microsecond time the sample was
+ * taken, or 0 if the producer does not know it.
  */
 
 /** Attitude in euler angle form */
@@ -87,6 +89,7 @@ typedef struct tdoaMeasurement_s {
   point_t anchorPosition[2];
   float distanceDiff;
   float stdDev;
+  uint64_t timestampUs; // Time the sample was taken, see usecTimestamp()
 } tdoaMeasurement_t;
 
 typedef struct baro_s {
@@ -105,6 +108,7 @@ typedef struct positionMeasurement_s {
     float pos[3];
   };
   float stdDev;
+  uint64_t timestampUs; // Time the sample was taken, see usecTimestamp()
 } positionMeasurement_t;
 
 typedef struct poseMeasurement_s {
@@ -119,6 +123,7 @@ typedef struct poseMeasurement_s {
   quaternion_t quat;
   float stdDevPos;
   float stdDevQuat;
+  uint64_t timestampUs; // Time the sample was taken, see usecTimestamp()
 } poseMeasurement_t;
 
 typedef struct distanceMeasurement_s {
@@ -132,6 +137,7 @@ typedef struct distanceMeasurement_s {
   };
   float distance;
   float stdDev;
+  uint64_t timestampUs; // Time the sample was taken, see usecTimestamp()
 } distanceMeasurement_t;
 
 typedef struct zDistance_s {
@@ -221,6 +227,7 @@ typedef struct flowMeasurement_s {
   float stdDevX;      // Measurement standard deviation
   float stdDevY;      // Measurement standard deviation
   float dt;           // Time during which pixels were accumulated
+  uint64_t timestampUs; // Time the sample was taken, see usecTimestamp()
 } flowMeasurement_t;
 
 
@@ -229,6 +236,7 @@ typedef struct tofMeasurement_s {
   uint32_t timestamp;
   float distance;
   float stdDev;
+  uint64_t timestampUs; // Time the sample was taken, see usecTimestamp()
 } tofMeasurement_t;
 
 /** Absolute height measurement */
@@ -236,6 +244,7 @@ typedef struct heightMeasurement_s {
   uint32_t timestamp;
   float height;
   float stdDev;
+  uint64_t timestampUs; // Time the sample was taken, see usecTimestamp()
 } heightMeasurement_t;
 
 /** Yaw error measurement */
@@ -243,6 +252,7 @@ typedef struct {
   uint32_t timestamp;
   float yawError;
   float stdDev;
+  uint64_t timestampUs; // Time the sample was taken, see usecTimestamp()
 } yawErrorMeasurement_t;
 
 /** Sweep angle measurement */
@@ -257,6 +267,7 @@ typedef struct {
   float stdDev;
   const lighthouseCalibrationSweep_t* calib;
   lighthouseCalibrationMeasurementModel_t calibrationMeasurementModel;
+  uint64_t timestampUs; // Time the sample was taken, see usecTimestamp()
 } sweepAngleMeasurement_t;
 
 // Frequencies to bo used with the RATE_DO_EXECUTE_HZ macro. Do NOT use an arbitrary number.
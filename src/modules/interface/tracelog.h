@@ -0,0 +1,135 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * tracelog.h - Binary trace log with format strings resolved on the host
+ */
+
+/**
+ * TRACE_PRINT() takes the same arguments as DEBUG_PRINT() but does not format
+ * anything on the Crazyflie. The format string is placed in the .trace_fmt
+ * section, which is kept in the elf file but not loaded to the target, and is
+ * identified by its offset in that section. Only the offset, a timestamp and
+ * one word per argument are written to a lock free ring buffer, see
+ * trace_ring.h. A low priority task drains the buffer over CRTP, Segger RTT
+ * or to the uSD card and tools/trace/decode_tracelog.py rebuilds the text
+ * from the elf file.
+ *
+ * Arguments are stored as 32 bit words: integers are truncated to 32 bits,
+ * floats and doubles are stored as float and pointers as addresses. A %s
+ * argument can only be decoded if the string is a constant in flash.
+ *
+ * Build with DEBUG_PRINT_ON_TRACE_LOG=1 to route DEBUG_PRINT() here.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TRACE_LOG_MAX_ARGS 10
+
+// Record tag: offset of the format string, the rest of the record is the
+// timestamp (us, 32 bits) followed by the arguments
+#define TRACE_LOG_FMT_SECTION ".trace_fmt"
+
+// CRTP packets on CRTP_PORT_TRACE: sequence number, offset of the first
+// record that starts in the packet (TRACE_LOG_CRTP_NO_RECORD_START if none)
+// and then the byte stream of records
+#define TRACE_LOG_CRTP_HEADER_SIZE 2
+#define TRACE_LOG_CRTP_NO_RECORD_START 0xff
+
+void traceLogInit(void);
+bool traceLogTest(void);
+
+/**
+ * Write a record, use TRACE_PRINT() instead of calling this directly
+ *
+ * Can be called from any task or interrupt.
+ */
+void traceLogWrite(const uint32_t fmtId, const uint32_t* args, const uint32_t count);
+
+// Signed and 64 bit so that any integer argument converts without warnings
+static inline uint32_t traceLogWordFromInt(const int64_t value) {
+  return (uint32_t)value;
+}
+
+static inline uint32_t traceLogWordFromFloat(const float value) {
+  union {
+    float f;
+    uint32_t u;
+  } word = {.f = value};
+  return word.u;
+}
+
+static inline uint32_t traceLogWordFromDouble(const double value) {
+  return traceLogWordFromFloat((float)value);
+}
+
+static inline uint32_t traceLogWordFromPointer(const void* value) {
+  return (uint32_t)(uintptr_t)value;
+}
+
+#define TRACE_LOG_WORD(X) _Generic((X), \
+  float: traceLogWordFromFloat, \
+  double: traceLogWordFromDouble, \
+  char*: traceLogWordFromPointer, \
+  const char*: traceLogWordFromPointer, \
+  unsigned char*: traceLogWordFromPointer, \
+  const unsigned char*: traceLogWordFromPointer, \
+  void*: traceLogWordFromPointer, \
+  const void*: traceLogWordFromPointer, \
+  default: traceLogWordFromInt)(X)
+
+#if defined(UNIT_TEST_MODE)
+  #define TRACE_PRINT(...)
+#else
+  #define TRACE_PRINT(...) TRACE_LOG_PRINT_N(TRACE_LOG_NARGS(__VA_ARGS__), __VA_ARGS__)
+#endif
+
+// Number of arguments after the format string
+#define TRACE_LOG_NARGS(...) TRACE_LOG_NARGS_(__VA_ARGS__, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, _)
+#define TRACE_LOG_NARGS_(FMT, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, N, ...) N
+
+#define TRACE_LOG_PRINT_N(N, ...) TRACE_LOG_PRINT_N_(N, __VA_ARGS__)
+#define TRACE_LOG_PRINT_N_(N, ...) TRACE_LOG_PRINT_ ## N(__VA_ARGS__)
+
+#define TRACE_LOG_RECORD(FMT, COUNT, ...) do { \
+    static const char traceLogFmt[] __attribute__((section(TRACE_LOG_FMT_SECTION), used)) = FMT; \
+    const uint32_t traceLogArgs[] = {__VA_ARGS__}; \
+    traceLogWrite((uint32_t)(uintptr_t)traceLogFmt, traceLogArgs, COUNT); \
+  } while (0)
+
+#define TRACE_LOG_PRINT_0(FMT) do { \
+    static const char traceLogFmt[] __attribute__((section(TRACE_LOG_FMT_SECTION), used)) = FMT; \
+    traceLogWrite((uint32_t)(uintptr_t)traceLogFmt, 0, 0); \
+  } while (0)
+#define TRACE_LOG_PRINT_1(FMT, A1) TRACE_LOG_RECORD(FMT, 1, TRACE_LOG_WORD(A1))
+#define TRACE_LOG_PRINT_2(FMT, A1, A2) TRACE_LOG_RECORD(FMT, 2, TRACE_LOG_WORD(A1), TRACE_LOG_WORD(A2))
+#define TRACE_LOG_PRINT_3(FMT, A1, A2, A3) TRACE_LOG_RECORD(FMT, 3, TRACE_LOG_WORD(A1), TRACE_LOG_WORD(A2), TRACE_LOG_WORD(A3))
+#define TRACE_LOG_PRINT_4(FMT, A1, A2, A3, A4) TRACE_LOG_RECORD(FMT, 4, TRACE_LOG_WORD(A1), TRACE_LOG_WORD(A2), TRACE_LOG_WORD(A3), TRACE_LOG_WORD(A4))
+#define TRACE_LOG_PRINT_5(FMT, A1, A2, A3, A4, A5) TRACE_LOG_RECORD(FMT, 5, TRACE_LOG_WORD(A1), TRACE_LOG_WORD(A2), TRACE_LOG_WORD(A3), TRACE_LOG_WORD(A4), TRACE_LOG_WORD(A5))
+#define TRACE_LOG_PRINT_6(FMT, A1, A2, A3, A4, A5, A6) TRACE_LOG_RECORD(FMT, 6, TRACE_LOG_WORD(A1), TRACE_LOG_WORD(A2), TRACE_LOG_WORD(A3), TRACE_LOG_WORD(A4), TRACE_LOG_WORD(A5), TRACE_LOG_WORD(A6))
+#define TRACE_LOG_PRINT_7(FMT, A1, A2, A3, A4, A5, A6, A7) TRACE_LOG_RECORD(FMT, 7, TRACE_LOG_WORD(A1), TRACE_LOG_WORD(A2), TRACE_LOG_WORD(A3), TRACE_LOG_WORD(A4), TRACE_LOG_WORD(A5), TRACE_LOG_WORD(A6), TRACE_LOG_WORD(A7))
+#define TRACE_LOG_PRINT_8(FMT, A1, A2, A3, A4, A5, A6, A7, A8) TRACE_LOG_RECORD(FMT, 8, TRACE_LOG_WORD(A1), TRACE_LOG_WORD(A2), TRACE_LOG_WORD(A3), TRACE_LOG_WORD(A4), TRACE_LOG_WORD(A5), TRACE_LOG_WORD(A6), TRACE_LOG_WORD(A7), TRACE_LOG_WORD(A8))
+#define TRACE_LOG_PRINT_9(FMT, A1, A2, A3, A4, A5, A6, A7, A8, A9) TRACE_LOG_RECORD(FMT, 9, TRACE_LOG_WORD(A1), TRACE_LOG_WORD(A2), TRACE_LOG_WORD(A3), TRACE_LOG_WORD(A4), TRACE_LOG_WORD(A5), TRACE_LOG_WORD(A6), TRACE_LOG_WORD(A7), TRACE_LOG_WORD(A8), TRACE_LOG_WORD(A9))
+#define TRACE_LOG_PRINT_10(FMT, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10) TRACE_LOG_RECORD(FMT, 10, TRACE_LOG_WORD(A1), TRACE_LOG_WORD(A2), TRACE_LOG_WORD(A3), TRACE_LOG_WORD(A4), TRACE_LOG_WORD(A5), TRACE_LOG_WORD(A6), TRACE_LOG_WORD(A7), TRACE_LOG_WORD(A8), TRACE_LOG_WORD(A9), TRACE_LOG_WORD(A10))
@@ -106,44 +106,90 @@ void collisionAvoidanceUpdateSetpointCore(
   // Part 1: Construct the polytope inequalities in A, b.
   //
 
-  int const nRows = nOthers + 6;
+  // The workspace is laid out for all neighbors, but only the ones that can
+  // affect the cell get a row.
+  int const nRowsMax = nOthers + 6;
   float *A = workspace;
-  float *B = workspace + 3 * nRows;
-  float *projectionWorkspace = workspace + 4 * nRows;
+  float *B = workspace + 3 * nRowsMax;
+  float *projectionWorkspace = workspace + 4 * nRowsMax;
+
+  // Stretched distance to the neighbor of each row. The projection workspace
+  // is not used until the cell is complete, so we borrow it.
+  float *rowDist = projectionWorkspace;
 
   // Compute the cell in a stretched coordinate system for downwash awareness.
   // See header for details.
   struct vec const radiiInv = veltrecip(params->ellipsoidRadii);
   struct vec const ourPos = vec2svec(state->position);
 
-  // We could do some optimizations here to reduce the number of rows, like
-  // leave out very far away neighbors. It would help the average case
-  // complexity, but not the worst case - so we skip it for now.
+  // The cell is always limited by the max speed box |x_i| <= maxDist. In the
+  // stretched coordinate system, the face of a neighbor at distance dist is at
+  // dist / 2 - 1 from us and no point of the box is further away than
+  // maxDist * |radiiInv|, so neighbors beyond cullDist can't cut the box.
+  float const maxDist = params->horizonSecs * params->maxSpeed;
+  float const cullDist = 2.0f * (maxDist * vmag(radiiInv) + 1.0f);
+  float const cullDistSq = cullDist * cullDist;
+
+  int nKept = 0;
   for (int i = 0; i < nOthers; ++i) {
     struct vec peerPos = vloadf(otherPositions + 3 * i);
     struct vec const toPeerStretched = veltmul(vsub(peerPos, ourPos), radiiInv);
-    float const dist = vmag(toPeerStretched);
+    float const distSq = vmag2(toPeerStretched);
+    if (distSq >= cullDistSq) {
+      continue;
+    }
+
+    float const dist = sqrtf(distSq);
     struct vec const a = vdiv(veltmul(toPeerStretched, radiiInv), dist);
     float const b = dist / 2.0f - 1.0f;
     float scale = 1.0f / vmag(a);
-    vstoref(vscl(scale, a), A + 3 * i);
-    B[i] = scale * b;
+    struct vec const aScaled = vscl(scale, a);
+    float const bScaled = scale * b;
+
+    // Tighter test on the actual face: the largest value of a^T x in the box
+    // is maxDist * |a|_1. If that is within the face, the row can't be active.
+    if (maxDist * vnorm1(aScaled) <= bScaled) {
+      continue;
+    }
+
+    // Keep the nearest neighbors only, to bound the cost of the projection.
+    // Rows are always written at or before the current index, so overlapping
+    // otherPositions and workspace is still fine.
+    int row = nKept;
+    if (params->maxNeighbors <= 0 || nKept < params->maxNeighbors) {
+      ++nKept;
+    } else {
+      row = 0;
+      for (int j = 1; j < nKept; ++j) {
+        if (rowDist[j] > rowDist[row]) {
+          row = j;
+        }
+      }
+      if (dist >= rowDist[row]) {
+        continue;
+      }
+    }
+
+    vstoref(aScaled, A + 3 * row);
+    B[row] = bScaled;
+    rowDist[row] = dist;
   }
 
+  collisionState->neighborCount = nKept;
+  int const nRows = nKept + 6;
+
   // Add the bounding box polytope faces. We also use the box faces to enforce
   // max speed in the infinity-norm.
-  float const maxDist = params->horizonSecs * params->maxSpeed;
-
-  memset(A + 3 * nOthers, 0, 18 * sizeof(float));
+  memset(A + 3 * nKept, 0, 18 * sizeof(float));
 
   for (int dim = 0; dim < 3; ++dim) {
     float boxMax = vindex(params->bboxMax, dim) - vindex(ourPos, dim);
-    A[3 * (nOthers + dim) + dim] = 1.0f;
-    B[nOthers + dim] = fminf(maxDist, boxMax);
+    A[3 * (nKept + dim) + dim] = 1.0f;
+    B[nKept + dim] = fminf(maxDist, boxMax);
 
     float boxMin = vindex(params->bboxMin, dim) - vindex(ourPos, dim);
-    A[3 * (nOthers + dim + 3) + dim] = -1.0f;
-    B[nOthers + dim + 3] = -fmaxf(-maxDist, boxMin);
+    A[3 * (nKept + dim + 3) + dim] = -1.0f;
+    B[nKept + dim + 3] = -fmaxf(-maxDist, boxMin);
   }
 
   //
@@ -279,10 +325,12 @@ static collision_avoidance_params_t params = {
   .maxPeerLocAgeMillis = 5000,  // Probably longer than desired in most applications.
   .voronoiProjectionTolerance = 1e-5,
   .voronoiProjectionMaxIters = 100,
+  .maxNeighbors = 6,  // Below PEER_LOCALIZATION_MAX_NEIGHBORS, so crowded cells are culled.
 };
 
 static collision_avoidance_state_t collisionState = {
   .lastFeasibleSetPosition = { .x = NAN, .y = NAN, .z = NAN },
+  .neighborCount = 0,
 };
 
 void collisionAvoidanceInit()
@@ -317,21 +365,22 @@ void collisionAvoidanceUpdateSetpoint(
   // Counts the actual number of neighbors after we filter stale measurements.
   int nOthers = 0;
 
-  for (int i = 0; i < PEER_LOCALIZATION_MAX_NEIGHBORS; ++i) {
-
-    peerLocalizationOtherPosition_t const *otherPos = peerLocalizationGetPositionByIdx(i);
-
-    if (otherPos == NULL || otherPos->id == 0) {
-      continue;
-    }
+  peerLocalizationIterator_t it;
+  peerLocalizationIteratorInit(&it);
+  peerLocalizationOtherPosition_t const *otherPos;
+  while ((otherPos = peerLocalizationIteratorNext(&it))) {
 
     if (doAgeFilter && (time - otherPos->pos.timestamp > params.maxPeerLocAgeMillis)) {
       continue;
     }
 
-    workspace[3 * nOthers + 0] = otherPos->pos.x;
-    workspace[3 * nOthers + 1] = otherPos->pos.y;
-    workspace[3 * nOthers + 2] = otherPos->pos.z;
+    // Use where the peer is now rather than where it was last seen
+    point_t predicted;
+    peerLocalizationPredictPosition(otherPos, time, &predicted);
+
+    workspace[3 * nOthers + 0] = predicted.x;
+    workspace[3 * nOthers + 1] = predicted.y;
+    workspace[3 * nOthers + 2] = predicted.z;
     ++nOthers;
   }
 
@@ -342,6 +391,7 @@ void collisionAvoidanceUpdateSetpoint(
 
 LOG_GROUP_START(colAv)
   LOG_ADD(LOG_UINT32, latency, &latency)
+  LOG_ADD(LOG_INT32, neighbors, &collisionState.neighborCount)
 LOG_GROUP_STOP(colAv)
 
 
@@ -366,6 +416,7 @@ PARAM_GROUP_START(colAv)
   PARAM_ADD(PARAM_INT32, maxPeerLocAge, &params.maxPeerLocAgeMillis)
   PARAM_ADD(PARAM_FLOAT, vorTol, &params.voronoiProjectionTolerance)
   PARAM_ADD(PARAM_INT32, vorIters, &params.voronoiProjectionMaxIters)
+  PARAM_ADD(PARAM_INT32, maxNeighbors, &params.maxNeighbors)
 PARAM_GROUP_STOP(colAv)
 
 #endif  // CRAZYFLIE_FW
@@ -119,7 +119,7 @@ int consolePutchar(int ch)
 
       if (ch == '\n' || messageToPrint.size >= CRTP_MAX_DATA_SIZE)
       {
-        if (crtpGetFreeTxQueuePackets() == 1)
+        if (crtpGetFreeTxQueuePacketsForPort(CRTP_PORT_CONSOLE) == 1)
         {
           addBufferFullMarker();
         }
@@ -36,6 +36,7 @@ Geometric tracking controller.
 #include "controller_geom.h"
 #include "controller_flip.h"
 #include "interpolation.h"
+#include "power_distribution.h"
 
 
 // Inertia matrix components
@@ -106,6 +107,7 @@ static struct vec edw;
 
 static bool gp = false;
 static bool robust = false;
+static bool useThrustModel = false; // map thrust to PWM with the battery compensated motor model instead of thrust_scale
 static float eta0 = 0;
 static float eta1 = 0;
 static float mu0 = 0;
@@ -406,6 +408,8 @@ void controllerGeom(control_t *control, setpoint_t *setpoint,
  
   if (setpoint->mode.z == modeDisable) {
     control->thrust = setpoint->thrust;
+  } else if (useThrustModel) {
+    control->thrust = thrust2pwm(thrust / 4.0f);
   } else {
     control->thrust = thrust * thrust_scale;
   }
@@ -456,6 +460,7 @@ PARAM_ADD(PARAM_UINT8, gp, &gp)
 PARAM_ADD(PARAM_UINT8, robust, &robust)
 PARAM_ADD(PARAM_FLOAT, delta_R, &delta_R)
 PARAM_ADD(PARAM_FLOAT, mass, &g_vehicleMass)
+PARAM_ADD(PARAM_UINT8, thrustModel, &useThrustModel)
 PARAM_GROUP_STOP(ctrlGeom)
 
 LOG_GROUP_START(ctrlGeom)
@@ -70,42 +70,46 @@ static inline void float_rates_zero(struct FloatRates *fr) {
 
 void indi_init_filters(void)
 {
-	// tau = 1/(2*pi*Fc)
-	float tau = 1.0f / (2.0f * M_PI_F * indi.filt_cutoff);
-	float tau_r = 1.0f / (2.0f * M_PI_F * indi.filt_cutoff_r);
-	float tau_axis[3] = {tau, tau, tau_r};
-	float sample_time = 1.0f / ATTITUDE_RATE;
-	// Filtering of gyroscope and actuators
+	float cutoff_axis[3] = {indi.filt_cutoff, indi.filt_cutoff, indi.filt_cutoff_r};
+	// Filtering of gyroscope and actuators, second order Butterworth
+	biquadBankInit(&indi.filters, 6, 1);
 	for (int8_t i = 0; i < 3; i++) {
-		init_butterworth_2_low_pass(&indi.u[i], tau_axis[i], sample_time, 0.0f);
-		init_butterworth_2_low_pass(&indi.rate[i], tau_axis[i], sample_time, 0.0f);
+		biquadBankSetLowPass(&indi.filters, i, 0, ATTITUDE_RATE, cutoff_axis[i]);
+		biquadBankSetLowPass(&indi.filters, 3 + i, 0, ATTITUDE_RATE, cutoff_axis[i]);
+		indi.rate_filt[i] = 0.0f;
+		indi.rate_filt_prev[i] = 0.0f;
+		indi.u_filt[i] = 0.0f;
 	}
 }
 
 /**
- * @brief Update butterworth filter for p, q and r of a FloatRates struct
+ * @brief Update the filters of the rates and actuators in one pass
  *
- * @param filter The filter array to use
- * @param new_values The new values
+ * @param rates The new rate measurements
+ * @param act The new actuator values
  */
-static inline void filter_pqr(Butterworth2LowPass *filter, struct FloatRates *new_values)
+static inline void filter_rates_and_actuators(struct FloatRates *rates, struct FloatRates *act)
 {
-	update_butterworth_2_low_pass(&filter[0], new_values->p);
-	update_butterworth_2_low_pass(&filter[1], new_values->q);
-	update_butterworth_2_low_pass(&filter[2], new_values->r);
+	float samples[6] = {rates->p, rates->q, rates->r, act->p, act->q, act->r};
+
+	biquadBankApply(&indi.filters, samples);
+
+	for (int8_t i = 0; i < 3; i++) {
+		indi.rate_filt_prev[i] = indi.rate_filt[i];
+		indi.rate_filt[i] = samples[i];
+		indi.u_filt[i] = samples[3 + i];
+	}
 }
 
 /**
- * @brief Caclulate finite difference form a filter array
- * The filter already contains the previous values
+ * @brief Caclulate finite difference of the filtered rates
  *
  * @param output The output array
- * @param filter The filter array input
  */
-static inline void finite_difference_from_filter(float *output, Butterworth2LowPass *filter)
+static inline void finite_difference_from_filter(float *output)
 {
 	for (int8_t i = 0; i < 3; i++) {
-		output[i] = (filter[i].o[0] - filter[i].o[1]) * ATTITUDE_RATE;
+		output[i] = (indi.rate_filt[i] - indi.rate_filt_prev[i]) * ATTITUDE_RATE;
 	}
 }
 
@@ -257,20 +261,21 @@ void controllerINDI(control_t *control, setpoint_t *setpoint,
 				.q = stateAttitudeRatePitch,
 				.r = stateAttitudeRateYaw,
 		};
-		filter_pqr(indi.rate, &body_rates);
+		// The actuators are filtered with the commands from the previous timestep
+		filter_rates_and_actuators(&body_rates, &indi.u_act_dyn);
 
 
 		/*
 		 * 2 - Calculate the derivative with finite difference.
 		 */
 
-		finite_difference_from_filter(indi.rate_d, indi.rate);
+		finite_difference_from_filter(indi.rate_d);
 
 
 		/*
 		 * 3 - same filter on the actuators (or control_t values), using the commands from the previous timestep.
+		 * Done together with the rates in step 1.
 		 */
-		filter_pqr(indi.u, &indi.u_act_dyn);
 
 
 		/*
@@ -308,9 +313,9 @@ void controllerINDI(control_t *control, setpoint_t *setpoint,
 		 * 6. Add delta_commands to commands and bound to allowable values
 		 */
 
-		indi.u_in.p = indi.u[0].o[0] + indi.du.p;
-		indi.u_in.q = indi.u[1].o[0] + indi.du.q;
-		indi.u_in.r = indi.u[2].o[0] + indi.du.r;
+		indi.u_in.p = indi.u_filt[0] + indi.du.p;
+		indi.u_in.q = indi.u_filt[1] + indi.du.q;
+		indi.u_in.r = indi.u_filt[2] + indi.du.r;
 
 		//bound the total control input
 		indi.u_in.p = clamp(indi.u_in.p, -1.0f*bound_control_input, bound_control_input);
@@ -36,10 +36,14 @@
 #include "config.h"
 
 #include "crtp.h"
+#include "crtp_tx_scheduler.h"
+#include "crtp_packet_pool.h"
+#include "crtp_rx_backlog.h"
 #include "info.h"
 #include "cfassert.h"
 #include "queuemonitor.h"
 #include "static_mem.h"
+#include "usec_time.h"
 
 #include "log.h"
 
@@ -63,21 +67,75 @@ static struct {
   uint16_t rxRate;
   uint16_t txRate;
 
+  // Max time in the TX queue (ms) per traffic class during the last interval
+  uint16_t txLatency[CRTP_TX_CLASS_COUNT];
+
   uint32_t nextStatisticsTime;
   uint32_t previousStatisticsTime;
 } stats;
 
-static xQueueHandle  txQueue;
-
 #define CRTP_NBR_OF_PORTS 16
-#define CRTP_TX_QUEUE_SIZE 120
 #define CRTP_RX_QUEUE_SIZE 16
+// Time to wait before retrying when the link rejects a packet
+#define CRTP_TX_RETRY_DELAY_MS 2
+
+// Control packets are sent first, the other classes share the link. Telemetry
+// is the bulk of the traffic, old log data is dropped in favour of new.
+static const crtpTxClassConfig_t txClassConfig[CRTP_TX_CLASS_COUNT] = {
+  [CRTP_TX_CLASS_CONTROL]   = {.depth = 16, .weight = 0, .dropOldest = false},
+  [CRTP_TX_CLASS_PARAM_MEM] = {.depth = 32, .weight = 4, .dropOldest = false},
+  [CRTP_TX_CLASS_CONSOLE]   = {.depth = 16, .weight = 2, .dropOldest = false},
+  [CRTP_TX_CLASS_TELEMETRY] = {.depth = 56, .weight = 4, .dropOldest = true},
+};
+
+NO_DMA_CCM_SAFE_ZERO_INIT static crtpTxScheduler_t txScheduler;
+// Given when a packet is queued
+static xSemaphoreHandle txPacketQueued;
+static StaticSemaphore_t txPacketQueuedBuffer;
+// Free places in the queue of the classes that do not drop oldest
+static xSemaphoreHandle txFree[CRTP_TX_CLASS_COUNT];
+static StaticSemaphore_t txFreeBuffer[CRTP_TX_CLASS_COUNT];
+#ifdef DEBUG_QUEUE_MONITOR
+// Queue monitor statistics of the class queues, updated with the scheduler
+static qmStats_t* txQueueStats[CRTP_TX_CLASS_COUNT];
+#endif
 
 static void crtpTxTask(void *param);
 static void crtpRxTask(void *param);
 
+// The port queues hold pointers to packets in the RX pool
 static xQueueHandle queues[CRTP_NBR_OF_PORTS];
 static volatile CrtpCallback callbacks[CRTP_NBR_OF_PORTS];
+NO_DMA_CCM_SAFE_ZERO_INIT static crtpPacketPool_t rxPool;
+
+// The pool is shared between the port queues, so that a port whose task
+// stalls can not take all buffers. What is not shared is kept for the backlog,
+// the packet being received and one packet being handled by each port task.
+static int queuedPortCount;
+static int queueLimit = CRTP_RX_QUEUE_SIZE;
+
+// Packets waiting for the callback of their port, only used by the RX task
+static crtpRxBacklog_t rxBacklog;
+
+// What to do when a packet arrives and the queue of the port is full, or when
+// the link delivers packets faster than they are handled for ports with a
+// callback. Setpoints are only useful until the next one arrives, external
+// positions are still useful if the oldest are dropped. Anything else is a
+// request that must not be reordered, the client retries if it gets no answer.
+static CRTPOverflowPolicy overflowPolicies[CRTP_NBR_OF_PORTS] = {
+  [CRTP_PORT_SETPOINT]         = CRTP_OVERFLOW_COALESCE_LATEST,
+  [CRTP_PORT_SETPOINT_GENERIC] = CRTP_OVERFLOW_COALESCE_LATEST,
+  [CRTP_PORT_LOCALIZATION]     = CRTP_OVERFLOW_DROP_OLDEST,
+};
+
+static struct {
+  // Packets dropped because their port queue was full, or because the
+  // backlog already held the limit of the port
+  uint32_t overflowCount[CRTP_NBR_OF_PORTS];
+  uint32_t coalescedCount;
+  // Packets not queued because the pool was empty
+  uint32_t poolEmptyCount;
+} rxStats;
 static void updateStats();
 
 STATIC_MEM_TASK_ALLOC_STACK_NO_DMA_CCM_SAFE(crtpTxTask, CRTP_TX_TASK_STACKSIZE);
@@ -88,8 +146,21 @@ void crtpInit(void)
   if(isInit)
     return;
 
-  txQueue = xQueueCreate(CRTP_TX_QUEUE_SIZE, sizeof(CRTPPacket));
-  DEBUG_QUEUE_MONITOR_REGISTER(txQueue);
+  crtpPacketPoolInit(&rxPool);
+  crtpRxBacklogInit(&rxBacklog);
+  crtpTxSchedulerInit(&txScheduler, txClassConfig);
+  txPacketQueued = xSemaphoreCreateBinaryStatic(&txPacketQueuedBuffer);
+  for (int i = 0; i < CRTP_TX_CLASS_COUNT; i++)
+  {
+    if (!txClassConfig[i].dropOldest)
+    {
+      txFree[i] = xSemaphoreCreateCountingStatic(txClassConfig[i].depth, txClassConfig[i].depth, &txFreeBuffer[i]);
+    }
+  }
+  DEBUG_QUEUE_MONITOR_REGISTER_STATS(txQueueStats[CRTP_TX_CLASS_CONTROL], "txQueue.control");
+  DEBUG_QUEUE_MONITOR_REGISTER_STATS(txQueueStats[CRTP_TX_CLASS_PARAM_MEM], "txQueue.paramMem");
+  DEBUG_QUEUE_MONITOR_REGISTER_STATS(txQueueStats[CRTP_TX_CLASS_CONSOLE], "txQueue.console");
+  DEBUG_QUEUE_MONITOR_REGISTER_STATS(txQueueStats[CRTP_TX_CLASS_TELEMETRY], "txQueue.telemetry");
 
   STATIC_MEM_TASK_CREATE(crtpTxTask, crtpTxTask, CRTP_TX_TASK_NAME, NULL, CRTP_TX_TASK_PRI);
   STATIC_MEM_TASK_CREATE(crtpRxTask, crtpRxTask, CRTP_RX_TASK_NAME, NULL, CRTP_RX_TASK_PRI);
@@ -106,94 +177,323 @@ void crtpInitTaskQueue(CRTPPort portId)
 {
   ASSERT(queues[portId] == NULL);
 
-  queues[portId] = xQueueCreate(CRTP_RX_QUEUE_SIZE, sizeof(CRTPPacket));
+  queues[portId] = xQueueCreate(CRTP_RX_QUEUE_SIZE, sizeof(CRTPPacket*));
   DEBUG_QUEUE_MONITOR_REGISTER(queues[portId]);
+
+  taskENTER_CRITICAL();
+  queuedPortCount++;
+  const int shared = CRTP_PACKET_POOL_SIZE - CRTP_RX_BACKLOG_SIZE - 1 - queuedPortCount;
+  const int limit = shared / queuedPortCount;
+  queueLimit = limit < CRTP_RX_QUEUE_SIZE ? limit : CRTP_RX_QUEUE_SIZE;
+  taskEXIT_CRITICAL();
+
+  ASSERT(limit > 0);
 }
 
-int crtpReceivePacket(CRTPPort portId, CRTPPacket *p)
+void crtpSetPortOverflowPolicy(CRTPPort portId, CRTPOverflowPolicy policy)
 {
-  ASSERT(queues[portId]);
-  ASSERT(p);
+  ASSERT(portId < CRTP_NBR_OF_PORTS);
 
-  return xQueueReceive(queues[portId], p, 0);
+  overflowPolicies[portId] = policy;
 }
 
-int crtpReceivePacketBlock(CRTPPort portId, CRTPPacket *p)
+static CRTPPacket* allocPacket(void)
+{
+  taskENTER_CRITICAL();
+  CRTPPacket* p = crtpPacketPoolAlloc(&rxPool);
+  taskEXIT_CRITICAL();
+
+  return p;
+}
+
+static void refPacket(CRTPPacket *p)
+{
+  taskENTER_CRITICAL();
+  crtpPacketPoolRef(&rxPool, p);
+  taskEXIT_CRITICAL();
+}
+
+void crtpReleasePacket(CRTPPacket *p)
 {
-  ASSERT(queues[portId]);
   ASSERT(p);
 
-  return xQueueReceive(queues[portId], p, portMAX_DELAY);
+  taskENTER_CRITICAL();
+  crtpPacketPoolRelease(&rxPool, p);
+  taskEXIT_CRITICAL();
 }
 
+CRTPPacket* crtpReceivePacketRefBlock(CRTPPort portId)
+{
+  ASSERT(queues[portId]);
 
-int crtpReceivePacketWait(CRTPPort portId, CRTPPacket *p, int wait)
+  CRTPPacket* p = NULL;
+  xQueueReceive(queues[portId], &p, portMAX_DELAY);
+
+  return p;
+}
+
+static int receivePacketCopy(CRTPPort portId, CRTPPacket *p, TickType_t wait)
 {
   ASSERT(queues[portId]);
   ASSERT(p);
 
-  return xQueueReceive(queues[portId], p, M2T(wait));
+  CRTPPacket* queued;
+  if (xQueueReceive(queues[portId], &queued, wait) != pdTRUE)
+  {
+    return pdFALSE;
+  }
+
+  *p = *queued;
+  crtpReleasePacket(queued);
+
+  return pdTRUE;
+}
+
+int crtpReceivePacket(CRTPPort portId, CRTPPacket *p)
+{
+  return receivePacketCopy(portId, p, 0);
+}
+
+int crtpReceivePacketBlock(CRTPPort portId, CRTPPacket *p)
+{
+  return receivePacketCopy(portId, p, portMAX_DELAY);
+}
+
+
+int crtpReceivePacketWait(CRTPPort portId, CRTPPacket *p, int wait)
+{
+  return receivePacketCopy(portId, p, M2T(wait));
 }
 
 int crtpGetFreeTxQueuePackets(void)
 {
-  return (CRTP_TX_QUEUE_SIZE - uxQueueMessagesWaiting(txQueue));
+  int freePackets = 0;
+
+  taskENTER_CRITICAL();
+  for (int i = 0; i < CRTP_TX_CLASS_COUNT; i++)
+  {
+    freePackets += crtpTxSchedulerFree(&txScheduler, i);
+  }
+  taskEXIT_CRITICAL();
+
+  return freePackets;
+}
+
+int crtpGetFreeTxQueuePacketsForPort(CRTPPort port)
+{
+  taskENTER_CRITICAL();
+  const int freePackets = crtpTxSchedulerFree(&txScheduler, crtpTxSchedulerClassOf(port));
+  taskEXIT_CRITICAL();
+
+  return freePackets;
 }
 
 void crtpTxTask(void *param)
 {
   CRTPPacket p;
+  crtpTxClass_t txClass;
 
   while (true)
   {
     if (link != &nopLink)
     {
-      if (xQueueReceive(txQueue, &p, portMAX_DELAY) == pdTRUE)
+      taskENTER_CRITICAL();
+      const bool isPacketTaken = crtpTxSchedulerPop(&txScheduler, &p, &txClass, T2M(xTaskGetTickCount()));
+#ifdef DEBUG_QUEUE_MONITOR
+      if (isPacketTaken && txQueueStats[txClass])
+      {
+        qmStatsOnReceive(txQueueStats[txClass], (uint32_t)usecTimestamp());
+      }
+#endif
+      taskEXIT_CRITICAL();
+
+      if (isPacketTaken)
       {
+        if (txFree[txClass])
+        {
+          xSemaphoreGive(txFree[txClass]);
+        }
+
         // Keep testing, if the link changes to USB it will go though
         while (link->sendPacket(&p) == false)
         {
           // Relaxation time
-          vTaskDelay(M2T(10));
+          vTaskDelay(M2T(CRTP_TX_RETRY_DELAY_MS));
         }
         stats.txCount++;
         updateStats();
       }
+      else
+      {
+        xSemaphoreTake(txPacketQueued, portMAX_DELAY);
+      }
     }
     else
     {
-      vTaskDelay(M2T(10));
+      // Woken by the next packet or when a link is set
+      xSemaphoreTake(txPacketQueued, portMAX_DELAY);
     }
   }
 }
 
+/**
+ * Hand a packet over to the queue of its port, applying the overflow policy
+ * of the port when the queue holds its share of the pool. The queue gets its
+ * own reference.
+ */
+static void queuePacket(xQueueHandle queue, CRTPPacket *p)
+{
+  const CRTPPort port = p->port;
+  CRTPPacket* oldest;
+
+  switch (overflowPolicies[port])
+  {
+    case CRTP_OVERFLOW_COALESCE_LATEST:
+      // Only the latest packet is kept
+      while (xQueueReceive(queue, &oldest, 0) == pdTRUE)
+      {
+        crtpReleasePacket(oldest);
+        rxStats.coalescedCount++;
+      }
+      break;
+    case CRTP_OVERFLOW_DROP_OLDEST:
+      if (uxQueueMessagesWaiting(queue) >= queueLimit && xQueueReceive(queue, &oldest, 0) == pdTRUE)
+      {
+        crtpReleasePacket(oldest);
+        rxStats.overflowCount[port]++;
+      }
+      break;
+    default:
+      break;
+  }
+
+  if (uxQueueMessagesWaiting(queue) >= queueLimit)
+  {
+    rxStats.overflowCount[port]++;
+    return;
+  }
+
+  refPacket(p);
+  if (xQueueSend(queue, &p, 0) != pdTRUE)
+  {
+    crtpReleasePacket(p);
+    rxStats.overflowCount[port]++;
+  }
+}
+
+/**
+ * Keep a packet for the callback of its port until the link has delivered
+ * the packets it holds, applying the overflow policy of the port. The backlog
+ * gets its own reference.
+ */
+static void deferCallback(CRTPPacket *p)
+{
+  CRTPPacket* removed;
+
+  refPacket(p);
+
+  switch (crtpRxBacklogAdd(&rxBacklog, p, overflowPolicies[p->port], &removed))
+  {
+    case CRTP_RX_BACKLOG_COALESCED:
+      rxStats.coalescedCount++;
+      crtpReleasePacket(removed);
+      break;
+    case CRTP_RX_BACKLOG_DROPPED:
+      rxStats.overflowCount[removed->port]++;
+      crtpReleasePacket(removed);
+      break;
+    case CRTP_RX_BACKLOG_FULL:
+      callbacks[removed->port](removed);
+      crtpReleasePacket(removed);
+      break;
+    default:
+      break;
+  }
+}
+
+static void dispatchBacklog(void)
+{
+  CRTPPacket* p;
+
+  while ((p = crtpRxBacklogTake(&rxBacklog)) != NULL)
+  {
+    callbacks[p->port](p);
+    crtpReleasePacket(p);
+  }
+}
+
+static bool isPacketWaiting(void)
+{
+  return link->isPacketWaiting && link->isPacketWaiting();
+}
+
 void crtpRxTask(void *param)
 {
-  CRTPPacket p;
+  // Used to receive when the pool is empty, packets in it are only passed to
+  // the callbacks
+  static CRTPPacket fallback;
+  CRTPPacket *p = NULL;
+  int deferredCount = 0;
 
   while (true)
   {
     if (link != &nopLink)
     {
-      if (!link->receivePacket(&p))
+      if (p == NULL)
+      {
+        p = allocPacket();
+      }
+      CRTPPacket *received = p ? p : &fallback;
+
+      if (!link->receivePacket(received))
       {
-        if (queues[p.port])
+        const CRTPPort port = received->port;
+        xQueueHandle queue = queues[port];
+        if (queue)
         {
-          if (xQueueSend(queues[p.port], &p, 0) == errQUEUE_FULL)
+          if (p)
+          {
+            queuePacket(queue, p);
+          }
+          else
+          {
+            rxStats.poolEmptyCount++;
+          }
+        }
+
+        if (callbacks[port])
+        {
+          if (p && overflowPolicies[port] != CRTP_OVERFLOW_DROP_NEW)
+          {
+            deferCallback(p);
+            deferredCount++;
+          }
+          else
           {
-            // We should never drop packet
-            ASSERT(0);
+            callbacks[port](received);
           }
         }
 
-        if (callbacks[p.port])
+        // Release the reference of this task, the buffer stays with the
+        // queue if it was queued
+        if (p)
         {
-          callbacks[p.port](&p);
+          crtpReleasePacket(p);
+          p = NULL;
         }
 
         stats.rxCount++;
         updateStats();
       }
+
+      // Deferred packets are handled when the link has nothing more to
+      // deliver, or after a backlog worth of them so that a long burst does
+      // not hold them back
+      if (deferredCount > 0 && (!isPacketWaiting() || deferredCount >= CRTP_RX_BACKLOG_SIZE))
+      {
+        dispatchBacklog();
+        deferredCount = 0;
+      }
     }
     else
     {
@@ -210,25 +510,68 @@ void crtpRegisterPortCB(int port, CrtpCallback cb)
   callbacks[port] = cb;
 }
 
-int crtpSendPacket(CRTPPacket *p)
+static int sendPacket(CRTPPacket *p, TickType_t wait)
 {
   ASSERT(p);
   ASSERT(p->size <= CRTP_MAX_DATA_SIZE);
 
-  return xQueueSend(txQueue, p, 0);
+  const crtpTxClass_t txClass = crtpTxSchedulerClassOf(p->port);
+
+  if (txFree[txClass] && xSemaphoreTake(txFree[txClass], wait) == pdFALSE)
+  {
+    taskENTER_CRITICAL();
+    txScheduler.classes[txClass].dropCount++;
+#ifdef DEBUG_QUEUE_MONITOR
+    if (txQueueStats[txClass])
+    {
+      qmStatsOnSendFailed(txQueueStats[txClass]);
+    }
+#endif
+    taskEXIT_CRITICAL();
+    return errQUEUE_FULL;
+  }
+
+  taskENTER_CRITICAL();
+  crtpTxSchedulerPush(&txScheduler, txClass, p, T2M(xTaskGetTickCount()));
+#ifdef DEBUG_QUEUE_MONITOR
+  if (txQueueStats[txClass])
+  {
+    // Passing the number of packets before this one makes the statistics
+    // forget the oldest packet when a full telemetry queue dropped it
+    const uint32_t waiting = txScheduler.classes[txClass].count - 1;
+    qmStatsOnSend(txQueueStats[txClass], (uint32_t)usecTimestamp(), waiting);
+  }
+#endif
+  taskEXIT_CRITICAL();
+
+  xSemaphoreGive(txPacketQueued);
+
+  return pdTRUE;
 }
 
-int crtpSendPacketBlock(CRTPPacket *p)
+int crtpSendPacket(CRTPPacket *p)
 {
-  ASSERT(p);
-  ASSERT(p->size <= CRTP_MAX_DATA_SIZE);
+  return sendPacket(p, 0);
+}
 
-  return xQueueSend(txQueue, p, portMAX_DELAY);
+int crtpSendPacketBlock(CRTPPacket *p)
+{
+  return sendPacket(p, portMAX_DELAY);
 }
 
 int crtpReset(void)
 {
-  xQueueReset(txQueue);
+  for (int i = 0; i < CRTP_TX_CLASS_COUNT; i++)
+  {
+    taskENTER_CRITICAL();
+    const int flushed = crtpTxSchedulerFlush(&txScheduler, i);
+    taskEXIT_CRITICAL();
+
+    for (int j = 0; txFree[i] && j < flushed; j++)
+    {
+      xSemaphoreGive(txFree[i]);
+    }
+  }
   if (link->reset) {
     link->reset();
   }
@@ -254,6 +597,12 @@ void crtpSetLink(struct crtpLinkOperations * lk)
     link = &nopLink;
 
   link->setEnable(true);
+
+  // Wake up the TX task, it waits for a link before sending queued packets
+  if (txPacketQueued)
+  {
+    xSemaphoreGive(txPacketQueued);
+  }
 }
 
 static int nopFunc(void)
@@ -275,6 +624,14 @@ static void updateStats()
     stats.rxRate = (uint16_t)(1000.0f * stats.rxCount / interval);
     stats.txRate = (uint16_t)(1000.0f * stats.txCount / interval);
 
+    for (int i = 0; i < CRTP_TX_CLASS_COUNT; i++)
+    {
+      taskENTER_CRITICAL();
+      stats.txLatency[i] = txScheduler.classes[i].maxLatency;
+      txScheduler.classes[i].maxLatency = 0;
+      taskEXIT_CRITICAL();
+    }
+
     clearStats();
     stats.previousStatisticsTime = now;
     stats.nextStatisticsTime = now + STATS_INTERVAL;
@@ -285,3 +642,34 @@ LOG_GROUP_START(crtp)
 LOG_ADD(LOG_UINT16, rxRate, &stats.rxRate)
 LOG_ADD(LOG_UINT16, txRate, &stats.txRate)
 LOG_GROUP_STOP(tdoa)
+
+/**
+ * Outgoing traffic per class, see crtp_tx_scheduler.h. Drops are packets
+ * rejected or replaced because the queue of the class was full, latency is
+ * the max time (ms) in the queue during the last statistics interval.
+ */
+LOG_GROUP_START(crtpTx)
+LOG_ADD(LOG_UINT32, ctrlDrop, &txScheduler.classes[CRTP_TX_CLASS_CONTROL].dropCount)
+LOG_ADD(LOG_UINT32, paramDrop, &txScheduler.classes[CRTP_TX_CLASS_PARAM_MEM].dropCount)
+LOG_ADD(LOG_UINT32, consDrop, &txScheduler.classes[CRTP_TX_CLASS_CONSOLE].dropCount)
+LOG_ADD(LOG_UINT32, logDrop, &txScheduler.classes[CRTP_TX_CLASS_TELEMETRY].dropCount)
+LOG_ADD(LOG_UINT16, ctrlLat, &stats.txLatency[CRTP_TX_CLASS_CONTROL])
+LOG_ADD(LOG_UINT16, paramLat, &stats.txLatency[CRTP_TX_CLASS_PARAM_MEM])
+LOG_ADD(LOG_UINT16, consLat, &stats.txLatency[CRTP_TX_CLASS_CONSOLE])
+LOG_ADD(LOG_UINT16, logLat, &stats.txLatency[CRTP_TX_CLASS_TELEMETRY])
+LOG_ADD(LOG_FLOAT, logLatAvg, &txScheduler.classes[CRTP_TX_CLASS_TELEMETRY].averageLatency)
+LOG_GROUP_STOP(crtpTx)
+
+/**
+ * Incoming packets, see crtp_packet_pool.h
+ */
+LOG_GROUP_START(crtpRx)
+LOG_ADD(LOG_UINT8, poolMinFree, &rxPool.minFreeCount)
+LOG_ADD(LOG_UINT32, poolEmpty, &rxStats.poolEmptyCount)
+LOG_ADD(LOG_UINT32, coalesced, &rxStats.coalescedCount)
+LOG_ADD(LOG_UINT32, hlDrop, &rxStats.overflowCount[CRTP_PORT_SETPOINT_HL])
+LOG_ADD(LOG_UINT32, locDrop, &rxStats.overflowCount[CRTP_PORT_LOCALIZATION])
+LOG_ADD(LOG_UINT32, paramDrop, &rxStats.overflowCount[CRTP_PORT_PARAM])
+LOG_ADD(LOG_UINT32, memDrop, &rxStats.overflowCount[CRTP_PORT_MEM])
+LOG_ADD(LOG_UINT32, logDrop, &rxStats.overflowCount[CRTP_PORT_LOG])
+LOG_GROUP_STOP(crtpRx)
@@ -277,6 +277,11 @@ bool crtpCommanderHighLevelIsStopped()
   return plan_is_stopped(&planner);
 }
 
+bool crtpCommanderHighLevelIsInGroup(uint8_t groupMask)
+{
+  return isInGroup(groupMask);
+}
+
 void crtpCommanderHighLevelTellState(const state_t *state)
 {
   xSemaphoreTake(lockTraj, portMAX_DELAY);
@@ -382,18 +387,18 @@ static int handleCommand(const enum TrajectoryCommand_e command, const uint8_t*
 
 void crtpCommanderHighLevelTask(void * prm)
 {
-  CRTPPacket p;
   crtpInitTaskQueue(CRTP_PORT_SETPOINT_HL);
 
   while(1) {
-    crtpReceivePacketBlock(CRTP_PORT_SETPOINT_HL, &p);
+    CRTPPacket* p = crtpReceivePacketRefBlock(CRTP_PORT_SETPOINT_HL);
 
-    int ret = handleCommand(p.data[0], &p.data[1]);
+    int ret = handleCommand(p->data[0], &p->data[1]);
 
     //answer
-    p.data[3] = ret;
-    p.size = 4;
-    crtpSendPacket(&p);
+    p->data[3] = ret;
+    p->size = 4;
+    crtpSendPacket(p);
+    crtpReleasePacket(p);
   }
 }
 
@@ -48,6 +48,7 @@
 #include "peer_localization.h"
 
 #include "num.h"
+#include "usec_time.h"
 
 #define NBR_OF_RANGES_IN_PACKET   5
 #define NBR_OF_SWEEPS_IN_PACKET   2
@@ -161,6 +162,7 @@ static void extPositionHandler(CRTPPacket* pk) {
   ext_pos.y = data->y;
   ext_pos.z = data->z;
   ext_pos.stdDev = extPosStdDev;
+  ext_pos.timestampUs = usecTimestamp();
 
   estimatorEnqueuePosition(&ext_pos);
   tickOfLastPacket = xTaskGetTickCount();
@@ -178,12 +180,14 @@ static void extPoseHandler(const CRTPPacket* pk) {
   ext_pose.quat.w = data->qw;
   ext_pose.stdDevPos = extPosStdDev;
   ext_pose.stdDevQuat = extQuatStdDev;
+  ext_pose.timestampUs = usecTimestamp();
 
   estimatorEnqueuePose(&ext_pose);
   tickOfLastPacket = xTaskGetTickCount();
 }
 
 static void extPosePackedHandler(const CRTPPacket* pk) {
+  const uint64_t arrival = usecTimestamp();
   uint8_t numItems = (pk->size - 1) / sizeof(extPosePackedItem);
   for (uint8_t i = 0; i < numItems; ++i) {
     const extPosePackedItem* item = (const extPosePackedItem*)&pk->data[1 + i * sizeof(extPosePackedItem)];
@@ -194,6 +198,7 @@ static void extPosePackedHandler(const CRTPPacket* pk) {
       quatdecompress(item->quat, (float *)&ext_pose.quat.q0);
       ext_pose.stdDevPos = extPosStdDev;
       ext_pose.stdDevQuat = extQuatStdDev;
+      ext_pose.timestampUs = arrival;
       estimatorEnqueuePose(&ext_pose);
       tickOfLastPacket = xTaskGetTickCount();
     } else {
@@ -201,6 +206,7 @@ static void extPosePackedHandler(const CRTPPacket* pk) {
       ext_pos.y = item->y / 1000.0f;
       ext_pos.z = item->z / 1000.0f;
       ext_pos.stdDev = extPosStdDev;
+      ext_pos.timestampUs = arrival;
       peerLocalizationTellPosition(item->id, &ext_pos);
     }
   }
@@ -293,6 +299,7 @@ static void genericLocHandle(CRTPPacket* pk)
 
 static void extPositionPackedHandler(CRTPPacket* pk)
 {
+  const uint64_t arrival = usecTimestamp();
   uint8_t numItems = pk->size / sizeof(extPositionPackedItem);
   for (uint8_t i = 0; i < numItems; ++i) {
     const extPositionPackedItem* item = (const extPositionPackedItem*)&pk->data[i * sizeof(extPositionPackedItem)];
@@ -300,6 +307,7 @@ static void extPositionPackedHandler(CRTPPacket* pk)
     ext_pos.y = item->y / 1000.0f;
     ext_pos.z = item->z / 1000.0f;
     ext_pos.stdDev = extPosStdDev;
+    ext_pos.timestampUs = arrival;
     if (item->id == my_id) {
       estimatorEnqueuePosition(&ext_pos);
       tickOfLastPacket = xTaskGetTickCount();
@@ -0,0 +1,91 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * crtp_packet_pool.c - Pool of reference counted CRTP packet buffers
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "crtp_packet_pool.h"
+#include "cfassert.h"
+
+void crtpPacketPoolInit(crtpPacketPool_t* this)
+{
+  memset(this, 0, sizeof(crtpPacketPool_t));
+
+  for (int i = 0; i < CRTP_PACKET_POOL_SIZE; i++) {
+    this->freeList[i] = i;
+  }
+  this->freeCount = CRTP_PACKET_POOL_SIZE;
+  this->minFreeCount = CRTP_PACKET_POOL_SIZE;
+}
+
+bool crtpPacketPoolContains(const crtpPacketPool_t* this, const CRTPPacket* p)
+{
+  return p >= &this->packets[0] && p < &this->packets[CRTP_PACKET_POOL_SIZE];
+}
+
+static int indexOf(const crtpPacketPool_t* this, const CRTPPacket* p)
+{
+  ASSERT(crtpPacketPoolContains(this, p));
+  return p - this->packets;
+}
+
+CRTPPacket* crtpPacketPoolAlloc(crtpPacketPool_t* this)
+{
+  if (this->freeCount == 0) {
+    this->allocFailCount++;
+    return NULL;
+  }
+
+  this->freeCount--;
+  if (this->freeCount < this->minFreeCount) {
+    this->minFreeCount = this->freeCount;
+  }
+
+  const int index = this->freeList[this->freeCount];
+  this->refCount[index] = 1;
+
+  return &this->packets[index];
+}
+
+void crtpPacketPoolRef(crtpPacketPool_t* this, CRTPPacket* p)
+{
+  const int index = indexOf(this, p);
+  ASSERT(this->refCount[index] > 0 && this->refCount[index] < UINT8_MAX);
+
+  this->refCount[index]++;
+}
+
+void crtpPacketPoolRelease(crtpPacketPool_t* this, CRTPPacket* p)
+{
+  const int index = indexOf(this, p);
+  ASSERT(this->refCount[index] > 0);
+
+  this->refCount[index]--;
+  if (this->refCount[index] == 0) {
+    this->freeList[this->freeCount] = index;
+    this->freeCount++;
+  }
+}
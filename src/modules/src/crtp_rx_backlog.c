@@ -0,0 +1,118 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * crtp_rx_backlog.c - Received packets waiting to be passed to a port callback
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "crtp_rx_backlog.h"
+
+void crtpRxBacklogInit(crtpRxBacklog_t* this)
+{
+  memset(this, 0, sizeof(crtpRxBacklog_t));
+}
+
+static CRTPPacket* removeAt(crtpRxBacklog_t* this, const int index)
+{
+  CRTPPacket* p = this->packets[index];
+
+  this->count--;
+  memmove(&this->packets[index], &this->packets[index + 1], (this->count - index) * sizeof(CRTPPacket*));
+
+  return p;
+}
+
+static int findCoalesced(const crtpRxBacklog_t* this, const CRTPPacket* p)
+{
+  for (int i = 0; i < this->count; i++) {
+    if (this->packets[i]->port == p->port && this->packets[i]->channel == p->channel) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+static int findDropped(const crtpRxBacklog_t* this, const CRTPPacket* p)
+{
+  int oldest = -1;
+  int portCount = 0;
+
+  for (int i = 0; i < this->count; i++) {
+    if (this->packets[i]->port == p->port) {
+      if (oldest < 0) {
+        oldest = i;
+      }
+      portCount++;
+    }
+  }
+
+  return portCount >= CRTP_RX_BACKLOG_PORT_LIMIT ? oldest : -1;
+}
+
+crtpRxBacklogResult_t crtpRxBacklogAdd(crtpRxBacklog_t* this, CRTPPacket* p, const CRTPOverflowPolicy policy, CRTPPacket** removed)
+{
+  crtpRxBacklogResult_t result = CRTP_RX_BACKLOG_ADDED;
+  *removed = NULL;
+
+  int index = -1;
+  switch (policy) {
+    case CRTP_OVERFLOW_COALESCE_LATEST:
+      index = findCoalesced(this, p);
+      result = CRTP_RX_BACKLOG_COALESCED;
+      break;
+    case CRTP_OVERFLOW_DROP_OLDEST:
+      index = findDropped(this, p);
+      result = CRTP_RX_BACKLOG_DROPPED;
+      break;
+    default:
+      break;
+  }
+
+  if (index < 0 && this->count == CRTP_RX_BACKLOG_SIZE) {
+    index = 0;
+    result = CRTP_RX_BACKLOG_FULL;
+  }
+
+  if (index >= 0) {
+    *removed = removeAt(this, index);
+  } else {
+    result = CRTP_RX_BACKLOG_ADDED;
+  }
+
+  this->packets[this->count] = p;
+  this->count++;
+
+  return result;
+}
+
+CRTPPacket* crtpRxBacklogTake(crtpRxBacklog_t* this)
+{
+  if (this->count == 0) {
+    return NULL;
+  }
+
+  return removeAt(this, 0);
+}
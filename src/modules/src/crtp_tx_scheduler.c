@@ -0,0 +1,166 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * crtp_tx_scheduler.c - Traffic classes and scheduling of outgoing CRTP packets
+ */
+
+#include <string.h>
+
+#include "crtp_tx_scheduler.h"
+#include "cfassert.h"
+
+// Weight of the latest packet in the average latency
+#define LATENCY_AVERAGE_WEIGHT 0.05f
+
+void crtpTxSchedulerInit(crtpTxScheduler_t* this, const crtpTxClassConfig_t config[CRTP_TX_CLASS_COUNT])
+{
+  memset(this, 0, sizeof(crtpTxScheduler_t));
+
+  uint16_t first = 0;
+  for (int i = 0; i < CRTP_TX_CLASS_COUNT; i++) {
+    crtpTxClassQueue_t* queue = &this->classes[i];
+    queue->first = first;
+    queue->depth = config[i].depth;
+    queue->weight = config[i].weight;
+    queue->dropOldest = config[i].dropOldest;
+    queue->credit = queue->weight;
+
+    first += queue->depth;
+  }
+
+  ASSERT(first <= CRTP_TX_SCHEDULER_SIZE);
+}
+
+crtpTxClass_t crtpTxSchedulerClassOf(const CRTPPort port)
+{
+  switch (port) {
+    case CRTP_PORT_CONSOLE:
+    case CRTP_PORT_TRACE:
+      return CRTP_TX_CLASS_CONSOLE;
+    case CRTP_PORT_LOG:
+      return CRTP_TX_CLASS_TELEMETRY;
+    case CRTP_PORT_LINK:
+    case CRTP_PORT_PLATFORM:
+    case CRTP_PORT_SETPOINT:
+    case CRTP_PORT_SETPOINT_GENERIC:
+    case CRTP_PORT_SETPOINT_HL:
+    case CRTP_PORT_LOCALIZATION:
+      return CRTP_TX_CLASS_CONTROL;
+    default:
+      // Param, mem and any other port, never dropped
+      return CRTP_TX_CLASS_PARAM_MEM;
+  }
+}
+
+bool crtpTxSchedulerPush(crtpTxScheduler_t* this, const crtpTxClass_t txClass, const CRTPPacket* p, const uint32_t now_ms)
+{
+  crtpTxClassQueue_t* queue = &this->classes[txClass];
+
+  if (queue->count >= queue->depth) {
+    queue->dropCount++;
+    if (!queue->dropOldest || queue->depth == 0) {
+      return false;
+    }
+
+    queue->head = (queue->head + 1) % queue->depth;
+    queue->count--;
+  }
+
+  const int index = queue->first + (queue->head + queue->count) % queue->depth;
+  this->packets[index] = *p;
+  this->timestamps[index] = now_ms;
+  queue->count++;
+
+  return true;
+}
+
+static int selectClass(crtpTxScheduler_t* this)
+{
+  for (int i = 0; i < CRTP_TX_CLASS_COUNT; i++) {
+    if (this->classes[i].weight == 0 && this->classes[i].count > 0) {
+      return i;
+    }
+  }
+
+  // Weighted classes, new credits are given when no class with packets has
+  // any left
+  for (int round = 0; round < 2; round++) {
+    for (int i = 0; i < CRTP_TX_CLASS_COUNT; i++) {
+      const crtpTxClassQueue_t* queue = &this->classes[i];
+      if (queue->weight > 0 && queue->count > 0 && queue->credit > 0) {
+        return i;
+      }
+    }
+
+    for (int i = 0; i < CRTP_TX_CLASS_COUNT; i++) {
+      this->classes[i].credit = this->classes[i].weight;
+    }
+  }
+
+  return -1;
+}
+
+bool crtpTxSchedulerPop(crtpTxScheduler_t* this, CRTPPacket* p, crtpTxClass_t* txClass, const uint32_t now_ms)
+{
+  const int selected = selectClass(this);
+  if (selected < 0) {
+    return false;
+  }
+
+  crtpTxClassQueue_t* queue = &this->classes[selected];
+  const int index = queue->first + queue->head;
+  *p = this->packets[index];
+  *txClass = (crtpTxClass_t)selected;
+
+  queue->head = (queue->head + 1) % queue->depth;
+  queue->count--;
+  if (queue->credit > 0) {
+    queue->credit--;
+  }
+
+  const uint32_t latency = now_ms - this->timestamps[index];
+  if (latency > queue->maxLatency) {
+    queue->maxLatency = latency < UINT16_MAX ? latency : UINT16_MAX;
+  }
+  queue->averageLatency += LATENCY_AVERAGE_WEIGHT * (latency - queue->averageLatency);
+  queue->sentCount++;
+
+  return true;
+}
+
+int crtpTxSchedulerFree(const crtpTxScheduler_t* this, const crtpTxClass_t txClass)
+{
+  return this->classes[txClass].depth - this->classes[txClass].count;
+}
+
+int crtpTxSchedulerFlush(crtpTxScheduler_t* this, const crtpTxClass_t txClass)
+{
+  crtpTxClassQueue_t* queue = &this->classes[txClass];
+  const int count = queue->count;
+
+  queue->head = 0;
+  queue->count = 0;
+  queue->credit = queue->weight;
+
+  return count;
+}
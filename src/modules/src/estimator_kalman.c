@@ -65,7 +65,9 @@
 #include "task.h"
 #include "semphr.h"
 #include "sensors.h"
+#include "usec_time.h"
 #include "static_mem.h"
+#include "queuemonitor.h"
 
 #include "system.h"
 #include "log.h"
@@ -275,6 +277,16 @@ void estimatorKalmanTaskInit() {
   yawErrorDataQueue = STATIC_MEM_QUEUE_CREATE(yawErrorDataQueue);
   sweepAnglesDataQueue = STATIC_MEM_QUEUE_CREATE(sweepAnglesDataQueue);
 
+  DEBUG_QUEUE_MONITOR_REGISTER(distDataQueue);
+  DEBUG_QUEUE_MONITOR_REGISTER(posDataQueue);
+  DEBUG_QUEUE_MONITOR_REGISTER(poseDataQueue);
+  DEBUG_QUEUE_MONITOR_REGISTER(tdoaDataQueue);
+  DEBUG_QUEUE_MONITOR_REGISTER(flowDataQueue);
+  DEBUG_QUEUE_MONITOR_REGISTER(tofDataQueue);
+  DEBUG_QUEUE_MONITOR_REGISTER(heightDataQueue);
+  DEBUG_QUEUE_MONITOR_REGISTER(yawErrorDataQueue);
+  DEBUG_QUEUE_MONITOR_REGISTER(sweepAnglesDataQueue);
+
   vSemaphoreCreateBinary(runTaskSemaphore);
 
   dataMutex = xSemaphoreCreateMutexStatic(&dataMutexBuffer);
@@ -291,9 +303,9 @@ bool estimatorKalmanTaskTest() {
 static void kalmanTask(void* parameters) {
   systemWaitStart();
 
-  uint32_t lastPrediction = xTaskGetTickCount();
+  uint64_t lastPredictionUs = usecTimestamp();
   uint32_t nextPrediction = xTaskGetTickCount();
-  uint32_t lastPNUpdate = xTaskGetTickCount();
+  uint64_t lastPNUpdateUs = usecTimestamp();
   uint32_t nextBaroUpdate = xTaskGetTickCount();
 
   rateSupervisorInit(&rateSupervisorContext, xTaskGetTickCount(), M2T(1000), 99, 101, 1);
@@ -310,7 +322,10 @@ static void kalmanTask(void* parameters) {
     // Tracks whether an update to the state has been made, and the state therefore requires finalization
     bool doneUpdate = false;
 
-    uint32_t osTick = xTaskGetTickCount(); // would be nice if this had a precision higher than 1ms...
+    uint32_t osTick = xTaskGetTickCount();
+    // The tick only has 1 ms resolution, integrate with the microsecond timer
+    // that measurements are also stamped with
+    uint64_t nowUs = usecTimestamp();
 
   #ifdef KALMAN_DECOUPLE_XY
     kalmanCoreDecoupleXY(&coreData);
@@ -318,9 +333,9 @@ static void kalmanTask(void* parameters) {
 
     // Run the system dynamics to predict the state forward.
     if (osTick >= nextPrediction) { // update at the PREDICT_RATE
-      float dt = T2S(osTick - lastPrediction);
+      float dt = (nowUs - lastPredictionUs) / 1e6f;
       if (predictStateForward(osTick, dt)) {
-        lastPrediction = osTick;
+        lastPredictionUs = nowUs;
         doneUpdate = true;
         STATS_CNT_RATE_EVENT(&predictionCounter);
       }
@@ -336,10 +351,10 @@ static void kalmanTask(void* parameters) {
      * Add process noise every loop, rather than every prediction
      */
     {
-      float dt = T2S(osTick - lastPNUpdate);
+      float dt = (nowUs - lastPNUpdateUs) / 1e6f;
       if (dt > 0.0f) {
         kalmanCoreAddProcessNoise(&coreData, dt);
-        lastPNUpdate = osTick;
+        lastPNUpdateUs = nowUs;
       }
     }
 
@@ -426,7 +441,11 @@ void estimatorKalman(state_t *state, sensorData_t *sensors, control_t *control,
     accAccumulatorCount++;
   }
 
-  if (sensorsReadGyro(&sensors->gyro)) {
+  // All gyro samples since the last call are averaged, the sensor may sample
+  // faster than this loop. The newest one is used by the controller.
+  imuSample_t gyroSample;
+  while (sensorsReadGyroSample(&gyroSample)) {
+    sensors->gyro = gyroSample.value;
     gyroAccumulator.x += sensors->gyro.x;
     gyroAccumulator.y += sensors->gyro.y;
     gyroAccumulator.z += sensors->gyro.z;
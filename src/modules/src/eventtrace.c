@@ -0,0 +1,226 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * eventtrace.c - Timeline of task switches, interrupts and user markers
+ */
+
+#include <string.h>
+
+#include "stm32fxxx.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "eventtrace.h"
+#include "trace_ring.h"
+#include "mem.h"
+#include "system.h"
+#include "log.h"
+#include "param.h"
+#include "static_mem.h"
+#include "config.h"
+
+#ifdef EVENT_TRACE_ON_SEGGER_RTT
+#include "SEGGER_RTT.h"
+#endif
+
+// Size of the ring in 32 bit words, a power of 2. Most events use 2 words.
+#ifndef EVENT_TRACE_BUFFER_SIZE
+#define EVENT_TRACE_BUFFER_SIZE 4096
+#endif
+
+#define EVENT_TRACE_TASK_NAME_WORDS 4
+#define EVENT_TRACE_MAX_TASKS 32
+
+#define EVENT_TRACE_RTT_BUFFER_INDEX 2
+#define EVENT_TRACE_RTT_BUFFER_SIZE 4096
+
+#define EVENT_TRACE_CONTROL_PERIOD_MS 10
+
+static bool isInit = false;
+
+static uint32_t ringBuffer[EVENT_TRACE_BUFFER_SIZE];
+static traceRing_t ring = TRACE_RING_INIT(ringBuffer, EVENT_TRACE_BUFFER_SIZE);
+
+static uint8_t enable = 0;
+static bool isRecording = false;
+
+// Statistics
+static uint32_t eventCount;
+static uint32_t dropCount;
+
+#ifdef EVENT_TRACE_ON_SEGGER_RTT
+static char rttBuffer[EVENT_TRACE_RTT_BUFFER_SIZE];
+static uint32_t drainBuffer[256];
+#endif
+
+static TaskStatus_t taskStatus[EVENT_TRACE_MAX_TASKS];
+
+// Handling from the memory module
+static uint32_t handleMemGetSize(void);
+static bool handleMemRead(const uint32_t memAddr, const uint8_t readLen, uint8_t* buffer);
+static const MemoryHandlerDef_t memDef = {
+  .type = MEM_TYPE_EVENT_TRACE,
+  .getSize = handleMemGetSize,
+  .read = handleMemRead,
+  .write = 0, // Write not supported
+};
+
+STATIC_MEM_TASK_ALLOC(eventTraceTask, EVENT_TRACE_TASK_STACKSIZE);
+
+static void eventTraceTask(void *param);
+
+void eventTraceInit()
+{
+  if (isInit) {
+    return;
+  }
+
+  // Enable the cycle counter
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+#ifdef EVENT_TRACE_ON_SEGGER_RTT
+  SEGGER_RTT_ConfigUpBuffer(EVENT_TRACE_RTT_BUFFER_INDEX, "events", rttBuffer, sizeof(rttBuffer), SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+#endif
+
+  memoryRegisterHandler(&memDef);
+
+  STATIC_MEM_TASK_CREATE(eventTraceTask, eventTraceTask, EVENT_TRACE_TASK_NAME, NULL, EVENT_TRACE_TASK_PRI);
+
+  isInit = true;
+}
+
+bool eventTraceTest()
+{
+  return isInit;
+}
+
+static void writeRecord(const eventTraceType_t type, const uint32_t id, const uint32_t* extra, const uint32_t extraLength)
+{
+  uint32_t words[1 + EVENT_TRACE_TASK_NAME_WORDS];
+
+  words[0] = DWT->CYCCNT;
+  if (extraLength > 0) {
+    memcpy(&words[1], extra, extraLength * sizeof(uint32_t));
+  }
+
+  const uint32_t tag = ((uint32_t)type << EVENT_TRACE_TYPE_SHIFT) | (id & EVENT_TRACE_ID_MASK);
+  if (traceRingWrite(&ring, tag, words, 1 + extraLength)) {
+    __atomic_fetch_add(&eventCount, 1, __ATOMIC_RELAXED);
+  }
+}
+
+void eventTraceWrite(const eventTraceType_t type, const uint32_t id)
+{
+  if (isRecording) {
+    writeRecord(type, id, 0, 0);
+  }
+}
+
+// The names of the tasks that already exist, so that the host knows them
+// even if they are not created while recording
+static void writeTaskNames()
+{
+  const UBaseType_t taskCount = uxTaskGetSystemState(taskStatus, EVENT_TRACE_MAX_TASKS, NULL);
+  for (UBaseType_t i = 0; i < taskCount; i++) {
+    uint32_t name[EVENT_TRACE_TASK_NAME_WORDS] = {0};
+    strncpy((char*)name, taskStatus[i].pcTaskName, sizeof(name) - 1);
+    writeRecord(eventTraceTaskName, taskStatus[i].xTaskNumber, name, EVENT_TRACE_TASK_NAME_WORDS);
+  }
+}
+
+static void startRecording()
+{
+  taskENTER_CRITICAL();
+  memset(ringBuffer, 0, sizeof(ringBuffer));
+  ring.head = 0;
+  ring.tail = 0;
+  ring.dropCount = 0;
+  eventCount = 0;
+  isRecording = true;
+  taskEXIT_CRITICAL();
+
+  const uint32_t frequency = SystemCoreClock;
+  writeRecord(eventTraceStart, 0, &frequency, 1);
+  writeTaskNames();
+}
+
+static void eventTraceTask(void *param)
+{
+  systemWaitStart();
+
+  uint32_t lastWakeTime = xTaskGetTickCount();
+
+  while (true) {
+    vTaskDelayUntil(&lastWakeTime, M2T(EVENT_TRACE_CONTROL_PERIOD_MS));
+
+    if (enable && !isRecording) {
+      startRecording();
+    } else if (!enable && isRecording) {
+      isRecording = false;
+    }
+
+#ifdef EVENT_TRACE_ON_SEGGER_RTT
+    uint32_t wordCount;
+    while ((wordCount = traceRingRead(&ring, drainBuffer, sizeof(drainBuffer) / sizeof(drainBuffer[0]))) > 0) {
+      SEGGER_RTT_Write(EVENT_TRACE_RTT_BUFFER_INDEX, drainBuffer, wordCount * sizeof(uint32_t));
+    }
+#endif
+
+    dropCount = ring.dropCount;
+  }
+}
+
+// The recording can be read when it is stopped. The ring is not read in this
+// mode, so the records are in order from the start of the buffer.
+static uint32_t handleMemGetSize(void)
+{
+#ifdef EVENT_TRACE_ON_SEGGER_RTT
+  return 0;
+#else
+  if (isRecording) {
+    return 0;
+  }
+  return ring.head * sizeof(uint32_t);
+#endif
+}
+
+static bool handleMemRead(const uint32_t memAddr, const uint8_t readLen, uint8_t* buffer)
+{
+  if (memAddr + readLen > handleMemGetSize()) {
+    return false;
+  }
+
+  memcpy(buffer, (const uint8_t*)ringBuffer + memAddr, readLen);
+  return true;
+}
+
+PARAM_GROUP_START(eventTrace)
+PARAM_ADD(PARAM_UINT8, enable, &enable)         // Record events, set to 0 to stop and read the recording, setting it again starts a new one
+PARAM_GROUP_STOP(eventTrace)
+
+LOG_GROUP_START(eventTrace)
+LOG_ADD(LOG_UINT32, events, &eventCount)        // Number of recorded events
+LOG_ADD(LOG_UINT32, dropped, &dropCount)        // Number of events dropped because the buffer was full
+LOG_GROUP_STOP(eventTrace)
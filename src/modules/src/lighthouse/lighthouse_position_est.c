@@ -35,6 +35,7 @@
 #include "param.h"
 #include "statsCnt.h"
 #include "mem.h"
+#include "usec_time.h"
 
 #include "lighthouse_position_est.h"
 #include "lighthouse_geometry.h"
@@ -199,6 +200,7 @@ static float deltaLog;
 
 static void estimatePositionCrossingBeams(const pulseProcessor_t *state, pulseProcessorResult_t* angles, int baseStation) {
   memset(&ext_pos, 0, sizeof(ext_pos));
+  ext_pos.timestampUs = usecTimestamp();
   int sensorsUsed = 0;
   float delta;
 
@@ -235,6 +237,7 @@ static void estimatePositionCrossingBeams(const pulseProcessor_t *state, pulsePr
 static void estimatePositionSweepsLh1(const pulseProcessor_t* appState, pulseProcessorResult_t* angles, int baseStation) {
   const lighthouseCalibration_t* bsCalib = &appState->bsCalibration[baseStation];
   sweepAngleMeasurement_t sweepInfo;
+  sweepInfo.timestampUs = usecTimestamp();
   sweepInfo.stdDev = sweepStd;
   sweepInfo.rotorPos = &appState->bsGeometry[baseStation].origin;
   sweepInfo.t = 0;
@@ -273,6 +276,7 @@ static void estimatePositionSweepsLh1(const pulseProcessor_t* appState, pulsePro
 static void estimatePositionSweepsLh2(const pulseProcessor_t* appState, pulseProcessorResult_t* angles, int baseStation) {
   const lighthouseCalibration_t* bsCalib = &appState->bsCalibration[baseStation];
   sweepAngleMeasurement_t sweepInfo;
+  sweepInfo.timestampUs = usecTimestamp();
   sweepInfo.stdDev = sweepStdLh2;
   sweepInfo.rotorPos = &appState->bsGeometry[baseStation].origin;
   sweepInfo.rotorRot = &appState->bsGeometry[baseStation].mat;
@@ -384,7 +388,7 @@ static void estimateYaw(const pulseProcessor_t *state, pulseProcessorResult_t* a
   // Calculate yaw delta using only one base station for now
   float yawDelta;
   if (estimateYawDeltaOneBaseStation(baseStation, angles, state->bsGeometry, cfPos, n, &RR, &yawDelta)) {
-    yawErrorMeasurement_t yawDeltaMeasurement = {.yawError = yawDelta, .stdDev = 0.01};
+    yawErrorMeasurement_t yawDeltaMeasurement = {.yawError = yawDelta, .stdDev = 0.01, .timestampUs = usecTimestamp()};
     estimatorEnqueueYawError(&yawDeltaMeasurement);
   }
 }
@@ -131,6 +131,7 @@ struct ops_setting_v2 {
 #define CONTROL_RESET           5
 #define CONTROL_CREATE_BLOCK_V2 6
 #define CONTROL_APPEND_BLOCK_V2 7
+#define CONTROL_START_BLOCK_V2  8 // period in ms instead of 10 ms units
 
 #define BLOCK_ID_FREE -1
 
@@ -412,6 +413,13 @@ void logControlProcess()
                             (struct ops_setting_v2*)&p.data[2],
                             (p.size-2)/sizeof(struct ops_setting_v2) );
       break;
+    case CONTROL_START_BLOCK_V2:
+      if (p.size < 4) {
+        ret = EINVAL;
+        break;
+      }
+      ret = logStartBlock( p.data[1], p.data[2] | (p.data[3] << 8));
+      break;
   }
 
   //Commands answer
@@ -0,0 +1,139 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * motor_mixer.c - Allocation of thrust and torques to the motors
+ */
+
+#include "motor_mixer.h"
+
+const motorMixerMatrix_t motorMixerQuadX = {
+  .roll  = {-1.0f, -1.0f,  1.0f,  1.0f},
+  .pitch = { 1.0f, -1.0f, -1.0f,  1.0f},
+  .yaw   = { 1.0f, -1.0f,  1.0f, -1.0f},
+};
+
+const motorMixerMatrix_t motorMixerQuadNormal = {
+  .roll  = { 0.0f, -1.0f,  0.0f,  1.0f},
+  .pitch = { 1.0f,  0.0f, -1.0f,  0.0f},
+  .yaw   = { 1.0f, -1.0f,  1.0f, -1.0f},
+};
+
+static float clampf(const float value, const float min, const float max) {
+  if (value < min) {
+    return min;
+  }
+  if (value > max) {
+    return max;
+  }
+  return value;
+}
+
+uint8_t motorMixerMix(const motorMixerMatrix_t* matrix, const float thrust, const float roll, const float pitch,
+                      const float yaw, const float maxOutput, float output[MOTOR_MIXER_MOTOR_COUNT]) {
+  float rollPitch[MOTOR_MIXER_MOTOR_COUNT];
+  float yawPart[MOTOR_MIXER_MOTOR_COUNT];
+  uint8_t saturation = 0;
+
+  // No torque without thrust, the motors must be able to stop
+  if (thrust <= 0.0f) {
+    for (int i = 0; i < MOTOR_MIXER_MOTOR_COUNT; i++) {
+      output[i] = 0.0f;
+    }
+    return 0;
+  }
+
+  float rollPitchMin = 0.0f;
+  float rollPitchMax = 0.0f;
+  for (int i = 0; i < MOTOR_MIXER_MOTOR_COUNT; i++) {
+    rollPitch[i] = matrix->roll[i] * roll + matrix->pitch[i] * pitch;
+    yawPart[i] = matrix->yaw[i] * yaw;
+    if (i == 0 || rollPitch[i] < rollPitchMin) {
+      rollPitchMin = rollPitch[i];
+    }
+    if (i == 0 || rollPitch[i] > rollPitchMax) {
+      rollPitchMax = rollPitch[i];
+    }
+  }
+
+  // 1. Roll and pitch
+  const float rollPitchSpread = rollPitchMax - rollPitchMin;
+  if (rollPitchSpread > maxOutput) {
+    const float scale = maxOutput / rollPitchSpread;
+    for (int i = 0; i < MOTOR_MIXER_MOTOR_COUNT; i++) {
+      rollPitch[i] *= scale;
+    }
+    rollPitchMin *= scale;
+    rollPitchMax *= scale;
+    saturation |= MOTOR_MIXER_SAT_ROLL_PITCH;
+  }
+
+  // 2. Thrust, lowered to the highest value where roll, pitch and yaw all fit.
+  // It is never raised, a low thrust command must not make the motors spin up.
+  float thrustMax = maxOutput - rollPitchMax;
+  float fullMin = 0.0f;
+  float fullMax = 0.0f;
+  for (int i = 0; i < MOTOR_MIXER_MOTOR_COUNT; i++) {
+    const float torque = rollPitch[i] + yawPart[i];
+    if (i == 0 || torque < fullMin) {
+      fullMin = torque;
+    }
+    if (i == 0 || torque > fullMax) {
+      fullMax = torque;
+    }
+  }
+
+  if ((maxOutput - fullMax) >= -fullMin) {
+    thrustMax = maxOutput - fullMax;
+  }
+
+  float adjustedThrust = thrust;
+  if (thrust > thrustMax) {
+    adjustedThrust = clampf(thrustMax, 0.0f, thrust);
+    saturation |= MOTOR_MIXER_SAT_THRUST;
+  }
+
+  // 3. Yaw, largest part of the command that fits on all motors
+  float yawScale = 1.0f;
+  for (int i = 0; i < MOTOR_MIXER_MOTOR_COUNT; i++) {
+    const float base = adjustedThrust + rollPitch[i];
+    if (yawPart[i] > 0.0f && base + yawPart[i] > maxOutput) {
+      yawScale = clampf((maxOutput - base) / yawPart[i], 0.0f, yawScale);
+    } else if (yawPart[i] < 0.0f && base + yawPart[i] < 0.0f) {
+      yawScale = clampf(-base / yawPart[i], 0.0f, yawScale);
+    }
+  }
+
+  if (yawScale < 1.0f) {
+    saturation |= MOTOR_MIXER_SAT_YAW;
+  }
+
+  for (int i = 0; i < MOTOR_MIXER_MOTOR_COUNT; i++) {
+    const float value = adjustedThrust + rollPitch[i] + yawScale * yawPart[i];
+    if (value < 0.0f) {
+      saturation |= MOTOR_MIXER_SAT_CLIPPED;
+    }
+    output[i] = clampf(value, 0.0f, maxOutput);
+  }
+
+  return saturation;
+}
@@ -0,0 +1,101 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * motor_thrust_model.c - Thrust to PWM mapping of the motors
+ */
+
+#include <math.h>
+
+#include "motor_thrust_model.h"
+
+static float voltageScale(const motorThrustModel_t* this, const float batteryVoltage) {
+  if (batteryVoltage < MOTOR_THRUST_MODEL_MIN_VOLTAGE) {
+    return 1.0f;
+  }
+
+  return batteryVoltage / this->nominalVoltage;
+}
+
+// Analytic inverse of the model at nominal voltage, only used to build the table
+static float effectivePwm(const motorThrustModel_t* this, const float thrust) {
+  const float a = this->pwmToThrustA;
+  const float b = this->pwmToThrustB;
+
+  if (a == 0.0f) {
+    return thrust / b;
+  }
+
+  return (-b + sqrtf(b * b + 4.0f * a * thrust)) / (2.0f * a);
+}
+
+bool motorThrustModelInit(motorThrustModel_t* this, const float pwmToThrustA, const float pwmToThrustB, const float nominalVoltage) {
+  const float maxThrust = pwmToThrustA + pwmToThrustB;
+  // Also false for NaN
+  const bool isValid = isfinite(maxThrust) && maxThrust > 0.0f && isfinite(nominalVoltage) && nominalVoltage > 0.0f;
+  if (!isValid) {
+    return false;
+  }
+
+  this->pwmToThrustA = pwmToThrustA;
+  this->pwmToThrustB = pwmToThrustB;
+  this->nominalVoltage = nominalVoltage;
+  this->maxThrust = maxThrust;
+
+  const float step = this->maxThrust / (MOTOR_THRUST_MODEL_TABLE_SIZE - 1);
+  this->tableStepInv = 1.0f / step;
+
+  for (int i = 0; i < MOTOR_THRUST_MODEL_TABLE_SIZE; i++) {
+    this->pwmTable[i] = effectivePwm(this, i * step);
+  }
+
+  return true;
+}
+
+float motorThrustModelPwm(const motorThrustModel_t* this, const float thrust, const float batteryVoltage) {
+  if (thrust <= 0.0f) {
+    return 0.0f;
+  }
+
+  // Above the table, the last segment is extrapolated. It is only reached with
+  // a battery above the nominal voltage, otherwise the PWM saturates anyway.
+  const float position = thrust * this->tableStepInv;
+  int index = (int)position;
+  if (index > MOTOR_THRUST_MODEL_TABLE_SIZE - 2) {
+    index = MOTOR_THRUST_MODEL_TABLE_SIZE - 2;
+  }
+
+  const float fraction = position - index;
+  const float u = this->pwmTable[index] + fraction * (this->pwmTable[index + 1] - this->pwmTable[index]);
+
+  const float pwm = u / voltageScale(this, batteryVoltage);
+  if (pwm > 1.0f) {
+    return 1.0f;
+  }
+
+  return pwm;
+}
+
+float motorThrustModelThrust(const motorThrustModel_t* this, const float pwm, const float batteryVoltage) {
+  const float u = pwm * voltageScale(this, batteryVoltage);
+  return this->pwmToThrustA * u * u + this->pwmToThrustB * u;
+}
@@ -37,6 +37,9 @@
 #include "console.h"
 #include "debug.h"
 #include "static_mem.h"
+#include "param_bulk.h"
+#include "param_persistent.h"
+#include "param_broadcast.h"
 
 #if 0
 #define PARAM_DEBUG(fmt, ...) DEBUG_PRINT("D/param " fmt, ## __VA_ARGS__)
@@ -72,6 +75,12 @@ static const uint8_t typeLength[] = {
 
 #define MISC_SETBYNAME 0
 #define MISC_VALUE_UPDATED 1
+#define MISC_PERSISTENT_STORE 2
+#define MISC_PERSISTENT_CLEAR 3
+#define MISC_PERSISTENT_GET_ALL 4
+#define MISC_BULK_WRITE 5
+#define MISC_BULK_READ 6
+#define MISC_BROADCAST_SET 7
 
 //Private functions
 static void paramTask(void * prm);
@@ -87,6 +96,13 @@ static void paramWriteProcess();
 static void paramReadProcess();
 static int variableGetIndex(int id);
 static char paramWriteByNameProcess(char* group, char* name, int type, void *valptr);
+static void paramPersistentStoreProcess();
+static void paramPersistentClearProcess();
+static void paramPersistentGetAllProcess();
+static void paramBulkWriteProcess();
+static void paramBulkReadProcess();
+static void paramBroadcastProcess();
+static void paramBroadcastApplyDue();
 
 //Pointer to the parameters list and length of it
 static struct param_s * params;
@@ -99,6 +115,9 @@ static bool useV2 = false;
 
 static CRTPPacket p;
 
+// Pending broadcast parameter set, waiting for its activation time
+static paramBroadcast_t broadcast;
+
 static bool isInit = false;
 
 STATIC_MEM_TASK_ALLOC_STACK_NO_DMA_CCM_SAFE(paramTask, PARAM_TASK_STACKSIZE);
@@ -166,9 +185,22 @@ bool paramTest(void)
 void paramTask(void * prm)
 {
 	crtpInitTaskQueue(CRTP_PORT_PARAM);
+	paramBroadcastInit(&broadcast);
 
 	while(1) {
-		crtpReceivePacketBlock(CRTP_PORT_PARAM, &p);
+    const uint32_t timeToActivation = paramBroadcastTimeToActivation(&broadcast, T2M(xTaskGetTickCount()));
+    int received;
+    if (timeToActivation == UINT32_MAX) {
+      received = crtpReceivePacketBlock(CRTP_PORT_PARAM, &p);
+    } else {
+      received = crtpReceivePacketWait(CRTP_PORT_PARAM, &p, timeToActivation);
+    }
+
+    paramBroadcastApplyDue();
+
+    if (received != pdTRUE) {
+      continue;
+    }
 
 		if (p.channel==TOC_CH)
 		  paramTOCProcess(p.data[0]);
@@ -203,6 +235,18 @@ void paramTask(void * prm)
         p.data[1+strlen(group)+1+strlen(name)+1] = error;
         p.size = 1+strlen(group)+1+strlen(name)+1+1;
         crtpSendPacket(&p);
+      } else if (p.data[0] == MISC_PERSISTENT_STORE) {
+        paramPersistentStoreProcess();
+      } else if (p.data[0] == MISC_PERSISTENT_CLEAR) {
+        paramPersistentClearProcess();
+      } else if (p.data[0] == MISC_PERSISTENT_GET_ALL) {
+        paramPersistentGetAllProcess();
+      } else if (p.data[0] == MISC_BULK_WRITE) {
+        paramBulkWriteProcess();
+      } else if (p.data[0] == MISC_BULK_READ) {
+        paramBulkReadProcess();
+      } else if (p.data[0] == MISC_BROADCAST_SET) {
+        paramBroadcastProcess();
       }
     }
 	}
@@ -524,6 +568,275 @@ static void paramReadProcess()
   crtpSendPacket(&p);
 }
 
+static uint8_t paramValueSize(int ptr)
+{
+  return 1 << (params[ptr].type & PARAM_BYTES_MASK);
+}
+
+static const char* paramGroupOf(int ptr)
+{
+  const char* group = "";
+
+  for (int i = ptr; i >= 0; i--) {
+    if ((params[i].type & PARAM_GROUP) && (params[i].type & PARAM_START)) {
+      group = params[i].name;
+      break;
+    }
+  }
+
+  return group;
+}
+
+/* Fetch the stored value of a parameter. Returns true if a value of the right
+ * type is stored, the raw value is then copied to value */
+static bool paramFetchStored(int ptr, const char* group, void* value)
+{
+  return paramPersistentFetch(group, params[ptr].name, params[ptr].type, value, paramValueSize(ptr));
+}
+
+static void paramPersistentStoreProcess()
+{
+  uint16_t ident;
+  memcpy(&ident, &p.data[1], 2);
+  int id = variableGetIndex(ident);
+
+  p.size = 4;
+
+  if (id < 0) {
+    p.data[3] = ENOENT;
+  } else if (params[id].type & PARAM_RONLY) {
+    p.data[3] = EACCES;
+  } else if (paramPersistentStore(paramGroupOf(id), params[id].name, params[id].type, params[id].address, paramValueSize(id))) {
+    p.data[3] = 0;
+  } else {
+    p.data[3] = EIO;
+  }
+
+  crtpSendPacket(&p);
+}
+
+static void paramPersistentClearProcess()
+{
+  uint16_t ident;
+  memcpy(&ident, &p.data[1], 2);
+  int id = variableGetIndex(ident);
+
+  p.size = 4;
+
+  if (id < 0) {
+    p.data[3] = ENOENT;
+  } else if (paramPersistentClear(paramGroupOf(id), params[id].name)) {
+    p.data[3] = 0;
+  } else {
+    p.data[3] = ENOENT;
+  }
+
+  crtpSendPacket(&p);
+}
+
+static void paramPersistentGetAllSend(uint8_t sequence, const uint8_t* payload, uint8_t length)
+{
+  p.header = CRTP_HEADER(CRTP_PORT_PARAM, MISC_CH);
+  p.data[0] = MISC_PERSISTENT_GET_ALL;
+  p.data[1] = sequence;
+  memcpy(&p.data[2], payload, length);
+  p.size = 2 + length;
+  crtpSendPacket(&p);
+}
+
+/* Answer with all persisted parameters in one sweep over the param table,
+ * see param_persistent.h for the packet format. */
+static void paramPersistentGetAllProcess()
+{
+  static paramPersistentGetAll_t answer;
+  const char* group = "";
+  uint16_t id = 0;
+  uint8_t value[8];
+
+  paramPersistentGetAllInit(&answer);
+
+  for (int ptr = 0; ptr < paramsLen; ptr++) {
+    if (params[ptr].type & PARAM_GROUP) {
+      if (params[ptr].type & PARAM_START) {
+        group = params[ptr].name;
+      }
+      continue;
+    }
+
+    if (paramFetchStored(ptr, group, value)) {
+      paramPersistentGetAllAdd(&answer, id, value, paramValueSize(ptr), paramPersistentGetAllSend);
+    }
+
+    id++;
+  }
+
+  paramPersistentGetAllFinish(&answer, paramPersistentGetAllSend);
+}
+
+static int paramBulkValueSize(uint16_t ident)
+{
+  int id = variableGetIndex(ident);
+
+  if (id < 0) {
+    return -1;
+  }
+
+  return paramValueSize(id);
+}
+
+static int paramBulkWritableValueSize(uint16_t ident)
+{
+  int id = variableGetIndex(ident);
+
+  if (id < 0 || (params[id].type & PARAM_RONLY)) {
+    return -1;
+  }
+
+  return paramValueSize(id);
+}
+
+// Apply all values at once so that no task sees a partially updated set
+static void paramBulkApply(const paramBulkEntry_t* entries, const int* targets, int count)
+{
+  taskENTER_CRITICAL();
+  for (int i = 0; i < count; i++) {
+    memcpy(params[targets[i]].address, entries[i].value, entries[i].size);
+  }
+  taskEXIT_CRITICAL();
+}
+
+/* Write a set of parameters from one packet: [cmd, (id, value)...]. Either all
+ * values are written or none of them. The answer is [cmd, error, count] where
+ * count is the index of the faulty entry if error is set. */
+static void paramBulkWriteProcess()
+{
+  paramBulkEntry_t entries[PARAM_BULK_MAX_ENTRIES];
+  int targets[PARAM_BULK_MAX_ENTRIES];
+  int failedEntry = 0;
+  int error = 0;
+
+  int count = paramBulkDecode(&p.data[1], p.size - 1, paramBulkValueSize, entries, PARAM_BULK_MAX_ENTRIES, &failedEntry);
+
+  if (count < 0) {
+    error = -count;
+  } else {
+    for (int i = 0; i < count; i++) {
+      targets[i] = variableGetIndex(entries[i].id);
+      if (params[targets[i]].type & PARAM_RONLY) {
+        error = EACCES;
+        failedEntry = i;
+        break;
+      }
+    }
+  }
+
+  if (error == 0) {
+    paramBulkApply(entries, targets, count);
+  }
+
+  p.data[1] = error;
+  p.data[2] = error ? failedEntry : count;
+  p.size = 3;
+  crtpSendPacket(&p);
+}
+
+/* Read a set of parameters from one packet: [cmd, id...]. The answer is
+ * [cmd, error, (id, value)...] with all values sampled at the same time. If
+ * the values do not fit in one packet, the answer holds the ones that fit and
+ * error is set to E2BIG. If an id is unknown the answer is [cmd, ENOENT, index]. */
+static void paramBulkReadProcess()
+{
+  uint16_t ids[PARAM_BULK_MAX_PAYLOAD_SIZE / 2];
+  int targets[PARAM_BULK_MAX_PAYLOAD_SIZE / 2];
+  uint8_t error = 0;
+
+  int count = paramBulkDecodeIds(&p.data[1], p.size - 1, ids, PARAM_BULK_MAX_PAYLOAD_SIZE / 2);
+
+  if (count < 0) {
+    p.data[1] = -count;
+    p.size = 2;
+    crtpSendPacket(&p);
+    return;
+  }
+
+  for (int i = 0; i < count; i++) {
+    targets[i] = variableGetIndex(ids[i]);
+    if (targets[i] < 0) {
+      p.data[1] = ENOENT;
+      p.data[2] = i;
+      p.size = 3;
+      crtpSendPacket(&p);
+      return;
+    }
+  }
+
+  int length = 2;
+  taskENTER_CRITICAL();
+  for (int i = 0; i < count; i++) {
+    int newLength = paramBulkAppend(p.data, length, CRTP_MAX_DATA_SIZE, ids[i],
+                                    params[targets[i]].address, paramValueSize(targets[i]));
+    if (newLength < 0) {
+      error = E2BIG;
+      break;
+    }
+    length = newLength;
+  }
+  taskEXIT_CRITICAL();
+
+  p.data[1] = error;
+  p.size = length;
+  crtpSendPacket(&p);
+}
+
+/* Broadcast parameter set: [cmd, groupMask, delay, (id, value)...]. Packets
+ * are broadcasted to the whole swarm so there is no answer. */
+static void paramBroadcastProcess()
+{
+  paramBroadcastHandle(&broadcast, &p.data[1], p.size - 1, paramBulkWritableValueSize, T2M(xTaskGetTickCount()));
+}
+
+static void paramBroadcastApplyDue()
+{
+  const paramBulkEntry_t* entries;
+  int targets[PARAM_BULK_MAX_ENTRIES];
+
+  int count = paramBroadcastGetDue(&broadcast, T2M(xTaskGetTickCount()), &entries);
+
+  // Ids are resolved before entering the critical section
+  for (int i = 0; i < count; i++) {
+    targets[i] = variableGetIndex(entries[i].id);
+  }
+
+  if (count > 0) {
+    paramBulkApply(entries, targets, count);
+  }
+}
+
+void paramStoredInit(void)
+{
+  const char* group = "";
+  uint8_t value[8];
+  int restored = 0;
+
+  for (int ptr = 0; ptr < paramsLen; ptr++) {
+    if (params[ptr].type & PARAM_GROUP) {
+      if (params[ptr].type & PARAM_START) {
+        group = params[ptr].name;
+      }
+      continue;
+    }
+
+    if ((params[ptr].type & PARAM_RONLY) == 0 && paramFetchStored(ptr, group, value)) {
+      memcpy(params[ptr].address, value, paramValueSize(ptr));
+      restored++;
+    }
+  }
+
+  if (restored > 0) {
+    DEBUG_PRINT("Restored %d persistent parameters\n", restored);
+  }
+}
+
 static int variableGetIndex(int id)
 {
   int i;
@@ -0,0 +1,105 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * param_broadcast.c - Group parameter updates broadcasted to a swarm
+ */
+
+#include <string.h>
+
+#include "param_broadcast.h"
+#include "crtp_commander_high_level.h"
+
+void paramBroadcastInit(paramBroadcast_t* this)
+{
+  memset(this, 0, sizeof(paramBroadcast_t));
+}
+
+paramBroadcastResult_t paramBroadcastHandle(paramBroadcast_t* this, const uint8_t* data, int length,
+                                            paramBulkValueSize_t valueSize, const uint32_t now_ms)
+{
+  if (length < PARAM_BROADCAST_HEADER_SIZE || length - PARAM_BROADCAST_HEADER_SIZE > PARAM_BROADCAST_PAYLOAD_SIZE) {
+    return paramBroadcastInvalid;
+  }
+
+  const uint8_t groupMask = data[0];
+  if (!crtpCommanderHighLevelIsInGroup(groupMask)) {
+    return paramBroadcastNotInGroup;
+  }
+
+  uint16_t delay_ms;
+  memcpy(&delay_ms, &data[1], 2);
+
+  const uint8_t* payload = &data[PARAM_BROADCAST_HEADER_SIZE];
+  const int payloadLength = length - PARAM_BROADCAST_HEADER_SIZE;
+
+  // Resent packet, keep the activation time of the first one
+  if (this->isPending && this->payloadLength == payloadLength && memcmp(this->payload, payload, payloadLength) == 0) {
+    return paramBroadcastDuplicate;
+  }
+
+  // Decode from a local copy, the entries point into the payload
+  uint8_t copy[PARAM_BROADCAST_PAYLOAD_SIZE];
+  paramBulkEntry_t entries[PARAM_BULK_MAX_ENTRIES];
+  memcpy(copy, payload, payloadLength);
+  const int count = paramBulkDecode(copy, payloadLength, valueSize, entries, PARAM_BULK_MAX_ENTRIES, 0);
+  if (count <= 0) {
+    return paramBroadcastInvalid;
+  }
+
+  memcpy(this->payload, copy, payloadLength);
+  this->payloadLength = payloadLength;
+  for (int i = 0; i < count; i++) {
+    this->entries[i] = entries[i];
+    this->entries[i].value = this->payload + (entries[i].value - copy);
+  }
+  this->entryCount = count;
+  this->activationTime = now_ms + delay_ms;
+  this->isPending = true;
+
+  return paramBroadcastScheduled;
+}
+
+int paramBroadcastGetDue(paramBroadcast_t* this, const uint32_t now_ms, const paramBulkEntry_t** entries)
+{
+  if (!this->isPending || paramBroadcastTimeToActivation(this, now_ms) > 0) {
+    return 0;
+  }
+
+  this->isPending = false;
+  *entries = this->entries;
+  return this->entryCount;
+}
+
+uint32_t paramBroadcastTimeToActivation(const paramBroadcast_t* this, const uint32_t now_ms)
+{
+  if (!this->isPending) {
+    return UINT32_MAX;
+  }
+
+  const int32_t remaining = (int32_t)(this->activationTime - now_ms);
+  if (remaining <= 0) {
+    return 0;
+  }
+
+  return remaining;
+}
@@ -0,0 +1,108 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * param_bulk.c - Encoding and decoding of bulk parameter packets
+ */
+
+#include <string.h>
+#include <errno.h>
+
+#include "param_bulk.h"
+
+int paramBulkAppend(uint8_t* buffer, int length, int maxLength, uint16_t id, const void* value, int size)
+{
+  if (length + 2 + size > maxLength) {
+    return -1;
+  }
+
+  memcpy(&buffer[length], &id, 2);
+  memcpy(&buffer[length + 2], value, size);
+
+  return length + 2 + size;
+}
+
+int paramBulkDecode(const uint8_t* buffer, int length, paramBulkValueSize_t valueSize,
+                    paramBulkEntry_t* entries, int maxEntries, int* failedEntry)
+{
+  int count = 0;
+  int index = 0;
+  int result = 0;
+
+  while (index < length) {
+    if (count >= maxEntries) {
+      result = -E2BIG;
+      break;
+    }
+
+    if (index + 2 > length) {
+      result = -EINVAL;
+      break;
+    }
+
+    uint16_t id;
+    memcpy(&id, &buffer[index], 2);
+
+    const int size = valueSize(id);
+    if (size < 0) {
+      result = -ENOENT;
+      break;
+    }
+
+    if (index + 2 + size > length) {
+      result = -EINVAL;
+      break;
+    }
+
+    entries[count].id = id;
+    entries[count].size = size;
+    entries[count].value = &buffer[index + 2];
+
+    index += 2 + size;
+    count++;
+  }
+
+  if (result < 0) {
+    if (failedEntry) {
+      *failedEntry = count;
+    }
+    return result;
+  }
+
+  return count;
+}
+
+int paramBulkDecodeIds(const uint8_t* buffer, int length, uint16_t* ids, int maxIds)
+{
+  if (length % 2) {
+    return -EINVAL;
+  }
+
+  const int count = length / 2;
+  if (count > maxIds) {
+    return -E2BIG;
+  }
+
+  memcpy(ids, buffer, length);
+
+  return count;
+}
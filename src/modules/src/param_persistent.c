@@ -0,0 +1,104 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ * param_persistent.c - Persistent parameters stored in the key/value storage
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "param_persistent.h"
+#include "param_bulk.h"
+#include "storage.h"
+
+bool paramPersistentKey(char* key, const char* group, const char* name)
+{
+  const int length = snprintf(key, PARAM_PERSISTENT_KEY_MAX_LENGTH, "%s%s.%s", PARAM_PERSISTENT_PREFIX_STRING, group, name);
+  return length > 0 && length < (int)PARAM_PERSISTENT_KEY_MAX_LENGTH;
+}
+
+bool paramPersistentStore(const char* group, const char* name, uint8_t type, const void* value, uint8_t size)
+{
+  char key[PARAM_PERSISTENT_KEY_MAX_LENGTH];
+  uint8_t stored[PARAM_PERSISTENT_MAX_STORED_SIZE];
+
+  if (size > PARAM_PERSISTENT_MAX_STORED_SIZE - 1 || !paramPersistentKey(key, group, name)) {
+    return false;
+  }
+
+  stored[0] = type;
+  memcpy(&stored[1], value, size);
+
+  return storageStore(key, stored, 1 + size);
+}
+
+bool paramPersistentFetch(const char* group, const char* name, uint8_t type, void* value, uint8_t size)
+{
+  char key[PARAM_PERSISTENT_KEY_MAX_LENGTH];
+  uint8_t stored[PARAM_PERSISTENT_MAX_STORED_SIZE];
+
+  if (!paramPersistentKey(key, group, name)) {
+    return false;
+  }
+
+  const size_t length = storageFetch(key, stored, sizeof(stored));
+  if ((length != (size_t)(1 + size)) || (stored[0] != type)) {
+    return false;
+  }
+
+  memcpy(value, &stored[1], size);
+  return true;
+}
+
+bool paramPersistentClear(const char* group, const char* name)
+{
+  char key[PARAM_PERSISTENT_KEY_MAX_LENGTH];
+
+  if (!paramPersistentKey(key, group, name)) {
+    return false;
+  }
+
+  return storageDelete(key);
+}
+
+void paramPersistentGetAllInit(paramPersistentGetAll_t* this)
+{
+  this->sequence = 0;
+  this->length = 0;
+}
+
+void paramPersistentGetAllAdd(paramPersistentGetAll_t* this, uint16_t id, const void* value, uint8_t size, paramPersistentSend_t send)
+{
+  int length = paramBulkAppend(this->payload, this->length, PARAM_PERSISTENT_GET_ALL_PAYLOAD_SIZE, id, value, size);
+  if (length < 0) {
+    send(this->sequence & PARAM_PERSISTENT_GET_ALL_SEQUENCE_MASK, this->payload, this->length);
+    this->sequence++;
+    length = paramBulkAppend(this->payload, 0, PARAM_PERSISTENT_GET_ALL_PAYLOAD_SIZE, id, value, size);
+  }
+
+  this->length = length;
+}
+
+void paramPersistentGetAllFinish(paramPersistentGetAll_t* this, paramPersistentSend_t send)
+{
+  send((this->sequence & PARAM_PERSISTENT_GET_ALL_SEQUENCE_MASK) | PARAM_PERSISTENT_GET_ALL_LAST, this->payload, this->length);
+}
@@ -0,0 +1,222 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * peer_broadcast.c - Broadcast of the own state to other Crazyflies over P2P
+ */
+
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include "peer_broadcast.h"
+#include "peer_broadcast_core.h"
+#include "peer_localization.h"
+#include "radiolink.h"
+#include "configblock.h"
+#include "system.h"
+#include "log.h"
+#include "param.h"
+#include "static_mem.h"
+#include "config.h"
+
+static bool isInit = false;
+static uint8_t isEnabled = 0;
+
+static peerBroadcastState_t ownState;
+static peerTdma_t tdma;
+
+// Protects ownState and tdma
+static xSemaphoreHandle lock;
+static StaticSemaphore_t lockBuffer;
+
+static P2PPacket txPacket;
+
+// Statistics
+static uint32_t txCount;
+static uint32_t rxCount;
+static uint32_t rxErrorCount;
+static uint32_t syncCount;
+static uint32_t skippedUpdateCount;
+static uint8_t ownSlot;
+
+STATIC_MEM_TASK_ALLOC(peerBroadcastTask, PEER_BROADCAST_TASK_STACKSIZE);
+
+static void peerBroadcastTask(void *param);
+static void p2pReceived(P2PPacket *p);
+
+void peerBroadcastInit()
+{
+  if (isInit) {
+    return;
+  }
+
+  const uint8_t ownId = configblockGetRadioAddress() & 0xFF;
+
+  lock = xSemaphoreCreateMutexStatic(&lockBuffer);
+  peerTdmaInit(&tdma, ownId, xTaskGetTickCount());
+  memset(&ownState, 0, sizeof(ownState));
+  ownState.id = ownId;
+  ownState.quat[3] = 1.0f;
+
+  p2pRegisterCB(p2pReceived);
+
+  STATIC_MEM_TASK_CREATE(peerBroadcastTask, peerBroadcastTask, PEER_BROADCAST_TASK_NAME, NULL, PEER_BROADCAST_TASK_PRI);
+
+  isInit = true;
+}
+
+bool peerBroadcastTest()
+{
+  return isInit;
+}
+
+void peerBroadcastTellState(const state_t *state, const setpoint_t *setpoint)
+{
+  if (!isInit) {
+    return;
+  }
+
+  // Called from the stabilizer loop, do not wait for the broadcast task. The
+  // state is updated at a much higher rate than it is sent, skipping one
+  // update is fine.
+  if (xSemaphoreTake(lock, 0) != pdTRUE) {
+    skippedUpdateCount++;
+    return;
+  }
+
+  ownState.position[0] = state->position.x;
+  ownState.position[1] = state->position.y;
+  ownState.position[2] = state->position.z;
+  ownState.velocity[0] = state->velocity.x;
+  ownState.velocity[1] = state->velocity.y;
+  ownState.velocity[2] = state->velocity.z;
+  ownState.quat[0] = state->attitudeQuaternion.x;
+  ownState.quat[1] = state->attitudeQuaternion.y;
+  ownState.quat[2] = state->attitudeQuaternion.z;
+  ownState.quat[3] = state->attitudeQuaternion.w;
+
+  ownState.isIntentValid = setpoint->mode.x == modeAbs && setpoint->mode.y == modeAbs && setpoint->mode.z == modeAbs;
+  ownState.intent[0] = setpoint->position.x;
+  ownState.intent[1] = setpoint->position.y;
+  ownState.intent[2] = setpoint->position.z;
+  xSemaphoreGive(lock);
+}
+
+static void peerBroadcastTask(void *param)
+{
+  systemWaitStart();
+
+  while (true) {
+    const uint32_t now = xTaskGetTickCount();
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    const uint32_t slotStart = peerTdmaNextSlotStart(&tdma, now);
+    xSemaphoreGive(lock);
+
+    vTaskDelay(slotStart - now);
+
+    if (isEnabled) {
+      peerBroadcastItem_t item;
+
+      xSemaphoreTake(lock, portMAX_DELAY);
+      ownSlot = peerTdmaSlotOf(&tdma, tdma.ownId);
+      ownState.slot = ownSlot;
+      peerBroadcastEncode(&ownState, &item);
+      xSemaphoreGive(lock);
+
+      txPacket.port = PEER_BROADCAST_P2P_PORT;
+      memcpy(txPacket.data, &item, sizeof(item));
+      txPacket.size = sizeof(item);
+      if (radiolinkSendP2PPacketBroadcast(&txPacket)) {
+        txCount++;
+      }
+    }
+  }
+}
+
+// Called from the syslink task
+static void p2pReceived(P2PPacket *p)
+{
+  if (p->port != PEER_BROADCAST_P2P_PORT) {
+    return;
+  }
+
+  // The size includes the port and rssi bytes
+  if (p->size < 2) {
+    rxErrorCount++;
+    return;
+  }
+
+  peerBroadcastState_t peer;
+  if (!peerBroadcastDecode(p->data, p->size - 2, &peer)) {
+    rxErrorCount++;
+    return;
+  }
+
+  const uint32_t rxTime = xTaskGetTickCount();
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  const bool isOwn = peer.id == tdma.ownId;
+  if (!isOwn && peerTdmaOnReceive(&tdma, peer.id, peer.slot, rxTime)) {
+    syncCount++;
+  }
+  xSemaphoreGive(lock);
+
+  if (isOwn) {
+    return;
+  }
+
+  positionMeasurement_t pos = {
+    .x = peer.position[0],
+    .y = peer.position[1],
+    .z = peer.position[2],
+  };
+  velocity_t vel = {
+    .x = peer.velocity[0],
+    .y = peer.velocity[1],
+    .z = peer.velocity[2],
+  };
+  peerLocalizationTellState(peer.id, &pos, &vel);
+  rxCount++;
+}
+
+/**
+ * Broadcast of the own state to other Crazyflies over P2P
+ */
+PARAM_GROUP_START(peerBc)
+PARAM_ADD(PARAM_UINT8, enable, &isEnabled)              // Broadcast the own state, received states are always used
+PARAM_ADD(PARAM_UINT8, slotCount, &tdma.slotCount)      // Number of TDMA slots per frame, must be the same in the swarm and larger than the highest id
+PARAM_ADD(PARAM_UINT8, slotLength, &tdma.slotLength)    // Length of a TDMA slot - ms
+PARAM_GROUP_STOP(peerBc)
+
+LOG_GROUP_START(peerBc)
+LOG_ADD(LOG_UINT32, tx, &txCount)                 // Number of sent states
+LOG_ADD(LOG_UINT32, rx, &rxCount)                 // Number of received states
+LOG_ADD(LOG_UINT32, rxError, &rxErrorCount)       // Number of received packets too short to hold a state
+LOG_ADD(LOG_UINT32, sync, &syncCount)             // Number of frame alignments to a peer
+LOG_ADD(LOG_UINT32, skipped, &skippedUpdateCount) // Number of own state updates skipped since the broadcast task held the lock
+LOG_ADD(LOG_UINT8, slot, &ownSlot)                // Own TDMA slot
+LOG_ADD(LOG_UINT8, refId, &tdma.referenceId)      // Id of the Crazyflie the frames are aligned to
+LOG_GROUP_STOP(peerBc)
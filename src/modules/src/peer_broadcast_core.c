@@ -0,0 +1,165 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * peer_broadcast_core.c - Encoding and TDMA timing of the peer state broadcast
+ */
+
+#include <string.h>
+
+#include "peer_broadcast_core.h"
+#include "quatcompress.h"
+#include "num.h"
+
+static int16_t toMilli(const float value) {
+  return (int16_t)constrain(value * 1000.0f, INT16_MIN, INT16_MAX);
+}
+
+void peerBroadcastEncode(const peerBroadcastState_t* state, peerBroadcastItem_t* item) {
+  item->id = state->id;
+  item->slot = state->slot;
+
+  item->x = toMilli(state->position[0]);
+  item->y = toMilli(state->position[1]);
+  item->z = toMilli(state->position[2]);
+
+  item->vx = toMilli(state->velocity[0]);
+  item->vy = toMilli(state->velocity[1]);
+  item->vz = toMilli(state->velocity[2]);
+
+  item->quat = quatcompress(state->quat);
+
+  item->flags = 0;
+  if (state->isIntentValid) {
+    item->intentX = toMilli(state->intent[0]);
+    item->intentY = toMilli(state->intent[1]);
+    item->intentZ = toMilli(state->intent[2]);
+    item->flags |= PEER_BROADCAST_FLAG_INTENT_VALID;
+  } else {
+    item->intentX = 0;
+    item->intentY = 0;
+    item->intentZ = 0;
+  }
+}
+
+bool peerBroadcastDecode(const uint8_t* data, const uint8_t size, peerBroadcastState_t* state) {
+  if (size < sizeof(peerBroadcastItem_t)) {
+    return false;
+  }
+
+  peerBroadcastItem_t item;
+  memcpy(&item, data, sizeof(item));
+
+  state->id = item.id;
+  state->slot = item.slot;
+
+  state->position[0] = item.x / 1000.0f;
+  state->position[1] = item.y / 1000.0f;
+  state->position[2] = item.z / 1000.0f;
+
+  state->velocity[0] = item.vx / 1000.0f;
+  state->velocity[1] = item.vy / 1000.0f;
+  state->velocity[2] = item.vz / 1000.0f;
+
+  quatdecompress(item.quat, state->quat);
+
+  state->isIntentValid = (item.flags & PEER_BROADCAST_FLAG_INTENT_VALID) != 0;
+  state->intent[0] = item.intentX / 1000.0f;
+  state->intent[1] = item.intentY / 1000.0f;
+  state->intent[2] = item.intentZ / 1000.0f;
+
+  return true;
+}
+
+void peerTdmaInit(peerTdma_t* this, const uint8_t ownId, const uint32_t now) {
+  this->ownId = ownId;
+  this->slotCount = PEER_BROADCAST_DEFAULT_SLOT_COUNT;
+  this->slotLength = PEER_BROADCAST_DEFAULT_SLOT_LENGTH;
+  this->referenceId = ownId;
+  this->referenceLastSeen = now;
+  this->frameStart = now;
+}
+
+uint8_t peerTdmaSlotOf(const peerTdma_t* this, const uint8_t id) {
+  // The slot count and length are parameters, protect against 0
+  if (this->slotCount == 0) {
+    return 0;
+  }
+
+  return id % this->slotCount;
+}
+
+static uint32_t slotLength(const peerTdma_t* this) {
+  if (this->slotLength == 0) {
+    return 1;
+  }
+
+  return this->slotLength;
+}
+
+static uint32_t framePeriod(const peerTdma_t* this) {
+  if (this->slotCount == 0) {
+    return slotLength(this);
+  }
+
+  return this->slotCount * slotLength(this);
+}
+
+static void expireReference(peerTdma_t* this, const uint32_t now) {
+  if (this->referenceId != this->ownId && (now - this->referenceLastSeen) > PEER_BROADCAST_REFERENCE_TIMEOUT) {
+    this->referenceId = this->ownId;
+  }
+}
+
+uint32_t peerTdmaNextSlotStart(peerTdma_t* this, const uint32_t now) {
+  expireReference(this, now);
+
+  const int32_t period = framePeriod(this);
+  int32_t offset = (int32_t)(now - this->frameStart) % period;
+  if (offset < 0) {
+    offset += period;
+  }
+
+  // Keep the frame start close to now to avoid overflow in the difference
+  this->frameStart = now - offset;
+
+  int32_t wait = peerTdmaSlotOf(this, this->ownId) * slotLength(this) - offset;
+  if (wait <= 0) {
+    wait += period;
+  }
+
+  return now + wait;
+}
+
+bool peerTdmaOnReceive(peerTdma_t* this, const uint8_t senderId, const uint8_t senderSlot, const uint32_t rxTime) {
+  expireReference(this, rxTime);
+
+  if (senderId == this->ownId || senderId > this->referenceId) {
+    return false;
+  }
+
+  this->referenceId = senderId;
+  this->referenceLastSeen = rxTime;
+  this->frameStart = rxTime - senderSlot * slotLength(this);
+
+  return true;
+}
@@ -2,13 +2,19 @@
 #include "debug.h"
 #include "FreeRTOS.h"
 #include "task.h"
+#include "param.h"
 #include "peer_localization.h"
 
 
+// Latest states of the other Crazyflies. The table is updated from the CRTP
+// and P2P tasks and read from the stabilizer, and readers may remove expired
+// entries, so every table call is made in a critical section. The calls are
+// short, the loops are bounded by PEER_LOCALIZATION_MAX_NEIGHBORS.
+static peerLocalizationTable_t table;
+
 void peerLocalizationInit()
 {
-  // All other_positions[in].id will be set to zero due to static initialization.
-  // If we ever switch to dynamic allocation, we need to set them to zero explicitly.
+  peerLocalizationTableInit(&table);
 }
 
 bool peerLocalizationTest()
@@ -16,49 +22,72 @@ bool peerLocalizationTest()
   return true;
 }
 
-// array of other's position
-static peerLocalizationOtherPosition_t other_positions[PEER_LOCALIZATION_MAX_NEIGHBORS];
-
 bool peerLocalizationTellPosition(int cfid, positionMeasurement_t const *pos)
 {
-  for (uint8_t i = 0; i < PEER_LOCALIZATION_MAX_NEIGHBORS; ++i) {
-    if (other_positions[i].id == 0 || other_positions[i].id == cfid) {
-      other_positions[i].id = cfid;
-      other_positions[i].pos.x = pos->x;
-      other_positions[i].pos.y = pos->y;
-      other_positions[i].pos.z = pos->z;
-      other_positions[i].pos.timestamp = xTaskGetTickCount();
-      return true;
-    }
+  return peerLocalizationTellState(cfid, pos, NULL);
+}
+
+bool peerLocalizationTellState(int cfid, positionMeasurement_t const *pos, velocity_t const *vel)
+{
+  if (cfid < 0 || cfid > UINT8_MAX) {
+    return false;
   }
-  return false;
+
+  const uint32_t now = xTaskGetTickCount();
+
+  taskENTER_CRITICAL();
+  const bool result = peerLocalizationTableUpdate(&table, cfid, pos->x, pos->y, pos->z, vel, now);
+  taskEXIT_CRITICAL();
+
+  return result;
 }
 
 bool peerLocalizationIsIDActive(uint8_t cfid)
 {
-  for (uint8_t i = 0; i < PEER_LOCALIZATION_MAX_NEIGHBORS; ++i) {
-    if (other_positions[i].id == cfid) {
-      return true;
-    }
-  }
-  return false;
+  return peerLocalizationGetPositionByID(cfid) != NULL;
 }
 
 peerLocalizationOtherPosition_t *peerLocalizationGetPositionByID(uint8_t cfid)
 {
-  for (uint8_t i = 0; i < PEER_LOCALIZATION_MAX_NEIGHBORS; ++i) {
-    if (other_positions[i].id == cfid) {
-      return &other_positions[i];
-    }
-  }
-  return NULL;
+  const uint32_t now = xTaskGetTickCount();
+
+  taskENTER_CRITICAL();
+  peerLocalizationOtherPosition_t *result = peerLocalizationTableFind(&table, cfid, now);
+  taskEXIT_CRITICAL();
+
+  return result;
 }
 
 peerLocalizationOtherPosition_t *peerLocalizationGetPositionByIdx(uint8_t idx)
 {
-  // TODO: should we return NULL if the id == 0?
   if (idx < PEER_LOCALIZATION_MAX_NEIGHBORS) {
-    return &other_positions[idx];
+    return &table.entries[idx];
   }
   return NULL;
 }
+
+void peerLocalizationIteratorInit(peerLocalizationIterator_t *it)
+{
+  it->index = 0;
+  it->time = xTaskGetTickCount();
+}
+
+peerLocalizationOtherPosition_t *peerLocalizationIteratorNext(peerLocalizationIterator_t *it)
+{
+  taskENTER_CRITICAL();
+  peerLocalizationOtherPosition_t *result = peerLocalizationTableNext(&table, &it->index, it->time);
+  taskEXIT_CRITICAL();
+
+  return result;
+}
+
+void peerLocalizationPredictPosition(peerLocalizationOtherPosition_t const *other, uint32_t time, point_t *pos)
+{
+  taskENTER_CRITICAL();
+  peerLocalizationTablePredict(other, time, pos);
+  taskEXIT_CRITICAL();
+}
+
+PARAM_GROUP_START(peerLoc)
+PARAM_ADD(PARAM_UINT32, maxAge, &table.maxAge) // Peers not heard from for this long are forgotten - ms
+PARAM_GROUP_STOP(peerLoc)
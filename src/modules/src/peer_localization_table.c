@@ -0,0 +1,156 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * peer_localization_table.c - Table of the latest known states of other Crazyflies
+ */
+
+#include <string.h>
+
+#include "peer_localization_table.h"
+
+void peerLocalizationTableInit(peerLocalizationTable_t* this) {
+  memset(this, 0, sizeof(peerLocalizationTable_t));
+  this->maxAge = PEER_LOCALIZATION_DEFAULT_MAX_AGE;
+}
+
+static bool isExpired(const peerLocalizationTable_t* this, const peerLocalizationOtherPosition_t* entry, const uint32_t now) {
+  // An entry may have been updated by another task after now was read, the
+  // age is then negative
+  const int32_t age = (int32_t)(now - entry->pos.timestamp);
+  return age > (int32_t)this->maxAge;
+}
+
+static void removeEntry(peerLocalizationTable_t* this, peerLocalizationOtherPosition_t* entry) {
+  this->entryOfId[entry->id] = 0;
+  memset(entry, 0, sizeof(peerLocalizationOtherPosition_t));
+}
+
+static peerLocalizationOtherPosition_t* allocateEntry(peerLocalizationTable_t* this, const uint8_t id, const uint32_t now) {
+  for (int i = 0; i < PEER_LOCALIZATION_MAX_NEIGHBORS; i++) {
+    peerLocalizationOtherPosition_t* entry = &this->entries[i];
+    if (entry->id != 0 && isExpired(this, entry, now)) {
+      removeEntry(this, entry);
+    }
+
+    if (entry->id == 0) {
+      entry->id = id;
+      this->entryOfId[id] = i + 1;
+      return entry;
+    }
+  }
+
+  return NULL;
+}
+
+bool peerLocalizationTableUpdate(peerLocalizationTable_t* this, const uint8_t id, const float x, const float y, const float z, const velocity_t* vel, const uint32_t now) {
+  if (id == 0) {
+    return false;
+  }
+
+  peerLocalizationOtherPosition_t* entry = peerLocalizationTableFind(this, id, now);
+  if (entry) {
+    if (vel == NULL) {
+      const int32_t dt = (int32_t)(now - entry->pos.timestamp);
+      if (dt > 0 && dt <= PEER_LOCALIZATION_MAX_VELOCITY_DT) {
+        entry->vel.x = (x - entry->pos.x) * 1000.0f / dt;
+        entry->vel.y = (y - entry->pos.y) * 1000.0f / dt;
+        entry->vel.z = (z - entry->pos.z) * 1000.0f / dt;
+      } else if (dt > PEER_LOCALIZATION_MAX_VELOCITY_DT) {
+        memset(&entry->vel, 0, sizeof(entry->vel));
+      }
+    }
+  } else {
+    entry = allocateEntry(this, id, now);
+    if (entry == NULL) {
+      return false;
+    }
+  }
+
+  entry->pos.x = x;
+  entry->pos.y = y;
+  entry->pos.z = z;
+  entry->pos.timestamp = now;
+  if (vel) {
+    entry->vel.x = vel->x;
+    entry->vel.y = vel->y;
+    entry->vel.z = vel->z;
+  }
+
+  return true;
+}
+
+peerLocalizationOtherPosition_t* peerLocalizationTableFind(peerLocalizationTable_t* this, const uint8_t id, const uint32_t now) {
+  const uint8_t entryIndex = this->entryOfId[id];
+  if (entryIndex == 0) {
+    return NULL;
+  }
+
+  peerLocalizationOtherPosition_t* entry = &this->entries[entryIndex - 1];
+  if (entry->id != id) {
+    // Stale index, the entry has been reused for another id
+    this->entryOfId[id] = 0;
+    return NULL;
+  }
+
+  if (isExpired(this, entry, now)) {
+    removeEntry(this, entry);
+    return NULL;
+  }
+
+  return entry;
+}
+
+peerLocalizationOtherPosition_t* peerLocalizationTableNext(peerLocalizationTable_t* this, uint8_t* index, const uint32_t now) {
+  while (*index < PEER_LOCALIZATION_MAX_NEIGHBORS) {
+    peerLocalizationOtherPosition_t* entry = &this->entries[*index];
+    (*index)++;
+
+    if (entry->id == 0) {
+      continue;
+    }
+
+    if (isExpired(this, entry, now)) {
+      removeEntry(this, entry);
+      continue;
+    }
+
+    return entry;
+  }
+
+  return NULL;
+}
+
+void peerLocalizationTablePredict(const peerLocalizationOtherPosition_t* other, const uint32_t time, point_t* pos) {
+  int32_t dt = (int32_t)(time - other->pos.timestamp);
+  if (dt < 0) {
+    dt = 0;
+  } else if (dt > PEER_LOCALIZATION_MAX_PREDICTION) {
+    dt = PEER_LOCALIZATION_MAX_PREDICTION;
+  }
+
+  const float dtSeconds = dt / 1000.0f;
+  pos->x = other->pos.x + other->vel.x * dtSeconds;
+  pos->y = other->pos.y + other->vel.y * dtSeconds;
+  pos->z = other->pos.z + other->vel.z * dtSeconds;
+  pos->timestamp = time;
+}
@@ -36,6 +36,9 @@
 #include "motors.h"
 #include "debug.h"
 #include "position_controller.h"
+#include "motor_thrust_model.h"
+#include "motor_mixer.h"
+#include "pm.h"
 
 static bool motorSetEnable = false;
 //const static float thrust_scale = 132000; // 119460.0; TODO: find a solution (scale gains somehow)
@@ -78,15 +81,70 @@ static bool isFeedForward = false;
 
 static float pwmToThrustA = 0.091492681f;
 static float pwmToThrustB = 0.067673604f;
+// The voltage a and b were fitted at is not recorded and the controllers are
+// tuned without compensation, so it is off by default. Set vNom to the fit
+// voltage before enabling it.
+static float nominalVoltage = 4.0f;
+static bool isVoltageCompensated = false;
+static motorThrustModel_t thrustModel;
+
+#ifdef QUAD_FORMATION_X
+static const motorMixerMatrix_t* mixerMatrix = &motorMixerQuadX;
+#else // QUAD_FORMATION_NORMAL
+static const motorMixerMatrix_t* mixerMatrix = &motorMixerQuadNormal;
+#endif
+
+// Saturation flags of the last mix, see motor_mixer.h, and number of saturated ticks per stage
+static uint8_t mixerSaturation;
+static uint32_t mixerSatRollPitchCount;
+static uint32_t mixerSatThrustCount;
+static uint32_t mixerSatYawCount;
 static float armLength = 0.046f; // m;
 static float thrustToTorque = 0.005964552f;
 static bool isFlip = false;
 //
 
 
+// Rebuild the thrust model table if the coefficients have been changed through the params.
+// Invalid coefficients are reverted to the ones of the current model.
+static void thrustModelUpdate(void)
+{
+  if (pwmToThrustA != thrustModel.pwmToThrustA ||
+      pwmToThrustB != thrustModel.pwmToThrustB ||
+      nominalVoltage != thrustModel.nominalVoltage) {
+    if (!motorThrustModelInit(&thrustModel, pwmToThrustA, pwmToThrustB, nominalVoltage)) {
+      DEBUG_PRINT("Invalid motor model, a + b and vNom must be positive\n");
+      pwmToThrustA = thrustModel.pwmToThrustA;
+      pwmToThrustB = thrustModel.pwmToThrustB;
+      nominalVoltage = thrustModel.nominalVoltage;
+    }
+  }
+}
+
+static float thrustModelBatteryVoltage(void)
+{
+  // A voltage of 0 disables the compensation in the model
+  return isVoltageCompensated ? pmGetBatteryVoltage() : 0.0f;
+}
+
+static void mixerSaturationUpdate(const uint8_t saturation)
+{
+  mixerSaturation = saturation;
+  if (saturation & MOTOR_MIXER_SAT_ROLL_PITCH) {
+    mixerSatRollPitchCount++;
+  }
+  if (saturation & MOTOR_MIXER_SAT_THRUST) {
+    mixerSatThrustCount++;
+  }
+  if (saturation & MOTOR_MIXER_SAT_YAW) {
+    mixerSatYawCount++;
+  }
+}
+
 void powerDistributionInit(void)
 {
   motorsInit(platformConfigGetMotorMapping());
+  motorThrustModelInit(&thrustModel, pwmToThrustA, pwmToThrustB, nominalVoltage);
   // Code of Peter
   num = 0;
   average.m1 = 0;
@@ -123,42 +181,18 @@ void setFlip(bool val)
 
 void powerDistribution(const control_t *control)  // Motor power: PWM -> 0...65535
 {
+  thrustModelUpdate();
+
   if(!isFlip)
   {
-    #ifdef QUAD_FORMATION_X
-      // float l = 0.0325f; // thrust2torque
-      // float bk = 0.0251f; // b/k
-      /*float rf = control->roll / thrust_scale / 4.0f;
-      float pf = control->pitch / thrust_scale / 4.0f;
-      float yf = control->yaw / thrust_scale / 4.0f;
-      float tf = control->thrust / thrust_scale / 4.0f;
-      
-      int32_t f1 = thrust2pwm(tf - rf + pf + yf);
-      int32_t f2 = thrust2pwm(tf - rf - pf - yf);
-      int32_t f3 = thrust2pwm(tf + rf - pf + yf);
-      int32_t f4 = thrust2pwm(tf + rf + pf - yf);
-      motorPower.m1 = limitThrust(f1);
-      motorPower.m2 = limitThrust(f2);
-      motorPower.m3 = limitThrust(f3);
-      motorPower.m4 = limitThrust(f4);
-      */
-      
-      int16_t r = control->roll; // / 2.0f;
-      int16_t p = control->pitch; // / 2.0f;
-      motorPower.m1 = (control->thrust - r + p + control->yaw);
-      motorPower.m2 = (control->thrust - r - p - control->yaw);
-      motorPower.m3 = (control->thrust + r - p + control->yaw);
-      motorPower.m4 = (control->thrust + r + p - control->yaw);
-    #else // QUAD_FORMATION_NORMAL
-      motorPower.m1 = limitThrust(control->thrust + control->pitch +
-                                control->yaw);
-      motorPower.m2 = limitThrust(control->thrust - control->roll -
-                                control->yaw);
-      motorPower.m3 =  limitThrust(control->thrust - control->pitch +
-                                control->yaw);
-      motorPower.m4 =  limitThrust(control->thrust + control->roll -
-                                control->yaw);
-    #endif
+    float motors[MOTOR_MIXER_MOTOR_COUNT];
+    uint8_t saturation = motorMixerMix(mixerMatrix, control->thrust, control->roll, control->pitch, control->yaw, UINT16_MAX, motors);
+    mixerSaturationUpdate(saturation);
+
+    motorPower.m1 = motors[0];
+    motorPower.m2 = motors[1];
+    motorPower.m3 = motors[2];
+    motorPower.m4 = motors[3];
   } else {
     powerDistributionForceTorque(control);
   }
@@ -213,18 +247,15 @@ void powerDistributionForceTorque(const control_t *control) {
   const float pitchPart = 0.25f / arm * control->pitch / 5.0e6f;
   const float thrustPart = 0.25f * control->thrust; // N (per rotor)
   const float yawPart = 0.25f * control->yaw / thrustToTorque;
+  const float batteryVoltage = thrustModelBatteryVoltage();
 
-  motorForces[0] = thrustPart - rollPart + pitchPart + yawPart;
-  motorForces[1] = thrustPart - rollPart - pitchPart - yawPart;
-  motorForces[2] = thrustPart + rollPart - pitchPart + yawPart;
-  motorForces[3] = thrustPart + rollPart + pitchPart - yawPart;
-  for (int motorIndex = 0; motorIndex < 4; motorIndex++) {
-    float motorForce = motorForces[motorIndex];
-    if (motorForce < 0.0f) {
-      motorForce = 0.0f;
-    }
+  // Desaturate in force, up to what the motors can deliver at the current battery voltage
+  const float maxForce = motorThrustModelThrust(&thrustModel, 1.0f, batteryVoltage);
+  uint8_t saturation = motorMixerMix(&motorMixerQuadX, thrustPart, rollPart, pitchPart, yawPart, maxForce, motorForces);
+  mixerSaturationUpdate(saturation);
 
-    float motor_pwm = (-pwmToThrustB + sqrtf(pwmToThrustB * pwmToThrustB + 4.0f * pwmToThrustA * motorForce)) / (2.0f * pwmToThrustA);
+  for (int motorIndex = 0; motorIndex < 4; motorIndex++) {
+    float motor_pwm = motorThrustModelPwm(&thrustModel, motorForces[motorIndex], batteryVoltage);
     motorForces[motorIndex]= motor_pwm * UINT16_MAX;
   }
   motorPower.m1 = motorForces[0];
@@ -238,7 +269,7 @@ void setFeedForward(){
 }
 
 float thrust2pwm(float thrust){
-  return -24239.44f + 216675.7f*(float)sqrt((double)(0.011966f + thrust));
+  return motorThrustModelPwm(&thrustModel, thrust, thrustModelBatteryVoltage()) * UINT16_MAX;
 }
 
 PARAM_GROUP_START(motorPowerSet)
@@ -251,6 +282,13 @@ PARAM_ADD(PARAM_UINT8, isAv, &isAverage)               // set true to average th
 PARAM_ADD(PARAM_UINT8, isFF, &isFeedForward)       // set true to feedforward the averaged PWMs
 PARAM_GROUP_STOP(motorPowerSet)
 
+PARAM_GROUP_START(motorModel)
+PARAM_ADD(PARAM_FLOAT, a, &pwmToThrustA)            // thrust [N] = a * pwm^2 + b * pwm at vNom, from tools/param_est
+PARAM_ADD(PARAM_FLOAT, b, &pwmToThrustB)
+PARAM_ADD(PARAM_FLOAT, vNom, &nominalVoltage)       // battery voltage a and b were fitted at
+PARAM_ADD(PARAM_UINT8, vComp, &isVoltageCompensated) // set true to compensate thrust for the battery voltage, off by default
+PARAM_GROUP_STOP(motorModel)
+
 LOG_GROUP_START(motor)
 LOG_ADD(LOG_UINT16, m1, &motorPower.m1)
 LOG_ADD(LOG_UINT16, m2, &motorPower.m2)
@@ -261,3 +299,10 @@ LOG_ADD(LOG_UINT16, am2, &actualPowerSet.m2)
 LOG_ADD(LOG_UINT16, am3, &actualPowerSet.m3)
 LOG_ADD(LOG_UINT16, am4, &actualPowerSet.m4)*/
 LOG_GROUP_STOP(motor)
+
+LOG_GROUP_START(mixer)
+LOG_ADD(LOG_UINT8, sat, &mixerSaturation)
+LOG_ADD(LOG_UINT32, nSatRP, &mixerSatRollPitchCount)
+LOG_ADD(LOG_UINT32, nSatThrust, &mixerSatThrustCount)
+LOG_ADD(LOG_UINT32, nSatYaw, &mixerSatYawCount)
+LOG_GROUP_STOP(mixer)
@@ -31,12 +31,19 @@
 #ifdef DEBUG_QUEUE_MONITOR
 
 #include <stdbool.h>
+#include <string.h>
 #include "timers.h"
+#include "task.h"
 #include "debug.h"
 #include "cfassert.h"
+#include "usec_time.h"
+#include "queuemonitor_stats.h"
+#include "log.h"
+#include "param.h"
 
-#define MAX_NR_OF_QUEUES 20
-#define TIMER_PERIOD M2T(10000)
+#define MAX_NR_OF_QUEUES 32
+#define TIMER_PERIOD M2T(100)
+#define DISPLAY_PERIOD_TICKS 100
 
 #define RESET_COUNTERS_AFTER_DISPLAY true
 #define DISPLAY_ONLY_OVERFLOW_QUEUES true
@@ -45,9 +52,9 @@ typedef struct
 {
   char* fileName;
   char* queueName;
-  int sendCount;
-  int maxWaiting;
-  int fullCount;
+  // Read at registration, the trace hooks may run in an ISR
+  uint32_t length;
+  qmStats_t stats;
 } Data;
 
 static Data data[MAX_NR_OF_QUEUES];
@@ -57,12 +64,15 @@ static StaticTimer_t timerBuffer;
 static unsigned char nrOfQueues = 1; // Unregistered queues will end up at 0
 static bool initialized = false;
 
+// Statistics of the queue selected by the queueMon.select parameter
+static uint8_t selectedQueue = 0;
+static qmStats_t selected;
+
 static void timerHandler(xTimerHandle timer);
 static void debugPrint();
 static bool filter(Data* queueData);
 static void debugPrintQueue(Data* queueData);
 static Data* getQueueData(xQueueHandle* xQueue);
-static int getMaxWaiting(xQueueHandle* xQueue, int prevPeak);
 static void resetCounters();
 
 unsigned char ucQueueGetQueueNumber( xQueueHandle xQueue );
@@ -76,16 +86,31 @@ void queueMonitorInit() {
 
   data[0].fileName = "Na";
   data[0].queueName = "Na";
+  for (int i = 0; i < MAX_NR_OF_QUEUES; i++) {
+    qmStatsInit(&data[i].stats);
+  }
 
   initialized = true;
 }
 
+// The trace hooks are called from within the critical section of the queue
+// operation, the queue can not change under our feet
+
+// Unregistered queues, and semaphores, share slot 0. Only their failed sends
+// are counted, items of different queues can not be told apart.
+
 void qm_traceQUEUE_SEND(void* xQueue) {
-  if(initialized) {
+  if(initialized && uxQueueGetQueueNumber(xQueue) != 0) {
     Data* queueData = getQueueData(xQueue);
 
-    queueData->sendCount++;
-    queueData->maxWaiting = getMaxWaiting(xQueue, queueData->maxWaiting);
+    // We get here before the current item is added to the queue. A send to a
+    // full queue can only be an xQueueOverwrite(), it replaces the newest item.
+    const uint32_t waiting = uxQueueMessagesWaitingFromISR(xQueue);
+    if (waiting >= queueData->length) {
+      qmStatsOnOverwrite(&queueData->stats, (uint32_t)usecTimestamp(), waiting);
+    } else {
+      qmStatsOnSend(&queueData->stats, (uint32_t)usecTimestamp(), waiting);
+    }
   }
 }
 
@@ -93,7 +118,15 @@ void qm_traceQUEUE_SEND_FAILED(void* xQueue) {
   if(initialized) {
     Data* queueData = getQueueData(xQueue);
 
-    queueData->fullCount++;
+    qmStatsOnSendFailed(&queueData->stats);
+  }
+}
+
+void qm_traceQUEUE_RECEIVE(void* xQueue) {
+  if(initialized && uxQueueGetQueueNumber(xQueue) != 0) {
+    Data* queueData = getQueueData(xQueue);
+
+    qmStatsOnReceive(&queueData->stats, (uint32_t)usecTimestamp());
   }
 }
 
@@ -104,28 +137,34 @@ void qmRegisterQueue(xQueueHandle* xQueue, char* fileName, char* queueName) {
 
   queueData->fileName = fileName;
   queueData->queueName = queueName;
+  queueData->length = uxQueueMessagesWaiting(xQueue) + uxQueueSpacesAvailable(xQueue);
   vQueueSetQueueNumber(xQueue, nrOfQueues);
 
+  DEBUG_PRINT("%s:%s is queue %i\n", fileName, queueName, nrOfQueues);
+
   nrOfQueues++;
 }
 
+qmStats_t* qmRegisterStats(char* fileName, char* queueName) {
+  ASSERT(initialized);
+  ASSERT(nrOfQueues < MAX_NR_OF_QUEUES);
+  Data* queueData = &data[nrOfQueues];
+
+  queueData->fileName = fileName;
+  queueData->queueName = queueName;
+
+  DEBUG_PRINT("%s:%s is queue %i\n", fileName, queueName, nrOfQueues);
+
+  nrOfQueues++;
+  return &queueData->stats;
+}
+
 static Data* getQueueData(xQueueHandle* xQueue) {
   unsigned char number = uxQueueGetQueueNumber(xQueue);
   ASSERT(number < MAX_NR_OF_QUEUES);
   return &data[number];
 }
 
-static int getMaxWaiting(xQueueHandle* xQueue, int prevPeak) {
-  // We get here before the current item is added to the queue.
-  // Must add 1 to get the peak value.
-  unsigned portBASE_TYPE waiting = uxQueueMessagesWaitingFromISR(xQueue) + 1;
-
-  if (waiting > prevPeak) {
-    return waiting;
-  }
-  return prevPeak;
-}
-
 static void debugPrint() {
   int i = 0;
   for (i = 0; i < nrOfQueues; i++) {
@@ -143,7 +182,7 @@ static void debugPrint() {
 static bool filter(Data* queueData) {
   bool doDisplay = false;
   if (DISPLAY_ONLY_OVERFLOW_QUEUES) {
-    doDisplay = (queueData->fullCount != 0);
+    doDisplay = (queueData->stats.fullCount != 0);
   } else {
     doDisplay = true;
   }
@@ -151,24 +190,58 @@ static bool filter(Data* queueData) {
 }
 
 static void debugPrintQueue(Data* queueData) {
-  DEBUG_PRINT("%s:%s, sent: %i, peak: %i, full: %i\n",
-    queueData->fileName, queueData->queueName, queueData->sendCount,
-    queueData->maxWaiting, queueData->fullCount);
+  DEBUG_PRINT("%s:%s, sent: %i, peak: %i, full: %i, max wait: %i us\n",
+    queueData->fileName, queueData->queueName, (int)queueData->stats.sendCount,
+    queueData->stats.highWater, (int)queueData->stats.fullCount, (int)queueData->stats.maxWait);
 }
 
 static void resetCounters() {
   int i = 0;
+  taskENTER_CRITICAL();
   for (i = 0; i < nrOfQueues; i++) {
-    Data* queueData = &data[i];
-
-    queueData->sendCount = 0;
-    queueData->maxWaiting = 0;
-    queueData->fullCount = 0;
+    qmStatsResetCounters(&data[i].stats);
   }
+  taskEXIT_CRITICAL();
 }
 
 static void timerHandler(xTimerHandle timer) {
-  debugPrint();
+  static int ticks = 0;
+
+  if (selectedQueue < nrOfQueues) {
+    taskENTER_CRITICAL();
+    memcpy(&selected, &data[selectedQueue].stats, sizeof(selected));
+    taskEXIT_CRITICAL();
+  }
+
+  ticks++;
+  if (ticks >= DISPLAY_PERIOD_TICKS) {
+    ticks = 0;
+    debugPrint();
+  }
 }
 
+PARAM_GROUP_START(queueMon)
+PARAM_ADD(PARAM_UINT8, select, &selectedQueue)            // Queue in the queueMon log group, the numbers are printed when the queues are registered
+PARAM_GROUP_STOP(queueMon)
+
+/**
+ * Statistics of the queue selected by queueMon.select. Counters are reset
+ * every 10 s, after they are printed on the console.
+ */
+LOG_GROUP_START(queueMon)
+LOG_ADD(LOG_UINT32, sent, &selected.sendCount)            // Number of items sent
+LOG_ADD(LOG_UINT32, received, &selected.receiveCount)     // Number of items received
+LOG_ADD(LOG_UINT32, full, &selected.fullCount)            // Number of sends that failed since the queue was full
+LOG_ADD(LOG_UINT16, highWater, &selected.highWater)       // Highest number of items in the queue
+LOG_ADD(LOG_UINT32, maxWait, &selected.maxWait)           // Longest time an item waited in the queue - us
+LOG_ADD(LOG_UINT32, wait16us, &selected.histogram[0])     // Number of items that waited less than 16 us
+LOG_ADD(LOG_UINT32, wait64us, &selected.histogram[1])     // Number of items that waited 16 - 64 us
+LOG_ADD(LOG_UINT32, wait256us, &selected.histogram[2])    // Number of items that waited 64 - 256 us
+LOG_ADD(LOG_UINT32, wait1ms, &selected.histogram[3])      // Number of items that waited 256 - 1024 us
+LOG_ADD(LOG_UINT32, wait4ms, &selected.histogram[4])      // Number of items that waited 1.024 - 4.096 ms
+LOG_ADD(LOG_UINT32, wait16ms, &selected.histogram[5])     // Number of items that waited 4.096 - 16.384 ms
+LOG_ADD(LOG_UINT32, wait64ms, &selected.histogram[6])     // Number of items that waited 16.384 - 65.536 ms
+LOG_ADD(LOG_UINT32, waitMore, &selected.histogram[7])     // Number of items that waited 65.536 ms or more
+LOG_GROUP_STOP(queueMon)
+
 #endif // DEBUG_QUEUE_MONITOR
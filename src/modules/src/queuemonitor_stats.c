@@ -0,0 +1,145 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * queuemonitor_stats.c - Wait time and fill level statistics of a queue
+ */
+
+#include <string.h>
+
+#include "queuemonitor_stats.h"
+
+void qmStatsInit(qmStats_t* this) {
+  memset(this, 0, sizeof(qmStats_t));
+}
+
+void qmStatsResetCounters(qmStats_t* this) {
+  this->sendCount = 0;
+  this->fullCount = 0;
+  this->receiveCount = 0;
+  this->highWater = 0;
+  memset(this->histogram, 0, sizeof(this->histogram));
+  this->maxWait = 0;
+}
+
+static void dropOldest(qmStats_t* this) {
+  this->first = (uint8_t)((this->first + 1) % QM_STATS_TIMESTAMP_COUNT);
+  this->count--;
+}
+
+// Make the number of items we keep track of match the queue. If there are too
+// many, items were removed without being received and we assume the oldest
+// ones are gone. If there are too few, which should not happen, the items in
+// the queue are not measured.
+static void synchronize(qmStats_t* this, const uint32_t waiting) {
+  uint32_t known = this->count + this->untrackedCount;
+
+  while (known > waiting) {
+    if (this->untrackedCount > 0) {
+      // Untracked items are newer, but this is a guess anyway and they must
+      // go before the tracked items can be trusted
+      this->untrackedCount--;
+    } else {
+      dropOldest(this);
+    }
+    known--;
+  }
+
+  if (known < waiting) {
+    this->count = 0;
+    this->untrackedCount = waiting;
+  }
+}
+
+void qmStatsOnSend(qmStats_t* this, const uint32_t now, const uint32_t waiting) {
+  synchronize(this, waiting);
+
+  this->sendCount++;
+  if (waiting + 1 > this->highWater) {
+    this->highWater = (uint16_t)(waiting + 1);
+  }
+
+  // Once an item is untracked all items after it must be too, to keep the
+  // timestamps in the order of the items
+  if (this->untrackedCount > 0 || this->count == QM_STATS_TIMESTAMP_COUNT) {
+    this->untrackedCount++;
+    return;
+  }
+
+  const uint8_t index = (uint8_t)((this->first + this->count) % QM_STATS_TIMESTAMP_COUNT);
+  this->timestamps[index] = now;
+  this->count++;
+}
+
+void qmStatsOnOverwrite(qmStats_t* this, const uint32_t now, const uint32_t waiting) {
+  synchronize(this, waiting);
+
+  this->sendCount++;
+  if (waiting > this->highWater) {
+    this->highWater = (uint16_t)waiting;
+  }
+
+  if (this->untrackedCount > 0) {
+    // The newest item is untracked and stays so
+    return;
+  }
+
+  if (this->count == 0) {
+    // Nothing in the queue, it is a plain send
+    this->timestamps[this->first] = now;
+    this->count = 1;
+    return;
+  }
+
+  const uint8_t index = (uint8_t)((this->first + this->count - 1) % QM_STATS_TIMESTAMP_COUNT);
+  this->timestamps[index] = now;
+}
+
+void qmStatsOnSendFailed(qmStats_t* this) {
+  this->fullCount++;
+}
+
+void qmStatsOnReceive(qmStats_t* this, const uint32_t now) {
+  this->receiveCount++;
+
+  if (this->count > 0) {
+    const uint32_t wait = now - this->timestamps[this->first];
+    dropOldest(this);
+
+    this->histogram[qmStatsBucketOf(wait)]++;
+    if (wait > this->maxWait) {
+      this->maxWait = wait;
+    }
+  } else if (this->untrackedCount > 0) {
+    this->untrackedCount--;
+  }
+}
+
+int qmStatsBucketOf(const uint32_t wait) {
+  uint32_t limit = QM_STATS_FIRST_BUCKET_LIMIT;
+  int bucket = 0;
+  while (bucket < QM_STATS_BUCKET_COUNT - 1 && wait >= limit) {
+    limit <<= QM_STATS_BUCKET_SHIFT;
+    bucket++;
+  }
+  return bucket;
+}
@@ -31,14 +31,22 @@
 #include "range.h"
 #include "stabilizer_types.h"
 #include "estimator.h"
+#include "usec_time.h"
 
 static uint16_t ranges[RANGE_T_END] = {0,};
+static uint64_t timestamps[RANGE_T_END] = {0,};
 
 void rangeSet(rangeDirection_t direction, float range_m)
+{
+  rangeSetWithTimestamp(direction, range_m, usecTimestamp());
+}
+
+void rangeSetWithTimestamp(rangeDirection_t direction, float range_m, uint64_t timestamp)
 {
   if (direction > (RANGE_T_END-1)) return;
 
   ranges[direction] = range_m * 1000;
+  timestamps[direction] = timestamp;
 }
 
 float rangeGet(rangeDirection_t direction)
@@ -48,9 +56,17 @@ float rangeGet(rangeDirection_t direction)
   return ranges[direction];
 }
 
+uint64_t rangeGetTimestamp(rangeDirection_t direction)
+{
+  if (direction > (RANGE_T_END-1)) return 0;
+
+  return timestamps[direction];
+}
+
 bool rangeEnqueueDownRangeInEstimator(float distance, float stdDev, uint32_t timeStamp) {
   tofMeasurement_t tofData;
   tofData.timestamp = timeStamp;
+  tofData.timestampUs = usecTimestamp();
   tofData.distance = distance;
   tofData.stdDev = stdDev;
 
@@ -46,6 +46,7 @@
 #include "controller.h"
 #include "power_distribution.h"
 #include "collision_avoidance.h"
+#include "peer_broadcast.h"
 
 #include "estimator.h"
 #include "usddeck.h"
@@ -53,6 +54,7 @@
 #include "statsCnt.h"
 #include "static_mem.h"
 #include "rateSupervisor.h"
+#include "eventtrace.h"
 
 static bool isInit;
 static bool emergencyStop = false;
@@ -259,6 +261,7 @@ static void stabilizerTask(void* param)
   while(1) {
     // The sensor should unlock at 1kHz
     sensorsWaitDataReady();
+    EVENT_TRACE_BEGIN("stabilizer");
 
     if (startPropTest != false) {
       // TODO: What happens with estimator when we run tests after startup?
@@ -281,16 +284,21 @@ static void stabilizerTask(void* param)
         controllerType = getControllerType();
       }
 
+      EVENT_TRACE_BEGIN("estimator");
       stateEstimator(&state, &sensorData, &control, tick);
+      EVENT_TRACE_END("estimator");
       compressState();
 
       commanderGetSetpoint(&setpoint, &state);
       compressSetpoint();
+      peerBroadcastTellState(&state, &setpoint);
 
       sitAwUpdateSetpoint(&setpoint, &sensorData, &state);
       collisionAvoidanceUpdateSetpoint(&setpoint, &sensorData, &state, tick);
 
+      EVENT_TRACE_BEGIN("controller");
       controller(&control, &setpoint, &sensorData, &state, tick);
+      EVENT_TRACE_END("controller");
 
       checkEmergencyStopTimeout();
 
@@ -311,6 +319,7 @@ static void stabilizerTask(void* param)
     calcSensorToOutputLatency(&sensorData);
     tick++;
     STATS_CNT_RATE_EVENT(&stabilizerRate);
+    EVENT_TRACE_END("stabilizer");
 
     if (!rateSupervisorValidate(&rateSupervisorContext, xTaskGetTickCount())) {
       if (!rateWarningDisplayed) {
@@ -27,11 +27,13 @@
 #define DEBUG_MODULE "SYSLOAD"
 
 #include <stdbool.h>
+#include <string.h>
 #include "FreeRTOS.h"
 #include "timers.h"
 #include "debug.h"
 #include "cfassert.h"
 #include "param.h"
+#include "log.h"
 #include "static_mem.h"
 
 #include "sysload.h"
@@ -42,16 +44,54 @@ static void timerHandler(xTimerHandle timer);
 
 static bool initialized = false;
 static uint8_t triggerDump = 0;
+static uint8_t isSamplingEnabled = 0;
+
+#define NOT_WATCHED 0xff
 
 typedef struct {
   uint32_t ulRunTimeCounter;
-  uint32_t xTaskNumber;
+  bool isSeen;
+  uint8_t watchedIndex;
 } taskData_t;
 
+// Tasks with load and stack exposed as log variables
+enum {
+  WATCHED_STABILIZER,
+  WATCHED_SENSORS,
+  WATCHED_KALMAN,
+  WATCHED_LIGHTHOUSE,
+  WATCHED_USDLOG,
+  WATCHED_USDWRITE,
+  WATCHED_CRTP_TX,
+  WATCHED_CRTP_RX,
+  WATCHED_IDLE,
+  WATCHED_COUNT,
+};
+
+static const char* const watchedTaskNames[WATCHED_COUNT] = {
+  [WATCHED_STABILIZER] = STABILIZER_TASK_NAME,
+  [WATCHED_SENSORS] = SENSORS_TASK_NAME,
+  [WATCHED_KALMAN] = KALMAN_TASK_NAME,
+  [WATCHED_LIGHTHOUSE] = LIGHTHOUSE_TASK_NAME,
+  [WATCHED_USDLOG] = USDLOG_TASK_NAME,
+  [WATCHED_USDWRITE] = USDWRITE_TASK_NAME,
+  [WATCHED_CRTP_TX] = CRTP_TX_TASK_NAME,
+  [WATCHED_CRTP_RX] = CRTP_RX_TASK_NAME,
+  [WATCHED_IDLE] = "IDLE",
+};
+
+// Load in 0.01% of the total time in the last period and stack left at peak
+// usage in words. Both are 0 for tasks that are not running.
+static uint16_t watchedLoad[WATCHED_COUNT];
+static uint16_t watchedStack[WATCHED_COUNT];
+
+// Indexed by the task number, which FreeRTOS assigns in creation order
 #define TASK_MAX_COUNT 32
 NO_DMA_CCM_SAFE_ZERO_INIT static taskData_t previousSnapshot[TASK_MAX_COUNT];
-static int taskTopIndex = 0;
+NO_DMA_CCM_SAFE_ZERO_INIT static TaskStatus_t taskStats[TASK_MAX_COUNT];
 static uint32_t previousTotalRunTime = 0;
+// Tasks left out of a sample because there are more than TASK_MAX_COUNT
+static uint32_t skippedTaskCount = 0;
 
 static StaticTimer_t timerBuffer;
 
@@ -65,59 +105,120 @@ void sysLoadInit() {
 }
 
 
-static taskData_t* getPreviousTaskData(uint32_t xTaskNumber) {
-  // Try to find the task in the list of tasks
-  for (int i = 0; i < taskTopIndex; i++) {
-    if (previousSnapshot[i].xTaskNumber == xTaskNumber) {
-      return &previousSnapshot[i];
+static uint8_t findWatchedIndex(const char* taskName) {
+  for (int i = 0; i < WATCHED_COUNT; i++) {
+    // Task names are truncated to configMAX_TASK_NAME_LEN - 1 characters
+    if (strncmp(taskName, watchedTaskNames[i], configMAX_TASK_NAME_LEN - 1) == 0) {
+      return i;
     }
   }
 
-  // Allocate a new entry
-  ASSERT(taskTopIndex < TASK_MAX_COUNT);
-  taskData_t* result = &previousSnapshot[taskTopIndex];
-  result->xTaskNumber = xTaskNumber;
+  return NOT_WATCHED;
+}
+
+static taskData_t* getPreviousTaskData(const TaskStatus_t* stats) {
+  // Task numbers are never reused, a task created after others were deleted
+  // may be out of range
+  if (stats->xTaskNumber >= TASK_MAX_COUNT) {
+    return NULL;
+  }
+
+  taskData_t* result = &previousSnapshot[stats->xTaskNumber];
 
-  taskTopIndex++;
+  if (!result->isSeen) {
+    result->watchedIndex = findWatchedIndex(stats->pcTaskName);
+    result->isSeen = true;
+  }
 
   return result;
 }
 
 static void timerHandler(xTimerHandle timer) {
-  if (triggerDump != 0) {
-    uint32_t totalRunTime;
+  if (isSamplingEnabled == 0 && triggerDump == 0) {
+    return;
+  }
 
-    TaskStatus_t taskStats[TASK_MAX_COUNT];
-    uint32_t taskCount = uxTaskGetSystemState(taskStats, TASK_MAX_COUNT, &totalRunTime);
-    ASSERT(taskCount < TASK_MAX_COUNT);
+  uint32_t totalRunTime;
+  uint32_t taskCount = uxTaskGetSystemState(taskStats, TASK_MAX_COUNT, &totalRunTime);
+  if (taskCount == 0) {
+    // More tasks than fit in taskStats
+    skippedTaskCount += uxTaskGetNumberOfTasks();
+    return;
+  }
 
-    uint32_t totalDelta = totalRunTime - previousTotalRunTime;
-    float f = 100.0 / totalDelta;
+  uint32_t totalDelta = totalRunTime - previousTotalRunTime;
+  if (totalDelta == 0) {
+    return;
+  }
 
+  if (triggerDump != 0) {
     // Dumps the the CPU load and stack usage for all tasks
-    // CPU usage is since last dump in % compared to total time spent in tasks. Note that time spent in interrupts will be included in measured time.
-    // Stack usage is displayed as nr of unused bytes at peak stack usage.
-
+    // CPU usage is since last sample in % compared to total time spent in tasks. Note that time spent in interrupts will be included in measured time.
+    // Stack usage is displayed as nr of unused words at peak stack usage.
     DEBUG_PRINT("Task dump\n");
     DEBUG_PRINT("Load\tStack left\tName\n");
-    for (uint32_t i = 0; i < taskCount; i++) {
-      TaskStatus_t* stats = &taskStats[i];
-      taskData_t* previousTaskData = getPreviousTaskData(stats->xTaskNumber);
+  }
+
+  memset(watchedLoad, 0, sizeof(watchedLoad));
+  memset(watchedStack, 0, sizeof(watchedStack));
 
-      uint32_t taskRunTime = stats->ulRunTimeCounter;
-      float load = f * (taskRunTime - previousTaskData->ulRunTimeCounter);
-      DEBUG_PRINT("%.2f \t%u \t%s\n", (double)load, stats->usStackHighWaterMark, stats->pcTaskName);
+  for (uint32_t i = 0; i < taskCount; i++) {
+    TaskStatus_t* stats = &taskStats[i];
+    taskData_t* previousTaskData = getPreviousTaskData(stats);
+    if (previousTaskData == NULL) {
+      skippedTaskCount++;
+      continue;
+    }
+
+    uint32_t taskRunTime = stats->ulRunTimeCounter;
+    uint32_t taskDelta = taskRunTime - previousTaskData->ulRunTimeCounter;
+    uint16_t load = (uint16_t)(((uint64_t)taskDelta * 10000) / totalDelta);
 
-      previousTaskData->ulRunTimeCounter = taskRunTime;
+    if (previousTaskData->watchedIndex != NOT_WATCHED) {
+      watchedLoad[previousTaskData->watchedIndex] = load;
+      watchedStack[previousTaskData->watchedIndex] = stats->usStackHighWaterMark;
     }
 
-    previousTotalRunTime = totalRunTime;
+    if (triggerDump != 0) {
+      DEBUG_PRINT("%u.%02u \t%u \t%s\n", load / 100, load % 100, stats->usStackHighWaterMark, stats->pcTaskName);
+    }
 
-    triggerDump = 0;
+    previousTaskData->ulRunTimeCounter = taskRunTime;
   }
+
+  previousTotalRunTime = totalRunTime;
+
+  triggerDump = 0;
 }
 
 
 PARAM_GROUP_START(system)
 PARAM_ADD(PARAM_UINT8, taskDump, &triggerDump)
+PARAM_ADD(PARAM_UINT8, taskLoadLog, &isSamplingEnabled)    // Sample task load and stack every second into the sysLoad log group, off by default
 PARAM_GROUP_STOP(system)
+
+/**
+ * Load (0.01 %) and stack left at peak usage (words) of some tasks, sampled
+ * every second when system.taskLoadLog is set. The load of the idle task is
+ * the CPU headroom.
+ */
+LOG_GROUP_START(sysLoad)
+LOG_ADD(LOG_UINT16, stabLoad, &watchedLoad[WATCHED_STABILIZER])
+LOG_ADD(LOG_UINT16, stabStack, &watchedStack[WATCHED_STABILIZER])
+LOG_ADD(LOG_UINT16, sensLoad, &watchedLoad[WATCHED_SENSORS])
+LOG_ADD(LOG_UINT16, sensStack, &watchedStack[WATCHED_SENSORS])
+LOG_ADD(LOG_UINT16, kalLoad, &watchedLoad[WATCHED_KALMAN])
+LOG_ADD(LOG_UINT16, kalStack, &watchedStack[WATCHED_KALMAN])
+LOG_ADD(LOG_UINT16, lhLoad, &watchedLoad[WATCHED_LIGHTHOUSE])
+LOG_ADD(LOG_UINT16, lhStack, &watchedStack[WATCHED_LIGHTHOUSE])
+LOG_ADD(LOG_UINT16, usdLoad, &watchedLoad[WATCHED_USDLOG])
+LOG_ADD(LOG_UINT16, usdStack, &watchedStack[WATCHED_USDLOG])
+LOG_ADD(LOG_UINT16, usdWLoad, &watchedLoad[WATCHED_USDWRITE])
+LOG_ADD(LOG_UINT16, usdWStack, &watchedStack[WATCHED_USDWRITE])
+LOG_ADD(LOG_UINT16, txLoad, &watchedLoad[WATCHED_CRTP_TX])
+LOG_ADD(LOG_UINT16, txStack, &watchedStack[WATCHED_CRTP_TX])
+LOG_ADD(LOG_UINT16, rxLoad, &watchedLoad[WATCHED_CRTP_RX])
+LOG_ADD(LOG_UINT16, rxStack, &watchedStack[WATCHED_CRTP_RX])
+LOG_ADD(LOG_UINT16, idleLoad, &watchedLoad[WATCHED_IDLE])
+LOG_ADD(LOG_UINT32, skipped, &skippedTaskCount)    // Tasks left out of the samples, there are more than the sampler can hold
+LOG_GROUP_STOP(sysLoad)
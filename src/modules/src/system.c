@@ -68,6 +68,9 @@
 #include "app.h"
 #include "static_mem.h"
 #include "peer_localization.h"
+#include "peer_broadcast.h"
+#include "tracelog.h"
+#include "eventtrace.h"
 #include "cfassert.h"
 
 #ifndef START_DISARMED
@@ -179,6 +182,11 @@ void systemTask(void *arg)
   systemInit();
   commInit();
   commanderInit();
+  peerBroadcastInit();
+  traceLogInit();
+#ifdef EVENT_TRACE
+  eventTraceInit();
+#endif
 
   StateEstimatorType estimator = anyEstimator;
   estimatorKalmanTaskInit();
@@ -202,6 +210,11 @@ void systemTask(void *arg)
   pass &= storageTest();
   pass &= commTest();
   pass &= commanderTest();
+  pass &= peerBroadcastTest();
+  pass &= traceLogTest();
+#ifdef EVENT_TRACE
+  pass &= eventTraceTest();
+#endif
   pass &= stabilizerTest();
   pass &= estimatorKalmanTaskTest();
   pass &= deckTest();
@@ -211,6 +224,9 @@ void systemTask(void *arg)
   pass &= cfAssertNormalStartTest();
   pass &= peerLocalizationTest();
 
+  // Restore persistent parameters now that all modules have set their defaults
+  paramStoredInit();
+
   //Start the firmware
   if(pass)
   {
@@ -0,0 +1,211 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * tracelog.c - Binary trace log with format strings resolved on the host
+ */
+
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "tracelog.h"
+#include "trace_ring.h"
+#include "crtp.h"
+#include "usddeck.h"
+#include "usec_time.h"
+#include "system.h"
+#include "log.h"
+#include "param.h"
+#include "static_mem.h"
+#include "config.h"
+
+#ifdef TRACE_LOG_ON_SEGGER_RTT
+#include "SEGGER_RTT.h"
+#endif
+
+// Size of the ring in 32 bit words, a power of 2
+#define TRACE_LOG_RING_SIZE 512
+
+#define TRACE_LOG_SINK_CRTP 0x01
+#define TRACE_LOG_SINK_RTT 0x02
+#define TRACE_LOG_SINK_USD 0x04
+
+#define TRACE_LOG_RTT_BUFFER_INDEX 1
+#define TRACE_LOG_RTT_BUFFER_SIZE 1024
+
+#define TRACE_LOG_CRTP_PAYLOAD_SIZE (CRTP_MAX_DATA_SIZE - TRACE_LOG_CRTP_HEADER_SIZE)
+
+#define TRACE_LOG_DRAIN_PERIOD_MS 10
+
+static bool isInit = false;
+
+static uint32_t ringBuffer[TRACE_LOG_RING_SIZE];
+static traceRing_t ring = TRACE_RING_INIT(ringBuffer, TRACE_LOG_RING_SIZE);
+
+// Records read from the ring, one drain at the time
+static uint32_t drainBuffer[TRACE_LOG_RING_SIZE / 4];
+
+static uint8_t sinks = TRACE_LOG_SINK_CRTP;
+
+static CRTPPacket txPacket;
+static uint8_t txLength;
+static uint8_t txSequence;
+
+#ifdef TRACE_LOG_ON_SEGGER_RTT
+static char rttBuffer[TRACE_LOG_RTT_BUFFER_SIZE];
+#endif
+
+// Statistics
+static uint32_t writeCount;
+static uint32_t dropCount;
+static uint32_t sentBytes;
+
+STATIC_MEM_TASK_ALLOC(traceLogTask, TRACE_LOG_TASK_STACKSIZE);
+
+static void traceLogTask(void *param);
+
+void traceLogInit()
+{
+  if (isInit) {
+    return;
+  }
+
+#ifdef TRACE_LOG_ON_SEGGER_RTT
+  SEGGER_RTT_ConfigUpBuffer(TRACE_LOG_RTT_BUFFER_INDEX, "trace", rttBuffer, sizeof(rttBuffer), SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+#endif
+
+  STATIC_MEM_TASK_CREATE(traceLogTask, traceLogTask, TRACE_LOG_TASK_NAME, NULL, TRACE_LOG_TASK_PRI);
+
+  isInit = true;
+}
+
+bool traceLogTest()
+{
+  return isInit;
+}
+
+void traceLogWrite(const uint32_t fmtId, const uint32_t* args, const uint32_t count)
+{
+  uint32_t words[1 + TRACE_LOG_MAX_ARGS];
+
+  words[0] = (uint32_t)usecTimestamp();
+  memcpy(&words[1], args, count * sizeof(uint32_t));
+
+  if (traceRingWrite(&ring, fmtId & TRACE_RING_TAG_MASK, words, 1 + count)) {
+    __atomic_fetch_add(&writeCount, 1, __ATOMIC_RELAXED);
+  }
+}
+
+static void crtpSinkFlush()
+{
+  txPacket.header = CRTP_HEADER(CRTP_PORT_TRACE, 0);
+  txPacket.size = TRACE_LOG_CRTP_HEADER_SIZE + txLength;
+  txPacket.data[0] = txSequence++;
+  crtpSendPacketBlock(&txPacket);
+  sentBytes += txPacket.size;
+
+  txPacket.data[1] = TRACE_LOG_CRTP_NO_RECORD_START;
+  txLength = 0;
+}
+
+// Pack the byte stream of records into packets and mark where the first
+// record starts, so that the host can resynchronize after a lost packet
+static void crtpSinkWrite(const uint32_t* records, const uint32_t wordCount)
+{
+  uint32_t index = 0;
+  while (index < wordCount) {
+    const uint32_t length = traceRingRecordLength(records[index]);
+    const uint8_t* bytes = (const uint8_t*)&records[index];
+    uint32_t byteCount = length * sizeof(uint32_t);
+
+    if (txPacket.data[1] == TRACE_LOG_CRTP_NO_RECORD_START) {
+      txPacket.data[1] = txLength;
+    }
+
+    while (byteCount > 0) {
+      uint32_t chunk = TRACE_LOG_CRTP_PAYLOAD_SIZE - txLength;
+      if (chunk > byteCount) {
+        chunk = byteCount;
+      }
+      memcpy(&txPacket.data[TRACE_LOG_CRTP_HEADER_SIZE + txLength], bytes, chunk);
+      txLength += chunk;
+      bytes += chunk;
+      byteCount -= chunk;
+
+      if (txLength == TRACE_LOG_CRTP_PAYLOAD_SIZE) {
+        crtpSinkFlush();
+      }
+    }
+
+    index += length;
+  }
+
+  // Do not keep a partial packet until the next drain
+  if (txLength > 0) {
+    crtpSinkFlush();
+  }
+}
+
+static void traceLogTask(void *param)
+{
+  systemWaitStart();
+
+  txPacket.data[1] = TRACE_LOG_CRTP_NO_RECORD_START;
+  uint32_t lastWakeTime = xTaskGetTickCount();
+
+  while (true) {
+    vTaskDelayUntil(&lastWakeTime, M2T(TRACE_LOG_DRAIN_PERIOD_MS));
+
+    uint32_t wordCount;
+    while ((wordCount = traceRingRead(&ring, drainBuffer, sizeof(drainBuffer) / sizeof(drainBuffer[0]))) > 0) {
+      const uint32_t byteCount = wordCount * sizeof(uint32_t);
+
+      if ((sinks & TRACE_LOG_SINK_CRTP) && crtpIsConnected()) {
+        crtpSinkWrite(drainBuffer, wordCount);
+      }
+
+#ifdef TRACE_LOG_ON_SEGGER_RTT
+      if (sinks & TRACE_LOG_SINK_RTT) {
+        SEGGER_RTT_Write(TRACE_LOG_RTT_BUFFER_INDEX, drainBuffer, byteCount);
+      }
+#endif
+
+      if (sinks & TRACE_LOG_SINK_USD) {
+        usddeckWriteTrace((const uint8_t*)drainBuffer, byteCount);
+      }
+    }
+
+    dropCount = ring.dropCount;
+  }
+}
+
+PARAM_GROUP_START(traceLog)
+PARAM_ADD(PARAM_UINT8, sink, &sinks)            // Bit mask of outputs: 1 - CRTP port 11, 2 - Segger RTT up buffer 1, 4 - uSD deck trcNN file
+PARAM_GROUP_STOP(traceLog)
+
+LOG_GROUP_START(traceLog)
+LOG_ADD(LOG_UINT32, written, &writeCount)       // Number of records written to the ring
+LOG_ADD(LOG_UINT32, dropped, &dropCount)        // Number of records dropped because the ring was full
+LOG_ADD(LOG_UINT32, crtpBytes, &sentBytes)      // Number of bytes sent over CRTP
+LOG_GROUP_STOP(traceLog)
@@ -0,0 +1,103 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * biquad_bank.h - Bank of cascaded biquad filters for multiple channels
+ */
+
+/**
+ * A bank filters up to BIQUAD_BANK_MAX_CHANNELS channels, for instance the 3
+ * gyro and 3 accelerometer axes, through the same number of cascaded second
+ * order sections. Coefficients and state are stored as a structure of arrays,
+ * indexed [stage][channel], so all channels of a stage are processed in one
+ * loop. Each section is a transposed direct form II biquad, the same structure
+ * as the CMSIS arm_biquad_cascade_df2T_f32(), but processing one sample of
+ * many channels instead of many samples of one channel.
+ *
+ * Each channel has its own coefficients. A stage that is not used by a channel
+ * is left as a pass through.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define BIQUAD_BANK_MAX_CHANNELS 6
+#define BIQUAD_BANK_MAX_STAGES 4
+
+typedef struct {
+  uint8_t channelCount;
+  uint8_t stageCount;
+
+  float b0[BIQUAD_BANK_MAX_STAGES][BIQUAD_BANK_MAX_CHANNELS];
+  float b1[BIQUAD_BANK_MAX_STAGES][BIQUAD_BANK_MAX_CHANNELS];
+  float b2[BIQUAD_BANK_MAX_STAGES][BIQUAD_BANK_MAX_CHANNELS];
+  float a1[BIQUAD_BANK_MAX_STAGES][BIQUAD_BANK_MAX_CHANNELS];
+  float a2[BIQUAD_BANK_MAX_STAGES][BIQUAD_BANK_MAX_CHANNELS];
+
+  float s1[BIQUAD_BANK_MAX_STAGES][BIQUAD_BANK_MAX_CHANNELS];
+  float s2[BIQUAD_BANK_MAX_STAGES][BIQUAD_BANK_MAX_CHANNELS];
+} biquadBank_t;
+
+/**
+ * Initialize a bank with all stages as pass through and zero state
+ *
+ * @param bank The bank
+ * @param channelCount Number of channels, up to BIQUAD_BANK_MAX_CHANNELS
+ * @param stageCount Number of cascaded sections, up to BIQUAD_BANK_MAX_STAGES
+ */
+void biquadBankInit(biquadBank_t* bank, const uint8_t channelCount, const uint8_t stageCount);
+
+/**
+ * Set a stage of a channel to a second order Butterworth low pass filter, the
+ * same filter as lpf2p. The state is not changed.
+ */
+void biquadBankSetLowPass(biquadBank_t* bank, const uint8_t channel, const uint8_t stage, const float sampleFreq, const float cutoffFreq);
+
+/**
+ * Set a stage of a channel to a notch filter. The state is not changed, so the
+ * center frequency can be moved while filtering.
+ *
+ * @param q Quality factor, center frequency / -3 dB bandwidth
+ */
+void biquadBankSetNotch(biquadBank_t* bank, const uint8_t channel, const uint8_t stage, const float sampleFreq, const float centerFreq, const float q);
+
+/**
+ * Set a stage of a channel to pass through
+ */
+void biquadBankSetPassThrough(biquadBank_t* bank, const uint8_t channel, const uint8_t stage);
+
+/**
+ * Set the state of a channel as if the input had been constant at value
+ */
+void biquadBankResetChannel(biquadBank_t* bank, const uint8_t channel, const float value);
+
+/**
+ * Filter one sample of all channels
+ *
+ * A channel that produces a non finite value is reset and outputs its input,
+ * so that a bad sample does not propagate through the filter.
+ *
+ * @param bank The bank
+ * @param samples One sample per channel, replaced by the filtered values
+ */
+void biquadBankApply(biquadBank_t* bank, float* samples);
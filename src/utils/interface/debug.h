@@ -35,6 +35,10 @@
   #include "SEGGER_RTT.h"
 #endif
 
+#ifdef DEBUG_PRINT_ON_TRACE_LOG
+  #include "tracelog.h"
+#endif
+
 #ifdef DEBUG_MODULE
 #define DEBUG_FMT(fmt) DEBUG_MODULE ": " fmt
 #endif
@@ -58,6 +62,9 @@ void debugInit(void);
 #elif defined(DEBUG_PRINT_ON_SEGGER_RTT)
   #define DEBUG_PRINT(fmt, ...) SEGGER_RTT_printf(0, fmt, ## __VA_ARGS__)
   #define DEBUG_PRINT_OS(fmt, ...) SEGGER_RTT_printf(0, fmt, ## __VA_ARGS__)
+#elif defined(DEBUG_PRINT_ON_TRACE_LOG)
+  #define DEBUG_PRINT(fmt, ...) TRACE_PRINT(DEBUG_FMT(fmt), ##__VA_ARGS__)
+  #define DEBUG_PRINT_OS(fmt, ...) TRACE_PRINT(DEBUG_FMT(fmt), ##__VA_ARGS__)
 #else // Debug using radio or USB
   #define DEBUG_PRINT(fmt, ...) consolePrintf(DEBUG_FMT(fmt), ##__VA_ARGS__)
 #define DEBUG_PRINT_OS(fmt, ...) consolePrintf(DEBUG_FMT(fmt), ##__VA_ARGS__)
@@ -0,0 +1,116 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * dynamic_notch.h - Gyro spectrum analysis for dynamic notch filtering
+ */
+
+/**
+ * Tracks the dominant noise peaks, typically from the motors and propellers,
+ * in the gyro signal. The samples of each axis are decimated into a sliding
+ * window of DYNAMIC_NOTCH_FFT_SIZE samples. Every DYNAMIC_NOTCH_HOP decimated
+ * samples the window of one axis, in turn, is Hann weighted and transformed
+ * with the CMSIS real FFT. The strongest local maxima in the frequency range
+ * [minFreq, maxFreq] that are well above the noise floor (the median power of
+ * the range) are interpolated to a fraction of a bin and smoothed over time.
+ *
+ * The tracked peaks are used to move notch filters in a biquad bank.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "arm_math.h"
+#include "biquad_bank.h"
+
+#define DYNAMIC_NOTCH_AXES 3
+#define DYNAMIC_NOTCH_FFT_SIZE 128
+#define DYNAMIC_NOTCH_MAX_PEAKS 2
+// Decimated samples between two analyses, each analysis covers one axis
+#define DYNAMIC_NOTCH_HOP 8
+// Number of analyses of an axis without a matching peak before a peak is dropped
+#define DYNAMIC_NOTCH_MAX_MISSES 10
+
+typedef struct {
+  // Configuration, may be changed at any time
+  float minFreq;
+  float maxFreq;
+  // Required ratio between the power of a peak and the median power of the range
+  float threshold;
+  // Weight of a new estimate in the smoothed peak frequency, 0 - 1
+  float smoothing;
+
+  float sampleFreq;
+  float binWidth;
+  uint8_t decimation;
+
+  uint8_t decimationCount;
+  float decimationSum[DYNAMIC_NOTCH_AXES];
+
+  float samples[DYNAMIC_NOTCH_AXES][DYNAMIC_NOTCH_FFT_SIZE];
+  uint16_t writeIndex;
+  uint16_t sampleCount;
+  uint8_t hopCount;
+  uint8_t nextAxis;
+
+  float window[DYNAMIC_NOTCH_FFT_SIZE];
+  arm_rfft_fast_instance_f32 fft;
+  float fftIn[DYNAMIC_NOTCH_FFT_SIZE];
+  float fftOut[DYNAMIC_NOTCH_FFT_SIZE];
+  float power[DYNAMIC_NOTCH_FFT_SIZE / 2 + 1];
+
+  // Smoothed peak frequencies (Hz), 0 when no peak is tracked
+  float peakFreq[DYNAMIC_NOTCH_AXES][DYNAMIC_NOTCH_MAX_PEAKS];
+  uint8_t missCount[DYNAMIC_NOTCH_AXES][DYNAMIC_NOTCH_MAX_PEAKS];
+} dynamicNotch_t;
+
+/**
+ * Initialize the analysis
+ *
+ * @param this The analysis
+ * @param inputSampleFreq Rate of the samples passed to dynamicNotchAddSample()
+ * @param decimation Number of input samples averaged into one analysed sample
+ */
+void dynamicNotchInit(dynamicNotch_t* this, const float inputSampleFreq, const uint8_t decimation);
+
+/**
+ * Add one sample for all axes. When an analysis is due it is run before
+ * returning, at most one axis per call.
+ *
+ * @param this The analysis
+ * @param sample One sample per axis
+ * @return The axis that has updated peak frequencies, or -1
+ */
+int dynamicNotchAddSample(dynamicNotch_t* this, const float sample[DYNAMIC_NOTCH_AXES]);
+
+/**
+ * Move the notch filters of one channel of a bank to the tracked peaks of an
+ * axis. Stage firstStage + n is used for peak n, stages of peaks that are not
+ * tracked are set to pass through.
+ *
+ * @param bankSampleFreq The sample rate of the bank
+ * @param q Quality factor of the notches
+ */
+void dynamicNotchRetune(const dynamicNotch_t* this, const int axis, biquadBank_t* bank, const uint8_t channel,
+                        const uint8_t firstStage, const float bankSampleFreq, const float q);
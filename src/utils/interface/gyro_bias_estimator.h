@@ -0,0 +1,100 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * gyro_bias_estimator.h - Streaming gyro bias estimation
+ */
+
+/**
+ * Estimates the gyro bias from a stream of samples in O(1) time and memory.
+ *
+ * The mean and variance of each axis are estimated with the Welford
+ * recurrence. For the first windowSize samples this is the exact mean and
+ * variance of all samples, after that old samples are exponentially
+ * forgotten with a time constant of windowSize samples.
+ *
+ * The platform is considered still when the variance of all axes is below
+ * the threshold. The first time the platform is still, after at least
+ * minSampleCount samples, the bias is set to the mean. After that the bias
+ * follows the mean slowly whenever the platform is still and the mean is
+ * close to the bias, to track thermal drift without absorbing slow
+ * rotations. A steady rotation in flight can look the same as drift, so
+ * tracking can be disabled while flying.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define GYRO_BIAS_ESTIMATOR_AXES 3
+
+typedef struct {
+  // Configuration
+  float windowSize;
+  uint32_t minSampleCount;
+  // Max variance of a still platform
+  float varianceThreshold;
+  // Weight of the mean in the bias, per sample, when tracking drift
+  float trackingRate;
+  // Max difference between the mean and the bias when tracking drift
+  float maxTrackingOffset;
+  bool isTrackingEnabled;
+
+  uint32_t sampleCount;
+  float mean[GYRO_BIAS_ESTIMATOR_AXES];
+  float variance[GYRO_BIAS_ESTIMATOR_AXES];
+
+  bool isStill;
+  bool isBiasFound;
+  float bias[GYRO_BIAS_ESTIMATOR_AXES];
+} gyroBiasEstimator_t;
+
+/**
+ * Initialize the estimator. The tracking rate defaults to 1 / (2 * windowSize)
+ * and the max tracking offset to 5 standard deviations at the variance
+ * threshold, they may be changed after init.
+ *
+ * @param this The estimator
+ * @param windowSize Number of samples the mean and variance are estimated over
+ * @param minSampleCount Number of samples needed before the first bias is set
+ * @param varianceThreshold Max variance, in squared sample units, of a still platform
+ */
+void gyroBiasEstimatorInit(gyroBiasEstimator_t* this, const float windowSize, const uint32_t minSampleCount, const float varianceThreshold);
+
+/**
+ * Enable or disable tracking of the drift once the bias is found. Tracking is
+ * enabled after init. The first bias is set regardless.
+ *
+ * @param this The estimator
+ * @param enabled true to track the drift
+ */
+void gyroBiasEstimatorSetTracking(gyroBiasEstimator_t* this, const bool enabled);
+
+/**
+ * Add a sample and update the bias
+ *
+ * @param this The estimator
+ * @param sample One sample per axis
+ * @return true if the bias has been found
+ */
+bool gyroBiasEstimatorAdd(gyroBiasEstimator_t* this, const float sample[GYRO_BIAS_ESTIMATOR_AXES]);
@@ -44,3 +44,13 @@ bool kveDelete(kveMemory_t *kve, char* key);
 void kveFormat(kveMemory_t *kve);
 
 bool kveCheck(kveMemory_t *kve);
+
+/** Build the RAM index of the table, if the memory has one
+ *
+ * After a successful build, lookups are done in RAM and the item chain in
+ * memory is not walked anymore. The index is kept up to date by all kve
+ * functions.
+ *
+ * Return true if the index is valid
+ */
+bool kveBuildIndex(kveMemory_t *kve);
@@ -0,0 +1,102 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--´  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * kve_cache.h - Write-back RAM cache for kve memories
+ *
+ */
+
+/**
+ * The cache keeps a RAM copy of a memory. Blocks are loaded from the backing
+ * memory the first time they are accessed, writes only modify the RAM copy
+ * and mark the written pages as dirty. kveCacheFlush() writes all dirty pages
+ * back, consecutive dirty pages are written in one call.
+ *
+ * The cache is intended to be used in the read/write/flush functions of a
+ * kveMemory_t.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Write granularity, should match the page size of the backing memory
+#define KVE_CACHE_PAGE_SIZE (32)
+
+// Read granularity when loading the cache from the backing memory
+#define KVE_CACHE_BLOCK_SIZE (256)
+
+// Number of uint32_t needed to hold one bit per unit
+#define KVE_CACHE_BITFIELD_LENGTH(SIZE, UNIT) ((((SIZE) + (UNIT) - 1) / (UNIT) + 31) / 32)
+
+typedef struct {
+    uint8_t* data;
+    size_t size;
+
+    uint32_t* loadedBlocks;     // One bit per KVE_CACHE_BLOCK_SIZE
+    uint32_t* dirtyPages;       // One bit per KVE_CACHE_PAGE_SIZE
+
+    size_t (*backingRead)(size_t address, void* data, size_t length);
+    size_t (*backingWrite)(size_t address, const void* data, size_t length);
+
+    // Statistics
+    uint32_t loadCount;
+    uint32_t writeBackCount;
+} kveCache_t;
+
+/** Initialize a cache
+ *
+ * data must hold size bytes, loadedBlocks and dirtyPages must hold
+ * KVE_CACHE_BITFIELD_LENGTH(size, KVE_CACHE_BLOCK_SIZE) and
+ * KVE_CACHE_BITFIELD_LENGTH(size, KVE_CACHE_PAGE_SIZE) words.
+ */
+void kveCacheInit(kveCache_t* cache, uint8_t* data, size_t size, uint32_t* loadedBlocks, uint32_t* dirtyPages,
+                  size_t (*backingRead)(size_t address, void* data, size_t length),
+                  size_t (*backingWrite)(size_t address, const void* data, size_t length));
+
+/** Read from the cache, loading missing blocks from the backing memory
+ *
+ * Return the number of bytes read
+ */
+size_t kveCacheRead(kveCache_t* cache, size_t address, void* data, size_t length);
+
+/** Write to the cache, nothing is written to the backing memory until
+ * kveCacheFlush() is called
+ *
+ * Return the number of bytes written
+ */
+size_t kveCacheWrite(kveCache_t* cache, size_t address, const void* data, size_t length);
+
+/** Write all dirty pages to the backing memory
+ *
+ * Return true if all pages were written successfully. Pages that failed are
+ * kept dirty and will be written at the next flush.
+ */
+bool kveCacheFlush(kveCache_t* cache);
+
+/** Return true if there are pages that have not been written back
+ */
+bool kveCacheIsDirty(const kveCache_t* cache);
@@ -29,10 +29,33 @@
 #pragma once
 
 #include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    uint32_t keyHash;
+    uint16_t address;
+    uint16_t fullLength;    // 0 for unused slots
+    uint8_t keyLength;
+} kveIndexEntry_t;
+
+typedef struct {
+    kveIndexEntry_t* entries;
+    size_t capacity;        // Must be a power of 2
+    size_t count;
+    size_t endAddress;      // Address of the end tag of the table
+    bool isValid;           // False if the index does not reflect the memory content
+} kveIndex_t;
 
 typedef struct {
     size_t memorySize;
     size_t (*read)(size_t address, void* data, size_t length);
     size_t (*write)(size_t address, const void* data, size_t length);
+    // Called once at the end of each operation that modifies the memory. Writes
+    // may be buffered until then, but must be visible to reads right away.
     void (*flush)(void);
+
+    // Optional RAM index of the items in the memory, set to NULL to always
+    // search the table in memory
+    kveIndex_t* index;
 } kveMemory_t;
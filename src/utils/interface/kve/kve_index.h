@@ -0,0 +1,85 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--´  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * kve_index.h - RAM index of the items in a kve table
+ *
+ */
+
+/**
+ * The index maps a key to the address and length of its item so that a
+ * lookup does not have to walk the item chain in the memory. Keys are stored
+ * as hashes only, a candidate is always confirmed by comparing the key in
+ * memory. Like kve_storage, these functions are intended to be used
+ * internally by the kve module.
+ */
+
+#pragma once
+
+#include "kve/kve_common.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/** Initialize an index using the entries array as storage
+ *
+ * Capacity must be a power of 2. The index is not valid until it has been
+ * built or cleared.
+ */
+void kveIndexInit(kveIndex_t* index, kveIndexEntry_t* entries, size_t capacity);
+
+/** Empty the index and mark it valid for an empty table ending at endAddress
+ */
+void kveIndexClear(kveIndex_t* index, size_t endAddress);
+
+/** Walk the table in memory once and add all items to the index
+ *
+ * The index is marked invalid if the table is corrupted or if there are more
+ * items than the index can hold.
+ *
+ * Return true if the index is valid
+ */
+bool kveIndexBuild(kveMemory_t* kve, size_t firstItemAddress);
+
+uint32_t kveIndexHash(const char* key, size_t keyLength);
+
+/** Add an item to the index
+ *
+ * The index is marked invalid if it is full.
+ */
+bool kveIndexAdd(kveIndex_t* index, const char* key, size_t address, uint16_t fullLength);
+
+/** Remove the item located at address from the index
+ */
+void kveIndexRemove(kveIndex_t* index, const char* key, size_t address);
+
+/** Find an item by key
+ *
+ * Candidates with a matching hash are verified by reading the key from
+ * memory.
+ *
+ * Return the index entry of the item or NULL if the key is not in the table
+ */
+const kveIndexEntry_t* kveIndexFind(kveMemory_t* kve, const char* key);
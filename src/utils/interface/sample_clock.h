@@ -0,0 +1,100 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * sample_clock.h - Timestamps of samples from a sensor with its own clock
+ */
+
+/**
+ * Reconstructs the time of every sample of a sensor that samples on its own
+ * clock and buffers the samples, for instance in a FIFO, when only some of the
+ * samples come with a timestamp.
+ *
+ * Samples are identified by a running index. An anchor is the local time of
+ * one sample, typically taken in an interrupt that fires at a known fill level
+ * of the FIFO. The clock is a phase locked loop on the anchors: the time of
+ * the anchored sample and the sample period are moved part of the way towards
+ * the anchor, which filters out the interrupt latency jitter and tracks the
+ * tolerance of the sensor clock. Anchors that are off by more than half a
+ * period are rejected, unless a number of them in a row agree, which happens
+ * when samples have been lost.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SAMPLE_CLOCK_MAX_OUTLIERS 3
+
+typedef struct {
+  // Configuration
+  float nominalPeriod;
+  // Max relative deviation of the period from the nominal period
+  float maxDrift;
+  // Part of the anchor error corrected in the time and the period
+  float phaseGain;
+  float periodGain;
+
+  bool isAnchored;
+  uint32_t anchorIndex;
+  uint64_t anchorTimestamp;
+  float period;
+
+  uint8_t outlierCount;
+} sampleClock_t;
+
+/**
+ * Initialize the clock. The drift defaults to 5% and the gains to values that
+ * average over about 10 anchors, they may be changed after init.
+ *
+ * @param this The clock
+ * @param nominalPeriod Nominal sample period, in the unit of the timestamps
+ */
+void sampleClockInit(sampleClock_t* this, const float nominalPeriod);
+
+/**
+ * Drop the anchor, for instance when samples have been lost. The next anchor
+ * is used as is, the estimated period is kept.
+ *
+ * @param this The clock
+ */
+void sampleClockReset(sampleClock_t* this);
+
+/**
+ * Add the local time of a sample
+ *
+ * @param this The clock
+ * @param index Index of the sample
+ * @param timestamp Local time of the sample
+ * @return true if the anchor was used, false if it was rejected
+ */
+bool sampleClockAddAnchor(sampleClock_t* this, const uint32_t index, const uint64_t timestamp);
+
+/**
+ * Get the local time of a sample, before or after the last anchor
+ *
+ * @param this The clock
+ * @param index Index of the sample
+ * @return The timestamp, 0 if no anchor has been added
+ */
+uint64_t sampleClockTimestamp(const sampleClock_t* this, const uint32_t index);
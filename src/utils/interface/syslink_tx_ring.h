@@ -0,0 +1,87 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * syslink_tx_ring.h - Ring of encoded syslink frames waiting for the UART DMA
+ */
+
+/**
+ * Packets are encoded straight into a free frame of the ring, the checksum
+ * is computed while the data is copied, and the UART DMA sends the frames
+ * back to back from the ring. Sending a packet only blocks when all frames
+ * are queued.
+ *
+ * There is one producer at the time (the caller serializes them) and one
+ * consumer, the DMA interrupt.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "syslink.h"
+
+#define SYSLINK_TX_RING_FRAME_COUNT 3
+
+// Start bytes, type, length, data and checksum
+#define SYSLINK_TX_FRAME_SIZE (SYSLINK_MTU + 6)
+
+typedef struct {
+  uint8_t data[SYSLINK_TX_FRAME_SIZE];
+  uint8_t size;
+} syslinkTxFrame_t;
+
+typedef struct {
+  syslinkTxFrame_t frames[SYSLINK_TX_RING_FRAME_COUNT];
+  uint32_t head; // Next frame to fill, written by the producer
+  uint32_t tail; // Next frame to send, written by the consumer
+} syslinkTxRing_t;
+
+void syslinkTxRingInit(syslinkTxRing_t* this);
+
+/**
+ * Get the next free frame, it is not queued until syslinkTxRingCommit()
+ *
+ * @return The frame, or NULL if all frames are queued
+ */
+syslinkTxFrame_t* syslinkTxRingAcquire(syslinkTxRing_t* this);
+
+/**
+ * Queue the acquired frame
+ */
+void syslinkTxRingCommit(syslinkTxRing_t* this);
+
+/**
+ * Get the oldest queued frame, it stays queued until syslinkTxRingRelease()
+ *
+ * @return The frame, or NULL if no frame is queued
+ */
+syslinkTxFrame_t* syslinkTxRingPeek(syslinkTxRing_t* this);
+
+/**
+ * Free the oldest queued frame once it is sent
+ */
+void syslinkTxRingRelease(syslinkTxRing_t* this);
+
+/**
+ * Encode a packet into a frame in one pass
+ */
+void syslinkTxFrameEncode(syslinkTxFrame_t* frame, const SyslinkPacket* slp);
@@ -0,0 +1,91 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * trace_ring.h - Lock free ring buffer of variable length word records
+ */
+
+/**
+ * Any number of tasks and interrupts can write records, one task reads them.
+ * A record is a header word followed by up to TRACE_RING_MAX_LENGTH words.
+ *
+ * Writers reserve space by moving the head with a compare and swap, fill in
+ * the record and write the header last. The reader stops at a header that is
+ * not written yet, so records are always read complete and in the order they
+ * were reserved. Read words are cleared before the space is released.
+ *
+ * A record that does not fit is dropped and counted, writers never wait.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Header: bit 31 set, bits 24-30 number of words after the header, bits 0-23
+// free for the user
+#define TRACE_RING_HEADER_VALID 0x80000000
+#define TRACE_RING_LENGTH_SHIFT 24
+#define TRACE_RING_MAX_LENGTH 0x7f
+#define TRACE_RING_TAG_MASK 0x00ffffff
+
+typedef struct {
+  uint32_t* buffer;
+  uint32_t mask; // size in words - 1, the size must be a power of 2
+
+  uint32_t head; // Next word to reserve
+  uint32_t tail; // Next word to read
+
+  uint32_t dropCount;
+} traceRing_t;
+
+/**
+ * Static initializer, so that records can be written before any init code
+ * has run
+ */
+#define TRACE_RING_INIT(BUFFER, SIZE) { .buffer = (BUFFER), .mask = (SIZE) - 1, .head = 0, .tail = 0, .dropCount = 0 }
+
+/**
+ * Write a record
+ *
+ * @param tag User data of the header, 24 bits
+ * @param words The words of the record
+ * @param length Number of words, up to TRACE_RING_MAX_LENGTH
+ * @return false if the record was dropped
+ */
+bool traceRingWrite(traceRing_t* this, const uint32_t tag, const uint32_t* words, const uint32_t length);
+
+/**
+ * Read complete records, header included
+ *
+ * @param out Buffer for the records
+ * @param maxWords Size of the buffer
+ * @return Number of words read
+ */
+uint32_t traceRingRead(traceRing_t* this, uint32_t* out, const uint32_t maxWords);
+
+/**
+ * Get the number of words in a record, header included
+ */
+static inline uint32_t traceRingRecordLength(const uint32_t header) {
+  return 1 + ((header >> TRACE_RING_LENGTH_SHIFT) & TRACE_RING_MAX_LENGTH);
+}
@@ -0,0 +1,86 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * usb_stream_ring.h - Byte ring of length prefixed CRTP frames for USB streaming
+ */
+
+/**
+ * In USB streaming mode CRTP packets are written to this ring as
+ * [size][header][data...], where size is the CRTP packet size including the
+ * header. The USB IN endpoint sends what is in the ring in transfers of many
+ * frames, straight from the ring buffer, and the host sees one byte stream.
+ *
+ * One producer writes whole frames and one consumer, the USB interrupt, peeks
+ * a contiguous block and consumes it once the transfer is done.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+  uint8_t* buffer;
+  uint32_t mask;
+  uint32_t head; // Written by the producer
+  uint32_t tail; // Written by the consumer
+} usbStreamRing_t;
+
+/**
+ * @param buffer Storage for the ring
+ * @param size Size of buffer, must be a power of 2
+ */
+void usbStreamRingInit(usbStreamRing_t* this, uint8_t* buffer, const uint32_t size);
+
+/**
+ * Write a frame, all or nothing
+ *
+ * @return false if there is not room for the whole frame
+ */
+bool usbStreamRingWriteFrame(usbStreamRing_t* this, const uint8_t header, const uint8_t* data, const uint8_t size);
+
+/**
+ * Get the next contiguous block to send, without consuming it
+ *
+ * A block shorter than maxSize is trimmed to not be a multiple of
+ * packetSize, so that the transfer always ends with a short packet and the
+ * host does not wait for more data.
+ *
+ * @param data Set to the start of the block
+ * @param maxSize Max size of the block
+ * @param packetSize The max packet size of the endpoint
+ * @return The size of the block, 0 if the ring is empty
+ */
+uint32_t usbStreamRingPeek(usbStreamRing_t* this, uint8_t** data, const uint32_t maxSize, const uint32_t packetSize);
+
+/**
+ * Free a block that has been sent
+ */
+void usbStreamRingConsume(usbStreamRing_t* this, const uint32_t size);
+
+/**
+ * Drop everything in the ring, must be called by the consumer
+ */
+void usbStreamRingDiscard(usbStreamRing_t* this);
+
+uint32_t usbStreamRingUsed(usbStreamRing_t* this);
@@ -0,0 +1,142 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * biquad_bank.c - Bank of cascaded biquad filters for multiple channels
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "biquad_bank.h"
+#include "physicalConstants.h"
+
+void biquadBankInit(biquadBank_t* bank, const uint8_t channelCount, const uint8_t stageCount)
+{
+  memset(bank, 0, sizeof(biquadBank_t));
+  bank->channelCount = channelCount;
+  bank->stageCount = stageCount;
+
+  for (int stage = 0; stage < stageCount; stage++) {
+    for (int channel = 0; channel < channelCount; channel++) {
+      biquadBankSetPassThrough(bank, channel, stage);
+    }
+  }
+}
+
+static void setCoefficients(biquadBank_t* bank, const uint8_t channel, const uint8_t stage,
+                            const float b0, const float b1, const float b2, const float a1, const float a2)
+{
+  bank->b0[stage][channel] = b0;
+  bank->b1[stage][channel] = b1;
+  bank->b2[stage][channel] = b2;
+  bank->a1[stage][channel] = a1;
+  bank->a2[stage][channel] = a2;
+}
+
+void biquadBankSetLowPass(biquadBank_t* bank, const uint8_t channel, const uint8_t stage, const float sampleFreq, const float cutoffFreq)
+{
+  const float ohm = tanf(M_PI_F * cutoffFreq / sampleFreq);
+  const float c = 1.0f + 2.0f * cosf(M_PI_F / 4.0f) * ohm + ohm * ohm;
+  const float b0 = ohm * ohm / c;
+
+  setCoefficients(bank, channel, stage, b0, 2.0f * b0, b0,
+                  2.0f * (ohm * ohm - 1.0f) / c,
+                  (1.0f - 2.0f * cosf(M_PI_F / 4.0f) * ohm + ohm * ohm) / c);
+}
+
+void biquadBankSetNotch(biquadBank_t* bank, const uint8_t channel, const uint8_t stage, const float sampleFreq, const float centerFreq, const float q)
+{
+  const float omega = 2.0f * M_PI_F * centerFreq / sampleFreq;
+  const float alpha = sinf(omega) / (2.0f * q);
+  const float cosOmega = cosf(omega);
+  const float a0Inv = 1.0f / (1.0f + alpha);
+
+  setCoefficients(bank, channel, stage, a0Inv, -2.0f * cosOmega * a0Inv, a0Inv,
+                  -2.0f * cosOmega * a0Inv, (1.0f - alpha) * a0Inv);
+}
+
+void biquadBankSetPassThrough(biquadBank_t* bank, const uint8_t channel, const uint8_t stage)
+{
+  setCoefficients(bank, channel, stage, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+}
+
+void biquadBankResetChannel(biquadBank_t* bank, const uint8_t channel, const float value)
+{
+  float x = value;
+
+  for (int stage = 0; stage < bank->stageCount; stage++) {
+    const float b0 = bank->b0[stage][channel];
+    const float b1 = bank->b1[stage][channel];
+    const float b2 = bank->b2[stage][channel];
+    const float a1 = bank->a1[stage][channel];
+    const float a2 = bank->a2[stage][channel];
+
+    // Steady state output for a constant input is the DC gain times the input
+    const float y = x * (b0 + b1 + b2) / (1.0f + a1 + a2);
+    bank->s1[stage][channel] = y - b0 * x;
+    bank->s2[stage][channel] = b2 * x - a2 * y;
+    x = y;
+  }
+}
+
+void biquadBankApply(biquadBank_t* bank, float* samples)
+{
+  const int channelCount = bank->channelCount;
+  float value[BIQUAD_BANK_MAX_CHANNELS];
+
+  // The first stage reads from the samples, so that the input is kept until
+  // the output is known to be finite
+  const float* input = samples;
+
+  for (int stage = 0; stage < bank->stageCount; stage++) {
+    const float* restrict b0 = bank->b0[stage];
+    const float* restrict b1 = bank->b1[stage];
+    const float* restrict b2 = bank->b2[stage];
+    const float* restrict a1 = bank->a1[stage];
+    const float* restrict a2 = bank->a2[stage];
+    float* restrict s1 = bank->s1[stage];
+    float* restrict s2 = bank->s2[stage];
+
+    for (int channel = 0; channel < channelCount; channel++) {
+      const float x = input[channel];
+      const float y = b0[channel] * x + s1[channel];
+      s1[channel] = b1[channel] * x - a1[channel] * y + s2[channel];
+      s2[channel] = b2[channel] * x - a2[channel] * y;
+      value[channel] = y;
+    }
+
+    input = value;
+  }
+
+  // One check per channel for the whole cascade
+  for (int channel = 0; channel < channelCount; channel++) {
+    if (isfinite(input[channel])) {
+      samples[channel] = input[channel];
+    } else {
+      for (int stage = 0; stage < bank->stageCount; stage++) {
+        bank->s1[stage][channel] = 0.0f;
+        bank->s2[stage][channel] = 0.0f;
+      }
+    }
+  }
+}
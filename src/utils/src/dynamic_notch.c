@@ -0,0 +1,252 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * dynamic_notch.c - Gyro spectrum analysis for dynamic notch filtering
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "dynamic_notch.h"
+#include "physicalConstants.h"
+
+#define DEFAULT_MIN_FREQ 80.0f
+#define DEFAULT_MAX_FREQ_RATIO 0.45f
+#define DEFAULT_THRESHOLD 50.0f
+#define DEFAULT_SMOOTHING 0.3f
+
+#define BIN_COUNT (DYNAMIC_NOTCH_FFT_SIZE / 2)
+
+typedef struct {
+  float freq;
+  float power;
+} peak_t;
+
+void dynamicNotchInit(dynamicNotch_t* this, const float inputSampleFreq, const uint8_t decimation)
+{
+  memset(this, 0, sizeof(dynamicNotch_t));
+
+  this->decimation = decimation > 0 ? decimation : 1;
+  this->sampleFreq = inputSampleFreq / this->decimation;
+  this->binWidth = this->sampleFreq / DYNAMIC_NOTCH_FFT_SIZE;
+
+  this->minFreq = DEFAULT_MIN_FREQ;
+  this->maxFreq = DEFAULT_MAX_FREQ_RATIO * this->sampleFreq;
+  this->threshold = DEFAULT_THRESHOLD;
+  this->smoothing = DEFAULT_SMOOTHING;
+
+  for (int i = 0; i < DYNAMIC_NOTCH_FFT_SIZE; i++) {
+    this->window[i] = 0.5f - 0.5f * cosf(2.0f * M_PI_F * i / DYNAMIC_NOTCH_FFT_SIZE);
+  }
+
+  arm_rfft_fast_init_f32(&this->fft, DYNAMIC_NOTCH_FFT_SIZE);
+}
+
+static void computePowerSpectrum(dynamicNotch_t* this, const int axis)
+{
+  const float* samples = this->samples[axis];
+
+  // The oldest sample is at the write index
+  float mean = 0.0f;
+  for (int i = 0; i < DYNAMIC_NOTCH_FFT_SIZE; i++) {
+    mean += samples[i];
+  }
+  mean /= DYNAMIC_NOTCH_FFT_SIZE;
+
+  int index = this->writeIndex;
+  for (int i = 0; i < DYNAMIC_NOTCH_FFT_SIZE; i++) {
+    this->fftIn[i] = (samples[index] - mean) * this->window[i];
+    index = (index + 1) % DYNAMIC_NOTCH_FFT_SIZE;
+  }
+
+  arm_rfft_fast_f32(&this->fft, this->fftIn, this->fftOut, 0);
+
+  // The real parts of the DC and Nyquist bins are packed in the first two values
+  this->power[0] = this->fftOut[0] * this->fftOut[0];
+  this->power[BIN_COUNT] = this->fftOut[1] * this->fftOut[1];
+  arm_cmplx_mag_squared_f32(&this->fftOut[2], &this->power[1], BIN_COUNT - 1);
+}
+
+// Median of the power in [firstBin, lastBin], uses fftIn as scratch
+static float medianPower(dynamicNotch_t* this, const int firstBin, const int lastBin)
+{
+  float* sorted = this->fftIn;
+  const int count = lastBin - firstBin + 1;
+
+  for (int i = 0; i < count; i++) {
+    const float value = this->power[firstBin + i];
+    int j = i;
+    while (j > 0 && sorted[j - 1] > value) {
+      sorted[j] = sorted[j - 1];
+      j--;
+    }
+    sorted[j] = value;
+  }
+
+  return sorted[count / 2];
+}
+
+static int findPeaks(dynamicNotch_t* this, peak_t peaks[DYNAMIC_NOTCH_MAX_PEAKS])
+{
+  // Keep one bin on each side for the interpolation
+  int firstBin = (int)ceilf(this->minFreq / this->binWidth);
+  int lastBin = (int)floorf(this->maxFreq / this->binWidth);
+  if (firstBin < 2) {
+    firstBin = 2;
+  }
+  if (lastBin > BIN_COUNT - 2) {
+    lastBin = BIN_COUNT - 2;
+  }
+  if (lastBin - firstBin < 2) {
+    return 0;
+  }
+
+  const float* power = this->power;
+  const float minPower = this->threshold * medianPower(this, firstBin, lastBin);
+
+  // The strongest local maxima, sorted by decreasing power
+  int peakCount = 0;
+  for (int bin = firstBin; bin <= lastBin; bin++) {
+    const float p = power[bin];
+    if (p <= minPower || p <= power[bin - 1] || p < power[bin + 1]) {
+      continue;
+    }
+
+    int slot = peakCount;
+    while (slot > 0 && peaks[slot - 1].power < p) {
+      if (slot < DYNAMIC_NOTCH_MAX_PEAKS) {
+        peaks[slot] = peaks[slot - 1];
+      }
+      slot--;
+    }
+    if (slot < DYNAMIC_NOTCH_MAX_PEAKS) {
+      // Parabolic interpolation of the peak position
+      const float denominator = power[bin - 1] - 2.0f * p + power[bin + 1];
+      const float offset = denominator < 0.0f ? 0.5f * (power[bin - 1] - power[bin + 1]) / denominator : 0.0f;
+      peaks[slot].freq = (bin + offset) * this->binWidth;
+      peaks[slot].power = p;
+      if (peakCount < DYNAMIC_NOTCH_MAX_PEAKS) {
+        peakCount++;
+      }
+    }
+  }
+
+  return peakCount;
+}
+
+static void trackPeaks(dynamicNotch_t* this, const int axis, const peak_t* peaks, const int peakCount)
+{
+  float* tracked = this->peakFreq[axis];
+  bool updated[DYNAMIC_NOTCH_MAX_PEAKS] = {false};
+
+  // Strongest peak first, each peak follows the closest tracked peak. A free
+  // slot is only used if no tracked peak is within a few bins.
+  const float newPeakDistance = 4.0f * this->binWidth;
+  for (int i = 0; i < peakCount; i++) {
+    int best = -1;
+    float bestDistance = 0.0f;
+    for (int slot = 0; slot < DYNAMIC_NOTCH_MAX_PEAKS; slot++) {
+      if (updated[slot]) {
+        continue;
+      }
+      const float distance = tracked[slot] > 0.0f ? fabsf(peaks[i].freq - tracked[slot]) : newPeakDistance;
+      if (best < 0 || distance < bestDistance) {
+        best = slot;
+        bestDistance = distance;
+      }
+    }
+
+    if (tracked[best] > 0.0f) {
+      tracked[best] += this->smoothing * (peaks[i].freq - tracked[best]);
+    } else {
+      tracked[best] = peaks[i].freq;
+    }
+    this->missCount[axis][best] = 0;
+    updated[best] = true;
+  }
+
+  for (int slot = 0; slot < DYNAMIC_NOTCH_MAX_PEAKS; slot++) {
+    if (!updated[slot] && tracked[slot] > 0.0f) {
+      this->missCount[axis][slot]++;
+      if (this->missCount[axis][slot] > DYNAMIC_NOTCH_MAX_MISSES) {
+        tracked[slot] = 0.0f;
+        this->missCount[axis][slot] = 0;
+      }
+    }
+  }
+}
+
+int dynamicNotchAddSample(dynamicNotch_t* this, const float sample[DYNAMIC_NOTCH_AXES])
+{
+  for (int axis = 0; axis < DYNAMIC_NOTCH_AXES; axis++) {
+    this->decimationSum[axis] += sample[axis];
+  }
+
+  this->decimationCount++;
+  if (this->decimationCount < this->decimation) {
+    return -1;
+  }
+
+  // Averaging is a simple anti-aliasing filter for the decimation
+  const float scale = 1.0f / this->decimationCount;
+  for (int axis = 0; axis < DYNAMIC_NOTCH_AXES; axis++) {
+    this->samples[axis][this->writeIndex] = this->decimationSum[axis] * scale;
+    this->decimationSum[axis] = 0.0f;
+  }
+  this->decimationCount = 0;
+  this->writeIndex = (this->writeIndex + 1) % DYNAMIC_NOTCH_FFT_SIZE;
+
+  if (this->sampleCount < DYNAMIC_NOTCH_FFT_SIZE) {
+    this->sampleCount++;
+    return -1;
+  }
+
+  this->hopCount++;
+  if (this->hopCount < DYNAMIC_NOTCH_HOP) {
+    return -1;
+  }
+  this->hopCount = 0;
+
+  const int axis = this->nextAxis;
+  this->nextAxis = (this->nextAxis + 1) % DYNAMIC_NOTCH_AXES;
+
+  peak_t peaks[DYNAMIC_NOTCH_MAX_PEAKS];
+  computePowerSpectrum(this, axis);
+  const int peakCount = findPeaks(this, peaks);
+  trackPeaks(this, axis, peaks, peakCount);
+
+  return axis;
+}
+
+void dynamicNotchRetune(const dynamicNotch_t* this, const int axis, biquadBank_t* bank, const uint8_t channel,
+                        const uint8_t firstStage, const float bankSampleFreq, const float q)
+{
+  for (int i = 0; i < DYNAMIC_NOTCH_MAX_PEAKS; i++) {
+    const float freq = this->peakFreq[axis][i];
+    if (freq > 0.0f && freq < 0.5f * bankSampleFreq) {
+      biquadBankSetNotch(bank, channel, firstStage + i, bankSampleFreq, freq, q);
+    } else {
+      biquadBankSetPassThrough(bank, channel, firstStage + i);
+    }
+  }
+}
@@ -0,0 +1,108 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * gyro_bias_estimator.c - Streaming gyro bias estimation
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "gyro_bias_estimator.h"
+
+void gyroBiasEstimatorInit(gyroBiasEstimator_t* this, const float windowSize, const uint32_t minSampleCount, const float varianceThreshold)
+{
+  memset(this, 0, sizeof(gyroBiasEstimator_t));
+
+  this->windowSize = windowSize;
+  // The sample count stops at the window size
+  this->minSampleCount = fminf(minSampleCount, ceilf(windowSize));
+  this->varianceThreshold = varianceThreshold;
+  this->trackingRate = 1.0f / (2.0f * windowSize);
+  this->maxTrackingOffset = 5.0f * sqrtf(varianceThreshold);
+  this->isTrackingEnabled = true;
+}
+
+void gyroBiasEstimatorSetTracking(gyroBiasEstimator_t* this, const bool enabled)
+{
+  this->isTrackingEnabled = enabled;
+}
+
+static void updateMeanAndVariance(gyroBiasEstimator_t* this, const float sample[GYRO_BIAS_ESTIMATOR_AXES])
+{
+  if ((float)this->sampleCount < this->windowSize) {
+    this->sampleCount++;
+  }
+
+  // 1/n is Welford's recurrence for the mean and (population) variance of n
+  // samples, a constant weight forgets old samples exponentially
+  const float weight = 1.0f / (float)this->sampleCount;
+
+  for (int axis = 0; axis < GYRO_BIAS_ESTIMATOR_AXES; axis++) {
+    const float delta = sample[axis] - this->mean[axis];
+    this->mean[axis] += weight * delta;
+    this->variance[axis] = (1.0f - weight) * (this->variance[axis] + weight * delta * delta);
+  }
+}
+
+static bool isStill(const gyroBiasEstimator_t* this)
+{
+  for (int axis = 0; axis < GYRO_BIAS_ESTIMATOR_AXES; axis++) {
+    if (!(this->variance[axis] < this->varianceThreshold)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static void trackBias(gyroBiasEstimator_t* this)
+{
+  for (int axis = 0; axis < GYRO_BIAS_ESTIMATOR_AXES; axis++) {
+    if (fabsf(this->mean[axis] - this->bias[axis]) > this->maxTrackingOffset) {
+      return;
+    }
+  }
+
+  for (int axis = 0; axis < GYRO_BIAS_ESTIMATOR_AXES; axis++) {
+    this->bias[axis] += this->trackingRate * (this->mean[axis] - this->bias[axis]);
+  }
+}
+
+bool gyroBiasEstimatorAdd(gyroBiasEstimator_t* this, const float sample[GYRO_BIAS_ESTIMATOR_AXES])
+{
+  updateMeanAndVariance(this, sample);
+
+  this->isStill = this->sampleCount >= this->minSampleCount && isStill(this);
+  if (this->isStill) {
+    if (this->isBiasFound) {
+      if (this->isTrackingEnabled) {
+        trackBias(this);
+      }
+    } else {
+      memcpy(this->bias, this->mean, sizeof(this->bias));
+      this->isBiasFound = true;
+    }
+  }
+
+  return this->isBiasFound;
+}
@@ -1,6 +1,7 @@
 
 #include "kve/kve.h"
 #include "kve/kve_storage.h"
+#include "kve/kve_index.h"
 
 #include "debug.h"
 
@@ -22,9 +23,44 @@ static size_t min(size_t a, size_t b)
     }
 }
 
+static bool isIndexed(kveMemory_t *kve) {
+    return kve->index && kve->index->isValid;
+}
+
+static size_t findItem(kveMemory_t *kve, const char* key) {
+    if (isIndexed(kve)) {
+        const kveIndexEntry_t* entry = kveIndexFind(kve, key);
+        if (entry) {
+            return entry->address;
+        }
+        return KVE_STORAGE_INVALID_ADDRESS;
+    }
+
+    return kveStorageFindItemByKey(kve, FIRST_ITEM_ADDRESS, key);
+}
+
+static size_t findEnd(kveMemory_t *kve, size_t address) {
+    if (isIndexed(kve)) {
+        return kve->index->endAddress;
+    }
+
+    return kveStorageFindEnd(kve, address);
+}
+
+// Write item and end tag, keeps the index up to date
+static void writeItemAtEnd(kveMemory_t *kve, size_t itemAddress, const char* key, const void* buffer, size_t length) {
+    const size_t itemLength = kveStorageWriteItem(kve, itemAddress, key, buffer, length);
+    kveStorageWriteEnd(kve, itemAddress + itemLength);
+
+    if (isIndexed(kve)) {
+        kve->index->endAddress = itemAddress + itemLength;
+        kveIndexAdd(kve->index, key, itemAddress, itemLength);
+    }
+}
+
 // Utility function
 static bool appendItemToEnd(kveMemory_t *kve, size_t address, const char* key, const void* buffer, size_t length) {
-    size_t itemAddress = kveStorageFindEnd(kve, address);
+    size_t itemAddress = findEnd(kve, address);
  
     // If it is over the end of the memory, table corrupted
     // Do not write anything ...
@@ -35,17 +71,16 @@ static bool appendItemToEnd(kveMemory_t *kve, size_t address, const char* key, c
 
     // Test that there is enough space to write the item
     if ((itemAddress + sizeof(kveItemHeader_t) + strlen(key) + length + END_TAG_LENDTH) < kve->memorySize) {
-        itemAddress += kveStorageWriteItem(kve, itemAddress, key, buffer, length);
-        kveStorageWriteEnd(kve, itemAddress);
+        writeItemAtEnd(kve, itemAddress, key, buffer, length);
     } else {
         // Otherwise, defrag and try to insert again!
         kveDefrag(kve);
 
-        itemAddress = kveStorageFindEnd(kve, FIRST_ITEM_ADDRESS);
+        itemAddress = findEnd(kve, FIRST_ITEM_ADDRESS);
 
-        if ((itemAddress + sizeof(kveItemHeader_t) + strlen(key) + length + END_TAG_LENDTH) < kve->memorySize) {
-            itemAddress += kveStorageWriteItem(kve, itemAddress, key, buffer, length);
-            kveStorageWriteEnd(kve, itemAddress);
+        if (KVE_STORAGE_IS_VALID(itemAddress) &&
+            (itemAddress + sizeof(kveItemHeader_t) + strlen(key) + length + END_TAG_LENDTH) < kve->memorySize) {
+            writeItemAtEnd(kve, itemAddress, key, buffer, length);
         } else {
             // Memory full!
             DEBUG_PRINT("Error: memory full!");
@@ -87,16 +122,24 @@ void kveDefrag(kveMemory_t *kve) {
 
         holeAddress = holeAddress + lenghtToMove;
     }
+
+    kve->flush();
+
+    // Items have moved, the index has to be rebuilt
+    if (kve->index) {
+        kveIndexBuild(kve, FIRST_ITEM_ADDRESS);
+    }
 }
 
 bool kveStore(kveMemory_t *kve, char* key, const void* buffer, size_t length) {
     size_t itemAddress;
+    bool result = true;
 
     // Search if the key is already present in the table
-    itemAddress = kveStorageFindItemByKey(kve, FIRST_ITEM_ADDRESS, key);
+    itemAddress = findItem(kve, key);
     if (KVE_STORAGE_IS_VALID(itemAddress) == false) {
         // Item does not exit, find the end of the table to insert it
-        return appendItemToEnd(kve, FIRST_ITEM_ADDRESS, key, buffer, length);
+        result = appendItemToEnd(kve, FIRST_ITEM_ADDRESS, key, buffer, length);
     } else {
         // Item exist, verify that the data has the same size
         kveItemHeader_t currentItem = kveStorageGetItemInfo(kve, itemAddress);
@@ -104,18 +147,33 @@ bool kveStore(kveMemory_t *kve, char* key, const void* buffer, size_t length) {
         if (currentItem.full_length != newLength) {
             // If not, delete the item and find the end of the table
             kveStorageWriteHole(kve, itemAddress, currentItem.full_length);
-            return appendItemToEnd(kve, FIRST_ITEM_ADDRESS, key, buffer, length);
+            if (isIndexed(kve)) {
+                kveIndexRemove(kve->index, key, itemAddress);
+            }
+            result = appendItemToEnd(kve, FIRST_ITEM_ADDRESS, key, buffer, length);
         } else {
             kveStorageWriteItem(kve, itemAddress, key, buffer, length);
         }
     }
 
-    return true;
+    kve->flush();
+
+    return result;
 }
 
 
 size_t kveFetch(kveMemory_t *kve, const char* key, void* buffer, size_t bufferLength)
 {
+    if (isIndexed(kve)) {
+        // The index knows the item length, only the key and the data has to be read
+        const kveIndexEntry_t* entry = kveIndexFind(kve, key);
+        if (entry) {
+            kveItemHeader_t header = {.full_length = entry->fullLength, .key_length = entry->keyLength};
+            return kveStorageGetBuffer(kve, entry->address, header, buffer, bufferLength);
+        }
+        return 0;
+    }
+
     size_t itemAddress = kveStorageFindItemByKey(kve, FIRST_ITEM_ADDRESS, key);
 
     if (KVE_STORAGE_IS_VALID(itemAddress)) {
@@ -128,11 +186,15 @@ size_t kveFetch(kveMemory_t *kve, const char* key, void* buffer, size_t bufferLe
 }
 
 bool kveDelete(kveMemory_t *kve, char* key) {
-    size_t itemAddress = kveStorageFindItemByKey(kve, FIRST_ITEM_ADDRESS, key);
+    size_t itemAddress = findItem(kve, key);
 
     if (KVE_STORAGE_IS_VALID(itemAddress)) {
         kveItemHeader_t itemInfo = kveStorageGetItemInfo(kve, itemAddress);
         kveStorageWriteHole(kve, itemAddress, itemInfo.full_length);
+        kve->flush();
+        if (isIndexed(kve)) {
+            kveIndexRemove(kve->index, key, itemAddress);
+        }
         return true;
     }
 
@@ -143,6 +205,11 @@ void kveFormat(kveMemory_t *kve) {
     uint8_t version = KVE_VERSION;
     kve->write(VERSION_ADDRESS, &version, 1);
     kveStorageWriteEnd(kve, FIRST_ITEM_ADDRESS);
+    kve->flush();
+
+    if (kve->index) {
+        kveIndexClear(kve->index, FIRST_ITEM_ADDRESS);
+    }
 }
 
 bool kveCheck(kveMemory_t *kve) {
@@ -164,3 +231,18 @@ bool kveCheck(kveMemory_t *kve) {
 
     return true;
 }
+
+bool kveBuildIndex(kveMemory_t *kve) {
+    if (!kve->index) {
+        return false;
+    }
+
+    uint8_t version;
+    kve->read(VERSION_ADDRESS, &version, 1);
+    if (version != KVE_VERSION) {
+        kve->index->isValid = false;
+        return false;
+    }
+
+    return kveIndexBuild(kve, FIRST_ITEM_ADDRESS);
+}
@@ -0,0 +1,194 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--´  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * kve_cache.c - Write-back RAM cache for kve memories
+ *
+ */
+
+#include "kve/kve_cache.h"
+
+#include <string.h>
+
+static inline bool isBitSet(const uint32_t* bitfield, size_t bit)
+{
+    return (bitfield[bit / 32] & (1u << (bit % 32))) != 0;
+}
+
+static inline void setBit(uint32_t* bitfield, size_t bit)
+{
+    bitfield[bit / 32] |= (1u << (bit % 32));
+}
+
+static inline void clearBit(uint32_t* bitfield, size_t bit)
+{
+    bitfield[bit / 32] &= ~(1u << (bit % 32));
+}
+
+static size_t pageCount(const kveCache_t* cache)
+{
+    return (cache->size + KVE_CACHE_PAGE_SIZE - 1) / KVE_CACHE_PAGE_SIZE;
+}
+
+static size_t clipLength(const kveCache_t* cache, size_t address, size_t length)
+{
+    if (address >= cache->size) {
+        return 0;
+    }
+
+    if (length > (cache->size - address)) {
+        return cache->size - address;
+    }
+
+    return length;
+}
+
+// Make sure all blocks overlapping the range are present in RAM
+static bool loadRange(kveCache_t* cache, size_t address, size_t length)
+{
+    const size_t firstBlock = address / KVE_CACHE_BLOCK_SIZE;
+    const size_t lastBlock = (address + length - 1) / KVE_CACHE_BLOCK_SIZE;
+
+    for (size_t block = firstBlock; block <= lastBlock; block++) {
+        if (isBitSet(cache->loadedBlocks, block)) {
+            continue;
+        }
+
+        const size_t blockAddress = block * KVE_CACHE_BLOCK_SIZE;
+        const size_t blockLength = clipLength(cache, blockAddress, KVE_CACHE_BLOCK_SIZE);
+        if (cache->backingRead(blockAddress, &cache->data[blockAddress], blockLength) != blockLength) {
+            return false;
+        }
+
+        setBit(cache->loadedBlocks, block);
+        cache->loadCount++;
+    }
+
+    return true;
+}
+
+void kveCacheInit(kveCache_t* cache, uint8_t* data, size_t size, uint32_t* loadedBlocks, uint32_t* dirtyPages,
+                  size_t (*backingRead)(size_t address, void* data, size_t length),
+                  size_t (*backingWrite)(size_t address, const void* data, size_t length))
+{
+    cache->data = data;
+    cache->size = size;
+    cache->loadedBlocks = loadedBlocks;
+    cache->dirtyPages = dirtyPages;
+    cache->backingRead = backingRead;
+    cache->backingWrite = backingWrite;
+    cache->loadCount = 0;
+    cache->writeBackCount = 0;
+
+    memset(loadedBlocks, 0, KVE_CACHE_BITFIELD_LENGTH(size, KVE_CACHE_BLOCK_SIZE) * sizeof(uint32_t));
+    memset(dirtyPages, 0, KVE_CACHE_BITFIELD_LENGTH(size, KVE_CACHE_PAGE_SIZE) * sizeof(uint32_t));
+}
+
+size_t kveCacheRead(kveCache_t* cache, size_t address, void* data, size_t length)
+{
+    const size_t toRead = clipLength(cache, address, length);
+    if (toRead == 0) {
+        return 0;
+    }
+
+    if (!loadRange(cache, address, toRead)) {
+        return 0;
+    }
+
+    memcpy(data, &cache->data[address], toRead);
+
+    return toRead;
+}
+
+size_t kveCacheWrite(kveCache_t* cache, size_t address, const void* data, size_t length)
+{
+    const size_t toWrite = clipLength(cache, address, length);
+    if (toWrite == 0) {
+        return 0;
+    }
+
+    // Partially written pages are written back in full, the rest of the page
+    // must be valid
+    if (!loadRange(cache, address, toWrite)) {
+        return 0;
+    }
+
+    memcpy(&cache->data[address], data, toWrite);
+
+    const size_t lastPage = (address + toWrite - 1) / KVE_CACHE_PAGE_SIZE;
+    for (size_t page = address / KVE_CACHE_PAGE_SIZE; page <= lastPage; page++) {
+        setBit(cache->dirtyPages, page);
+    }
+
+    return toWrite;
+}
+
+bool kveCacheFlush(kveCache_t* cache)
+{
+    bool result = true;
+    const size_t pages = pageCount(cache);
+
+    size_t page = 0;
+    while (page < pages) {
+        if (!isBitSet(cache->dirtyPages, page)) {
+            page++;
+            continue;
+        }
+
+        // Write back runs of consecutive dirty pages in one go
+        size_t runEnd = page;
+        while ((runEnd < pages) && isBitSet(cache->dirtyPages, runEnd)) {
+            runEnd++;
+        }
+
+        const size_t address = page * KVE_CACHE_PAGE_SIZE;
+        const size_t length = clipLength(cache, address, (runEnd - page) * KVE_CACHE_PAGE_SIZE);
+
+        if (cache->backingWrite(address, &cache->data[address], length) == length) {
+            for (size_t i = page; i < runEnd; i++) {
+                clearBit(cache->dirtyPages, i);
+            }
+            cache->writeBackCount++;
+        } else {
+            result = false;
+        }
+
+        page = runEnd;
+    }
+
+    return result;
+}
+
+bool kveCacheIsDirty(const kveCache_t* cache)
+{
+    const size_t words = KVE_CACHE_BITFIELD_LENGTH(cache->size, KVE_CACHE_PAGE_SIZE);
+
+    for (size_t i = 0; i < words; i++) {
+        if (cache->dirtyPages[i] != 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
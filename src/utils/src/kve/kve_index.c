@@ -0,0 +1,211 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--´  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * kve_index.c - RAM index of the items in a kve table
+ *
+ */
+
+#include "kve/kve_index.h"
+#include "kve/kve_storage.h"
+
+#include <string.h>
+
+#define END_TAG (0xffffu)
+
+// FNV-1a
+#define HASH_OFFSET_BASIS (2166136261u)
+#define HASH_PRIME (16777619u)
+
+static inline size_t slotMask(const kveIndex_t* index)
+{
+    return index->capacity - 1;
+}
+
+static inline bool isUsed(const kveIndexEntry_t* entry)
+{
+    return entry->fullLength != 0;
+}
+
+void kveIndexInit(kveIndex_t* index, kveIndexEntry_t* entries, size_t capacity)
+{
+    index->entries = entries;
+    index->capacity = capacity;
+    index->count = 0;
+    index->endAddress = KVE_STORAGE_INVALID_ADDRESS;
+    index->isValid = false;
+
+    memset(entries, 0, sizeof(kveIndexEntry_t) * capacity);
+}
+
+void kveIndexClear(kveIndex_t* index, size_t endAddress)
+{
+    memset(index->entries, 0, sizeof(kveIndexEntry_t) * index->capacity);
+    index->count = 0;
+    index->endAddress = endAddress;
+    index->isValid = true;
+}
+
+uint32_t kveIndexHash(const char* key, size_t keyLength)
+{
+    uint32_t hash = HASH_OFFSET_BASIS;
+
+    for (size_t i = 0; i < keyLength; i++) {
+        hash ^= (uint8_t)key[i];
+        hash *= HASH_PRIME;
+    }
+
+    return hash;
+}
+
+static bool addEntry(kveIndex_t* index, uint32_t hash, uint8_t keyLength, size_t address, uint16_t fullLength)
+{
+    // Keep at least one free slot so that probing always terminates
+    if ((index->count + 1) >= index->capacity) {
+        index->isValid = false;
+        return false;
+    }
+
+    size_t slot = hash & slotMask(index);
+    while (isUsed(&index->entries[slot])) {
+        slot = (slot + 1) & slotMask(index);
+    }
+
+    kveIndexEntry_t* entry = &index->entries[slot];
+    entry->keyHash = hash;
+    entry->address = address;
+    entry->fullLength = fullLength;
+    entry->keyLength = keyLength;
+    index->count++;
+
+    return true;
+}
+
+bool kveIndexAdd(kveIndex_t* index, const char* key, size_t address, uint16_t fullLength)
+{
+    if (!index->isValid) {
+        return false;
+    }
+
+    const size_t keyLength = strlen(key);
+    return addEntry(index, kveIndexHash(key, keyLength), keyLength, address, fullLength);
+}
+
+void kveIndexRemove(kveIndex_t* index, const char* key, size_t address)
+{
+    if (!index->isValid) {
+        return;
+    }
+
+    const uint32_t hash = kveIndexHash(key, strlen(key));
+    size_t slot = hash & slotMask(index);
+
+    while (isUsed(&index->entries[slot])) {
+        if (index->entries[slot].address == address) {
+            break;
+        }
+        slot = (slot + 1) & slotMask(index);
+    }
+
+    if (!isUsed(&index->entries[slot])) {
+        return;
+    }
+
+    // Backward shift deletion, moves up entries from the same probe sequence
+    // to keep the table free of tombstones
+    size_t hole = slot;
+    size_t next = (hole + 1) & slotMask(index);
+    while (isUsed(&index->entries[next])) {
+        const size_t home = index->entries[next].keyHash & slotMask(index);
+        const bool canMove = ((next - home) & slotMask(index)) >= ((next - hole) & slotMask(index));
+        if (canMove) {
+            index->entries[hole] = index->entries[next];
+            hole = next;
+        }
+        next = (next + 1) & slotMask(index);
+    }
+
+    memset(&index->entries[hole], 0, sizeof(kveIndexEntry_t));
+    index->count--;
+}
+
+bool kveIndexBuild(kveMemory_t* kve, size_t firstItemAddress)
+{
+    kveIndex_t* index = kve->index;
+    char keyBuffer[255];
+
+    kveIndexClear(index, KVE_STORAGE_INVALID_ADDRESS);
+
+    size_t currentAddress = firstItemAddress;
+    while (currentAddress < (kve->memorySize - 2)) {
+        kveItemHeader_t header = kveStorageGetItemInfo(kve, currentAddress);
+
+        if (header.full_length == END_TAG) {
+            index->endAddress = currentAddress;
+            return index->isValid;
+        }
+
+        if (header.full_length < sizeof(header)) {
+            // Corrupted table
+            break;
+        }
+
+        if (header.key_length != 0) {
+            kveStorageGetKey(kve, currentAddress, header, keyBuffer, header.key_length);
+            if (!addEntry(index, kveIndexHash(keyBuffer, header.key_length), header.key_length, currentAddress, header.full_length)) {
+                return false;
+            }
+        }
+
+        currentAddress += header.full_length;
+    }
+
+    index->isValid = false;
+    return false;
+}
+
+const kveIndexEntry_t* kveIndexFind(kveMemory_t* kve, const char* key)
+{
+    const kveIndex_t* index = kve->index;
+    char keyBuffer[255];
+
+    const size_t keyLength = strlen(key);
+    const uint32_t hash = kveIndexHash(key, keyLength);
+
+    size_t slot = hash & slotMask(index);
+    while (isUsed(&index->entries[slot])) {
+        const kveIndexEntry_t* entry = &index->entries[slot];
+
+        if ((entry->keyHash == hash) && (entry->keyLength == keyLength)) {
+            kve->read(entry->address + sizeof(kveItemHeader_t), keyBuffer, keyLength);
+            if (memcmp(key, keyBuffer, keyLength) == 0) {
+                return entry;
+            }
+        }
+
+        slot = (slot + 1) & slotMask(index);
+    }
+
+    return NULL;
+}
@@ -53,8 +53,6 @@ int kveStorageWriteItem(kveMemory_t *kve, size_t address, const char* key, const
   kve->write(address + sizeof(header), key, header.key_length);
   kve->write(address + sizeof(header) + header.key_length, buffer, length);
 
-  kve->flush();
-
   return header.full_length;
 }
 
@@ -64,7 +62,6 @@ uint16_t kveStorageWriteHole(kveMemory_t *kve, size_t address, size_t full_lengt
   header.key_length = 0;
 
   kve->write(address, &header, sizeof(header));
-  kve->flush();
 
   return full_length;   
 }
@@ -74,8 +71,6 @@ uint16_t kveStorageWriteEnd(kveMemory_t *kve, size_t address) {
 
     kve->write(address, &endTag, 2);
 
-    kve->flush();
-
     return 2;
 }
 
@@ -93,8 +88,6 @@ void kveStorageMoveMemory(kveMemory_t *kve, size_t sourceAddress, size_t destina
         destinationAddress += moving;
         leftToMove -= moving;
     }
-
-    kve->flush();
 }
 
 size_t kveStorageFindItemByKey(kveMemory_t *kve, size_t address, const char * key) {
@@ -107,7 +100,7 @@ size_t kveStorageFindItemByKey(kveMemory_t *kve, size_t address, const char * ke
 
     while (currentAddress < (kve->memorySize - 3)) {
         kve->read(currentAddress, searchBuffer, 3);
-        length = searchBuffer[0] + (searchBuffer[1]<<8);
+        length = (uint8_t)searchBuffer[0] + ((uint8_t)searchBuffer[1] << 8);
         keyLength = searchBuffer[2];
 
         if (length == END_TAG) {
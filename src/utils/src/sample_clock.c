@@ -0,0 +1,99 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * sample_clock.c - Timestamps of samples from a sensor with its own clock
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "sample_clock.h"
+
+void sampleClockInit(sampleClock_t* this, const float nominalPeriod)
+{
+  memset(this, 0, sizeof(sampleClock_t));
+
+  this->nominalPeriod = nominalPeriod;
+  this->maxDrift = 0.05f;
+  this->phaseGain = 0.1f;
+  this->periodGain = 0.01f;
+
+  this->period = nominalPeriod;
+}
+
+void sampleClockReset(sampleClock_t* this)
+{
+  this->isAnchored = false;
+  this->outlierCount = 0;
+}
+
+static void anchor(sampleClock_t* this, const uint32_t index, const uint64_t timestamp)
+{
+  this->anchorIndex = index;
+  this->anchorTimestamp = timestamp;
+  this->outlierCount = 0;
+  this->isAnchored = true;
+}
+
+bool sampleClockAddAnchor(sampleClock_t* this, const uint32_t index, const uint64_t timestamp)
+{
+  if (!this->isAnchored) {
+    anchor(this, index, timestamp);
+    return true;
+  }
+
+  // Signed differences also handle anchors older than the current one
+  const int32_t sampleCount = (int32_t)(index - this->anchorIndex);
+  const float predicted = sampleCount * this->period;
+  const float error = (float)(int64_t)(timestamp - this->anchorTimestamp) - predicted;
+
+  if (fabsf(error) > 0.5f * this->period) {
+    this->outlierCount++;
+    if (this->outlierCount >= SAMPLE_CLOCK_MAX_OUTLIERS) {
+      // Samples have been lost or the clock was wrong, start over from here
+      anchor(this, index, timestamp);
+      return true;
+    }
+    return false;
+  }
+
+  const uint64_t anchorTimestamp = this->anchorTimestamp + (int64_t)lroundf(predicted + this->phaseGain * error);
+  if (sampleCount > 0) {
+    const float minPeriod = this->nominalPeriod * (1.0f - this->maxDrift);
+    const float maxPeriod = this->nominalPeriod * (1.0f + this->maxDrift);
+    this->period = fminf(fmaxf(this->period + this->periodGain * error / sampleCount, minPeriod), maxPeriod);
+  }
+  anchor(this, index, anchorTimestamp);
+
+  return true;
+}
+
+uint64_t sampleClockTimestamp(const sampleClock_t* this, const uint32_t index)
+{
+  if (!this->isAnchored) {
+    return 0;
+  }
+
+  const int32_t sampleCount = (int32_t)(index - this->anchorIndex);
+  return this->anchorTimestamp + (int64_t)lroundf(sampleCount * this->period);
+}
@@ -0,0 +1,86 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * syslink_tx_ring.c - Ring of encoded syslink frames waiting for the UART DMA
+ */
+
+#include <string.h>
+
+#include "syslink_tx_ring.h"
+
+void syslinkTxRingInit(syslinkTxRing_t* this) {
+  memset(this, 0, sizeof(syslinkTxRing_t));
+}
+
+syslinkTxFrame_t* syslinkTxRingAcquire(syslinkTxRing_t* this) {
+  const uint32_t tail = __atomic_load_n(&this->tail, __ATOMIC_ACQUIRE);
+  if (this->head - tail >= SYSLINK_TX_RING_FRAME_COUNT) {
+    return 0;
+  }
+
+  return &this->frames[this->head % SYSLINK_TX_RING_FRAME_COUNT];
+}
+
+void syslinkTxRingCommit(syslinkTxRing_t* this) {
+  __atomic_store_n(&this->head, this->head + 1, __ATOMIC_RELEASE);
+}
+
+syslinkTxFrame_t* syslinkTxRingPeek(syslinkTxRing_t* this) {
+  const uint32_t head = __atomic_load_n(&this->head, __ATOMIC_ACQUIRE);
+  if (head == this->tail) {
+    return 0;
+  }
+
+  return &this->frames[this->tail % SYSLINK_TX_RING_FRAME_COUNT];
+}
+
+void syslinkTxRingRelease(syslinkTxRing_t* this) {
+  __atomic_store_n(&this->tail, this->tail + 1, __ATOMIC_RELEASE);
+}
+
+void syslinkTxFrameEncode(syslinkTxFrame_t* frame, const SyslinkPacket* slp) {
+  uint8_t* out = frame->data;
+  uint8_t cksum0 = slp->type;
+  uint8_t cksum1 = slp->type;
+
+  cksum0 += slp->length;
+  cksum1 += cksum0;
+
+  *out++ = SYSLINK_START_BYTE1;
+  *out++ = SYSLINK_START_BYTE2;
+  *out++ = slp->type;
+  *out++ = slp->length;
+
+  const uint8_t* in = (const uint8_t*)slp->data;
+  for (int i = 0; i < slp->length; i++) {
+    const uint8_t byte = in[i];
+    *out++ = byte;
+    cksum0 += byte;
+    cksum1 += cksum0;
+  }
+
+  *out++ = cksum0;
+  *out++ = cksum1;
+
+  frame->size = (uint8_t)(out - frame->data);
+}
@@ -0,0 +1,83 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * trace_ring.c - Lock free ring buffer of variable length word records
+ */
+
+#include "trace_ring.h"
+
+bool traceRingWrite(traceRing_t* this, const uint32_t tag, const uint32_t* words, const uint32_t length) {
+  if (length > TRACE_RING_MAX_LENGTH) {
+    __atomic_fetch_add(&this->dropCount, 1, __ATOMIC_RELAXED);
+    return false;
+  }
+
+  const uint32_t recordLength = length + 1;
+  uint32_t start = __atomic_load_n(&this->head, __ATOMIC_RELAXED);
+  do {
+    const uint32_t tail = __atomic_load_n(&this->tail, __ATOMIC_ACQUIRE);
+    if (start - tail + recordLength > this->mask + 1) {
+      __atomic_fetch_add(&this->dropCount, 1, __ATOMIC_RELAXED);
+      return false;
+    }
+  } while (!__atomic_compare_exchange_n(&this->head, &start, start + recordLength, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+  for (uint32_t i = 0; i < length; i++) {
+    this->buffer[(start + 1 + i) & this->mask] = words[i];
+  }
+
+  // Publish the record
+  const uint32_t header = TRACE_RING_HEADER_VALID | (length << TRACE_RING_LENGTH_SHIFT) | (tag & TRACE_RING_TAG_MASK);
+  __atomic_store_n(&this->buffer[start & this->mask], header, __ATOMIC_RELEASE);
+
+  return true;
+}
+
+uint32_t traceRingRead(traceRing_t* this, uint32_t* out, const uint32_t maxWords) {
+  uint32_t count = 0;
+  uint32_t tail = this->tail;
+
+  while (true) {
+    const uint32_t header = __atomic_load_n(&this->buffer[tail & this->mask], __ATOMIC_ACQUIRE);
+    if ((header & TRACE_RING_HEADER_VALID) == 0) {
+      break;
+    }
+
+    const uint32_t recordLength = traceRingRecordLength(header);
+    if (count + recordLength > maxWords) {
+      break;
+    }
+
+    for (uint32_t i = 0; i < recordLength; i++) {
+      out[count + i] = this->buffer[(tail + i) & this->mask];
+      this->buffer[(tail + i) & this->mask] = 0;
+    }
+    count += recordLength;
+    tail += recordLength;
+
+    // Release the space, after it is cleared
+    __atomic_store_n(&this->tail, tail, __ATOMIC_RELEASE);
+  }
+
+  return count;
+}
@@ -0,0 +1,87 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie Firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * usb_stream_ring.c - Byte ring of length prefixed CRTP frames for USB streaming
+ */
+
+#include "usb_stream_ring.h"
+
+void usbStreamRingInit(usbStreamRing_t* this, uint8_t* buffer, const uint32_t size) {
+  this->buffer = buffer;
+  this->mask = size - 1;
+  this->head = 0;
+  this->tail = 0;
+}
+
+bool usbStreamRingWriteFrame(usbStreamRing_t* this, const uint8_t header, const uint8_t* data, const uint8_t size) {
+  const uint32_t tail = __atomic_load_n(&this->tail, __ATOMIC_ACQUIRE);
+  const uint32_t frameSize = (uint32_t)size + 2;
+  const uint32_t free = this->mask + 1 - (this->head - tail);
+  if (frameSize > free) {
+    return false;
+  }
+
+  uint32_t head = this->head;
+  this->buffer[head++ & this->mask] = (uint8_t)(size + 1);
+  this->buffer[head++ & this->mask] = header;
+  for (int i = 0; i < size; i++) {
+    this->buffer[head++ & this->mask] = data[i];
+  }
+
+  __atomic_store_n(&this->head, head, __ATOMIC_RELEASE);
+  return true;
+}
+
+uint32_t usbStreamRingPeek(usbStreamRing_t* this, uint8_t** data, const uint32_t maxSize, const uint32_t packetSize) {
+  const uint32_t head = __atomic_load_n(&this->head, __ATOMIC_ACQUIRE);
+  const uint32_t start = this->tail & this->mask;
+  const uint32_t toEnd = this->mask + 1 - start;
+
+  uint32_t size = head - this->tail;
+  if (size > toEnd) {
+    size = toEnd;
+  }
+  if (size > maxSize) {
+    size = maxSize;
+  }
+
+  if (size < maxSize && size > 1 && (size % packetSize) == 0) {
+    size--;
+  }
+
+  *data = &this->buffer[start];
+  return size;
+}
+
+void usbStreamRingConsume(usbStreamRing_t* this, const uint32_t size) {
+  __atomic_store_n(&this->tail, this->tail + size, __ATOMIC_RELEASE);
+}
+
+void usbStreamRingDiscard(usbStreamRing_t* this) {
+  const uint32_t head = __atomic_load_n(&this->head, __ATOMIC_ACQUIRE);
+  __atomic_store_n(&this->tail, head, __ATOMIC_RELEASE);
+}
+
+uint32_t usbStreamRingUsed(usbStreamRing_t* this) {
+  return __atomic_load_n(&this->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&this->tail, __ATOMIC_ACQUIRE);
+}
@@ -21,6 +21,7 @@ void arm_std_f32( float32_t * pSrc, uint32_t blockSize, float32_t * pResult) { *
 void arm_mean_f32( float32_t * pSrc, uint32_t blockSize, float32_t * pResult) { *pResult = 0.0; }
 
 #include "mock_estimator.h"
+#include "mock_usec_time.h"
 
 #include "freertosMocks.h"
 
@@ -75,6 +76,7 @@ void setUp(void) {
 
   locoDeckGetRangingState_IgnoreAndReturn(0);
   locoDeckSetRangingState_Ignore();
+  usecTimestampGetCapture_IgnoreAndReturn(0);
 }
 
 void testNormalMessageSequenceShouldGenerateDistance() {
@@ -0,0 +1,250 @@
+// File under test multiranger_scheduler.c
+#include "multiranger_scheduler.h"
+
+#include <string.h>
+#include "unity.h"
+
+// The VL53L1 API is too large for the mocking FW, we use a hand written fake
+// instead that simulates sensors running in timed ranging mode.
+
+#define SENSOR_COUNT 5
+
+typedef struct {
+  bool isStarted;
+  uint8_t dataReady;
+  int16_t range_mm;
+  uint8_t rangeStatus;
+  VL53L1_Error readyError;
+
+  VL53L1_DistanceModes distanceMode;
+  uint32_t timingBudget_us;
+  uint32_t interMeasurementPeriod_ms;
+
+  int startCount;
+  int stopCount;
+  int clearAndStartCount;
+  int readyPollCount;
+} fakeSensor_t;
+
+static VL53L1_Dev_t devs[SENSOR_COUNT];
+static VL53L1_Dev_t* devPointers[SENSOR_COUNT];
+static fakeSensor_t fakes[SENSOR_COUNT];
+
+static mrScheduler_t scheduler;
+
+static fakeSensor_t* fakeFor(VL53L1_DEV dev) {
+  return &fakes[dev - devs];
+}
+
+VL53L1_Error VL53L1_StopMeasurement(VL53L1_DEV dev) {
+  fakeFor(dev)->isStarted = false;
+  fakeFor(dev)->stopCount++;
+  return VL53L1_ERROR_NONE;
+}
+
+VL53L1_Error VL53L1_StartMeasurement(VL53L1_DEV dev) {
+  fakeFor(dev)->isStarted = true;
+  fakeFor(dev)->startCount++;
+  return VL53L1_ERROR_NONE;
+}
+
+VL53L1_Error VL53L1_ClearInterruptAndStartMeasurement(VL53L1_DEV dev) {
+  fakeFor(dev)->dataReady = 0;
+  fakeFor(dev)->clearAndStartCount++;
+  return VL53L1_ERROR_NONE;
+}
+
+VL53L1_Error VL53L1_SetDistanceMode(VL53L1_DEV dev, VL53L1_DistanceModes distanceMode) {
+  fakeFor(dev)->distanceMode = distanceMode;
+  return VL53L1_ERROR_NONE;
+}
+
+VL53L1_Error VL53L1_SetMeasurementTimingBudgetMicroSeconds(VL53L1_DEV dev, uint32_t budget) {
+  fakeFor(dev)->timingBudget_us = budget;
+  return VL53L1_ERROR_NONE;
+}
+
+VL53L1_Error VL53L1_SetInterMeasurementPeriodMilliSeconds(VL53L1_DEV dev, uint32_t period) {
+  fakeFor(dev)->interMeasurementPeriod_ms = period;
+  return VL53L1_ERROR_NONE;
+}
+
+VL53L1_Error VL53L1_GetMeasurementDataReady(VL53L1_DEV dev, uint8_t *pReady) {
+  fakeSensor_t* fake = fakeFor(dev);
+  fake->readyPollCount++;
+  *pReady = fake->dataReady;
+  return fake->readyError;
+}
+
+VL53L1_Error VL53L1_GetRangingMeasurementData(VL53L1_DEV dev, VL53L1_RangingMeasurementData_t *pData) {
+  memset(pData, 0, sizeof(VL53L1_RangingMeasurementData_t));
+  pData->RangeMilliMeter = fakeFor(dev)->range_mm;
+  pData->RangeStatus = fakeFor(dev)->rangeStatus;
+  return VL53L1_ERROR_NONE;
+}
+
+static void setSample(int index, int16_t range_mm) {
+  fakes[index].dataReady = 1;
+  fakes[index].range_mm = range_mm;
+  fakes[index].rangeStatus = VL53L1_RANGESTATUS_RANGE_VALID;
+}
+
+void setUp(void) {
+  memset(devs, 0, sizeof(devs));
+  memset(fakes, 0, sizeof(fakes));
+  for (int i = 0; i < SENSOR_COUNT; i++) {
+    devPointers[i] = &devs[i];
+  }
+
+  mrSchedulerInit(&scheduler, devPointers, SENSOR_COUNT);
+}
+
+void testThatStartStartsAllSensorsInTimedMode() {
+  // Fixture
+  // Test
+  mrSchedulerStart(&scheduler, 20000, 25);
+
+  // Assert
+  for (int i = 0; i < SENSOR_COUNT; i++) {
+    TEST_ASSERT_TRUE(fakes[i].isStarted);
+    TEST_ASSERT_TRUE(scheduler.sensors[i].isRunning);
+    TEST_ASSERT_EQUAL_INT(VL53L1_DISTANCEMODE_MEDIUM, fakes[i].distanceMode);
+    TEST_ASSERT_EQUAL_UINT32(20000, fakes[i].timingBudget_us);
+    TEST_ASSERT_EQUAL_UINT32(25, fakes[i].interMeasurementPeriod_ms);
+  }
+}
+
+void testThatPollWithoutReadySensorsReturnsNoUpdatesAndDoesNotBlock() {
+  // Fixture
+  mrSchedulerStart(&scheduler, 20000, 25);
+
+  // Test
+  uint32_t actual = mrSchedulerPoll(&scheduler, 1000);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(0, actual);
+  for (int i = 0; i < SENSOR_COUNT; i++) {
+    TEST_ASSERT_EQUAL_INT(1, fakes[i].readyPollCount);
+  }
+}
+
+void testThatPollReadsOnlyReadySensors() {
+  // Fixture
+  mrSchedulerStart(&scheduler, 20000, 25);
+  setSample(1, 1234);
+  setSample(3, 567);
+
+  // Test
+  uint32_t actual = mrSchedulerPoll(&scheduler, 1000);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32((1 << 1) | (1 << 3), actual);
+  TEST_ASSERT_EQUAL_UINT16(1234, scheduler.sensors[1].range_mm);
+  TEST_ASSERT_EQUAL_UINT16(567, scheduler.sensors[3].range_mm);
+  TEST_ASSERT_EQUAL_UINT32(0, scheduler.sensors[0].measurementCount);
+}
+
+void testThatSamplesAreTimestampedWithPollTime() {
+  // Fixture
+  mrSchedulerStart(&scheduler, 20000, 25);
+  setSample(0, 100);
+  mrSchedulerPoll(&scheduler, 1000);
+  setSample(4, 200);
+
+  // Test
+  mrSchedulerPoll(&scheduler, 3000);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT64(1000, scheduler.sensors[0].timestamp);
+  TEST_ASSERT_EQUAL_UINT64(3000, scheduler.sensors[4].timestamp);
+}
+
+void testThatSensorIsRearmedWithoutStopStart() {
+  // Fixture
+  mrSchedulerStart(&scheduler, 20000, 25);
+  setSample(2, 100);
+
+  // Test
+  mrSchedulerPoll(&scheduler, 1000);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(1, fakes[2].clearAndStartCount);
+  TEST_ASSERT_EQUAL_INT(1, fakes[2].startCount);
+  TEST_ASSERT_EQUAL_INT(1, fakes[2].stopCount);
+  TEST_ASSERT_EQUAL_UINT8(0, fakes[2].dataReady);
+}
+
+void testThatAllSensorsReachTheConfiguredRate() {
+  // Fixture
+  const uint32_t periodMs = 25;
+  const uint32_t pollMs = 2;
+  const uint32_t durationMs = 1000;
+  mrSchedulerStart(&scheduler, 20000, periodMs);
+
+  // Test
+  // Sensors finish samples with different phase offsets
+  for (uint32_t t = 0; t < durationMs; t += pollMs) {
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+      if (((t + i * 5) % periodMs) < pollMs) {
+        setSample(i, 1000);
+      }
+    }
+    mrSchedulerPoll(&scheduler, t * 1000);
+  }
+
+  // Assert
+  for (int i = 0; i < SENSOR_COUNT; i++) {
+    TEST_ASSERT_EQUAL_UINT32(durationMs / periodMs, scheduler.sensors[i].measurementCount);
+  }
+}
+
+void testThatNegativeRangeIsReportedAsZero() {
+  // Fixture
+  mrSchedulerStart(&scheduler, 20000, 25);
+  setSample(0, -3);
+
+  // Test
+  mrSchedulerPoll(&scheduler, 1000);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT16(0, scheduler.sensors[0].range_mm);
+}
+
+void testThatInvalidRangeStatusIsKept() {
+  // Fixture
+  mrSchedulerStart(&scheduler, 20000, 25);
+  setSample(0, 4000);
+  fakes[0].rangeStatus = VL53L1_RANGESTATUS_SIGNAL_FAIL;
+
+  // Test
+  uint32_t actual = mrSchedulerPoll(&scheduler, 1000);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(1, actual);
+  TEST_ASSERT_EQUAL_UINT8(VL53L1_RANGESTATUS_SIGNAL_FAIL, scheduler.sensors[0].rangeStatus);
+}
+
+void testThatCommunicationErrorIsCountedAndSkipped() {
+  // Fixture
+  mrSchedulerStart(&scheduler, 20000, 25);
+  setSample(0, 100);
+  fakes[0].readyError = VL53L1_ERROR_CONTROL_INTERFACE;
+
+  // Test
+  uint32_t actual = mrSchedulerPoll(&scheduler, 1000);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(0, actual);
+  TEST_ASSERT_EQUAL_UINT32(1, scheduler.sensors[0].errorCount);
+}
+
+void testThatSensorCountIsLimited() {
+  // Fixture
+  VL53L1_Dev_t* tooMany[MR_SCHEDULER_MAX_SENSORS + 2] = {0};
+
+  // Test
+  mrSchedulerInit(&scheduler, tooMany, MR_SCHEDULER_MAX_SENSORS + 2);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(MR_SCHEDULER_MAX_SENSORS, scheduler.sensorCount);
+}
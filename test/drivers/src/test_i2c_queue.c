@@ -0,0 +1,281 @@
+// File under test i2c_queue.c
+#include "i2c_queue.h"
+
+#include "unity.h"
+
+static I2cQueue queue;
+
+// Fake bus, the message on the bus and the transactions that are done
+static I2cMessage* onBus;
+static I2cTransaction* doneTransactions[4];
+static int doneCount;
+static int stopCount;
+
+static I2cMessage messagesA[2];
+static I2cMessage messagesB[1];
+static I2cMessage messagesC[1];
+static I2cTransaction transactionA;
+static I2cTransaction transactionB;
+static I2cTransaction transactionC;
+
+// Helpers
+static void submit(I2cTransaction* transaction);
+static void busCompleteMessage(const I2cStatus status);
+static void busStopGenerated();
+static void initTransaction(I2cTransaction* transaction, I2cMessage* messages, const uint32_t messageCount);
+
+
+void setUp(void) {
+  i2cQueueInit(&queue);
+  onBus = 0;
+  doneCount = 0;
+  stopCount = 0;
+
+  initTransaction(&transactionA, messagesA, 2);
+  initTransaction(&transactionB, messagesB, 1);
+  initTransaction(&transactionC, messagesC, 1);
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatSubmitOnIdleBusStartsFirstMessage() {
+  // Fixture
+  // Test
+  submit(&transactionA);
+
+  // Assert
+  TEST_ASSERT_EQUAL_PTR(&messagesA[0], onBus);
+  TEST_ASSERT_EQUAL_PTR(&transactionA, queue.transaction);
+}
+
+void testThatSubmitOnBusyBusDoesNotStartMessage() {
+  // Fixture
+  submit(&transactionA);
+
+  // Test
+  submit(&transactionB);
+
+  // Assert
+  TEST_ASSERT_EQUAL_PTR(&messagesA[0], onBus);
+  TEST_ASSERT_EQUAL_PTR(&transactionB, queue.head);
+}
+
+void testThatMessagesOfTransactionAreChained() {
+  // Fixture
+  submit(&transactionA);
+
+  // Test
+  busCompleteMessage(i2cAck);
+
+  // Assert
+  TEST_ASSERT_EQUAL_PTR(&messagesA[1], onBus);
+  TEST_ASSERT_EQUAL_INT(0, doneCount);
+  TEST_ASSERT_EQUAL_INT(0, stopCount);
+  TEST_ASSERT_EQUAL_INT(i2cAck, messagesA[0].status);
+}
+
+void testThatTransactionsAreDoneInOrder() {
+  // Fixture
+  submit(&transactionA);
+  submit(&transactionB);
+  submit(&transactionC);
+
+  // Test
+  busCompleteMessage(i2cAck);
+  busCompleteMessage(i2cAck);
+  busStopGenerated();
+  busCompleteMessage(i2cAck);
+  busStopGenerated();
+  busCompleteMessage(i2cAck);
+  busStopGenerated();
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(3, doneCount);
+  TEST_ASSERT_EQUAL_INT(3, stopCount);
+  TEST_ASSERT_EQUAL_PTR(&transactionA, doneTransactions[0]);
+  TEST_ASSERT_EQUAL_PTR(&transactionB, doneTransactions[1]);
+  TEST_ASSERT_EQUAL_PTR(&transactionC, doneTransactions[2]);
+  TEST_ASSERT_TRUE(transactionA.success);
+  TEST_ASSERT_TRUE(transactionC.success);
+  TEST_ASSERT_NULL(onBus);
+  TEST_ASSERT_NULL(queue.transaction);
+}
+
+void testThatBusIsStoppedWhenTransactionIsDone() {
+  // Fixture
+  submit(&transactionB);
+  submit(&transactionC);
+
+  // Test
+  busCompleteMessage(i2cAck);
+
+  // Assert
+  TEST_ASSERT_NULL(onBus);
+  TEST_ASSERT_EQUAL_INT(1, stopCount);
+  TEST_ASSERT_EQUAL_PTR(&transactionB, doneTransactions[0]);
+  TEST_ASSERT_TRUE(i2cQueueHasPending(&queue));
+}
+
+void testThatNextTransactionIsStartedAfterTheStop() {
+  // Fixture
+  submit(&transactionB);
+  submit(&transactionC);
+  busCompleteMessage(i2cAck);
+
+  // Test
+  busStopGenerated();
+
+  // Assert
+  TEST_ASSERT_EQUAL_PTR(&messagesC[0], onBus);
+  TEST_ASSERT_FALSE(i2cQueueHasPending(&queue));
+}
+
+void testThatChainStopsAtNack() {
+  // Fixture
+  submit(&transactionA);
+  submit(&transactionB);
+
+  // Test
+  busCompleteMessage(i2cNack);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(1, doneCount);
+  TEST_ASSERT_EQUAL_PTR(&transactionA, doneTransactions[0]);
+  TEST_ASSERT_FALSE(transactionA.success);
+  TEST_ASSERT_EQUAL_INT(i2cNack, messagesA[0].status);
+  TEST_ASSERT_NULL(onBus);
+  TEST_ASSERT_EQUAL_INT(1, stopCount);
+}
+
+void testThatCanceledPendingTransactionIsNotStarted() {
+  // Fixture
+  submit(&transactionB);
+  submit(&transactionA);
+  submit(&transactionC);
+
+  // Test
+  const bool actual = i2cQueueCancel(&queue, &transactionA);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+  busCompleteMessage(i2cAck);
+  busStopGenerated();
+  TEST_ASSERT_EQUAL_PTR(&messagesC[0], onBus);
+  busCompleteMessage(i2cAck);
+  TEST_ASSERT_EQUAL_INT(2, doneCount);
+  TEST_ASSERT_EQUAL_PTR(&transactionC, doneTransactions[1]);
+}
+
+void testThatCanceledLastTransactionUpdatesTail() {
+  // Fixture
+  submit(&transactionA);
+  submit(&transactionB);
+  i2cQueueCancel(&queue, &transactionB);
+
+  // Test
+  submit(&transactionC);
+
+  // Assert
+  TEST_ASSERT_EQUAL_PTR(&transactionC, queue.head);
+  TEST_ASSERT_EQUAL_PTR(&transactionC, queue.tail);
+}
+
+void testThatCanceledTransactionInProgressRestartsBus() {
+  // Fixture
+  submit(&transactionA);
+  submit(&transactionB);
+
+  // Test
+  const bool actual = i2cQueueCancel(&queue, &transactionA);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_NULL(i2cQueueStartNext(&queue));
+}
+
+void testThatLateMessageOfCanceledTransactionIsIgnored() {
+  // Fixture
+  submit(&transactionA);
+  submit(&transactionB);
+  i2cQueueCancel(&queue, &transactionA);
+
+  // Test
+  busCompleteMessage(i2cAck);
+
+  // Assert
+  TEST_ASSERT_NULL(onBus);
+  TEST_ASSERT_EQUAL_INT(0, doneCount);
+  TEST_ASSERT_FALSE(transactionA.isDone);
+}
+
+void testThatPendingTransactionIsStartedAfterRestart() {
+  // Fixture
+  submit(&transactionA);
+  submit(&transactionB);
+  i2cQueueCancel(&queue, &transactionA);
+
+  // Test
+  i2cQueueOnRestarted(&queue);
+
+  // Assert
+  TEST_ASSERT_EQUAL_PTR(&messagesB[0], i2cQueueStartNext(&queue));
+}
+
+void testThatCancelOfUnknownTransactionIsIgnored() {
+  // Fixture
+  submit(&transactionA);
+
+  // Test
+  const bool actual = i2cQueueCancel(&queue, &transactionB);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+  TEST_ASSERT_EQUAL_PTR(&transactionA, queue.transaction);
+  TEST_ASSERT_NULL(queue.head);
+}
+
+// Helpers ////////////////////////////////////////////////////////////////////
+
+static void submit(I2cTransaction* transaction) {
+  i2cQueueAdd(&queue, transaction);
+  I2cMessage* message = i2cQueueStartNext(&queue);
+  if (message) {
+    onBus = message;
+  }
+}
+
+static void busCompleteMessage(const I2cStatus status) {
+  I2cTransaction* done;
+  onBus = i2cQueueOnMessageDone(&queue, status, &done);
+  if (done) {
+    done->isDone = true;
+    doneTransactions[doneCount++] = done;
+  }
+  if (onBus == 0) {
+    stopCount++;
+  }
+}
+
+static void busStopGenerated() {
+  I2cMessage* message = i2cQueueStartNext(&queue);
+  if (message) {
+    onBus = message;
+  }
+}
+
+static void initTransaction(I2cTransaction* transaction, I2cMessage* messages, const uint32_t messageCount) {
+  transaction->messages = messages;
+  transaction->messageCount = messageCount;
+  transaction->callback = 0;
+  transaction->doneSemaphore = 0;
+  transaction->arg = 0;
+  transaction->isDone = false;
+  transaction->success = false;
+  transaction->next = 0;
+
+  for (uint32_t i = 0; i < messageCount; i++) {
+    messages[i].status = i2cAck;
+  }
+}
@@ -0,0 +1,265 @@
+// File under test collision_avoidance.c
+#include "collision_avoidance.h"
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include "unity.h"
+
+#define MAX_PEERS 100
+
+static collision_avoidance_params_t params;
+static collision_avoidance_state_t collisionState;
+static float otherPositions[3 * MAX_PEERS];
+static float workspace[7 * (MAX_PEERS + 6)];
+static state_t state;
+static uint32_t randomState;
+
+// Helpers
+static void updateToGoal(const int nOthers, const float x, const float y, const float z, setpoint_t* setpoint);
+static void setPeer(const int index, const float x, const float y, const float z);
+static int addRandomPeers(const int first, const int count, const float size, const float minDist);
+static float randomIn(const float min, const float max);
+static struct vec referenceWaypoint(const int nOthers, const struct vec goal);
+
+
+void setUp(void) {
+  params = (collision_avoidance_params_t){
+    .ellipsoidRadii = { .x = 0.3, .y = 0.3, .z = 0.9 },
+    .bboxMin = { .x = -FLT_MAX, .y = -FLT_MAX, .z = -FLT_MAX },
+    .bboxMax = { .x = FLT_MAX, .y = FLT_MAX, .z = FLT_MAX },
+    .horizonSecs = 1.0f,
+    .maxSpeed = 0.5f,
+    .sidestepThreshold = 0.25f,
+    .maxPeerLocAgeMillis = 5000,
+    .voronoiProjectionTolerance = 1e-5,
+    .voronoiProjectionMaxIters = 100,
+    .maxNeighbors = 0,
+  };
+
+  collisionState.lastFeasibleSetPosition = mkvec(NAN, NAN, NAN);
+  collisionState.neighborCount = 0;
+
+  memset(&state, 0, sizeof(state));
+  state.position.z = 1.0f;
+
+  randomState = 4711;
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatGoalIsUnchangedWithoutNeighbors() {
+  // Fixture
+  setpoint_t setpoint;
+
+  // Test
+  updateToGoal(0, 0.3f, 0.0f, 1.0f, &setpoint);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.3f, setpoint.position.x);
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.0f, setpoint.position.y);
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.0f, setpoint.position.z);
+}
+
+void testThatGoalIsLimitedByNearNeighbor() {
+  // Fixture
+  setpoint_t setpoint;
+  setPeer(0, 0.8f, 0.0f, 1.0f);
+
+  // Test
+  updateToGoal(1, 0.3f, 0.0f, 1.0f, &setpoint);
+
+  // Assert
+  // The cell wall is at half the distance minus the ellipsoid radius
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.1f, setpoint.position.x);
+  TEST_ASSERT_EQUAL_INT(1, collisionState.neighborCount);
+}
+
+void testThatFarNeighborsAreCulled() {
+  // Fixture
+  setpoint_t setpoint;
+  setPeer(0, 0.8f, 0.0f, 1.0f);
+  int nOthers = 1 + addRandomPeers(1, MAX_PEERS - 1, 50.0f, 5.0f);
+
+  // Test
+  updateToGoal(nOthers, 0.3f, 0.0f, 1.0f, &setpoint);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.1f, setpoint.position.x);
+  TEST_ASSERT_EQUAL_INT(1, collisionState.neighborCount);
+}
+
+void testThatNeighborWithFaceOutsideTheHorizonIsCulled() {
+  // Fixture
+  setpoint_t setpoint;
+  // Face at 1.1 m, further than the 0.5 m the box allows
+  setPeer(0, 2.8f, 0.0f, 1.0f);
+
+  // Test
+  updateToGoal(1, 0.3f, 0.0f, 1.0f, &setpoint);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(0, collisionState.neighborCount);
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.3f, setpoint.position.x);
+}
+
+void testThatNeighborWithFaceInsideTheHorizonIsKept() {
+  // Fixture
+  setpoint_t setpoint;
+  // Face at 0.4 m, inside the box
+  setPeer(0, 1.4f, 0.0f, 1.0f);
+
+  // Test
+  updateToGoal(1, 0.3f, 0.0f, 1.0f, &setpoint);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(1, collisionState.neighborCount);
+}
+
+void testThatNearestNeighborsAreKeptWhenLimited() {
+  // Fixture
+  setpoint_t setpoint;
+  params.maxNeighbors = 1;
+  setPeer(0, 1.2f, 0.0f, 1.0f);
+  setPeer(1, 0.8f, 0.0f, 1.0f);
+  setPeer(2, 1.0f, 0.0f, 1.0f);
+
+  // Test
+  updateToGoal(3, 0.3f, 0.0f, 1.0f, &setpoint);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(1, collisionState.neighborCount);
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.1f, setpoint.position.x);
+}
+
+void testThatCulledResultIsSameAsBruteForceReference() {
+  // Fixture
+  setpoint_t actual;
+  int nOthers = addRandomPeers(0, MAX_PEERS, 5.0f, 0.7f);
+  struct vec expected = referenceWaypoint(nOthers, mkvec(0.3f, 0.2f, 1.1f));
+
+  // Test
+  updateToGoal(nOthers, 0.3f, 0.2f, 1.1f, &actual);
+
+  // Assert
+  TEST_ASSERT_TRUE(collisionState.neighborCount > 0);
+  TEST_ASSERT_TRUE(collisionState.neighborCount < nOthers);
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, expected.x, actual.position.x);
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, expected.y, actual.position.y);
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, expected.z, actual.position.z);
+}
+
+void testThatCulledResultIsSameAsBruteForceReferenceWhenPositionsOverlapWorkspace() {
+  // Fixture
+  setpoint_t actual;
+  int nOthers = addRandomPeers(0, MAX_PEERS, 5.0f, 0.7f);
+  struct vec expected = referenceWaypoint(nOthers, mkvec(0.3f, 0.2f, 1.1f));
+  memcpy(workspace, otherPositions, sizeof(otherPositions));
+
+  // Test
+  memset(&actual, 0, sizeof(actual));
+  actual.mode.x = modeAbs;
+  actual.mode.y = modeAbs;
+  actual.mode.z = modeAbs;
+  actual.position.x = 0.3f;
+  actual.position.y = 0.2f;
+  actual.position.z = 1.1f;
+  collisionAvoidanceUpdateSetpointCore(&params, &collisionState, nOthers, workspace, workspace, &actual, NULL, &state);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, expected.x, actual.position.x);
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, expected.y, actual.position.y);
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, expected.z, actual.position.z);
+}
+
+// Helpers ////////////////////////////////////////////////////////////////////
+
+static void updateToGoal(const int nOthers, const float x, const float y, const float z, setpoint_t* setpoint) {
+  memset(setpoint, 0, sizeof(*setpoint));
+  setpoint->mode.x = modeAbs;
+  setpoint->mode.y = modeAbs;
+  setpoint->mode.z = modeAbs;
+  setpoint->position.x = x;
+  setpoint->position.y = y;
+  setpoint->position.z = z;
+
+  collisionAvoidanceUpdateSetpointCore(&params, &collisionState, nOthers, otherPositions, workspace, setpoint, NULL, &state);
+}
+
+static void setPeer(const int index, const float x, const float y, const float z) {
+  otherPositions[3 * index + 0] = x;
+  otherPositions[3 * index + 1] = y;
+  otherPositions[3 * index + 2] = z;
+}
+
+// Random peers in a cube of the given size centered around us, not closer than
+// minDist to us
+static int addRandomPeers(const int first, const int count, const float size, const float minDist) {
+  int index = first;
+  while (index < first + count) {
+    const float x = randomIn(-size / 2.0f, size / 2.0f);
+    const float y = randomIn(-size / 2.0f, size / 2.0f);
+    const float z = 1.0f + randomIn(-size / 2.0f, size / 2.0f);
+    const float dx = x - state.position.x;
+    const float dy = y - state.position.y;
+    const float dz = z - state.position.z;
+    if (sqrtf(dx * dx + dy * dy + dz * dz) >= minDist) {
+      setPeer(index, x, y, z);
+      index++;
+    }
+  }
+
+  return count;
+}
+
+static float randomIn(const float min, const float max) {
+  randomState = randomState * 1664525u + 1013904223u;
+  return min + (max - min) * (float)(randomState >> 8) / (float)(1 << 24);
+}
+
+// Brute force reference for a waypoint, with one cell row for every peer and
+// no neighbor limit. Same as collisionAvoidanceUpdateSetpointCore() without
+// culling, for a goal that is reachable.
+static struct vec referenceWaypoint(const int nOthers, const struct vec goal) {
+  static float A[3 * (MAX_PEERS + 6)];
+  static float B[MAX_PEERS + 6];
+  static float projectionWorkspace[3 * (MAX_PEERS + 6)];
+  const int nRows = nOthers + 6;
+
+  const struct vec radiiInv = veltrecip(params.ellipsoidRadii);
+  const struct vec ourPos = mkvec(state.position.x, state.position.y, state.position.z);
+  for (int i = 0; i < nOthers; i++) {
+    const struct vec toPeerStretched = veltmul(vsub(vloadf(otherPositions + 3 * i), ourPos), radiiInv);
+    const float dist = vmag(toPeerStretched);
+    const struct vec a = vdiv(veltmul(toPeerStretched, radiiInv), dist);
+    const float scale = 1.0f / vmag(a);
+    vstoref(vscl(scale, a), A + 3 * i);
+    B[i] = scale * (dist / 2.0f - 1.0f);
+  }
+
+  const float maxDist = params.horizonSecs * params.maxSpeed;
+  memset(A + 3 * nOthers, 0, 18 * sizeof(float));
+  for (int dim = 0; dim < 3; dim++) {
+    A[3 * (nOthers + dim) + dim] = 1.0f;
+    B[nOthers + dim] = fminf(maxDist, vindex(params.bboxMax, dim) - vindex(ourPos, dim));
+    A[3 * (nOthers + dim + 3) + dim] = -1.0f;
+    B[nOthers + dim + 3] = -fmaxf(-maxDist, vindex(params.bboxMin, dim) - vindex(ourPos, dim));
+  }
+
+  struct vec goalRelative = vsub(goal, ourPos);
+  const float rayScale = rayintersectpolytope(vzero(), goalRelative, A, B, nRows, NULL);
+  if (rayScale < 1.0f) {
+    const float distFromWall = rayScale * vmag(goalRelative);
+    if (distFromWall <= params.sidestepThreshold) {
+      const struct vec sidestepDir = vcross(goalRelative, mkvec(0.0f, 0.0f, 1.0f));
+      goalRelative = vadd(goalRelative, vscl(fsqr(1.0f - distFromWall / params.sidestepThreshold), sidestepDir));
+    }
+    goalRelative = vprojectpolytope(goalRelative, A, B, projectionWorkspace, nRows,
+      params.voronoiProjectionTolerance, params.voronoiProjectionMaxIters);
+  }
+
+  return vadd(ourPos, goalRelative);
+}
@@ -0,0 +1,156 @@
+// File under test collision_avoidance.c
+// @IGNORE_IF_NOT COLLISION_AVOIDANCE_BENCHMARK
+//
+// Timing of the neighbor cull in swarms of 10, 50 and 100 peers. Not part of
+// the normal unit tests since it depends on the host, run with
+// rake unit "DEFINES=-DCOLLISION_AVOIDANCE_BENCHMARK" FILES=test/modules/src/test_collision_avoidance_benchmark.c
+#include "collision_avoidance.h"
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+#include "unity.h"
+
+#define MAX_PEERS 100
+#define SWARM_SIZES 3
+#define ITERATIONS 2000
+
+// Same as the firmware default
+#define MAX_NEIGHBORS 6
+
+static collision_avoidance_params_t params;
+static collision_avoidance_state_t collisionState;
+static float otherPositions[3 * MAX_PEERS];
+static float workspace[7 * (MAX_PEERS + 6)];
+static state_t state;
+static uint32_t randomState;
+
+static const int swarmSizes[SWARM_SIZES] = {10, 50, 100};
+
+// Helpers
+static double secondsPerUpdate(const int nOthers);
+static void updateToGoal(const int nOthers, const float x, const float y, const float z, setpoint_t* setpoint);
+static void setPeer(const int index, const float x, const float y, const float z);
+static int addRandomPeers(const int first, const int count, const float size, const float minDist);
+static float randomIn(const float min, const float max);
+
+
+void setUp(void) {
+  params = (collision_avoidance_params_t){
+    .ellipsoidRadii = { .x = 0.3, .y = 0.3, .z = 0.9 },
+    .bboxMin = { .x = -FLT_MAX, .y = -FLT_MAX, .z = -FLT_MAX },
+    .bboxMax = { .x = FLT_MAX, .y = FLT_MAX, .z = FLT_MAX },
+    .horizonSecs = 1.0f,
+    .maxSpeed = 0.5f,
+    .sidestepThreshold = 0.25f,
+    .maxPeerLocAgeMillis = 5000,
+    .voronoiProjectionTolerance = 1e-5,
+    .voronoiProjectionMaxIters = 100,
+    .maxNeighbors = MAX_NEIGHBORS,
+  };
+
+  collisionState.lastFeasibleSetPosition = mkvec(NAN, NAN, NAN);
+  collisionState.neighborCount = 0;
+
+  memset(&state, 0, sizeof(state));
+  state.position.z = 1.0f;
+
+  randomState = 4711;
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatCellRowsAreBoundedForAllSwarmSizes() {
+  for (int s = 0; s < SWARM_SIZES; s++) {
+    // Fixture
+    // Random peers, about one per 2 m^3 so that a few are always near
+    randomState = 4711;
+    const int nOthers = addRandomPeers(0, swarmSizes[s], cbrtf(2.0f * swarmSizes[s]), 0.7f);
+    setpoint_t setpoint;
+
+    // Test
+    updateToGoal(nOthers, 0.3f, 0.2f, 1.1f, &setpoint);
+
+    // Assert
+    TEST_ASSERT_TRUE(collisionState.neighborCount <= MAX_NEIGHBORS);
+  }
+}
+
+void testThatCostIsBoundedForAllSwarmSizes() {
+  // Fixture
+  double seconds[SWARM_SIZES];
+
+  // Test
+  for (int s = 0; s < SWARM_SIZES; s++) {
+    randomState = 4711;
+    const int nOthers = addRandomPeers(0, swarmSizes[s], cbrtf(2.0f * swarmSizes[s]), 0.7f);
+    seconds[s] = secondsPerUpdate(nOthers);
+  }
+
+  // Assert
+  // The cell has the same number of rows in all swarms, only the cull itself
+  // grows with the number of peers
+  for (int s = 1; s < SWARM_SIZES; s++) {
+    TEST_ASSERT_TRUE(seconds[s] < 4.0 * seconds[0]);
+  }
+}
+
+// Helpers ////////////////////////////////////////////////////////////////////
+
+static double secondsPerUpdate(const int nOthers) {
+  setpoint_t setpoint;
+
+  const clock_t start = clock();
+  for (int n = 0; n < ITERATIONS; n++) {
+    updateToGoal(nOthers, 0.3f, 0.2f, 1.1f, &setpoint);
+  }
+
+  return (double)(clock() - start) / CLOCKS_PER_SEC / ITERATIONS;
+}
+
+static void updateToGoal(const int nOthers, const float x, const float y, const float z, setpoint_t* setpoint) {
+  memset(setpoint, 0, sizeof(*setpoint));
+  setpoint->mode.x = modeAbs;
+  setpoint->mode.y = modeAbs;
+  setpoint->mode.z = modeAbs;
+  setpoint->position.x = x;
+  setpoint->position.y = y;
+  setpoint->position.z = z;
+
+  collisionAvoidanceUpdateSetpointCore(&params, &collisionState, nOthers, otherPositions, workspace, setpoint, NULL, &state);
+}
+
+static void setPeer(const int index, const float x, const float y, const float z) {
+  otherPositions[3 * index + 0] = x;
+  otherPositions[3 * index + 1] = y;
+  otherPositions[3 * index + 2] = z;
+}
+
+// Random peers in a cube of the given size centered around us, not closer than
+// minDist to us
+static int addRandomPeers(const int first, const int count, const float size, const float minDist) {
+  int index = first;
+  while (index < first + count) {
+    const float x = randomIn(-size / 2.0f, size / 2.0f);
+    const float y = randomIn(-size / 2.0f, size / 2.0f);
+    const float z = 1.0f + randomIn(-size / 2.0f, size / 2.0f);
+    const float dx = x - state.position.x;
+    const float dy = y - state.position.y;
+    const float dz = z - state.position.z;
+    if (sqrtf(dx * dx + dy * dy + dz * dz) >= minDist) {
+      setPeer(index, x, y, z);
+      index++;
+    }
+  }
+
+  return count;
+}
+
+static float randomIn(const float min, const float max) {
+  randomState = randomState * 1664525u + 1013904223u;
+  return min + (max - min) * (float)(randomState >> 8) / (float)(1 << 24);
+}
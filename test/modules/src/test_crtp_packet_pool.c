@@ -0,0 +1,147 @@
+// File under test crtp_packet_pool.c
+#include "crtp_packet_pool.h"
+
+#include <stddef.h>
+
+#include "unity.h"
+
+#include "mock_cfassert.h"
+
+static crtpPacketPool_t pool;
+
+// Helpers
+static void allocAll(CRTPPacket* packets[CRTP_PACKET_POOL_SIZE]);
+
+
+void setUp(void) {
+  crtpPacketPoolInit(&pool);
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatAllocatedBufferIsInPool() {
+  // Fixture
+  // Test
+  CRTPPacket* actual = crtpPacketPoolAlloc(&pool);
+
+  // Assert
+  TEST_ASSERT_NOT_NULL(actual);
+  TEST_ASSERT_TRUE(crtpPacketPoolContains(&pool, actual));
+  TEST_ASSERT_EQUAL_UINT8(CRTP_PACKET_POOL_SIZE - 1, pool.freeCount);
+}
+
+void testThatAllBuffersCanBeAllocatedOnce() {
+  // Fixture
+  CRTPPacket* packets[CRTP_PACKET_POOL_SIZE];
+
+  // Test
+  allocAll(packets);
+
+  // Assert
+  for (int i = 0; i < CRTP_PACKET_POOL_SIZE; i++) {
+    TEST_ASSERT_NOT_NULL(packets[i]);
+    for (int j = 0; j < i; j++) {
+      TEST_ASSERT_TRUE(packets[i] != packets[j]);
+    }
+  }
+}
+
+void testThatAllocFailsWhenPoolIsEmpty() {
+  // Fixture
+  CRTPPacket* packets[CRTP_PACKET_POOL_SIZE];
+  allocAll(packets);
+
+  // Test
+  CRTPPacket* actual = crtpPacketPoolAlloc(&pool);
+
+  // Assert
+  TEST_ASSERT_NULL(actual);
+  TEST_ASSERT_EQUAL_UINT32(1, pool.allocFailCount);
+  TEST_ASSERT_EQUAL_UINT8(0, pool.minFreeCount);
+}
+
+void testThatReleasedBufferIsReused() {
+  // Fixture
+  CRTPPacket* packets[CRTP_PACKET_POOL_SIZE];
+  allocAll(packets);
+  crtpPacketPoolRelease(&pool, packets[5]);
+
+  // Test
+  CRTPPacket* actual = crtpPacketPoolAlloc(&pool);
+
+  // Assert
+  TEST_ASSERT_EQUAL_PTR(packets[5], actual);
+}
+
+void testThatBufferIsKeptUntilLastReferenceIsReleased() {
+  // Fixture
+  CRTPPacket* p = crtpPacketPoolAlloc(&pool);
+  crtpPacketPoolRef(&pool, p);
+  crtpPacketPoolRef(&pool, p);
+
+  // Test
+  crtpPacketPoolRelease(&pool, p);
+  crtpPacketPoolRelease(&pool, p);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(CRTP_PACKET_POOL_SIZE - 1, pool.freeCount);
+
+  crtpPacketPoolRelease(&pool, p);
+  TEST_ASSERT_EQUAL_UINT8(CRTP_PACKET_POOL_SIZE, pool.freeCount);
+}
+
+void testThatPacketContentIsKeptWhileReferenced() {
+  // Fixture
+  CRTPPacket* p = crtpPacketPoolAlloc(&pool);
+  p->header = CRTP_HEADER(CRTP_PORT_SETPOINT_HL, 0);
+  p->data[0] = 0x42;
+  crtpPacketPoolRef(&pool, p);
+  crtpPacketPoolRelease(&pool, p);
+
+  // Test
+  CRTPPacket* other = crtpPacketPoolAlloc(&pool);
+
+  // Assert
+  TEST_ASSERT_TRUE(other != p);
+  TEST_ASSERT_EQUAL_UINT8(0x42, p->data[0]);
+}
+
+void testThatMinFreeCountIsTracked() {
+  // Fixture
+  CRTPPacket* a = crtpPacketPoolAlloc(&pool);
+  CRTPPacket* b = crtpPacketPoolAlloc(&pool);
+  CRTPPacket* c = crtpPacketPoolAlloc(&pool);
+
+  // Test
+  crtpPacketPoolRelease(&pool, a);
+  crtpPacketPoolRelease(&pool, b);
+  crtpPacketPoolRelease(&pool, c);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(CRTP_PACKET_POOL_SIZE - 3, pool.minFreeCount);
+  TEST_ASSERT_EQUAL_UINT8(CRTP_PACKET_POOL_SIZE, pool.freeCount);
+}
+
+void testThatReleaseOfFreeBufferAsserts() {
+  // Fixture
+  CRTPPacket* p = crtpPacketPoolAlloc(&pool);
+  crtpPacketPoolRelease(&pool, p);
+  assertFail_Ignore();
+
+  // Test
+  crtpPacketPoolRelease(&pool, p);
+
+  // Assert
+  // Not added to the free list twice
+  TEST_ASSERT_EQUAL_UINT8(CRTP_PACKET_POOL_SIZE, pool.freeCount);
+}
+
+// Helpers ////////////////////////////////////////////////////////
+
+static void allocAll(CRTPPacket* packets[CRTP_PACKET_POOL_SIZE]) {
+  for (int i = 0; i < CRTP_PACKET_POOL_SIZE; i++) {
+    packets[i] = crtpPacketPoolAlloc(&pool);
+  }
+}
@@ -0,0 +1,114 @@
+// File under test crtp_rx_backlog.c
+#include "crtp_rx_backlog.h"
+
+#include <stddef.h>
+
+#include "unity.h"
+
+#define PACKET_COUNT 16
+
+static crtpRxBacklog_t backlog;
+static CRTPPacket packets[PACKET_COUNT];
+
+// Helpers
+static CRTPPacket* packet(const int index, const CRTPPort port, const uint8_t channel);
+
+
+void setUp(void) {
+  crtpRxBacklogInit(&backlog);
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatPacketsAreTakenInTheOrderTheyWereAdded() {
+  // Fixture
+  CRTPPacket* removed;
+  crtpRxBacklogAdd(&backlog, packet(0, CRTP_PORT_SETPOINT, 0), CRTP_OVERFLOW_COALESCE_LATEST, &removed);
+  crtpRxBacklogAdd(&backlog, packet(1, CRTP_PORT_LOCALIZATION, 0), CRTP_OVERFLOW_DROP_OLDEST, &removed);
+
+  // Test
+  CRTPPacket* first = crtpRxBacklogTake(&backlog);
+  CRTPPacket* second = crtpRxBacklogTake(&backlog);
+  CRTPPacket* third = crtpRxBacklogTake(&backlog);
+
+  // Assert
+  TEST_ASSERT_EQUAL_PTR(&packets[0], first);
+  TEST_ASSERT_EQUAL_PTR(&packets[1], second);
+  TEST_ASSERT_NULL(third);
+}
+
+void testThatCoalesceReplacesThePacketOfTheSamePortAndChannel() {
+  // Fixture
+  CRTPPacket* removed;
+  crtpRxBacklogAdd(&backlog, packet(0, CRTP_PORT_SETPOINT, 0), CRTP_OVERFLOW_COALESCE_LATEST, &removed);
+  crtpRxBacklogAdd(&backlog, packet(1, CRTP_PORT_LOCALIZATION, 0), CRTP_OVERFLOW_DROP_OLDEST, &removed);
+
+  // Test
+  crtpRxBacklogResult_t actual = crtpRxBacklogAdd(&backlog, packet(2, CRTP_PORT_SETPOINT, 0), CRTP_OVERFLOW_COALESCE_LATEST, &removed);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(CRTP_RX_BACKLOG_COALESCED, actual);
+  TEST_ASSERT_EQUAL_PTR(&packets[0], removed);
+  TEST_ASSERT_EQUAL_UINT8(2, backlog.count);
+  TEST_ASSERT_EQUAL_PTR(&packets[1], crtpRxBacklogTake(&backlog));
+  TEST_ASSERT_EQUAL_PTR(&packets[2], crtpRxBacklogTake(&backlog));
+}
+
+void testThatCoalesceKeepsPacketsOfOtherChannels() {
+  // Fixture
+  CRTPPacket* removed;
+  crtpRxBacklogAdd(&backlog, packet(0, CRTP_PORT_SETPOINT_GENERIC, 1), CRTP_OVERFLOW_COALESCE_LATEST, &removed);
+
+  // Test
+  crtpRxBacklogResult_t actual = crtpRxBacklogAdd(&backlog, packet(1, CRTP_PORT_SETPOINT_GENERIC, 0), CRTP_OVERFLOW_COALESCE_LATEST, &removed);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(CRTP_RX_BACKLOG_ADDED, actual);
+  TEST_ASSERT_NULL(removed);
+  TEST_ASSERT_EQUAL_UINT8(2, backlog.count);
+}
+
+void testThatDropOldestKeepsTheLimitOfThePort() {
+  // Fixture
+  CRTPPacket* removed;
+  crtpRxBacklogAdd(&backlog, packet(0, CRTP_PORT_SETPOINT, 0), CRTP_OVERFLOW_COALESCE_LATEST, &removed);
+  for (int i = 1; i <= CRTP_RX_BACKLOG_PORT_LIMIT; i++) {
+    crtpRxBacklogAdd(&backlog, packet(i, CRTP_PORT_LOCALIZATION, 0), CRTP_OVERFLOW_DROP_OLDEST, &removed);
+  }
+
+  // Test
+  crtpRxBacklogResult_t actual = crtpRxBacklogAdd(&backlog, packet(10, CRTP_PORT_LOCALIZATION, 0), CRTP_OVERFLOW_DROP_OLDEST, &removed);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(CRTP_RX_BACKLOG_DROPPED, actual);
+  TEST_ASSERT_EQUAL_PTR(&packets[1], removed);
+  TEST_ASSERT_EQUAL_UINT8(CRTP_RX_BACKLOG_PORT_LIMIT + 1, backlog.count);
+  TEST_ASSERT_EQUAL_PTR(&packets[0], crtpRxBacklogTake(&backlog));
+  TEST_ASSERT_EQUAL_PTR(&packets[2], crtpRxBacklogTake(&backlog));
+}
+
+void testThatOldestPacketIsHandedBackWhenFull() {
+  // Fixture
+  CRTPPacket* removed;
+  for (int i = 0; i < CRTP_RX_BACKLOG_SIZE; i++) {
+    crtpRxBacklogAdd(&backlog, packet(i, CRTP_PORT_LOCALIZATION, 0), CRTP_OVERFLOW_DROP_NEW, &removed);
+  }
+
+  // Test
+  crtpRxBacklogResult_t actual = crtpRxBacklogAdd(&backlog, packet(CRTP_RX_BACKLOG_SIZE, CRTP_PORT_SETPOINT, 0), CRTP_OVERFLOW_COALESCE_LATEST, &removed);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(CRTP_RX_BACKLOG_FULL, actual);
+  TEST_ASSERT_EQUAL_PTR(&packets[0], removed);
+  TEST_ASSERT_EQUAL_UINT8(CRTP_RX_BACKLOG_SIZE, backlog.count);
+  TEST_ASSERT_EQUAL_PTR(&packets[1], crtpRxBacklogTake(&backlog));
+}
+
+// Helpers ////////////////////////////////////////////////////////
+
+static CRTPPacket* packet(const int index, const CRTPPort port, const uint8_t channel) {
+  packets[index].header = CRTP_HEADER(port, channel);
+  return &packets[index];
+}
@@ -0,0 +1,228 @@
+// File under test crtp_tx_scheduler.c
+#include "crtp_tx_scheduler.h"
+
+#include <string.h>
+
+#include "unity.h"
+
+#include "mock_cfassert.h"
+
+static const crtpTxClassConfig_t config[CRTP_TX_CLASS_COUNT] = {
+  [CRTP_TX_CLASS_CONTROL]   = {.depth = 4, .weight = 0, .dropOldest = false},
+  [CRTP_TX_CLASS_PARAM_MEM] = {.depth = 8, .weight = 2, .dropOldest = false},
+  [CRTP_TX_CLASS_CONSOLE]   = {.depth = 4, .weight = 1, .dropOldest = false},
+  [CRTP_TX_CLASS_TELEMETRY] = {.depth = 8, .weight = 2, .dropOldest = true},
+};
+
+static crtpTxScheduler_t scheduler;
+
+// Helpers
+static CRTPPacket packet(const CRTPPort port, const uint8_t id);
+static void push(const CRTPPort port, const uint8_t id, const uint32_t now);
+static uint8_t popId(crtpTxClass_t* txClass, const uint32_t now);
+
+
+void setUp(void) {
+  crtpTxSchedulerInit(&scheduler, config);
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatPortsAreMappedToClasses() {
+  // Fixture
+  // Test
+  // Assert
+  TEST_ASSERT_EQUAL_INT(CRTP_TX_CLASS_CONSOLE, crtpTxSchedulerClassOf(CRTP_PORT_CONSOLE));
+  TEST_ASSERT_EQUAL_INT(CRTP_TX_CLASS_PARAM_MEM, crtpTxSchedulerClassOf(CRTP_PORT_PARAM));
+  TEST_ASSERT_EQUAL_INT(CRTP_TX_CLASS_PARAM_MEM, crtpTxSchedulerClassOf(CRTP_PORT_MEM));
+  TEST_ASSERT_EQUAL_INT(CRTP_TX_CLASS_TELEMETRY, crtpTxSchedulerClassOf(CRTP_PORT_LOG));
+  TEST_ASSERT_EQUAL_INT(CRTP_TX_CLASS_CONTROL, crtpTxSchedulerClassOf(CRTP_PORT_LINK));
+  TEST_ASSERT_EQUAL_INT(CRTP_TX_CLASS_CONTROL, crtpTxSchedulerClassOf(CRTP_PORT_SETPOINT_HL));
+}
+
+void testThatEmptySchedulerHasNoPacket() {
+  // Fixture
+  CRTPPacket p;
+  crtpTxClass_t txClass;
+
+  // Test
+  const bool actual = crtpTxSchedulerPop(&scheduler, &p, &txClass, 0);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+}
+
+void testThatPacketsOfAClassAreSentInOrder() {
+  // Fixture
+  crtpTxClass_t txClass;
+  push(CRTP_PORT_PARAM, 1, 0);
+  push(CRTP_PORT_PARAM, 2, 0);
+  push(CRTP_PORT_MEM, 3, 0);
+
+  // Test
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(1, popId(&txClass, 0));
+  TEST_ASSERT_EQUAL_INT(CRTP_TX_CLASS_PARAM_MEM, txClass);
+  TEST_ASSERT_EQUAL_UINT8(2, popId(&txClass, 0));
+  TEST_ASSERT_EQUAL_UINT8(3, popId(&txClass, 0));
+}
+
+void testThatPacketContentIsKept() {
+  // Fixture
+  CRTPPacket expected = packet(CRTP_PORT_MEM, 7);
+  expected.size = CRTP_MAX_DATA_SIZE;
+  memset(expected.data, 0xa5, CRTP_MAX_DATA_SIZE);
+  crtpTxSchedulerPush(&scheduler, CRTP_TX_CLASS_PARAM_MEM, &expected, 0);
+  CRTPPacket actual;
+  crtpTxClass_t txClass;
+
+  // Test
+  crtpTxSchedulerPop(&scheduler, &actual, &txClass, 0);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected.raw, actual.raw, sizeof(expected.raw));
+  TEST_ASSERT_EQUAL_UINT8(expected.size, actual.size);
+}
+
+void testThatControlPacketsAreSentBeforeOtherClasses() {
+  // Fixture
+  crtpTxClass_t txClass;
+  push(CRTP_PORT_LOG, 1, 0);
+  push(CRTP_PORT_PARAM, 2, 0);
+  push(CRTP_PORT_CONSOLE, 3, 0);
+  push(CRTP_PORT_LINK, 4, 0);
+  push(CRTP_PORT_PLATFORM, 5, 0);
+
+  // Test
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(4, popId(&txClass, 0));
+  TEST_ASSERT_EQUAL_INT(CRTP_TX_CLASS_CONTROL, txClass);
+  TEST_ASSERT_EQUAL_UINT8(5, popId(&txClass, 0));
+  TEST_ASSERT_EQUAL_INT(CRTP_TX_CLASS_CONTROL, txClass);
+}
+
+void testThatWeightedClassesShareTheLink() {
+  // Fixture
+  crtpTxClass_t txClass;
+  int sent[CRTP_TX_CLASS_COUNT] = {0};
+  for (int i = 0; i < 8; i++) {
+    push(CRTP_PORT_PARAM, i, 0);
+    push(CRTP_PORT_LOG, i, 0);
+  }
+  for (int i = 0; i < 4; i++) {
+    push(CRTP_PORT_CONSOLE, i, 0);
+  }
+
+  // Test
+  // One round is 2 param, 1 console and 2 log packets
+  for (int i = 0; i < 10; i++) {
+    popId(&txClass, 0);
+    sent[txClass]++;
+  }
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(4, sent[CRTP_TX_CLASS_PARAM_MEM]);
+  TEST_ASSERT_EQUAL_INT(2, sent[CRTP_TX_CLASS_CONSOLE]);
+  TEST_ASSERT_EQUAL_INT(4, sent[CRTP_TX_CLASS_TELEMETRY]);
+}
+
+void testThatSingleWeightedClassGetsTheWholeLink() {
+  // Fixture
+  crtpTxClass_t txClass;
+  for (int i = 0; i < 8; i++) {
+    push(CRTP_PORT_LOG, i, 0);
+  }
+
+  // Test
+  // Assert
+  for (int i = 0; i < 8; i++) {
+    TEST_ASSERT_EQUAL_UINT8(i, popId(&txClass, 0));
+  }
+}
+
+void testThatFullClassRejectsPacketAndCountsDrop() {
+  // Fixture
+  for (int i = 0; i < 4; i++) {
+    push(CRTP_PORT_CONSOLE, i, 0);
+  }
+  const CRTPPacket p = packet(CRTP_PORT_CONSOLE, 4);
+
+  // Test
+  const bool actual = crtpTxSchedulerPush(&scheduler, CRTP_TX_CLASS_CONSOLE, &p, 0);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+  TEST_ASSERT_EQUAL_UINT32(1, scheduler.classes[CRTP_TX_CLASS_CONSOLE].dropCount);
+  TEST_ASSERT_EQUAL_INT(0, crtpTxSchedulerFree(&scheduler, CRTP_TX_CLASS_CONSOLE));
+  TEST_ASSERT_EQUAL_INT(8, crtpTxSchedulerFree(&scheduler, CRTP_TX_CLASS_PARAM_MEM));
+}
+
+void testThatFullTelemetryClassDropsOldest() {
+  // Fixture
+  crtpTxClass_t txClass;
+  for (int i = 0; i < 10; i++) {
+    push(CRTP_PORT_LOG, i, 0);
+  }
+
+  // Test
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(2, scheduler.classes[CRTP_TX_CLASS_TELEMETRY].dropCount);
+  for (int i = 2; i < 10; i++) {
+    TEST_ASSERT_EQUAL_UINT8(i, popId(&txClass, 0));
+  }
+}
+
+void testThatLatencyIsMeasured() {
+  // Fixture
+  crtpTxClass_t txClass;
+  push(CRTP_PORT_LOG, 1, 100);
+  push(CRTP_PORT_LOG, 2, 110);
+
+  // Test
+  popId(&txClass, 130);
+  popId(&txClass, 135);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT16(30, scheduler.classes[CRTP_TX_CLASS_TELEMETRY].maxLatency);
+  TEST_ASSERT_TRUE(scheduler.classes[CRTP_TX_CLASS_TELEMETRY].averageLatency > 0.0f);
+  TEST_ASSERT_EQUAL_UINT32(2, scheduler.classes[CRTP_TX_CLASS_TELEMETRY].sentCount);
+}
+
+void testThatFlushEmptiesClass() {
+  // Fixture
+  CRTPPacket p;
+  crtpTxClass_t txClass;
+  push(CRTP_PORT_PARAM, 1, 0);
+  push(CRTP_PORT_PARAM, 2, 0);
+
+  // Test
+  const int actual = crtpTxSchedulerFlush(&scheduler, CRTP_TX_CLASS_PARAM_MEM);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(2, actual);
+  TEST_ASSERT_FALSE(crtpTxSchedulerPop(&scheduler, &p, &txClass, 0));
+  TEST_ASSERT_EQUAL_UINT32(0, scheduler.classes[CRTP_TX_CLASS_PARAM_MEM].dropCount);
+}
+
+// Helpers ////////////////////////////////////////////////////////
+
+static CRTPPacket packet(const CRTPPort port, const uint8_t id) {
+  CRTPPacket p = {0};
+  p.header = CRTP_HEADER(port, 0);
+  p.size = 1;
+  p.data[0] = id;
+  return p;
+}
+
+static void push(const CRTPPort port, const uint8_t id, const uint32_t now) {
+  const CRTPPacket p = packet(port, id);
+  crtpTxSchedulerPush(&scheduler, crtpTxSchedulerClassOf(port), &p, now);
+}
+
+static uint8_t popId(crtpTxClass_t* txClass, const uint32_t now) {
+  CRTPPacket p;
+  TEST_ASSERT_TRUE(crtpTxSchedulerPop(&scheduler, &p, txClass, now));
+  return p.data[0];
+}
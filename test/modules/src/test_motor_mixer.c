@@ -0,0 +1,202 @@
+// File under test motor_mixer.c
+#include "motor_mixer.h"
+
+#include <stdlib.h>
+
+#include "unity.h"
+
+#define MAX_OUTPUT 65535.0f
+
+static float output[MOTOR_MIXER_MOTOR_COUNT];
+
+// Helpers
+static float rollOf(const motorMixerMatrix_t* matrix, const float* motors);
+static float pitchOf(const motorMixerMatrix_t* matrix, const float* motors);
+static float yawOf(const motorMixerMatrix_t* matrix, const float* motors);
+static float thrustOf(const float* motors);
+
+
+void setUp(void) {
+  for (int i = 0; i < MOTOR_MIXER_MOTOR_COUNT; i++) {
+    output[i] = -1.0f;
+  }
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatUnsaturatedCommandIsMixedWithTheXMatrix() {
+  // Fixture
+  // Test
+  uint8_t actual = motorMixerMix(&motorMixerQuadX, 30000.0f, 1000.0f, 2000.0f, 500.0f, MAX_OUTPUT, output);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(0, actual);
+  TEST_ASSERT_EQUAL_FLOAT(30000.0f - 1000.0f + 2000.0f + 500.0f, output[0]);
+  TEST_ASSERT_EQUAL_FLOAT(30000.0f - 1000.0f - 2000.0f - 500.0f, output[1]);
+  TEST_ASSERT_EQUAL_FLOAT(30000.0f + 1000.0f - 2000.0f + 500.0f, output[2]);
+  TEST_ASSERT_EQUAL_FLOAT(30000.0f + 1000.0f + 2000.0f - 500.0f, output[3]);
+}
+
+void testThatUnsaturatedCommandIsMixedWithTheNormalMatrix() {
+  // Fixture
+  // Test
+  uint8_t actual = motorMixerMix(&motorMixerQuadNormal, 30000.0f, 1000.0f, 2000.0f, 500.0f, MAX_OUTPUT, output);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(0, actual);
+  TEST_ASSERT_EQUAL_FLOAT(30000.0f + 2000.0f + 500.0f, output[0]);
+  TEST_ASSERT_EQUAL_FLOAT(30000.0f - 1000.0f - 500.0f, output[1]);
+  TEST_ASSERT_EQUAL_FLOAT(30000.0f - 2000.0f + 500.0f, output[2]);
+  TEST_ASSERT_EQUAL_FLOAT(30000.0f + 1000.0f - 500.0f, output[3]);
+}
+
+void testThatZeroThrustStopsAllMotors() {
+  // Fixture
+  // Test
+  uint8_t actual = motorMixerMix(&motorMixerQuadX, 0.0f, 1000.0f, 2000.0f, 500.0f, MAX_OUTPUT, output);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(0, actual);
+  for (int i = 0; i < MOTOR_MIXER_MOTOR_COUNT; i++) {
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, output[i]);
+  }
+}
+
+void testThatHighThrustIsLoweredToKeepTorques() {
+  // Fixture
+  // Test
+  uint8_t actual = motorMixerMix(&motorMixerQuadX, 64000.0f, 0.0f, 8000.0f, 1000.0f, MAX_OUTPUT, output);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(MOTOR_MIXER_SAT_THRUST, actual);
+  TEST_ASSERT_FLOAT_WITHIN(0.1f, 0.0f, rollOf(&motorMixerQuadX, output));
+  TEST_ASSERT_FLOAT_WITHIN(0.1f, 8000.0f, pitchOf(&motorMixerQuadX, output));
+  TEST_ASSERT_FLOAT_WITHIN(0.1f, 1000.0f, yawOf(&motorMixerQuadX, output));
+  TEST_ASSERT_FLOAT_WITHIN(0.1f, MAX_OUTPUT - 9000.0f, thrustOf(output));
+}
+
+void testThatLowThrustIsNotRaised() {
+  // Fixture
+  // Test
+  uint8_t actual = motorMixerMix(&motorMixerQuadX, 2000.0f, 5000.0f, 0.0f, 0.0f, MAX_OUTPUT, output);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(MOTOR_MIXER_SAT_CLIPPED, actual);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, output[0]);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, output[1]);
+  TEST_ASSERT_EQUAL_FLOAT(7000.0f, output[2]);
+  TEST_ASSERT_EQUAL_FLOAT(7000.0f, output[3]);
+}
+
+void testThatNearZeroThrustWithLargeRollKeepsMotorsLow() {
+  // Fixture
+  const float thrust = 1.0f;
+
+  // Test
+  uint8_t actual = motorMixerMix(&motorMixerQuadX, thrust, 30000.0f, 0.0f, 10000.0f, MAX_OUTPUT, output);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual & MOTOR_MIXER_SAT_CLIPPED);
+  TEST_ASSERT_FALSE(actual & MOTOR_MIXER_SAT_THRUST);
+  for (int i = 0; i < MOTOR_MIXER_MOTOR_COUNT; i++) {
+    TEST_ASSERT_TRUE(output[i] <= thrust + 30000.0f + 10000.0f);
+  }
+  TEST_ASSERT_TRUE(thrustOf(output) < 30000.0f);
+}
+
+void testThatLargeRollPitchIsScaledKeepingTheRatio() {
+  // Fixture
+  // Test
+  uint8_t actual = motorMixerMix(&motorMixerQuadX, MAX_OUTPUT / 2.0f, 30000.0f, 15000.0f, 0.0f, MAX_OUTPUT, output);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual & MOTOR_MIXER_SAT_ROLL_PITCH);
+  const float roll = rollOf(&motorMixerQuadX, output);
+  const float pitch = pitchOf(&motorMixerQuadX, output);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 2.0f, roll / pitch);
+  TEST_ASSERT_FLOAT_WITHIN(1.0f, MAX_OUTPUT / 2.0f, roll + pitch);
+}
+
+void testThatYawIsReducedBeforeRollAndPitch() {
+  // Fixture
+  // Test
+  uint8_t actual = motorMixerMix(&motorMixerQuadX, 32000.0f, 0.0f, 30000.0f, 10000.0f, MAX_OUTPUT, output);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(MOTOR_MIXER_SAT_YAW, actual);
+  TEST_ASSERT_FLOAT_WITHIN(0.1f, 30000.0f, pitchOf(&motorMixerQuadX, output));
+  const float yaw = yawOf(&motorMixerQuadX, output);
+  TEST_ASSERT_TRUE(yaw >= 0.0f);
+  TEST_ASSERT_TRUE(yaw < 10000.0f);
+}
+
+void testThatOutputsAreAlwaysInRange() {
+  // Fixture
+  srand(1);
+
+  // Test
+  for (int n = 0; n < 10000; n++) {
+    const float thrust = (rand() % 70000);
+    const float roll = (rand() % 80000) - 40000;
+    const float pitch = (rand() % 80000) - 40000;
+    const float yaw = (rand() % 80000) - 40000;
+
+    motorMixerMix(&motorMixerQuadX, thrust, roll, pitch, yaw, MAX_OUTPUT, output);
+
+    // Assert
+    for (int i = 0; i < MOTOR_MIXER_MOTOR_COUNT; i++) {
+      TEST_ASSERT_TRUE(output[i] >= 0.0f);
+      TEST_ASSERT_TRUE(output[i] <= MAX_OUTPUT);
+    }
+  }
+}
+
+void testThatRollPitchRatioIsKeptUnderSaturation() {
+  // Fixture
+  srand(2);
+
+  // Test
+  for (int n = 0; n < 10000; n++) {
+    // Thrust high enough for the roll and pitch, the mixer does not raise a low thrust
+    const float thrust = 32768 + (rand() % 32767);
+    const float roll = 1000 + (rand() % 30000);
+    const float pitch = 1000 + (rand() % 30000);
+    const float yaw = (rand() % 80000) - 40000;
+
+    motorMixerMix(&motorMixerQuadX, thrust, roll, pitch, yaw, MAX_OUTPUT, output);
+
+    // Assert
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, roll / pitch, rollOf(&motorMixerQuadX, output) / pitchOf(&motorMixerQuadX, output));
+  }
+}
+
+// Helpers
+// The matrices are orthogonal with rows of norm 2, so the command is recovered by projection
+
+static float project(const float* row, const float* motors) {
+  float sum = 0.0f;
+  float norm = 0.0f;
+  for (int i = 0; i < MOTOR_MIXER_MOTOR_COUNT; i++) {
+    sum += row[i] * motors[i];
+    norm += row[i] * row[i];
+  }
+  return sum / norm;
+}
+
+static float rollOf(const motorMixerMatrix_t* matrix, const float* motors) {
+  return project(matrix->roll, motors);
+}
+
+static float pitchOf(const motorMixerMatrix_t* matrix, const float* motors) {
+  return project(matrix->pitch, motors);
+}
+
+static float yawOf(const motorMixerMatrix_t* matrix, const float* motors) {
+  return project(matrix->yaw, motors);
+}
+
+static float thrustOf(const float* motors) {
+  return (motors[0] + motors[1] + motors[2] + motors[3]) / 4.0f;
+}
@@ -0,0 +1,147 @@
+// File under test motor_thrust_model.c
+#include "motor_thrust_model.h"
+
+#include <math.h>
+
+#include "unity.h"
+
+// Coefficients of the CF2 motors with 45 mm propellers
+#define A 0.091492681f
+#define B 0.067673604f
+#define V_NOMINAL 4.0f
+
+static motorThrustModel_t model;
+
+static float analyticPwm(float thrust, float batteryVoltage) {
+  return (-B + sqrtf(B * B + 4.0f * A * thrust)) / (2.0f * A) * V_NOMINAL / batteryVoltage;
+}
+
+void setUp(void) {
+  motorThrustModelInit(&model, A, B, V_NOMINAL);
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatTableMatchesAnalyticInverseOverTheThrustRange() {
+  // Fixture
+  const int samples = 1000;
+  float maxError = 0.0f;
+
+  // Test
+  for (int i = 0; i <= samples; i++) {
+    const float thrust = (A + B) * i / samples;
+    const float error = fabsf(motorThrustModelPwm(&model, thrust, V_NOMINAL) - analyticPwm(thrust, V_NOMINAL));
+    if (error > maxError) {
+      maxError = error;
+    }
+  }
+
+  // Assert
+  // Less than 1/1000 of full scale, below the resolution of the motor timers
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, maxError);
+}
+
+void testThatTableIsExactAtTheNodes() {
+  // Fixture
+  const float step = (A + B) / (MOTOR_THRUST_MODEL_TABLE_SIZE - 1);
+  const float thrust = 7 * step;
+
+  // Test
+  const float actual = motorThrustModelPwm(&model, thrust, V_NOMINAL);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(0.00001f, analyticPwm(thrust, V_NOMINAL), actual);
+}
+
+void testThatLowBatteryNeedsMorePwm() {
+  // Fixture
+  const float thrust = 0.08f;
+
+  // Test
+  const float nominal = motorThrustModelPwm(&model, thrust, V_NOMINAL);
+  const float low = motorThrustModelPwm(&model, thrust, 3.6f);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(0.0001f, nominal * V_NOMINAL / 3.6f, low);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, analyticPwm(thrust, 3.6f), low);
+}
+
+void testThatForwardModelInvertsLookup() {
+  // Fixture
+  const float thrust = 0.05f;
+  const float batteryVoltage = 3.7f;
+
+  // Test
+  const float pwm = motorThrustModelPwm(&model, thrust, batteryVoltage);
+  const float actual = motorThrustModelThrust(&model, pwm, batteryVoltage);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(0.0005f, thrust, actual);
+}
+
+void testThatNegativeThrustGivesZeroPwm() {
+  // Fixture
+  // Test
+  const float actual = motorThrustModelPwm(&model, -0.1f, V_NOMINAL);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, actual);
+}
+
+void testThatPwmSaturatesAtFullScale() {
+  // Fixture
+  // Test
+  const float actual = motorThrustModelPwm(&model, 1.0f, 3.5f);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, actual);
+}
+
+void testThatThrustAboveTableIsReachableWithFullBattery() {
+  // Fixture
+  const float thrust = (A + B) * 1.05f;
+
+  // Test
+  const float actual = motorThrustModelPwm(&model, thrust, 4.2f);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual < 1.0f);
+  TEST_ASSERT_FLOAT_WITHIN(0.005f, analyticPwm(thrust, 4.2f), actual);
+}
+
+void testThatMissingBatteryMeasurementIsNotCompensated() {
+  // Fixture
+  const float thrust = 0.08f;
+
+  // Test
+  const float actual = motorThrustModelPwm(&model, thrust, 0.0f);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, analyticPwm(thrust, V_NOMINAL), actual);
+}
+
+void testThatZeroMaxThrustIsRejected() {
+  // Fixture
+  // Test
+  const bool actual = motorThrustModelInit(&model, 0.1f, -0.1f, V_NOMINAL);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+}
+
+void testThatInvalidParametersKeepThePreviousModel() {
+  // Fixture
+  const float thrust = 0.08f;
+  const float expected = motorThrustModelPwm(&model, thrust, V_NOMINAL);
+
+  // Test
+  motorThrustModelInit(&model, -0.2f, 0.1f, V_NOMINAL);
+  motorThrustModelInit(&model, NAN, B, V_NOMINAL);
+  motorThrustModelInit(&model, A, B, 0.0f);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(A, model.pwmToThrustA);
+  TEST_ASSERT_EQUAL_FLOAT(expected, motorThrustModelPwm(&model, thrust, V_NOMINAL));
+}
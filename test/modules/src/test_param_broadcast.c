@@ -0,0 +1,198 @@
+// File under test param_broadcast.c
+#include "param_broadcast.h"
+#include "param_bulk.h"
+
+#include <string.h>
+
+#include "unity.h"
+
+#include "mock_crtp_commander_high_level.h"
+
+static paramBroadcast_t broadcast;
+static uint8_t packet[PARAM_BROADCAST_HEADER_SIZE + PARAM_BROADCAST_PAYLOAD_SIZE];
+static const paramBulkEntry_t* entries;
+
+// Fake TOC: id 0 is a float, id 1 a uint8, other ids are unknown or read only
+static int fakeValueSize(uint16_t id) {
+  if (id == 0) {
+    return 4;
+  }
+  if (id == 1) {
+    return 1;
+  }
+
+  return -1;
+}
+
+// Helpers
+static int fixtureBuildPacket(uint8_t groupMask, uint16_t delay_ms, float value0, uint8_t value1);
+
+
+void setUp(void) {
+  paramBroadcastInit(&broadcast);
+  memset(packet, 0, sizeof(packet));
+  entries = 0;
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatPacketForOtherGroupIsIgnored() {
+  // Fixture
+  int length = fixtureBuildPacket(0x02, 0, 1.0f, 1);
+  crtpCommanderHighLevelIsInGroup_ExpectAndReturn(0x02, false);
+
+  // Test
+  paramBroadcastResult_t actual = paramBroadcastHandle(&broadcast, packet, length, fakeValueSize, 1000);
+
+  // Assert
+  TEST_ASSERT_EQUAL(paramBroadcastNotInGroup, actual);
+  TEST_ASSERT_EQUAL_INT(0, paramBroadcastGetDue(&broadcast, 1000, &entries));
+}
+
+void testThatPacketWithoutDelayIsDueImmediately() {
+  // Fixture
+  int length = fixtureBuildPacket(0x01, 0, 2.5f, 7);
+  crtpCommanderHighLevelIsInGroup_ExpectAndReturn(0x01, true);
+
+  // Test
+  paramBroadcastResult_t actual = paramBroadcastHandle(&broadcast, packet, length, fakeValueSize, 1000);
+  int count = paramBroadcastGetDue(&broadcast, 1000, &entries);
+
+  // Assert
+  TEST_ASSERT_EQUAL(paramBroadcastScheduled, actual);
+  TEST_ASSERT_EQUAL_INT(2, count);
+
+  float value0;
+  memcpy(&value0, entries[0].value, 4);
+  TEST_ASSERT_EQUAL_UINT16(0, entries[0].id);
+  TEST_ASSERT_EQUAL_FLOAT(2.5f, value0);
+
+  TEST_ASSERT_EQUAL_UINT16(1, entries[1].id);
+  TEST_ASSERT_EQUAL_UINT8(7, entries[1].value[0]);
+}
+
+void testThatDelayedPacketIsNotDueBeforeActivation() {
+  // Fixture
+  int length = fixtureBuildPacket(0x01, 500, 1.0f, 1);
+  crtpCommanderHighLevelIsInGroup_ExpectAndReturn(0x01, true);
+  paramBroadcastHandle(&broadcast, packet, length, fakeValueSize, 1000);
+
+  // Test
+  int count = paramBroadcastGetDue(&broadcast, 1499, &entries);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(0, count);
+  TEST_ASSERT_EQUAL_UINT32(1, paramBroadcastTimeToActivation(&broadcast, 1499));
+}
+
+void testThatDelayedPacketIsDueOnceAtActivation() {
+  // Fixture
+  int length = fixtureBuildPacket(0x01, 500, 1.0f, 1);
+  crtpCommanderHighLevelIsInGroup_ExpectAndReturn(0x01, true);
+  paramBroadcastHandle(&broadcast, packet, length, fakeValueSize, 1000);
+
+  // Test
+  int first = paramBroadcastGetDue(&broadcast, 1500, &entries);
+  int second = paramBroadcastGetDue(&broadcast, 1501, &entries);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(2, first);
+  TEST_ASSERT_EQUAL_INT(0, second);
+}
+
+void testThatActivationHandlesTimerWrapAround() {
+  // Fixture
+  int length = fixtureBuildPacket(0x01, 100, 1.0f, 1);
+  crtpCommanderHighLevelIsInGroup_ExpectAndReturn(0x01, true);
+  paramBroadcastHandle(&broadcast, packet, length, fakeValueSize, UINT32_MAX - 49);
+
+  // Test
+  int before = paramBroadcastGetDue(&broadcast, 49, &entries);
+  int after = paramBroadcastGetDue(&broadcast, 50, &entries);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(0, before);
+  TEST_ASSERT_EQUAL_INT(2, after);
+}
+
+void testThatResentPacketKeepsActivationTime() {
+  // Fixture
+  int length = fixtureBuildPacket(0x01, 500, 1.0f, 1);
+  crtpCommanderHighLevelIsInGroup_ExpectAndReturn(0x01, true);
+  crtpCommanderHighLevelIsInGroup_ExpectAndReturn(0x01, true);
+  paramBroadcastHandle(&broadcast, packet, length, fakeValueSize, 1000);
+
+  // Test
+  paramBroadcastResult_t actual = paramBroadcastHandle(&broadcast, packet, length, fakeValueSize, 1100);
+
+  // Assert
+  TEST_ASSERT_EQUAL(paramBroadcastDuplicate, actual);
+  TEST_ASSERT_EQUAL_UINT32(400, paramBroadcastTimeToActivation(&broadcast, 1100));
+}
+
+void testThatNewPacketReplacesPendingPacket() {
+  // Fixture
+  int length = fixtureBuildPacket(0x01, 500, 1.0f, 1);
+  crtpCommanderHighLevelIsInGroup_ExpectAndReturn(0x01, true);
+  crtpCommanderHighLevelIsInGroup_ExpectAndReturn(0x01, true);
+  paramBroadcastHandle(&broadcast, packet, length, fakeValueSize, 1000);
+  length = fixtureBuildPacket(0x01, 0, 1.0f, 9);
+
+  // Test
+  paramBroadcastResult_t actual = paramBroadcastHandle(&broadcast, packet, length, fakeValueSize, 1100);
+  int count = paramBroadcastGetDue(&broadcast, 1100, &entries);
+
+  // Assert
+  TEST_ASSERT_EQUAL(paramBroadcastScheduled, actual);
+  TEST_ASSERT_EQUAL_INT(2, count);
+  TEST_ASSERT_EQUAL_UINT8(9, entries[1].value[0]);
+}
+
+void testThatPacketWithUnknownIdIsDroppedAsAWhole() {
+  // Fixture
+  int length = fixtureBuildPacket(0x01, 0, 1.0f, 1);
+  uint16_t unknownId = 5;
+  uint8_t value = 0;
+  length = PARAM_BROADCAST_HEADER_SIZE + paramBulkAppend(&packet[PARAM_BROADCAST_HEADER_SIZE], length - PARAM_BROADCAST_HEADER_SIZE, PARAM_BROADCAST_PAYLOAD_SIZE, unknownId, &value, 1);
+  crtpCommanderHighLevelIsInGroup_ExpectAndReturn(0x01, true);
+
+  // Test
+  paramBroadcastResult_t actual = paramBroadcastHandle(&broadcast, packet, length, fakeValueSize, 1000);
+
+  // Assert
+  TEST_ASSERT_EQUAL(paramBroadcastInvalid, actual);
+  TEST_ASSERT_EQUAL_INT(0, paramBroadcastGetDue(&broadcast, 1000, &entries));
+}
+
+void testThatTruncatedHeaderIsInvalid() {
+  // Fixture
+  // Test
+  paramBroadcastResult_t actual = paramBroadcastHandle(&broadcast, packet, 2, fakeValueSize, 1000);
+
+  // Assert
+  TEST_ASSERT_EQUAL(paramBroadcastInvalid, actual);
+}
+
+void testThatNothingPendingGivesNoActivationTime() {
+  // Fixture
+  // Test
+  uint32_t actual = paramBroadcastTimeToActivation(&broadcast, 1000);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, actual);
+}
+
+// Helpers
+
+static int fixtureBuildPacket(uint8_t groupMask, uint16_t delay_ms, float value0, uint8_t value1) {
+  packet[0] = groupMask;
+  memcpy(&packet[1], &delay_ms, 2);
+
+  int length = 0;
+  length = paramBulkAppend(&packet[PARAM_BROADCAST_HEADER_SIZE], length, PARAM_BROADCAST_PAYLOAD_SIZE, 0, &value0, 4);
+  length = paramBulkAppend(&packet[PARAM_BROADCAST_HEADER_SIZE], length, PARAM_BROADCAST_PAYLOAD_SIZE, 1, &value1, 1);
+
+  return PARAM_BROADCAST_HEADER_SIZE + length;
+}
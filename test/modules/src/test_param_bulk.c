@@ -0,0 +1,227 @@
+// File under test param_bulk.c
+#include "param_bulk.h"
+
+#include <string.h>
+#include <errno.h>
+
+#include "unity.h"
+
+#define BUFFER_SIZE PARAM_BULK_MAX_PAYLOAD_SIZE
+
+static uint8_t buffer[BUFFER_SIZE];
+static paramBulkEntry_t entries[PARAM_BULK_MAX_ENTRIES];
+
+// Fake TOC: ids 0-3 are 1, 2, 4 and 8 bytes, other ids are unknown
+static int fakeValueSize(uint16_t id) {
+  if (id < 4) {
+    return 1 << id;
+  }
+
+  return -1;
+}
+
+void setUp(void) {
+  memset(buffer, 0, sizeof(buffer));
+  memset(entries, 0, sizeof(entries));
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatAppendEncodesIdFollowedByValue() {
+  // Fixture
+  uint32_t value = 0x11223344;
+
+  // Test
+  int actual = paramBulkAppend(buffer, 0, BUFFER_SIZE, 0x0102, &value, 4);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(6, actual);
+  TEST_ASSERT_EQUAL_UINT8(0x02, buffer[0]);
+  TEST_ASSERT_EQUAL_UINT8(0x01, buffer[1]);
+  TEST_ASSERT_EQUAL_UINT8(0x44, buffer[2]);
+  TEST_ASSERT_EQUAL_UINT8(0x11, buffer[5]);
+}
+
+void testThatAppendRejectsEntryThatDoesNotFit() {
+  // Fixture
+  uint64_t value = 0;
+  int length = BUFFER_SIZE - 9;
+
+  // Test
+  int actual = paramBulkAppend(buffer, length, BUFFER_SIZE, 3, &value, 8);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(-1, actual);
+}
+
+void testThatAppendAcceptsEntryThatFillsTheBuffer() {
+  // Fixture
+  uint64_t value = 0;
+  int length = BUFFER_SIZE - 10;
+
+  // Test
+  int actual = paramBulkAppend(buffer, length, BUFFER_SIZE, 3, &value, 8);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(BUFFER_SIZE, actual);
+}
+
+void testThatDecodeReturnsAppendedEntries() {
+  // Fixture
+  uint8_t value0 = 0xab;
+  uint16_t value1 = 0x1234;
+  float value2 = 3.5f;
+  uint64_t value3 = 0x0102030405060708;
+
+  int length = 0;
+  length = paramBulkAppend(buffer, length, BUFFER_SIZE, 0, &value0, 1);
+  length = paramBulkAppend(buffer, length, BUFFER_SIZE, 1, &value1, 2);
+  length = paramBulkAppend(buffer, length, BUFFER_SIZE, 2, &value2, 4);
+  length = paramBulkAppend(buffer, length, BUFFER_SIZE, 3, &value3, 8);
+
+  // Test
+  int actual = paramBulkDecode(buffer, length, fakeValueSize, entries, PARAM_BULK_MAX_ENTRIES, NULL);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(4, actual);
+
+  TEST_ASSERT_EQUAL_UINT16(0, entries[0].id);
+  TEST_ASSERT_EQUAL_UINT8(1, entries[0].size);
+  TEST_ASSERT_EQUAL_MEMORY(&value0, entries[0].value, 1);
+
+  TEST_ASSERT_EQUAL_UINT16(1, entries[1].id);
+  TEST_ASSERT_EQUAL_MEMORY(&value1, entries[1].value, 2);
+
+  TEST_ASSERT_EQUAL_UINT16(2, entries[2].id);
+  TEST_ASSERT_EQUAL_MEMORY(&value2, entries[2].value, 4);
+
+  TEST_ASSERT_EQUAL_UINT16(3, entries[3].id);
+  TEST_ASSERT_EQUAL_UINT8(8, entries[3].size);
+  TEST_ASSERT_EQUAL_MEMORY(&value3, entries[3].value, 8);
+}
+
+void testThatDecodeOfEmptyPayloadReturnsNoEntries() {
+  // Fixture
+  // Test
+  int actual = paramBulkDecode(buffer, 0, fakeValueSize, entries, PARAM_BULK_MAX_ENTRIES, NULL);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(0, actual);
+}
+
+void testThatDecodeFailsOnUnknownId() {
+  // Fixture
+  uint8_t value = 0;
+  int failedEntry = -1;
+
+  int length = 0;
+  length = paramBulkAppend(buffer, length, BUFFER_SIZE, 0, &value, 1);
+  length = paramBulkAppend(buffer, length, BUFFER_SIZE, 17, &value, 1);
+
+  // Test
+  int actual = paramBulkDecode(buffer, length, fakeValueSize, entries, PARAM_BULK_MAX_ENTRIES, &failedEntry);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(-ENOENT, actual);
+  TEST_ASSERT_EQUAL_INT(1, failedEntry);
+}
+
+void testThatDecodeFailsOnTruncatedValue() {
+  // Fixture
+  uint32_t value = 0;
+  int failedEntry = -1;
+
+  int length = paramBulkAppend(buffer, 0, BUFFER_SIZE, 2, &value, 4);
+
+  // Test
+  int actual = paramBulkDecode(buffer, length - 1, fakeValueSize, entries, PARAM_BULK_MAX_ENTRIES, &failedEntry);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(-EINVAL, actual);
+  TEST_ASSERT_EQUAL_INT(0, failedEntry);
+}
+
+void testThatDecodeFailsOnTruncatedId() {
+  // Fixture
+  uint8_t value = 0;
+
+  int length = paramBulkAppend(buffer, 0, BUFFER_SIZE, 0, &value, 1);
+
+  // Test
+  int actual = paramBulkDecode(buffer, length + 1, fakeValueSize, entries, PARAM_BULK_MAX_ENTRIES, NULL);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(-EINVAL, actual);
+}
+
+void testThatDecodeFailsOnTooManyEntries() {
+  // Fixture
+  uint8_t value = 0;
+
+  int length = 0;
+  for (int i = 0; i < 3; i++) {
+    length = paramBulkAppend(buffer, length, BUFFER_SIZE, 0, &value, 1);
+  }
+
+  // Test
+  int actual = paramBulkDecode(buffer, length, fakeValueSize, entries, 2, NULL);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(-E2BIG, actual);
+}
+
+void testThatMaxEntriesFitsAFullPacketOfSmallestEntries() {
+  // Fixture
+  uint8_t value = 0;
+
+  int length = 0;
+  int newLength = 0;
+  while (newLength >= 0) {
+    length = newLength;
+    newLength = paramBulkAppend(buffer, length, BUFFER_SIZE, 0, &value, 1);
+  }
+
+  // Test
+  int actual = paramBulkDecode(buffer, length, fakeValueSize, entries, PARAM_BULK_MAX_ENTRIES, NULL);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(PARAM_BULK_MAX_ENTRIES, actual);
+}
+
+void testThatDecodeIdsReturnsIds() {
+  // Fixture
+  uint16_t expected[] = {1, 300, 4000};
+  uint16_t ids[4];
+  memcpy(buffer, expected, sizeof(expected));
+
+  // Test
+  int actual = paramBulkDecodeIds(buffer, sizeof(expected), ids, 4);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(3, actual);
+  TEST_ASSERT_EQUAL_UINT16_ARRAY(expected, ids, 3);
+}
+
+void testThatDecodeIdsFailsOnOddLength() {
+  // Fixture
+  uint16_t ids[4];
+
+  // Test
+  int actual = paramBulkDecodeIds(buffer, 3, ids, 4);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(-EINVAL, actual);
+}
+
+void testThatDecodeIdsFailsOnTooManyIds() {
+  // Fixture
+  uint16_t ids[2];
+
+  // Test
+  int actual = paramBulkDecodeIds(buffer, 6, ids, 2);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(-E2BIG, actual);
+}
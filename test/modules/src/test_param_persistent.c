@@ -0,0 +1,301 @@
+// File under test param_persistent.c
+#include "param_persistent.h"
+#include "param_bulk.h"
+#include "param.h"
+
+#include <string.h>
+
+#include "unity.h"
+
+#include "mock_storage.h"
+
+#define FAKE_STORAGE_SIZE 8
+#define MAX_SENT 200
+
+// Fake KVE, holding up to FAKE_STORAGE_SIZE keys
+static struct {
+  bool isUsed;
+  char key[PARAM_PERSISTENT_KEY_MAX_LENGTH];
+  uint8_t data[PARAM_PERSISTENT_MAX_STORED_SIZE];
+  size_t length;
+} storage[FAKE_STORAGE_SIZE];
+
+static paramPersistentGetAll_t getAll;
+static int sentCount;
+static uint8_t sentSequence[MAX_SENT];
+static uint8_t sentLength[MAX_SENT];
+static uint8_t sentPayload[MAX_SENT][PARAM_PERSISTENT_GET_ALL_PAYLOAD_SIZE];
+
+// Fake TOC: id 3 is a float, id 0x0102 a uint8, other ids are unknown
+static int fakeValueSizeOf(uint16_t id) {
+  if (id == 3) {
+    return 4;
+  }
+  if (id == 0x0102) {
+    return 1;
+  }
+
+  return -1;
+}
+
+// Helpers
+static bool fakeStorageStore(char* key, const void* buffer, size_t length, int cmock_num_calls);
+static size_t fakeStorageFetch(char* key, void* buffer, size_t length, int cmock_num_calls);
+static bool fakeStorageDelete(char* key, int cmock_num_calls);
+static int fakeStorageFind(const char* key);
+static void fakeSend(uint8_t sequence, const uint8_t* payload, uint8_t length);
+
+
+void setUp(void) {
+  memset(storage, 0, sizeof(storage));
+  storageStore_StubWithCallback(fakeStorageStore);
+  storageFetch_StubWithCallback(fakeStorageFetch);
+  storageDelete_StubWithCallback(fakeStorageDelete);
+
+  paramPersistentGetAllInit(&getAll);
+  sentCount = 0;
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatKeyIsPrefixGroupDotName() {
+  // Fixture
+  char key[PARAM_PERSISTENT_KEY_MAX_LENGTH];
+
+  // Test
+  bool actual = paramPersistentKey(key, "motion", "disable");
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_EQUAL_STRING("prm/motion.disable", key);
+}
+
+void testThatTooLongKeyIsRejected() {
+  // Fixture
+  char key[PARAM_PERSISTENT_KEY_MAX_LENGTH];
+  char name[PARAM_PERSISTENT_KEY_MAX_LENGTH];
+  memset(name, 'a', sizeof(name) - 1);
+  name[sizeof(name) - 1] = '\0';
+
+  // Test
+  bool actual = paramPersistentKey(key, "group", name);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+  TEST_ASSERT_EQUAL_UINT(PARAM_PERSISTENT_KEY_MAX_LENGTH - 1, strlen(key));
+}
+
+void testThatStoredValueIsFetched() {
+  // Fixture
+  float value = 3.5f;
+  paramPersistentStore("pid", "kp", PARAM_FLOAT, &value, sizeof(value));
+
+  // Test
+  float actual = 0.0f;
+  bool isFound = paramPersistentFetch("pid", "kp", PARAM_FLOAT, &actual, sizeof(actual));
+
+  // Assert
+  TEST_ASSERT_TRUE(isFound);
+  TEST_ASSERT_EQUAL_FLOAT(3.5f, actual);
+  TEST_ASSERT_EQUAL_INT(0, fakeStorageFind("prm/pid.kp"));
+}
+
+void testThatValueOfOtherTypeIsNotFetched() {
+  // Fixture
+  uint8_t value = 7;
+  paramPersistentStore("pid", "kp", PARAM_UINT8, &value, sizeof(value));
+
+  // Test
+  float actual = 0.0f;
+  bool isFound = paramPersistentFetch("pid", "kp", PARAM_FLOAT, &actual, sizeof(actual));
+
+  // Assert
+  TEST_ASSERT_FALSE(isFound);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, actual);
+}
+
+void testThatMissingValueIsNotFetched() {
+  // Fixture
+  // Test
+  float actual = 0.0f;
+  bool isFound = paramPersistentFetch("pid", "kp", PARAM_FLOAT, &actual, sizeof(actual));
+
+  // Assert
+  TEST_ASSERT_FALSE(isFound);
+}
+
+void testThatStoreFailsWhenStorageIsFull() {
+  // Fixture
+  uint8_t value = 1;
+  char name[] = "p0";
+  for (int i = 0; i < FAKE_STORAGE_SIZE; i++) {
+    name[1] = '0' + i;
+    paramPersistentStore("group", name, PARAM_UINT8, &value, sizeof(value));
+  }
+
+  // Test
+  bool actual = paramPersistentStore("group", "other", PARAM_UINT8, &value, sizeof(value));
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+}
+
+void testThatClearedValueIsNotFetched() {
+  // Fixture
+  uint8_t value = 7;
+  paramPersistentStore("ring", "effect", PARAM_UINT8, &value, sizeof(value));
+
+  // Test
+  bool isCleared = paramPersistentClear("ring", "effect");
+
+  // Assert
+  uint8_t actual = 0;
+  TEST_ASSERT_TRUE(isCleared);
+  TEST_ASSERT_FALSE(paramPersistentFetch("ring", "effect", PARAM_UINT8, &actual, sizeof(actual)));
+}
+
+void testThatClearOfMissingValueFails() {
+  // Fixture
+  // Test
+  bool actual = paramPersistentClear("ring", "effect");
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+}
+
+void testThatGetAllWithoutEntriesSendsOneEmptyLastPacket() {
+  // Fixture
+  // Test
+  paramPersistentGetAllFinish(&getAll, fakeSend);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(1, sentCount);
+  TEST_ASSERT_EQUAL_HEX8(PARAM_PERSISTENT_GET_ALL_LAST, sentSequence[0]);
+  TEST_ASSERT_EQUAL_UINT8(0, sentLength[0]);
+}
+
+void testThatGetAllEncodesEntriesAsBulkPayload() {
+  // Fixture
+  float value0 = 1.5f;
+  uint8_t value1 = 9;
+  paramBulkEntry_t entries[2];
+
+  // Test
+  paramPersistentGetAllAdd(&getAll, 3, &value0, sizeof(value0), fakeSend);
+  paramPersistentGetAllAdd(&getAll, 0x0102, &value1, sizeof(value1), fakeSend);
+  paramPersistentGetAllFinish(&getAll, fakeSend);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(1, sentCount);
+  TEST_ASSERT_EQUAL_HEX8(PARAM_PERSISTENT_GET_ALL_LAST, sentSequence[0]);
+  TEST_ASSERT_EQUAL_UINT8(2 + 4 + 2 + 1, sentLength[0]);
+  TEST_ASSERT_EQUAL_INT(2, paramBulkDecode(sentPayload[0], sentLength[0], fakeValueSizeOf, entries, 2, 0));
+  TEST_ASSERT_EQUAL_UINT16(3, entries[0].id);
+  TEST_ASSERT_EQUAL_UINT16(0x0102, entries[1].id);
+  TEST_ASSERT_EQUAL_UINT8(9, entries[1].value[0]);
+}
+
+void testThatGetAllSplitsEntriesOverPackets() {
+  // Fixture
+  uint64_t value = 0;
+  const int entriesPerPacket = PARAM_PERSISTENT_GET_ALL_PAYLOAD_SIZE / (2 + sizeof(value));
+
+  // Test
+  for (int i = 0; i < entriesPerPacket + 1; i++) {
+    paramPersistentGetAllAdd(&getAll, i, &value, sizeof(value), fakeSend);
+  }
+  paramPersistentGetAllFinish(&getAll, fakeSend);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(2, sentCount);
+  TEST_ASSERT_EQUAL_HEX8(0, sentSequence[0]);
+  TEST_ASSERT_EQUAL_UINT8(entriesPerPacket * (2 + sizeof(value)), sentLength[0]);
+  TEST_ASSERT_EQUAL_HEX8(1 | PARAM_PERSISTENT_GET_ALL_LAST, sentSequence[1]);
+  TEST_ASSERT_EQUAL_UINT8(2 + sizeof(value), sentLength[1]);
+}
+
+void testThatGetAllSequenceWrapsWithoutSettingTheLastFlag() {
+  // Fixture
+  uint64_t value = 0;
+  const int entriesPerPacket = PARAM_PERSISTENT_GET_ALL_PAYLOAD_SIZE / (2 + sizeof(value));
+  const int packets = 150;
+
+  // Test
+  for (int i = 0; i < packets * entriesPerPacket; i++) {
+    paramPersistentGetAllAdd(&getAll, i, &value, sizeof(value), fakeSend);
+  }
+  paramPersistentGetAllFinish(&getAll, fakeSend);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(packets, sentCount);
+  for (int i = 0; i < packets - 1; i++) {
+    TEST_ASSERT_EQUAL_HEX8(i & PARAM_PERSISTENT_GET_ALL_SEQUENCE_MASK, sentSequence[i]);
+  }
+  TEST_ASSERT_EQUAL_HEX8(((packets - 1) & PARAM_PERSISTENT_GET_ALL_SEQUENCE_MASK) | PARAM_PERSISTENT_GET_ALL_LAST, sentSequence[packets - 1]);
+}
+
+// Helpers ////////////////////////////////////////////////////////
+
+static bool fakeStorageStore(char* key, const void* buffer, size_t length, int cmock_num_calls) {
+  int index = fakeStorageFind(key);
+  if (index < 0) {
+    for (int i = 0; i < FAKE_STORAGE_SIZE && index < 0; i++) {
+      if (!storage[i].isUsed) {
+        index = i;
+      }
+    }
+  }
+
+  if (index < 0 || length > sizeof(storage[index].data)) {
+    return false;
+  }
+
+  storage[index].isUsed = true;
+  strcpy(storage[index].key, key);
+  memcpy(storage[index].data, buffer, length);
+  storage[index].length = length;
+  return true;
+}
+
+static size_t fakeStorageFetch(char* key, void* buffer, size_t length, int cmock_num_calls) {
+  const int index = fakeStorageFind(key);
+  if (index < 0) {
+    return 0;
+  }
+
+  const size_t copied = length < storage[index].length ? length : storage[index].length;
+  memcpy(buffer, storage[index].data, copied);
+  return copied;
+}
+
+static bool fakeStorageDelete(char* key, int cmock_num_calls) {
+  const int index = fakeStorageFind(key);
+  if (index < 0) {
+    return false;
+  }
+
+  storage[index].isUsed = false;
+  return true;
+}
+
+static int fakeStorageFind(const char* key) {
+  for (int i = 0; i < FAKE_STORAGE_SIZE; i++) {
+    if (storage[i].isUsed && strcmp(storage[i].key, key) == 0) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+static void fakeSend(uint8_t sequence, const uint8_t* payload, uint8_t length) {
+  TEST_ASSERT_TRUE(sentCount < MAX_SENT);
+  TEST_ASSERT_TRUE(length <= PARAM_PERSISTENT_GET_ALL_PAYLOAD_SIZE);
+
+  sentSequence[sentCount] = sequence;
+  sentLength[sentCount] = length;
+  memcpy(sentPayload[sentCount], payload, length);
+  sentCount++;
+}
@@ -0,0 +1,219 @@
+// File under test peer_broadcast_core.c
+#include "peer_broadcast_core.h"
+
+#include <string.h>
+
+#include "unity.h"
+
+#define OWN_ID 5
+
+static peerTdma_t tdma;
+
+// Helpers
+static void fixtureState(peerBroadcastState_t* state);
+
+
+void setUp(void) {
+  peerTdmaInit(&tdma, OWN_ID, 0);
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatItemIsCompact() {
+  // Fixture
+  // Test
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(25, sizeof(peerBroadcastItem_t));
+}
+
+void testThatStateIsDecodedAfterEncode() {
+  // Fixture
+  peerBroadcastState_t state;
+  fixtureState(&state);
+  peerBroadcastItem_t item;
+  peerBroadcastState_t actual;
+
+  // Test
+  peerBroadcastEncode(&state, &item);
+  const bool result = peerBroadcastDecode((const uint8_t*)&item, sizeof(item), &actual);
+
+  // Assert
+  TEST_ASSERT_TRUE(result);
+  TEST_ASSERT_EQUAL_UINT8(state.id, actual.id);
+  TEST_ASSERT_EQUAL_UINT8(state.slot, actual.slot);
+  for (int i = 0; i < 3; i++) {
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, state.position[i], actual.position[i]);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, state.velocity[i], actual.velocity[i]);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, state.intent[i], actual.intent[i]);
+  }
+  for (int i = 0; i < 4; i++) {
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, state.quat[i], actual.quat[i]);
+  }
+  TEST_ASSERT_TRUE(actual.isIntentValid);
+}
+
+void testThatInvalidIntentIsDecodedAsInvalid() {
+  // Fixture
+  peerBroadcastState_t state;
+  fixtureState(&state);
+  state.isIntentValid = false;
+  peerBroadcastItem_t item;
+  peerBroadcastState_t actual;
+
+  // Test
+  peerBroadcastEncode(&state, &item);
+  peerBroadcastDecode((const uint8_t*)&item, sizeof(item), &actual);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual.isIntentValid);
+}
+
+void testThatOutOfRangeValuesAreSaturated() {
+  // Fixture
+  peerBroadcastState_t state;
+  fixtureState(&state);
+  state.position[0] = 100.0f;
+  state.velocity[2] = -100.0f;
+  peerBroadcastItem_t item;
+
+  // Test
+  peerBroadcastEncode(&state, &item);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT16(INT16_MAX, item.x);
+  TEST_ASSERT_EQUAL_INT16(INT16_MIN, item.vz);
+}
+
+void testThatShortDataIsRejected() {
+  // Fixture
+  uint8_t data[sizeof(peerBroadcastItem_t)] = {0};
+  peerBroadcastState_t actual;
+
+  // Test
+  const bool result = peerBroadcastDecode(data, sizeof(data) - 1, &actual);
+
+  // Assert
+  TEST_ASSERT_FALSE(result);
+}
+
+void testThatSlotIsDerivedFromId() {
+  // Fixture
+  // Test
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(OWN_ID, peerTdmaSlotOf(&tdma, OWN_ID));
+  TEST_ASSERT_EQUAL_UINT8(3, peerTdmaSlotOf(&tdma, PEER_BROADCAST_DEFAULT_SLOT_COUNT + 3));
+}
+
+void testThatNextSlotStartIsInOwnSlot() {
+  // Fixture
+  const uint32_t expected = OWN_ID * PEER_BROADCAST_DEFAULT_SLOT_LENGTH;
+
+  // Test
+  const uint32_t actual = peerTdmaNextSlotStart(&tdma, 1);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(expected, actual);
+}
+
+void testThatNextSlotStartIsInNextFrameWhenAtSlotStart() {
+  // Fixture
+  const uint32_t period = PEER_BROADCAST_DEFAULT_SLOT_COUNT * PEER_BROADCAST_DEFAULT_SLOT_LENGTH;
+  const uint32_t now = OWN_ID * PEER_BROADCAST_DEFAULT_SLOT_LENGTH;
+
+  // Test
+  const uint32_t actual = peerTdmaNextSlotStart(&tdma, now);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(now + period, actual);
+}
+
+void testThatNextSlotStartHandlesTimerWrap() {
+  // Fixture
+  const uint32_t period = PEER_BROADCAST_DEFAULT_SLOT_COUNT * PEER_BROADCAST_DEFAULT_SLOT_LENGTH;
+  peerTdmaInit(&tdma, OWN_ID, UINT32_MAX - 10);
+  const uint32_t now = UINT32_MAX - 10 + 3 * period + 1;
+
+  // Test
+  const uint32_t actual = peerTdmaNextSlotStart(&tdma, now);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(UINT32_MAX - 10 + 3 * period + OWN_ID * PEER_BROADCAST_DEFAULT_SLOT_LENGTH, actual);
+}
+
+void testThatFrameIsAlignedToLowerId() {
+  // Fixture
+  const uint8_t senderId = 2;
+  const uint32_t rxTime = 1003;
+
+  // Test
+  const bool result = peerTdmaOnReceive(&tdma, senderId, senderId, rxTime);
+  const uint32_t actual = peerTdmaNextSlotStart(&tdma, rxTime);
+
+  // Assert
+  TEST_ASSERT_TRUE(result);
+  TEST_ASSERT_EQUAL_UINT8(senderId, tdma.referenceId);
+  TEST_ASSERT_EQUAL_UINT32(rxTime + (OWN_ID - senderId) * PEER_BROADCAST_DEFAULT_SLOT_LENGTH, actual);
+}
+
+void testThatFrameIsNotAlignedToHigherId() {
+  // Fixture
+  const uint32_t frameStart = tdma.frameStart;
+
+  // Test
+  const bool result = peerTdmaOnReceive(&tdma, OWN_ID + 1, OWN_ID + 1, 1003);
+
+  // Assert
+  TEST_ASSERT_FALSE(result);
+  TEST_ASSERT_EQUAL_UINT8(OWN_ID, tdma.referenceId);
+  TEST_ASSERT_EQUAL_UINT32(frameStart, tdma.frameStart);
+}
+
+void testThatLowerIdThanReferenceIsIgnoredUntilTimeout() {
+  // Fixture
+  peerTdmaOnReceive(&tdma, 1, 1, 1000);
+
+  // Test
+  const bool resultBeforeTimeout = peerTdmaOnReceive(&tdma, 3, 3, 1000 + PEER_BROADCAST_REFERENCE_TIMEOUT);
+  const bool resultAfterTimeout = peerTdmaOnReceive(&tdma, 3, 3, 1001 + PEER_BROADCAST_REFERENCE_TIMEOUT);
+
+  // Assert
+  TEST_ASSERT_FALSE(resultBeforeTimeout);
+  TEST_ASSERT_TRUE(resultAfterTimeout);
+  TEST_ASSERT_EQUAL_UINT8(3, tdma.referenceId);
+}
+
+void testThatZeroSlotParametersAreHandled() {
+  // Fixture
+  tdma.slotCount = 0;
+  tdma.slotLength = 0;
+
+  // Test
+  const uint32_t actual = peerTdmaNextSlotStart(&tdma, 100);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(101, actual);
+}
+
+// Helpers ////////////////////////////////////////////////////////////////////
+
+static void fixtureState(peerBroadcastState_t* state) {
+  memset(state, 0, sizeof(*state));
+  state->id = 7;
+  state->slot = 7;
+  state->position[0] = 1.234f;
+  state->position[1] = -2.5f;
+  state->position[2] = 0.75f;
+  state->velocity[0] = 0.1f;
+  state->velocity[1] = -0.2f;
+  state->velocity[2] = 0.3f;
+  state->quat[0] = 0.0f;
+  state->quat[1] = 0.0f;
+  state->quat[2] = 0.3826834f;
+  state->quat[3] = 0.9238795f;
+  state->intent[0] = 2.0f;
+  state->intent[1] = 1.0f;
+  state->intent[2] = 1.5f;
+  state->isIntentValid = true;
+}
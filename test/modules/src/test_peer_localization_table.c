@@ -0,0 +1,226 @@
+// File under test peer_localization_table.c
+#include "peer_localization_table.h"
+
+#include "unity.h"
+
+static peerLocalizationTable_t table;
+
+// Helpers
+static bool update(const uint8_t id, const float x, const uint32_t now);
+
+
+void setUp(void) {
+  peerLocalizationTableInit(&table);
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatUnknownIdIsNotFound() {
+  // Fixture
+  // Test
+  peerLocalizationOtherPosition_t* actual = peerLocalizationTableFind(&table, 17, 0);
+
+  // Assert
+  TEST_ASSERT_NULL(actual);
+}
+
+void testThatUpdatedIdIsFound() {
+  // Fixture
+  update(17, 1.0f, 100);
+
+  // Test
+  peerLocalizationOtherPosition_t* actual = peerLocalizationTableFind(&table, 17, 100);
+
+  // Assert
+  TEST_ASSERT_NOT_NULL(actual);
+  TEST_ASSERT_EQUAL_UINT8(17, actual->id);
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, actual->pos.x);
+  TEST_ASSERT_EQUAL_UINT32(100, actual->pos.timestamp);
+}
+
+void testThatStaleIndexIsNotFollowedToAnotherId() {
+  // Fixture
+  update(17, 1.0f, 100);
+  table.entryOfId[18] = table.entryOfId[17];
+
+  // Test
+  peerLocalizationOtherPosition_t* actual = peerLocalizationTableFind(&table, 18, 100);
+
+  // Assert
+  TEST_ASSERT_NULL(actual);
+  TEST_ASSERT_EQUAL_UINT8(0, table.entryOfId[18]);
+  TEST_ASSERT_NOT_NULL(peerLocalizationTableFind(&table, 17, 100));
+}
+
+void testThatIdZeroIsRejected() {
+  // Fixture
+  // Test
+  const bool actual = update(0, 1.0f, 100);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+}
+
+void testThatUpdateOfSameIdUsesSameEntry() {
+  // Fixture
+  update(17, 1.0f, 100);
+
+  // Test
+  update(17, 2.0f, 110);
+
+  // Assert
+  uint8_t index = 0;
+  TEST_ASSERT_NOT_NULL(peerLocalizationTableNext(&table, &index, 110));
+  TEST_ASSERT_NULL(peerLocalizationTableNext(&table, &index, 110));
+}
+
+void testThatUpdateFailsWhenTableIsFull() {
+  // Fixture
+  for (int i = 0; i < PEER_LOCALIZATION_MAX_NEIGHBORS; i++) {
+    update(i + 1, 0.0f, 100);
+  }
+
+  // Test
+  const bool actual = update(200, 1.0f, 100);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+}
+
+void testThatExpiredEntryIsNotFound() {
+  // Fixture
+  update(17, 1.0f, 100);
+
+  // Test
+  peerLocalizationOtherPosition_t* beforeExpiry = peerLocalizationTableFind(&table, 17, 100 + table.maxAge);
+  peerLocalizationOtherPosition_t* afterExpiry = peerLocalizationTableFind(&table, 17, 101 + table.maxAge);
+
+  // Assert
+  TEST_ASSERT_NOT_NULL(beforeExpiry);
+  TEST_ASSERT_NULL(afterExpiry);
+}
+
+void testThatExpiredEntryIsReused() {
+  // Fixture
+  for (int i = 0; i < PEER_LOCALIZATION_MAX_NEIGHBORS; i++) {
+    update(i + 1, 0.0f, 100);
+  }
+  update(1, 0.0f, 200);
+
+  // Test
+  const bool actual = update(200, 1.0f, 101 + table.maxAge);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_NOT_NULL(peerLocalizationTableFind(&table, 200, 101 + table.maxAge));
+  TEST_ASSERT_NOT_NULL(peerLocalizationTableFind(&table, 1, 101 + table.maxAge));
+  TEST_ASSERT_NULL(peerLocalizationTableFind(&table, 2, 101 + table.maxAge));
+}
+
+void testThatIteratorSkipsFreeAndExpiredEntries() {
+  // Fixture
+  update(1, 0.0f, 100);
+  update(2, 0.0f, 2000);
+  update(3, 0.0f, 100);
+  update(4, 0.0f, 3000);
+  const uint32_t now = 101 + table.maxAge;
+
+  // Test
+  uint8_t index = 0;
+  peerLocalizationOtherPosition_t* first = peerLocalizationTableNext(&table, &index, now);
+  peerLocalizationOtherPosition_t* second = peerLocalizationTableNext(&table, &index, now);
+  peerLocalizationOtherPosition_t* third = peerLocalizationTableNext(&table, &index, now);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(2, first->id);
+  TEST_ASSERT_EQUAL_UINT8(4, second->id);
+  TEST_ASSERT_NULL(third);
+  TEST_ASSERT_NULL(peerLocalizationTableFind(&table, 1, now));
+}
+
+void testThatEntryUpdatedAfterNowIsNotExpired() {
+  // Fixture
+  update(17, 1.0f, 100);
+
+  // Test
+  peerLocalizationOtherPosition_t* actual = peerLocalizationTableFind(&table, 17, 99);
+
+  // Assert
+  TEST_ASSERT_NOT_NULL(actual);
+}
+
+void testThatVelocityIsComputedFromPositions() {
+  // Fixture
+  update(17, 1.0f, 100);
+
+  // Test
+  update(17, 1.5f, 200);
+
+  // Assert
+  peerLocalizationOtherPosition_t* actual = peerLocalizationTableFind(&table, 17, 200);
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 5.0f, actual->vel.x);
+}
+
+void testThatVelocityIsNotComputedFromOldPosition() {
+  // Fixture
+  update(17, 1.0f, 100);
+  update(17, 1.5f, 200);
+
+  // Test
+  update(17, 2.0f, 201 + PEER_LOCALIZATION_MAX_VELOCITY_DT);
+
+  // Assert
+  peerLocalizationOtherPosition_t* actual = peerLocalizationTableFind(&table, 17, 201 + PEER_LOCALIZATION_MAX_VELOCITY_DT);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, actual->vel.x);
+}
+
+void testThatGivenVelocityIsUsed() {
+  // Fixture
+  const velocity_t vel = {.x = 0.1f, .y = 0.2f, .z = 0.3f};
+
+  // Test
+  peerLocalizationTableUpdate(&table, 17, 1.0f, 2.0f, 3.0f, &vel, 100);
+
+  // Assert
+  peerLocalizationOtherPosition_t* actual = peerLocalizationTableFind(&table, 17, 100);
+  TEST_ASSERT_EQUAL_FLOAT(0.1f, actual->vel.x);
+  TEST_ASSERT_EQUAL_FLOAT(0.2f, actual->vel.y);
+  TEST_ASSERT_EQUAL_FLOAT(0.3f, actual->vel.z);
+}
+
+void testThatPositionIsPredictedWithVelocity() {
+  // Fixture
+  const velocity_t vel = {.x = 1.0f, .y = -2.0f, .z = 0.0f};
+  peerLocalizationTableUpdate(&table, 17, 1.0f, 2.0f, 3.0f, &vel, 100);
+  point_t actual;
+
+  // Test
+  peerLocalizationTablePredict(peerLocalizationTableFind(&table, 17, 150), 150, &actual);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, 1.05f, actual.x);
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, 1.9f, actual.y);
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, 3.0f, actual.z);
+  TEST_ASSERT_EQUAL_UINT32(150, actual.timestamp);
+}
+
+void testThatPredictionIsLimited() {
+  // Fixture
+  const velocity_t vel = {.x = 1.0f, .y = 0.0f, .z = 0.0f};
+  peerLocalizationTableUpdate(&table, 17, 0.0f, 0.0f, 0.0f, &vel, 100);
+  point_t actual;
+
+  // Test
+  peerLocalizationTablePredict(peerLocalizationTableFind(&table, 17, 100), 100 + 10 * PEER_LOCALIZATION_MAX_PREDICTION, &actual);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, PEER_LOCALIZATION_MAX_PREDICTION / 1000.0f, actual.x);
+}
+
+// Helpers ////////////////////////////////////////////////////////////////////
+
+static bool update(const uint8_t id, const float x, const uint32_t now) {
+  return peerLocalizationTableUpdate(&table, id, x, 0.0f, 0.0f, NULL, now);
+}
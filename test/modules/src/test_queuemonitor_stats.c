@@ -0,0 +1,205 @@
+// File under test queuemonitor_stats.c
+#include "queuemonitor_stats.h"
+
+#include "unity.h"
+
+static qmStats_t stats;
+
+// Helpers
+static uint32_t histogramSum();
+
+
+void setUp(void) {
+  qmStatsInit(&stats);
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatWaitTimeIsMeasuredFromSendToReceive() {
+  // Fixture
+  qmStatsOnSend(&stats, 1000, 0);
+
+  // Test
+  qmStatsOnReceive(&stats, 1300);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(300, stats.maxWait);
+  TEST_ASSERT_EQUAL_UINT32(1, stats.histogram[qmStatsBucketOf(300)]);
+  TEST_ASSERT_EQUAL_UINT32(1, histogramSum());
+}
+
+void testThatItemsAreReceivedInSendOrder() {
+  // Fixture
+  qmStatsOnSend(&stats, 1000, 0);
+  qmStatsOnSend(&stats, 2000, 1);
+
+  // Test
+  qmStatsOnReceive(&stats, 2010);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(1010, stats.maxWait);
+}
+
+void testThatWaitTimeIsMeasuredOverTimerWrap() {
+  // Fixture
+  qmStatsOnSend(&stats, 0xfffffff0, 0);
+
+  // Test
+  qmStatsOnReceive(&stats, 0x10);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(0x20, stats.maxWait);
+}
+
+void testThatHighWaterIsTheLargestFillLevel() {
+  // Fixture
+  qmStatsOnSend(&stats, 0, 0);
+  qmStatsOnSend(&stats, 0, 1);
+  qmStatsOnReceive(&stats, 0);
+  qmStatsOnReceive(&stats, 0);
+
+  // Test
+  qmStatsOnSend(&stats, 0, 0);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT16(2, stats.highWater);
+  TEST_ASSERT_EQUAL_UINT32(3, stats.sendCount);
+  TEST_ASSERT_EQUAL_UINT32(2, stats.receiveCount);
+}
+
+void testThatFailedSendIsCounted() {
+  // Fixture
+  // Test
+  qmStatsOnSendFailed(&stats);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(1, stats.fullCount);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.sendCount);
+}
+
+void testThatBucketsAreLogScale() {
+  // Fixture
+  // Test
+  // Assert
+  TEST_ASSERT_EQUAL_INT(0, qmStatsBucketOf(0));
+  TEST_ASSERT_EQUAL_INT(0, qmStatsBucketOf(15));
+  TEST_ASSERT_EQUAL_INT(1, qmStatsBucketOf(16));
+  TEST_ASSERT_EQUAL_INT(1, qmStatsBucketOf(63));
+  TEST_ASSERT_EQUAL_INT(2, qmStatsBucketOf(64));
+  TEST_ASSERT_EQUAL_INT(6, qmStatsBucketOf(65535));
+  TEST_ASSERT_EQUAL_INT(QM_STATS_BUCKET_COUNT - 1, qmStatsBucketOf(65536));
+  TEST_ASSERT_EQUAL_INT(QM_STATS_BUCKET_COUNT - 1, qmStatsBucketOf(0xffffffff));
+}
+
+void testThatItemsBeyondTheTimestampRingAreNotMeasured() {
+  // Fixture
+  const uint32_t itemCount = QM_STATS_TIMESTAMP_COUNT + 2;
+  for (uint32_t i = 0; i < itemCount; i++) {
+    qmStatsOnSend(&stats, i, i);
+  }
+
+  // Test
+  for (uint32_t i = 0; i < itemCount; i++) {
+    qmStatsOnReceive(&stats, 100);
+  }
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(QM_STATS_TIMESTAMP_COUNT, histogramSum());
+  TEST_ASSERT_EQUAL_UINT32(100, stats.maxWait);
+  TEST_ASSERT_EQUAL_UINT8(0, stats.count);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.untrackedCount);
+}
+
+void testThatTrackingResumesWhenUntrackedItemsAreReceived() {
+  // Fixture
+  for (uint32_t i = 0; i < QM_STATS_TIMESTAMP_COUNT + 1; i++) {
+    qmStatsOnSend(&stats, 0, i);
+  }
+  for (uint32_t i = 0; i < QM_STATS_TIMESTAMP_COUNT + 1; i++) {
+    qmStatsOnReceive(&stats, 10);
+  }
+
+  // Test
+  qmStatsOnSend(&stats, 1000, 0);
+  qmStatsOnReceive(&stats, 3000);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(2000, stats.maxWait);
+}
+
+void testThatItemsRemovedWithoutReceiveAreForgotten() {
+  // Fixture
+  qmStatsOnSend(&stats, 1000, 0);
+  qmStatsOnSend(&stats, 1000, 1);
+  // The queue is reset
+
+  // Test
+  qmStatsOnSend(&stats, 5000, 0);
+  qmStatsOnReceive(&stats, 5100);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(100, stats.maxWait);
+  TEST_ASSERT_EQUAL_UINT8(0, stats.count);
+}
+
+void testThatUnknownItemsInTheQueueAreNotMeasured() {
+  // Fixture
+  // The queue holds 2 items we have not seen
+
+  qmStatsOnSend(&stats, 1000, 2);
+  qmStatsOnReceive(&stats, 1100);
+  qmStatsOnReceive(&stats, 1200);
+  qmStatsOnReceive(&stats, 1300);
+
+  // Test
+  qmStatsOnSend(&stats, 2000, 0);
+  qmStatsOnReceive(&stats, 2040);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(1, histogramSum());
+  TEST_ASSERT_EQUAL_UINT32(40, stats.maxWait);
+}
+
+void testThatOverwriteReplacesTheNewestItem() {
+  // Fixture
+  qmStatsOnSend(&stats, 1000, 0);
+
+  // Test
+  qmStatsOnOverwrite(&stats, 1800, 1);
+  qmStatsOnReceive(&stats, 2000);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(200, stats.maxWait);
+  TEST_ASSERT_EQUAL_UINT16(1, stats.highWater);
+  TEST_ASSERT_EQUAL_UINT8(0, stats.count);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.untrackedCount);
+}
+
+void testThatResetCountersKeepsTrackOfItemsInTheQueue() {
+  // Fixture
+  qmStatsOnSend(&stats, 1000, 0);
+  qmStatsOnSendFailed(&stats);
+
+  // Test
+  qmStatsResetCounters(&stats);
+  qmStatsOnReceive(&stats, 1050);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(0, stats.sendCount);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.fullCount);
+  TEST_ASSERT_EQUAL_UINT16(0, stats.highWater);
+  TEST_ASSERT_EQUAL_UINT32(50, stats.maxWait);
+  TEST_ASSERT_EQUAL_UINT32(1, histogramSum());
+}
+
+// Helpers ////////////////////////////////////////////////////////////////
+
+static uint32_t histogramSum() {
+  uint32_t sum = 0;
+  for (int i = 0; i < QM_STATS_BUCKET_COUNT; i++) {
+    sum += stats.histogram[i];
+  }
+  return sum;
+}
@@ -0,0 +1,337 @@
+// File under test kve.c
+#include "kve/kve.h"
+#include "kve/kve_storage.h"
+#include "kve/kve_index.h"
+
+#include "unity.h"
+#include <string.h>
+
+#define TEST_MEMORY_SIZE 200
+#define TEST_INDEX_CAPACITY 8
+
+static size_t min(size_t a, size_t b)
+{
+    if (a < b) {
+        return a;
+    } else {
+        return b;
+    }
+}
+
+char memory[TEST_MEMORY_SIZE];
+char cacheMemory[TEST_MEMORY_SIZE];
+
+static int readCount;
+static int flushCount;
+
+size_t kvememoryRead(size_t address, void* data, size_t length) {
+    readCount++;
+
+    if(address > TEST_MEMORY_SIZE) {
+        return 0;
+    }
+    size_t toRead = min(length, TEST_MEMORY_SIZE - address);
+    memcpy(data, &cacheMemory[address], toRead);
+
+    return toRead;
+}
+
+size_t kvememoryWrite(size_t address, const void* data, size_t length) {
+    if(address > TEST_MEMORY_SIZE) {
+        return 0;
+    }
+    size_t toWrite = min(length, TEST_MEMORY_SIZE - address);
+    memcpy(&cacheMemory[address], data, toWrite);
+
+    return toWrite;
+}
+
+void kvememoryFlush() {
+    flushCount++;
+    memcpy(memory, cacheMemory, TEST_MEMORY_SIZE);
+}
+
+static kveIndexEntry_t indexEntries[TEST_INDEX_CAPACITY];
+static kveIndex_t kveIndex;
+
+kveMemory_t kveMemory = {
+    .memorySize = TEST_MEMORY_SIZE,
+    .read = kvememoryRead,
+    .write = kvememoryWrite,
+    .flush = kvememoryFlush,
+    .index = &kveIndex,
+};
+
+kveMemory_t kveMemoryNoIndex = {
+    .memorySize = TEST_MEMORY_SIZE,
+    .read = kvememoryRead,
+    .write = kvememoryWrite,
+    .flush = kvememoryFlush,
+};
+
+void setUp(void) {
+    // The full memory is initialized to the characted 'a'
+    memset(memory, 'a', TEST_MEMORY_SIZE);
+    memset(cacheMemory, 'a', TEST_MEMORY_SIZE);
+
+    kveIndexInit(&kveIndex, indexEntries, TEST_INDEX_CAPACITY);
+    readCount = 0;
+    flushCount = 0;
+}
+
+void testThatBuildIndexFindsAllItems() {
+  // Fixture
+  kveFormat(&kveMemoryNoIndex);
+  kveStore(&kveMemoryNoIndex, "hello", "world", 5);
+  kveStore(&kveMemoryNoIndex, "key", "value", 5);
+  kveStore(&kveMemoryNoIndex, "other", "x", 1);
+
+  // Test
+  bool actual = kveBuildIndex(&kveMemory);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_EQUAL(3, kveIndex.count);
+  TEST_ASSERT_EQUAL(kveStorageFindEnd(&kveMemory, 1), kveIndex.endAddress);
+}
+
+void testThatBuildIndexSkipsHoles() {
+  // Fixture
+  kveFormat(&kveMemoryNoIndex);
+  kveStore(&kveMemoryNoIndex, "hello", "world", 5);
+  kveStore(&kveMemoryNoIndex, "key", "value", 5);
+  kveDelete(&kveMemoryNoIndex, "hello");
+
+  // Test
+  kveBuildIndex(&kveMemory);
+
+  // Assert
+  TEST_ASSERT_EQUAL(1, kveIndex.count);
+}
+
+void testThatBuildIndexFailsOnWrongVersion() {
+  // Fixture
+  // Memory is not formatted
+
+  // Test
+  bool actual = kveBuildIndex(&kveMemory);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+  TEST_ASSERT_FALSE(kveIndex.isValid);
+}
+
+void testThatBuildIndexFailsWhenIndexIsFull() {
+  // Fixture
+  char key[] = "k0";
+  kveFormat(&kveMemoryNoIndex);
+  for (int i = 0; i < TEST_INDEX_CAPACITY; i++) {
+    key[1] = '0' + i;
+    kveStore(&kveMemoryNoIndex, key, "v", 1);
+  }
+
+  // Test
+  bool actual = kveBuildIndex(&kveMemory);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+}
+
+void testThatIndexedFetchReturnsTheStoredData() {
+  // Fixture
+  char buffer[10] = {0};
+  kveFormat(&kveMemory);
+  kveStore(&kveMemory, "hello", "world", 5);
+  kveStore(&kveMemory, "key", "value", 5);
+
+  // Test
+  size_t actual = kveFetch(&kveMemory, "key", buffer, sizeof(buffer));
+
+  // Assert
+  TEST_ASSERT_EQUAL(5, actual);
+  TEST_ASSERT_EQUAL_MEMORY("value", buffer, 5);
+}
+
+void testThatIndexedFetchOnlyReadsKeyAndData() {
+  // Fixture
+  char buffer[10];
+  kveFormat(&kveMemory);
+  kveStore(&kveMemory, "a", "1", 1);
+  kveStore(&kveMemory, "b", "2", 1);
+  kveStore(&kveMemory, "c", "3", 1);
+  kveStore(&kveMemory, "hello", "world", 5);
+  readCount = 0;
+
+  // Test
+  kveFetch(&kveMemory, "hello", buffer, sizeof(buffer));
+
+  // Assert
+  TEST_ASSERT_EQUAL(2, readCount);
+}
+
+void testThatIndexedFetchOfMissingKeyDoesNotReadMemory() {
+  // Fixture
+  char buffer[10];
+  kveFormat(&kveMemory);
+  kveStore(&kveMemory, "hello", "world", 5);
+  readCount = 0;
+
+  // Test
+  size_t actual = kveFetch(&kveMemory, "nothere", buffer, sizeof(buffer));
+
+  // Assert
+  TEST_ASSERT_EQUAL(0, actual);
+  TEST_ASSERT_EQUAL(0, readCount);
+}
+
+void testThatIndexFollowsDelete() {
+  // Fixture
+  char buffer[10];
+  kveFormat(&kveMemory);
+  kveStore(&kveMemory, "hello", "world", 5);
+  kveStore(&kveMemory, "key", "value", 5);
+
+  // Test
+  kveDelete(&kveMemory, "hello");
+
+  // Assert
+  TEST_ASSERT_EQUAL(0, kveFetch(&kveMemory, "hello", buffer, sizeof(buffer)));
+  TEST_ASSERT_EQUAL(5, kveFetch(&kveMemory, "key", buffer, sizeof(buffer)));
+  TEST_ASSERT_EQUAL(1, kveIndex.count);
+}
+
+void testThatIndexFollowsStoreWithNewLength() {
+  // Fixture
+  char buffer[10] = {0};
+  kveFormat(&kveMemory);
+  kveStore(&kveMemory, "hello", "world", 5);
+  kveStore(&kveMemory, "key", "value", 5);
+
+  // Test
+  kveStore(&kveMemory, "hello", "there!", 6);
+
+  // Assert
+  TEST_ASSERT_EQUAL(6, kveFetch(&kveMemory, "hello", buffer, sizeof(buffer)));
+  TEST_ASSERT_EQUAL_MEMORY("there!", buffer, 6);
+  TEST_ASSERT_EQUAL(2, kveIndex.count);
+  TEST_ASSERT_EQUAL(kveStorageFindEnd(&kveMemory, 1), kveIndex.endAddress);
+}
+
+void testThatIndexFollowsDefrag() {
+  // Fixture
+  char buffer[10] = {0};
+  kveFormat(&kveMemory);
+  kveStore(&kveMemory, "hello", "world", 5);
+  kveStore(&kveMemory, "key", "value", 5);
+  kveDelete(&kveMemory, "hello");
+
+  // Test
+  kveDefrag(&kveMemory);
+
+  // Assert
+  TEST_ASSERT_TRUE(kveIndex.isValid);
+  TEST_ASSERT_EQUAL(5, kveFetch(&kveMemory, "key", buffer, sizeof(buffer)));
+  TEST_ASSERT_EQUAL_MEMORY("value", buffer, 5);
+  TEST_ASSERT_EQUAL(kveStorageFindEnd(&kveMemory, 1), kveIndex.endAddress);
+}
+
+void testThatIndexedAndNonIndexedTablesAreIdentical() {
+  // Fixture
+  char indexedMemory[TEST_MEMORY_SIZE];
+  kveFormat(&kveMemoryNoIndex);
+  kveStore(&kveMemoryNoIndex, "hello", "world", 5);
+  kveStore(&kveMemoryNoIndex, "key", "value", 5);
+  kveStore(&kveMemoryNoIndex, "hello", "hi", 2);
+  kveDelete(&kveMemoryNoIndex, "key");
+  kveStore(&kveMemoryNoIndex, "third", "3", 1);
+  char notIndexedMemory[TEST_MEMORY_SIZE];
+  memcpy(notIndexedMemory, memory, TEST_MEMORY_SIZE);
+
+  setUp();
+
+  // Test
+  kveFormat(&kveMemory);
+  kveStore(&kveMemory, "hello", "world", 5);
+  kveStore(&kveMemory, "key", "value", 5);
+  kveStore(&kveMemory, "hello", "hi", 2);
+  kveDelete(&kveMemory, "key");
+  kveStore(&kveMemory, "third", "3", 1);
+  memcpy(indexedMemory, memory, TEST_MEMORY_SIZE);
+
+  // Assert
+  TEST_ASSERT_EQUAL_MEMORY(notIndexedMemory, indexedMemory, TEST_MEMORY_SIZE);
+}
+
+void testThatIndexHandlesHashCollisionsInTheSameSlot() {
+  // Fixture
+  char buffer[10] = {0};
+  char key[] = "k0";
+  kveFormat(&kveMemory);
+
+  // With capacity 8, 7 keys share slots in any case
+  for (int i = 0; i < TEST_INDEX_CAPACITY - 1; i++) {
+    key[1] = '0' + i;
+    buffer[0] = 'A' + i;
+    kveStore(&kveMemory, key, buffer, 1);
+  }
+  kveDelete(&kveMemory, "k2");
+  kveDelete(&kveMemory, "k4");
+
+  // Test
+  // Assert
+  for (int i = 0; i < TEST_INDEX_CAPACITY - 1; i++) {
+    key[1] = '0' + i;
+    size_t expected = ((i == 2) || (i == 4)) ? 0 : 1;
+    TEST_ASSERT_EQUAL(expected, kveFetch(&kveMemory, key, buffer, sizeof(buffer)));
+    if (expected) {
+      TEST_ASSERT_EQUAL('A' + i, buffer[0]);
+    }
+  }
+}
+
+void testThatFullIndexFallsBackToMemorySearch() {
+  // Fixture
+  char buffer[10] = {0};
+  char key[] = "k0";
+  kveFormat(&kveMemory);
+
+  // Test
+  for (int i = 0; i < TEST_INDEX_CAPACITY + 2; i++) {
+    key[1] = '0' + i;
+    kveStore(&kveMemory, key, "v", 1);
+  }
+
+  // Assert
+  TEST_ASSERT_FALSE(kveIndex.isValid);
+  for (int i = 0; i < TEST_INDEX_CAPACITY + 2; i++) {
+    key[1] = '0' + i;
+    TEST_ASSERT_EQUAL(1, kveFetch(&kveMemory, key, buffer, sizeof(buffer)));
+  }
+}
+
+void testThatStoreIsFlushedOnceWhenDone() {
+  // Fixture
+  kveFormat(&kveMemory);
+  flushCount = 0;
+
+  // Test
+  kveStore(&kveMemory, "hello", "world", 5);
+
+  // Assert
+  TEST_ASSERT_EQUAL(1, flushCount);
+  TEST_ASSERT_EQUAL_MEMORY(cacheMemory, memory, TEST_MEMORY_SIZE);
+}
+
+void testThatDeleteIsFlushedWhenDone() {
+  // Fixture
+  kveFormat(&kveMemory);
+  kveStore(&kveMemory, "hello", "world", 5);
+  flushCount = 0;
+
+  // Test
+  kveDelete(&kveMemory, "hello");
+
+  // Assert
+  TEST_ASSERT_EQUAL(1, flushCount);
+  TEST_ASSERT_EQUAL_MEMORY(cacheMemory, memory, TEST_MEMORY_SIZE);
+}
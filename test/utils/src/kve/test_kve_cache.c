@@ -0,0 +1,272 @@
+// File under test kve_cache.c
+#include "kve/kve_cache.h"
+#include "kve/kve.h"
+#include "kve/kve_storage.h"
+#include "kve/kve_index.h"
+
+#include "unity.h"
+#include <string.h>
+
+#define TEST_MEMORY_SIZE 1000
+
+static size_t min(size_t a, size_t b)
+{
+    if (a < b) {
+        return a;
+    } else {
+        return b;
+    }
+}
+
+// Backing memory
+char memory[TEST_MEMORY_SIZE];
+
+static int backingReadCount;
+static int backingWriteCount;
+static size_t lastWriteAddress;
+static size_t lastWriteLength;
+
+size_t backingRead(size_t address, void* data, size_t length) {
+    backingReadCount++;
+
+    if(address > TEST_MEMORY_SIZE) {
+        return 0;
+    }
+    size_t toRead = min(length, TEST_MEMORY_SIZE - address);
+    memcpy(data, &memory[address], toRead);
+
+    return toRead;
+}
+
+size_t backingWrite(size_t address, const void* data, size_t length) {
+    backingWriteCount++;
+    lastWriteAddress = address;
+    lastWriteLength = length;
+
+    if(address > TEST_MEMORY_SIZE) {
+        return 0;
+    }
+    size_t toWrite = min(length, TEST_MEMORY_SIZE - address);
+    memcpy(&memory[address], data, toWrite);
+
+    return toWrite;
+}
+
+static uint8_t cacheData[TEST_MEMORY_SIZE];
+static uint32_t loadedBlocks[KVE_CACHE_BITFIELD_LENGTH(TEST_MEMORY_SIZE, KVE_CACHE_BLOCK_SIZE)];
+static uint32_t dirtyPages[KVE_CACHE_BITFIELD_LENGTH(TEST_MEMORY_SIZE, KVE_CACHE_PAGE_SIZE)];
+static kveCache_t cache;
+
+// kve memory on top of the cache
+size_t cachedRead(size_t address, void* data, size_t length) {
+    return kveCacheRead(&cache, address, data, length);
+}
+
+size_t cachedWrite(size_t address, const void* data, size_t length) {
+    return kveCacheWrite(&cache, address, data, length);
+}
+
+void cachedFlush() {
+    kveCacheFlush(&cache);
+}
+
+static kveIndexEntry_t indexEntries[16];
+static kveIndex_t index;
+
+kveMemory_t kveMemory = {
+    .memorySize = TEST_MEMORY_SIZE,
+    .read = cachedRead,
+    .write = cachedWrite,
+    .flush = cachedFlush,
+    .index = &index,
+};
+
+void setUp(void) {
+    // The full memory is initialized to the characted 'a'
+    memset(memory, 'a', TEST_MEMORY_SIZE);
+    memset(cacheData, 0, TEST_MEMORY_SIZE);
+
+    kveCacheInit(&cache, cacheData, TEST_MEMORY_SIZE, loadedBlocks, dirtyPages, backingRead, backingWrite);
+    kveIndexInit(&index, indexEntries, 16);
+
+    backingReadCount = 0;
+    backingWriteCount = 0;
+}
+
+void testThatReadLoadsFromBackingMemory() {
+  // Fixture
+  char buffer[5];
+  memcpy(&memory[10], "hello", 5);
+
+  // Test
+  size_t actual = kveCacheRead(&cache, 10, buffer, 5);
+
+  // Assert
+  TEST_ASSERT_EQUAL(5, actual);
+  TEST_ASSERT_EQUAL_MEMORY("hello", buffer, 5);
+}
+
+void testThatSecondReadInSameBlockDoesNotAccessBackingMemory() {
+  // Fixture
+  char buffer[5];
+  kveCacheRead(&cache, 10, buffer, 5);
+
+  // Test
+  kveCacheRead(&cache, 100, buffer, 5);
+
+  // Assert
+  TEST_ASSERT_EQUAL(1, backingReadCount);
+}
+
+void testThatReadAcrossBlocksLoadsBothBlocks() {
+  // Fixture
+  char buffer[10];
+
+  // Test
+  kveCacheRead(&cache, KVE_CACHE_BLOCK_SIZE - 5, buffer, 10);
+
+  // Assert
+  TEST_ASSERT_EQUAL(2, backingReadCount);
+  TEST_ASSERT_EQUAL_MEMORY("aaaaaaaaaa", buffer, 10);
+}
+
+void testThatReadIsClippedAtEndOfMemory() {
+  // Fixture
+  char buffer[10];
+
+  // Test
+  size_t actual = kveCacheRead(&cache, TEST_MEMORY_SIZE - 4, buffer, 10);
+
+  // Assert
+  TEST_ASSERT_EQUAL(4, actual);
+}
+
+void testThatWriteIsNotWrittenBackBeforeFlush() {
+  // Fixture
+
+  // Test
+  kveCacheWrite(&cache, 10, "hello", 5);
+
+  // Assert
+  TEST_ASSERT_EQUAL(0, backingWriteCount);
+  TEST_ASSERT_EQUAL_MEMORY("aaaaa", &memory[10], 5);
+  TEST_ASSERT_TRUE(kveCacheIsDirty(&cache));
+}
+
+void testThatWriteCanBeReadBackBeforeFlush() {
+  // Fixture
+  char buffer[5];
+  kveCacheWrite(&cache, 10, "hello", 5);
+
+  // Test
+  kveCacheRead(&cache, 10, buffer, 5);
+
+  // Assert
+  TEST_ASSERT_EQUAL_MEMORY("hello", buffer, 5);
+}
+
+void testThatFlushWritesFullPages() {
+  // Fixture
+  kveCacheWrite(&cache, KVE_CACHE_PAGE_SIZE + 3, "hello", 5);
+
+  // Test
+  bool actual = kveCacheFlush(&cache);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_EQUAL(1, backingWriteCount);
+  TEST_ASSERT_EQUAL(KVE_CACHE_PAGE_SIZE, lastWriteAddress);
+  TEST_ASSERT_EQUAL(KVE_CACHE_PAGE_SIZE, lastWriteLength);
+  TEST_ASSERT_EQUAL_MEMORY("hello", &memory[KVE_CACHE_PAGE_SIZE + 3], 5);
+  TEST_ASSERT_FALSE(kveCacheIsDirty(&cache));
+}
+
+void testThatFlushBatchesConsecutivePages() {
+  // Fixture
+  kveCacheWrite(&cache, 10, "hello", 5);
+  kveCacheWrite(&cache, KVE_CACHE_PAGE_SIZE + 10, "world", 5);
+  kveCacheWrite(&cache, 2 * KVE_CACHE_PAGE_SIZE + 10, "again", 5);
+
+  // Test
+  kveCacheFlush(&cache);
+
+  // Assert
+  TEST_ASSERT_EQUAL(1, backingWriteCount);
+  TEST_ASSERT_EQUAL(0, lastWriteAddress);
+  TEST_ASSERT_EQUAL(3 * KVE_CACHE_PAGE_SIZE, lastWriteLength);
+}
+
+void testThatFlushWithoutWritesDoesNothing() {
+  // Fixture
+
+  // Test
+  kveCacheFlush(&cache);
+
+  // Assert
+  TEST_ASSERT_EQUAL(0, backingWriteCount);
+}
+
+void testThatLastPartialPageIsClippedWhenFlushed() {
+  // Fixture
+  kveCacheWrite(&cache, TEST_MEMORY_SIZE - 2, "hi", 2);
+
+  // Test
+  kveCacheFlush(&cache);
+
+  // Assert
+  TEST_ASSERT_EQUAL(TEST_MEMORY_SIZE - lastWriteAddress, lastWriteLength);
+  TEST_ASSERT_EQUAL_MEMORY("hi", &memory[TEST_MEMORY_SIZE - 2], 2);
+}
+
+void testThatKveStoreThroughCacheBatchesWrites() {
+  // Fixture
+  kveFormat(&kveMemory);
+  kveBuildIndex(&kveMemory);
+  backingWriteCount = 0;
+
+  // Test
+  // Header, key, data and end tag are separate writes to the cache, they are
+  // all in the same page and written back in one flush
+  kveStore(&kveMemory, "hello", "world", 5);
+
+  // Assert
+  TEST_ASSERT_EQUAL(1, backingWriteCount);
+}
+
+void testThatKveTableIsPersistedThroughCache() {
+  // Fixture
+  char buffer[10] = {0};
+  kveFormat(&kveMemory);
+  kveBuildIndex(&kveMemory);
+  kveStore(&kveMemory, "hello", "world", 5);
+  kveStore(&kveMemory, "key", "value", 5);
+
+  // Test
+  // Start over from the backing memory only
+  kveCacheInit(&cache, cacheData, TEST_MEMORY_SIZE, loadedBlocks, dirtyPages, backingRead, backingWrite);
+  memset(cacheData, 0, TEST_MEMORY_SIZE);
+  bool indexOk = kveBuildIndex(&kveMemory);
+  size_t actual = kveFetch(&kveMemory, "key", buffer, sizeof(buffer));
+
+  // Assert
+  TEST_ASSERT_TRUE(indexOk);
+  TEST_ASSERT_TRUE(kveCheck(&kveMemory));
+  TEST_ASSERT_EQUAL(5, actual);
+  TEST_ASSERT_EQUAL_MEMORY("value", buffer, 5);
+}
+
+void testThatFetchAfterIndexBuildDoesNotAccessBackingMemory() {
+  // Fixture
+  char buffer[10];
+  kveFormat(&kveMemory);
+  kveStore(&kveMemory, "hello", "world", 5);
+  kveCacheInit(&cache, cacheData, TEST_MEMORY_SIZE, loadedBlocks, dirtyPages, backingRead, backingWrite);
+  kveBuildIndex(&kveMemory);
+  backingReadCount = 0;
+
+  // Test
+  kveFetch(&kveMemory, "hello", buffer, sizeof(buffer));
+
+  // Assert
+  TEST_ASSERT_EQUAL(0, backingReadCount);
+}
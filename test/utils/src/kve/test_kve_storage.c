@@ -22,7 +22,7 @@ size_t kvememoryRead(size_t address, void* data, size_t length) {
         return 0;
     }
     size_t toRead = min(length, TEST_MEMORY_SIZE - address);
-    memcpy(data, &memory[address], toRead);
+    memcpy(data, &cacheMemory[address], toRead);
 
     return toRead;
 }
@@ -70,12 +70,12 @@ void testThatWriteItemDoesWriteTheItemAtTheRightAddress() {
 
   // Assert
   TEST_ASSERT_EQUAL(expectedItemSize, itemSize);
-  TEST_ASSERT_EQUAL_MEMORY(expectedItemInMemory, &memory[address-1], expectedItemSize+2);
+  TEST_ASSERT_EQUAL_MEMORY(expectedItemInMemory, &cacheMemory[address-1], expectedItemSize+2);
 }
 
 void testThatWriteHoleDoesWriteAHoleAtTheRightAddress() {
   // Fixture
-  memset(memory, 'a', TEST_MEMORY_SIZE);
+  memset(cacheMemory, 'a', TEST_MEMORY_SIZE);
 
   size_t address = 42;
   uint16_t length = 5;
@@ -89,12 +89,12 @@ void testThatWriteHoleDoesWriteAHoleAtTheRightAddress() {
 
   // Assert
   TEST_ASSERT_EQUAL(expectedItemSize, itemSize);
-  TEST_ASSERT_EQUAL_MEMORY(expectedItemInMemory, &memory[address - 1], expectedItemSize + 1);
+  TEST_ASSERT_EQUAL_MEMORY(expectedItemInMemory, &cacheMemory[address - 1], expectedItemSize + 1);
 }
 
 void testThatWriteEndDoesWriteTheEndAtTheRightAddress() {
   // Fixture
-  memset(memory, 'a', TEST_MEMORY_SIZE);
+  memset(cacheMemory, 'a', TEST_MEMORY_SIZE);
 
   size_t address = 42;
 
@@ -107,7 +107,7 @@ void testThatWriteEndDoesWriteTheEndAtTheRightAddress() {
 
   // Assert
   TEST_ASSERT_EQUAL(expectedItemSize, itemSize);
-  TEST_ASSERT_EQUAL_MEMORY(expectedItemInMemory, &memory[address - 1], expectedItemSize + 2);
+  TEST_ASSERT_EQUAL_MEMORY(expectedItemInMemory, &cacheMemory[address - 1], expectedItemSize + 2);
 }
 
 void testThatMoveMemoryDoesMoveAnItem() {
@@ -127,7 +127,7 @@ void testThatMoveMemoryDoesMoveAnItem() {
   kveStorageMoveMemory(&kveMemory, address, newAddress, itemSize);
   
   // Assert
-  TEST_ASSERT_EQUAL_MEMORY(expectedItemInMemory, &memory[newAddress], itemSize);
+  TEST_ASSERT_EQUAL_MEMORY(expectedItemInMemory, &cacheMemory[newAddress], itemSize);
 }
 
 void testThatFindItemByKeyFindsAnItem() {
@@ -0,0 +1,190 @@
+// File under test biquad_bank.c
+#include "biquad_bank.h"
+
+#include <math.h>
+
+#include "unity.h"
+#include "filter.h"
+
+#define SAMPLE_FREQ 1000.0f
+#define PI_F 3.14159265358979f
+
+static biquadBank_t bank;
+
+// Helpers
+static float measureGain(const uint8_t channel, const float freq);
+static float butterworthGain(const float freq, const float cutoffFreq);
+
+
+void setUp(void) {
+  biquadBankInit(&bank, 6, 2);
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatInitializedBankPassesSamplesThrough() {
+  // Fixture
+  float samples[6] = {1.0f, -2.0f, 3.0f, 4.5f, 0.0f, 100.0f};
+  float expected[6] = {1.0f, -2.0f, 3.0f, 4.5f, 0.0f, 100.0f};
+
+  // Test
+  biquadBankApply(&bank, samples);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT_ARRAY(expected, samples, 6);
+}
+
+void testThatLowPassIsEqualToLpf2p() {
+  // Fixture
+  lpf2pData lpf;
+  lpf2pInit(&lpf, SAMPLE_FREQ, 80.0f);
+  biquadBankSetLowPass(&bank, 2, 0, SAMPLE_FREQ, 80.0f);
+
+  // Test
+  // Assert
+  for (int n = 0; n < 500; n++) {
+    const float x = sinf(n * 0.3f) + 0.5f * cosf(n * 1.7f) + ((n % 50) == 0 ? 3.0f : 0.0f);
+    float samples[6] = {0, 0, x, 0, 0, 0};
+
+    biquadBankApply(&bank, samples);
+    const float expected = lpf2pApply(&lpf, x);
+
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, expected, samples[2]);
+  }
+}
+
+void testThatLowPassFrequencyResponseMatchesButterworth() {
+  // Fixture
+  const float cutoffFreq = 80.0f;
+  const float freqs[] = {5.0f, 40.0f, 80.0f, 160.0f, 300.0f};
+  biquadBankSetLowPass(&bank, 0, 0, SAMPLE_FREQ, cutoffFreq);
+
+  // Test
+  // Assert
+  for (unsigned int i = 0; i < sizeof(freqs) / sizeof(freqs[0]); i++) {
+    const float actual = measureGain(0, freqs[i]);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, butterworthGain(freqs[i], cutoffFreq), actual);
+  }
+}
+
+void testThatCascadedStagesMultiplyTheirGains() {
+  // Fixture
+  const float cutoffFreq = 80.0f;
+  const float freq = 120.0f;
+  biquadBankSetLowPass(&bank, 1, 0, SAMPLE_FREQ, cutoffFreq);
+  biquadBankSetLowPass(&bank, 1, 1, SAMPLE_FREQ, cutoffFreq);
+
+  // Test
+  const float actual = measureGain(1, freq);
+
+  // Assert
+  const float single = butterworthGain(freq, cutoffFreq);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, single * single, actual);
+}
+
+void testThatNotchRemovesCenterFrequency() {
+  // Fixture
+  biquadBankSetNotch(&bank, 3, 0, SAMPLE_FREQ, 200.0f, 3.0f);
+
+  // Test
+  const float atCenter = measureGain(3, 200.0f);
+  const float below = measureGain(3, 20.0f);
+  const float above = measureGain(3, 450.0f);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, atCenter);
+  TEST_ASSERT_FLOAT_WITHIN(0.02f, 1.0f, below);
+  TEST_ASSERT_FLOAT_WITHIN(0.02f, 1.0f, above);
+}
+
+void testThatChannelsAreIndependent() {
+  // Fixture
+  biquadBankSetNotch(&bank, 0, 0, SAMPLE_FREQ, 100.0f, 3.0f);
+
+  // Test
+  const float notched = measureGain(0, 100.0f);
+  const float passed = measureGain(5, 100.0f);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, notched);
+  TEST_ASSERT_FLOAT_WITHIN(0.0001f, 1.0f, passed);
+}
+
+void testThatResetChannelGivesSteadyStateOutput() {
+  // Fixture
+  biquadBankSetLowPass(&bank, 4, 0, SAMPLE_FREQ, 30.0f);
+  biquadBankSetLowPass(&bank, 4, 1, SAMPLE_FREQ, 30.0f);
+  biquadBankResetChannel(&bank, 4, 9.81f);
+
+  // Test
+  float samples[6] = {0, 0, 0, 0, 9.81f, 0};
+  biquadBankApply(&bank, samples);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 9.81f, samples[4]);
+}
+
+void testThatNonFiniteOutputResetsTheChannel() {
+  // Fixture
+  biquadBankSetLowPass(&bank, 0, 0, SAMPLE_FREQ, 80.0f);
+  float samples[6] = {INFINITY, 1.0f, 0, 0, 0, 0};
+
+  // Test
+  biquadBankApply(&bank, samples);
+  float next[6] = {0, 0, 0, 0, 0, 0};
+  biquadBankApply(&bank, next);
+
+  // Assert
+  TEST_ASSERT_TRUE(isfinite(next[0]));
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, next[0]);
+}
+
+void testThatLowPassIsEqualToButterworth2LowPass() {
+  // Fixture
+  const float cutoffFreq = 8.0f;
+  Butterworth2LowPass butterworth;
+  init_butterworth_2_low_pass(&butterworth, 1.0f / (2.0f * PI_F * cutoffFreq), 1.0f / SAMPLE_FREQ, 0.0f);
+  biquadBankSetLowPass(&bank, 5, 0, SAMPLE_FREQ, cutoffFreq);
+
+  // Test
+  // Assert
+  for (int n = 0; n < 500; n++) {
+    const float x = sinf(n * 0.05f) + ((n % 100) == 0 ? 2.0f : 0.0f);
+    float samples[6] = {0, 0, 0, 0, 0, x};
+
+    biquadBankApply(&bank, samples);
+    const float expected = update_butterworth_2_low_pass(&butterworth, x);
+
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, expected, samples[5]);
+  }
+}
+
+// Helpers
+
+// Amplitude of the steady state output for a unit sine input, from the RMS
+// value over a whole number of periods
+static float measureGain(const uint8_t channel, const float freq) {
+  const int settle = 2000;
+  const int measure = 2000;
+  float sumSquares = 0.0f;
+
+  for (int n = 0; n < settle + measure; n++) {
+    float samples[BIQUAD_BANK_MAX_CHANNELS] = {0};
+    samples[channel] = sinf(2.0f * PI_F * freq * n / SAMPLE_FREQ);
+    biquadBankApply(&bank, samples);
+
+    if (n >= settle) {
+      sumSquares += samples[channel] * samples[channel];
+    }
+  }
+
+  return sqrtf(2.0f * sumSquares / measure);
+}
+
+// Bilinear transformed Butterworth with prewarped cutoff
+static float butterworthGain(const float freq, const float cutoffFreq) {
+  const float ratio = tanf(PI_F * freq / SAMPLE_FREQ) / tanf(PI_F * cutoffFreq / SAMPLE_FREQ);
+  return 1.0f / sqrtf(1.0f + ratio * ratio * ratio * ratio);
+}
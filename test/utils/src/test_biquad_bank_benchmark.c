@@ -0,0 +1,78 @@
+// File under test biquad_bank.c
+// @IGNORE_IF_NOT BIQUAD_BANK_BENCHMARK
+//
+// Timing of the bank against six lpf2p filters, the IMU filtering of the
+// sensor drivers. The timing depends on the host and is only printed, the
+// filtered output is asserted to be the same. Not part of the normal unit
+// tests, run with
+// rake unit "DEFINES=-DBIQUAD_BANK_BENCHMARK" FILES=test/utils/src/test_biquad_bank_benchmark.c
+#include "biquad_bank.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "unity.h"
+#include "filter.h"
+
+#define SAMPLE_FREQ 1000.0f
+#define SAMPLE_COUNT 200000
+#define CHANNELS 6
+
+static biquadBank_t bank;
+static lpf2pData lpf[CHANNELS];
+
+// Helpers
+static float input(const int n, const int channel);
+
+
+void setUp(void) {
+  biquadBankInit(&bank, CHANNELS, 1);
+  for (int i = 0; i < CHANNELS; i++) {
+    lpf2pInit(&lpf[i], SAMPLE_FREQ, 80.0f);
+    biquadBankSetLowPass(&bank, i, 0, SAMPLE_FREQ, 80.0f);
+  }
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testBenchmarkBankAgainstLpf2p() {
+  // Fixture
+  float sumLpf = 0.0f;
+  float sumBank = 0.0f;
+
+  // Test
+  clock_t start = clock();
+  for (int n = 0; n < SAMPLE_COUNT; n++) {
+    for (int i = 0; i < CHANNELS; i++) {
+      sumLpf += lpf2pApply(&lpf[i], input(n, i));
+    }
+  }
+  const clock_t lpfTicks = clock() - start;
+
+  start = clock();
+  for (int n = 0; n < SAMPLE_COUNT; n++) {
+    float samples[CHANNELS];
+    for (int i = 0; i < CHANNELS; i++) {
+      samples[i] = input(n, i);
+    }
+    biquadBankApply(&bank, samples);
+    for (int i = 0; i < CHANNELS; i++) {
+      sumBank += samples[i];
+    }
+  }
+  const clock_t bankTicks = clock() - start;
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(fabsf(sumLpf) * 1e-3f, sumLpf, sumBank);
+  printf("%d channels x %d samples: lpf2p %.1f ns/sample, bank %.1f ns/sample\n", CHANNELS, SAMPLE_COUNT,
+         1e9 * lpfTicks / CLOCKS_PER_SEC / SAMPLE_COUNT, 1e9 * bankTicks / CLOCKS_PER_SEC / SAMPLE_COUNT);
+}
+
+// Helpers
+
+static float input(const int n, const int channel) {
+  return (float)((n + channel) & 0xff);
+}
@@ -0,0 +1,244 @@
+// File under test dynamic_notch.c
+#include "dynamic_notch.h"
+
+#include <math.h>
+
+#include "unity.h"
+#include "biquad_bank.h"
+
+// Build the arm dsp math lib and use the "real thing" instead of mocking calls to it
+// @BUILD_LIB ARM_DSP_MATH
+
+#define SAMPLE_FREQ 1000.0f
+#define PI_F 3.14159265358979f
+
+static dynamicNotch_t dynNotch;
+static uint32_t noiseState;
+
+// Helpers
+static float noise(const float amplitude);
+static void feed(const int sampleCount, const float freq[DYNAMIC_NOTCH_AXES], const float amplitude[DYNAMIC_NOTCH_AXES], const float noiseAmplitude);
+
+
+void setUp(void) {
+  dynamicNotchInit(&dynNotch, SAMPLE_FREQ, 1);
+  noiseState = 12345;
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatNoPeaksAreTrackedAfterInit() {
+  // Fixture
+  // Test
+  // Assert
+  for (int axis = 0; axis < DYNAMIC_NOTCH_AXES; axis++) {
+    for (int i = 0; i < DYNAMIC_NOTCH_MAX_PEAKS; i++) {
+      TEST_ASSERT_EQUAL_FLOAT(0.0f, dynNotch.peakFreq[axis][i]);
+    }
+  }
+}
+
+void testThatAxesAreAnalysedInTurn() {
+  // Fixture
+  const float sample[DYNAMIC_NOTCH_AXES] = {0.0f, 0.0f, 0.0f};
+  int expectedAxis = 0;
+  int analysisCount = 0;
+
+  // Test
+  for (int n = 0; n < DYNAMIC_NOTCH_FFT_SIZE + 10 * DYNAMIC_NOTCH_HOP; n++) {
+    const int axis = dynamicNotchAddSample(&dynNotch, sample);
+
+    // Assert
+    if (n < DYNAMIC_NOTCH_FFT_SIZE) {
+      TEST_ASSERT_EQUAL_INT(-1, axis);
+    } else if (axis >= 0) {
+      TEST_ASSERT_EQUAL_INT(expectedAxis, axis);
+      expectedAxis = (expectedAxis + 1) % DYNAMIC_NOTCH_AXES;
+      analysisCount++;
+    }
+  }
+
+  TEST_ASSERT_EQUAL_INT(10, analysisCount);
+}
+
+void testThatSinglePeakIsFoundInNoisySignal() {
+  // Fixture
+  const float freq[DYNAMIC_NOTCH_AXES] = {230.0f, 0.0f, 0.0f};
+  const float amplitude[DYNAMIC_NOTCH_AXES] = {5.0f, 0.0f, 0.0f};
+
+  // Test
+  feed(1000, freq, amplitude, 2.0f);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(2.0f, 230.0f, dynNotch.peakFreq[0][0]);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, dynNotch.peakFreq[0][1]);
+}
+
+void testThatPeakBetweenBinsIsInterpolated() {
+  // Fixture
+  // Half way between two bins
+  const float expected = 35.5f * SAMPLE_FREQ / DYNAMIC_NOTCH_FFT_SIZE;
+  const float freq[DYNAMIC_NOTCH_AXES] = {expected, 0.0f, 0.0f};
+  const float amplitude[DYNAMIC_NOTCH_AXES] = {5.0f, 0.0f, 0.0f};
+
+  // Test
+  feed(1000, freq, amplitude, 0.5f);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(1.5f, expected, dynNotch.peakFreq[0][0]);
+}
+
+void testThatTwoPeaksAreFound() {
+  // Fixture
+  const float amplitude[DYNAMIC_NOTCH_AXES] = {4.0f, 0.0f, 0.0f};
+
+  // Test
+  for (int n = 0; n < 1000; n++) {
+    const float t = n / SAMPLE_FREQ;
+    const float x = amplitude[0] * sinf(2.0f * PI_F * 180.0f * t) + 0.5f * amplitude[0] * sinf(2.0f * PI_F * 340.0f * t) + noise(1.0f);
+    const float sample[DYNAMIC_NOTCH_AXES] = {x, 0.0f, 0.0f};
+    dynamicNotchAddSample(&dynNotch, sample);
+  }
+
+  // Assert
+  const float low = fminf(dynNotch.peakFreq[0][0], dynNotch.peakFreq[0][1]);
+  const float high = fmaxf(dynNotch.peakFreq[0][0], dynNotch.peakFreq[0][1]);
+  TEST_ASSERT_FLOAT_WITHIN(2.0f, 180.0f, low);
+  TEST_ASSERT_FLOAT_WITHIN(2.0f, 340.0f, high);
+}
+
+void testThatNoPeakIsFoundInNoise() {
+  // Fixture
+  const float freq[DYNAMIC_NOTCH_AXES] = {0.0f, 0.0f, 0.0f};
+  const float amplitude[DYNAMIC_NOTCH_AXES] = {0.0f, 0.0f, 0.0f};
+
+  // Test
+  feed(3000, freq, amplitude, 3.0f);
+
+  // Assert
+  for (int axis = 0; axis < DYNAMIC_NOTCH_AXES; axis++) {
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, dynNotch.peakFreq[axis][0]);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, dynNotch.peakFreq[axis][1]);
+  }
+}
+
+void testThatPeakBelowMinFreqIsIgnored() {
+  // Fixture
+  const float freq[DYNAMIC_NOTCH_AXES] = {40.0f, 0.0f, 0.0f};
+  const float amplitude[DYNAMIC_NOTCH_AXES] = {50.0f, 0.0f, 0.0f};
+
+  // Test
+  feed(1000, freq, amplitude, 1.0f);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, dynNotch.peakFreq[0][0]);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, dynNotch.peakFreq[0][1]);
+}
+
+void testThatAxesAreAnalysedIndependently() {
+  // Fixture
+  const float freq[DYNAMIC_NOTCH_AXES] = {200.0f, 300.0f, 0.0f};
+  const float amplitude[DYNAMIC_NOTCH_AXES] = {5.0f, 5.0f, 0.0f};
+
+  // Test
+  feed(1000, freq, amplitude, 1.0f);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(2.0f, 200.0f, dynNotch.peakFreq[0][0]);
+  TEST_ASSERT_FLOAT_WITHIN(2.0f, 300.0f, dynNotch.peakFreq[1][0]);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, dynNotch.peakFreq[2][0]);
+}
+
+void testThatPeakFollowsChangingFrequency() {
+  // Fixture
+  float phase = 0.0f;
+
+  // Test
+  // Sweep from 200 to 260 Hz in 2 seconds, then hold
+  for (int n = 0; n < 3000; n++) {
+    const float f = n < 2000 ? 200.0f + 60.0f * n / 2000.0f : 260.0f;
+    phase += 2.0f * PI_F * f / SAMPLE_FREQ;
+    const float sample[DYNAMIC_NOTCH_AXES] = {5.0f * sinf(phase) + noise(1.0f), 0.0f, 0.0f};
+    dynamicNotchAddSample(&dynNotch, sample);
+  }
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(2.0f, 260.0f, dynNotch.peakFreq[0][0]);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, dynNotch.peakFreq[0][1]);
+}
+
+void testThatLostPeakIsDropped() {
+  // Fixture
+  const float freq[DYNAMIC_NOTCH_AXES] = {230.0f, 0.0f, 0.0f};
+  const float amplitude[DYNAMIC_NOTCH_AXES] = {5.0f, 0.0f, 0.0f};
+  const float noAmplitude[DYNAMIC_NOTCH_AXES] = {0.0f, 0.0f, 0.0f};
+  feed(1000, freq, amplitude, 1.0f);
+  TEST_ASSERT_TRUE(dynNotch.peakFreq[0][0] > 0.0f);
+
+  // Test
+  feed(1000, freq, noAmplitude, 1.0f);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, dynNotch.peakFreq[0][0]);
+}
+
+void testThatDecimatedSamplesAreAnalysed() {
+  // Fixture
+  dynamicNotchInit(&dynNotch, 2.0f * SAMPLE_FREQ, 2);
+  float phase = 0.0f;
+
+  // Test
+  for (int n = 0; n < 2000; n++) {
+    phase += 2.0f * PI_F * 230.0f / (2.0f * SAMPLE_FREQ);
+    const float sample[DYNAMIC_NOTCH_AXES] = {5.0f * sinf(phase) + noise(1.0f), 0.0f, 0.0f};
+    dynamicNotchAddSample(&dynNotch, sample);
+  }
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(SAMPLE_FREQ, dynNotch.sampleFreq);
+  TEST_ASSERT_FLOAT_WITHIN(2.0f, 230.0f, dynNotch.peakFreq[0][0]);
+}
+
+void testThatRetuneMovesNotchToPeakAndBypassesUntrackedStages() {
+  // Fixture
+  biquadBank_t bank;
+  biquadBank_t expected;
+  biquadBankInit(&bank, 6, 1 + DYNAMIC_NOTCH_MAX_PEAKS);
+  biquadBankInit(&expected, 6, 1 + DYNAMIC_NOTCH_MAX_PEAKS);
+  biquadBankSetNotch(&bank, 1, 2, SAMPLE_FREQ, 100.0f, 3.0f);
+
+  dynNotch.peakFreq[1][0] = 250.0f;
+  biquadBankSetNotch(&expected, 1, 1, SAMPLE_FREQ, 250.0f, 3.0f);
+
+  // Test
+  dynamicNotchRetune(&dynNotch, 1, &bank, 1, 1, SAMPLE_FREQ, 3.0f);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(expected.b0[1][1], bank.b0[1][1]);
+  TEST_ASSERT_EQUAL_FLOAT(expected.b1[1][1], bank.b1[1][1]);
+  TEST_ASSERT_EQUAL_FLOAT(expected.a1[1][1], bank.a1[1][1]);
+  TEST_ASSERT_EQUAL_FLOAT(expected.a2[1][1], bank.a2[1][1]);
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, bank.b0[2][1]);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, bank.b1[2][1]);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, bank.a1[2][1]);
+}
+
+// Helpers ////////////////////////////////////////////////////////
+
+static float noise(const float amplitude) {
+  noiseState = noiseState * 1103515245 + 12345;
+  return amplitude * (((noiseState >> 8) & 0xffff) / 32768.0f - 1.0f);
+}
+
+static void feed(const int sampleCount, const float freq[DYNAMIC_NOTCH_AXES], const float amplitude[DYNAMIC_NOTCH_AXES], const float noiseAmplitude) {
+  for (int n = 0; n < sampleCount; n++) {
+    const float t = n / SAMPLE_FREQ;
+    float sample[DYNAMIC_NOTCH_AXES];
+    for (int axis = 0; axis < DYNAMIC_NOTCH_AXES; axis++) {
+      sample[axis] = amplitude[axis] * sinf(2.0f * PI_F * freq[axis] * t) + noise(noiseAmplitude);
+    }
+    dynamicNotchAddSample(&dynNotch, sample);
+  }
+}
@@ -0,0 +1,180 @@
+// File under test gyro_bias_estimator.c
+#include "gyro_bias_estimator.h"
+
+#include <math.h>
+
+#include "unity.h"
+
+#define WINDOW_SIZE 512
+#define MIN_SAMPLES 200
+#define VARIANCE_THRESHOLD 20.0f
+
+static gyroBiasEstimator_t estimator;
+static uint32_t noiseState;
+
+// Helpers
+static float noise(const float amplitude);
+static void feed(const int sampleCount, const float x, const float y, const float z, const float noiseAmplitude);
+
+
+void setUp(void) {
+  gyroBiasEstimatorInit(&estimator, WINDOW_SIZE, MIN_SAMPLES, VARIANCE_THRESHOLD);
+  noiseState = 4711;
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatBiasIsNotFoundAfterInit() {
+  // Fixture
+  // Test
+  // Assert
+  TEST_ASSERT_FALSE(estimator.isBiasFound);
+}
+
+void testThatMeanAndVarianceAreExactForFewSamples() {
+  // Fixture
+  const float values[] = {2.0f, 4.0f, 4.0f, 4.0f, 5.0f, 5.0f, 7.0f, 9.0f};
+
+  // Test
+  for (int i = 0; i < 8; i++) {
+    const float sample[] = {values[i], -values[i], 0.0f};
+    gyroBiasEstimatorAdd(&estimator, sample);
+  }
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, 5.0f, estimator.mean[0]);
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, -5.0f, estimator.mean[1]);
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, 4.0f, estimator.variance[0]);
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, 4.0f, estimator.variance[1]);
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.0f, estimator.variance[2]);
+}
+
+void testThatBiasIsNotFoundBeforeMinSamples() {
+  // Fixture
+  // Test
+  feed(MIN_SAMPLES - 1, 10.0f, -20.0f, 30.0f, 2.0f);
+
+  // Assert
+  TEST_ASSERT_FALSE(estimator.isBiasFound);
+}
+
+void testThatBiasIsFoundWhenStill() {
+  // Fixture
+  // Test
+  feed(MIN_SAMPLES, 10.0f, -20.0f, 30.0f, 2.0f);
+
+  // Assert
+  TEST_ASSERT_TRUE(estimator.isBiasFound);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 10.0f, estimator.bias[0]);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, -20.0f, estimator.bias[1]);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 30.0f, estimator.bias[2]);
+}
+
+void testThatBiasIsNotFoundWhenMoving() {
+  // Fixture
+  // Test
+  feed(5000, 10.0f, -20.0f, 30.0f, 20.0f);
+
+  // Assert
+  TEST_ASSERT_FALSE(estimator.isBiasFound);
+  TEST_ASSERT_FALSE(estimator.isStill);
+}
+
+void testThatBiasIsFoundWhenMovementStops() {
+  // Fixture
+  feed(1000, 10.0f, -20.0f, 30.0f, 20.0f);
+  TEST_ASSERT_FALSE(estimator.isBiasFound);
+
+  // Test
+  feed(3000, 10.0f, -20.0f, 30.0f, 2.0f);
+
+  // Assert
+  TEST_ASSERT_TRUE(estimator.isBiasFound);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 10.0f, estimator.bias[0]);
+}
+
+void testThatBiasTracksSlowDriftWhenStill() {
+  // Fixture
+  feed(MIN_SAMPLES, 10.0f, -20.0f, 30.0f, 2.0f);
+
+  // Test
+  // 3 LSB drift over 10 seconds
+  for (int i = 0; i < 10000; i++) {
+    feed(1, 10.0f + 3.0f * i / 10000.0f, -20.0f, 30.0f, 2.0f);
+  }
+  feed(5000, 13.0f, -20.0f, 30.0f, 2.0f);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(0.3f, 13.0f, estimator.bias[0]);
+  TEST_ASSERT_FLOAT_WITHIN(0.3f, -20.0f, estimator.bias[1]);
+}
+
+void testThatBiasIsKeptWhileMoving() {
+  // Fixture
+  feed(MIN_SAMPLES, 10.0f, -20.0f, 30.0f, 2.0f);
+  const float expected = estimator.bias[0];
+
+  // Test
+  feed(5000, 50.0f, -20.0f, 30.0f, 100.0f);
+
+  // Assert
+  TEST_ASSERT_TRUE(estimator.isBiasFound);
+  TEST_ASSERT_EQUAL_FLOAT(expected, estimator.bias[0]);
+}
+
+void testThatSlowSteadyRotationIsNotTakenAsBias() {
+  // Fixture
+  feed(MIN_SAMPLES, 10.0f, -20.0f, 30.0f, 2.0f);
+  const float expected = estimator.bias[2];
+
+  // Test
+  // Smooth rotation, still by variance but far from the bias
+  feed(5000, 10.0f, -20.0f, 30.0f + 100.0f, 2.0f);
+
+  // Assert
+  TEST_ASSERT_TRUE(estimator.isStill);
+  TEST_ASSERT_EQUAL_FLOAT(expected, estimator.bias[2]);
+}
+
+void testThatBiasIsKeptWhenTrackingIsDisabled() {
+  // Fixture
+  feed(MIN_SAMPLES, 10.0f, -20.0f, 30.0f, 2.0f);
+  const float expected = estimator.bias[0];
+  gyroBiasEstimatorSetTracking(&estimator, false);
+
+  // Test
+  // Steady rotation close to the bias, as in flight
+  feed(5000, 13.0f, -20.0f, 30.0f, 2.0f);
+
+  // Assert
+  TEST_ASSERT_TRUE(estimator.isStill);
+  TEST_ASSERT_EQUAL_FLOAT(expected, estimator.bias[0]);
+}
+
+void testThatBiasIsFoundWhenTrackingIsDisabled() {
+  // Fixture
+  gyroBiasEstimatorSetTracking(&estimator, false);
+
+  // Test
+  feed(MIN_SAMPLES, 10.0f, -20.0f, 30.0f, 2.0f);
+
+  // Assert
+  TEST_ASSERT_TRUE(estimator.isBiasFound);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 10.0f, estimator.bias[0]);
+}
+
+// Helpers ////////////////////////////////////////////////////////
+
+static float noise(const float amplitude) {
+  noiseState = noiseState * 1103515245 + 12345;
+  return amplitude * (((noiseState >> 8) & 0xffff) / 32768.0f - 1.0f);
+}
+
+static void feed(const int sampleCount, const float x, const float y, const float z, const float noiseAmplitude) {
+  for (int i = 0; i < sampleCount; i++) {
+    const float sample[] = {x + noise(noiseAmplitude), y + noise(noiseAmplitude), z + noise(noiseAmplitude)};
+    gyroBiasEstimatorAdd(&estimator, sample);
+  }
+}
@@ -0,0 +1,168 @@
+// File under test sample_clock.c
+#include "sample_clock.h"
+
+#include "unity.h"
+
+#define NOMINAL_PERIOD 500.0f
+#define WATERMARK 2
+
+static sampleClock_t sampleClock;
+static uint32_t noiseState;
+
+// Helpers
+static float noise(const float amplitude);
+static void feed(const int anchorCount, const uint32_t firstIndex, const double startTime, const double period, const float jitter);
+
+
+void setUp(void) {
+  sampleClockInit(&sampleClock, NOMINAL_PERIOD);
+  noiseState = 4711;
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatTimestampIsZeroBeforeFirstAnchor() {
+  // Fixture
+  // Test
+  const uint64_t actual = sampleClockTimestamp(&sampleClock, 17);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT64(0, actual);
+}
+
+void testThatSamplesAroundFirstAnchorUseNominalPeriod() {
+  // Fixture
+  sampleClockAddAnchor(&sampleClock, 10, 100000);
+
+  // Test
+  const uint64_t before = sampleClockTimestamp(&sampleClock, 8);
+  const uint64_t after = sampleClockTimestamp(&sampleClock, 13);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT64(99000, before);
+  TEST_ASSERT_EQUAL_UINT64(101500, after);
+}
+
+void testThatExactAnchorsAreKept() {
+  // Fixture
+  // Test
+  feed(100, 1, 1000000.0, NOMINAL_PERIOD, 0.0f);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, NOMINAL_PERIOD, sampleClock.period);
+  TEST_ASSERT_EQUAL_UINT64(1000000 + 198 * 500, sampleClock.anchorTimestamp);
+}
+
+void testThatPeriodOfSlowSensorClockIsTracked() {
+  // Fixture
+  const double period = 510.0;
+
+  // Test
+  feed(2000, 1, 1000000.0, period, 0.0f);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, period, sampleClock.period);
+  const double expected = 1000000.0 + 4010 * period;
+  TEST_ASSERT_FLOAT_WITHIN(1.0f, expected, (double)sampleClockTimestamp(&sampleClock, 4011));
+}
+
+void testThatPeriodIsLimitedToMaxDrift() {
+  // Fixture
+  sampleClock.maxDrift = 0.01f;
+
+  // Test
+  feed(2000, 1, 1000000.0, 510.0, 0.0f);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 505.0f, sampleClock.period);
+}
+
+void testThatInterruptJitterIsFiltered() {
+  // Fixture
+  const float jitter = 20.0f;
+
+  // Test
+  feed(2000, 1, 1000000.0, NOMINAL_PERIOD, jitter);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, NOMINAL_PERIOD, sampleClock.period);
+  const double expected = 1000000.0 + 3998 * NOMINAL_PERIOD;
+  TEST_ASSERT_FLOAT_WITHIN(jitter / 2, expected, (double)sampleClock.anchorTimestamp);
+}
+
+void testThatOutlierIsRejected() {
+  // Fixture
+  feed(10, 1, 1000000.0, NOMINAL_PERIOD, 0.0f);
+  const uint64_t anchorTimestamp = sampleClock.anchorTimestamp;
+
+  // Test
+  const bool actual = sampleClockAddAnchor(&sampleClock, 21, 1000000 + 20 * 500 + 300);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+  TEST_ASSERT_EQUAL_UINT64(anchorTimestamp, sampleClock.anchorTimestamp);
+  TEST_ASSERT_EQUAL_UINT8(1, sampleClock.outlierCount);
+}
+
+void testThatClockIsReanchoredAfterConsecutiveOutliers() {
+  // Fixture
+  feed(10, 1, 1000000.0, NOMINAL_PERIOD, 0.0f);
+
+  // Test
+  // Samples have been lost, all anchors are off by 40 samples
+  bool actual = true;
+  for (int i = 0; i < SAMPLE_CLOCK_MAX_OUTLIERS; i++) {
+    const uint32_t index = 21 + i * WATERMARK;
+    actual = sampleClockAddAnchor(&sampleClock, index, 1000000 + (index + 40 - 1) * 500);
+  }
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_EQUAL_UINT8(0, sampleClock.outlierCount);
+  TEST_ASSERT_EQUAL_UINT64(1000000 + (25 + 40 - 1) * 500, sampleClockTimestamp(&sampleClock, 25));
+}
+
+void testThatResetClockUsesNextAnchorAndKeepsPeriod() {
+  // Fixture
+  feed(2000, 1, 1000000.0, 510.0, 0.0f);
+  const float period = sampleClock.period;
+
+  // Test
+  sampleClockReset(&sampleClock);
+  const bool actual = sampleClockAddAnchor(&sampleClock, 5000, 9000000);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_EQUAL_FLOAT(period, sampleClock.period);
+  TEST_ASSERT_EQUAL_UINT64(9000000, sampleClockTimestamp(&sampleClock, 5000));
+}
+
+void testThatIndexWrapAroundIsHandled() {
+  // Fixture
+  const uint32_t firstIndex = UINT32_MAX - 10;
+
+  // Test
+  feed(20, firstIndex, 1000000.0, NOMINAL_PERIOD, 0.0f);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT64(1000000 + 40 * 500, sampleClockTimestamp(&sampleClock, firstIndex + 40));
+}
+
+// Helpers ////////////////////////////////////////////////////////////////////
+
+static float noise(const float amplitude) {
+  // Deterministic uniform noise in [-amplitude, amplitude]
+  noiseState = noiseState * 1103515245u + 12345u;
+  return amplitude * (2.0f * (float)((noiseState >> 8) & 0xffff) / 65535.0f - 1.0f);
+}
+
+// Anchors every WATERMARK samples, sample firstIndex is taken at startTime
+static void feed(const int anchorCount, const uint32_t firstIndex, const double startTime, const double period, const float jitter) {
+  for (int i = 0; i < anchorCount; i++) {
+    const uint32_t sampleCount = (uint32_t)(i * WATERMARK);
+    const double time = startTime + sampleCount * period + noise(jitter);
+    sampleClockAddAnchor(&sampleClock, firstIndex + sampleCount, (uint64_t)(time + 0.5));
+  }
+}
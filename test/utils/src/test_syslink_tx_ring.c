@@ -0,0 +1,137 @@
+// File under test syslink_tx_ring.c
+#include "syslink_tx_ring.h"
+
+#include <string.h>
+
+#include "unity.h"
+
+static syslinkTxRing_t ring;
+
+// Helpers
+static void fillRing();
+
+
+void setUp(void) {
+  syslinkTxRingInit(&ring);
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatEmptyRingHasNothingToSend() {
+  // Fixture
+
+  // Test
+  syslinkTxFrame_t* actual = syslinkTxRingPeek(&ring);
+
+  // Assert
+  TEST_ASSERT_NULL(actual);
+}
+
+void testThatAcquiredFrameIsNotSentBeforeCommit() {
+  // Fixture
+  syslinkTxRingAcquire(&ring);
+
+  // Test
+  syslinkTxFrame_t* actual = syslinkTxRingPeek(&ring);
+
+  // Assert
+  TEST_ASSERT_NULL(actual);
+}
+
+void testThatCommittedFrameIsSent() {
+  // Fixture
+  syslinkTxFrame_t* expected = syslinkTxRingAcquire(&ring);
+  syslinkTxRingCommit(&ring);
+
+  // Test
+  syslinkTxFrame_t* actual = syslinkTxRingPeek(&ring);
+
+  // Assert
+  TEST_ASSERT_EQUAL_PTR(expected, actual);
+}
+
+void testThatFullRingHasNoFreeFrame() {
+  // Fixture
+  fillRing();
+
+  // Test
+  syslinkTxFrame_t* actual = syslinkTxRingAcquire(&ring);
+
+  // Assert
+  TEST_ASSERT_NULL(actual);
+}
+
+void testThatReleasedFrameIsFreeAgain() {
+  // Fixture
+  fillRing();
+  syslinkTxFrame_t* expected = syslinkTxRingPeek(&ring);
+  syslinkTxRingRelease(&ring);
+
+  // Test
+  syslinkTxFrame_t* actual = syslinkTxRingAcquire(&ring);
+
+  // Assert
+  TEST_ASSERT_EQUAL_PTR(expected, actual);
+}
+
+void testThatFramesAreSentInOrderAcrossWrap() {
+  // Fixture
+  syslinkTxFrame_t* frames[SYSLINK_TX_RING_FRAME_COUNT * 3];
+
+  // Test
+  // Assert
+  for (int i = 0; i < SYSLINK_TX_RING_FRAME_COUNT * 3; i++) {
+    frames[i] = syslinkTxRingAcquire(&ring);
+    TEST_ASSERT_NOT_NULL(frames[i]);
+    frames[i]->size = (uint8_t)i;
+    syslinkTxRingCommit(&ring);
+
+    if (i > 0) {
+      syslinkTxFrame_t* actual = syslinkTxRingPeek(&ring);
+      TEST_ASSERT_EQUAL_UINT8(i - 1, actual->size);
+      syslinkTxRingRelease(&ring);
+    }
+  }
+}
+
+void testThatFrameIsEncodedWithStartBytesAndChecksum() {
+  // Fixture
+  SyslinkPacket slp = {.type = 0x13, .length = 3, .data = {0x01, 0x02, 0x03}};
+  syslinkTxFrame_t frame;
+
+  // The checksum is a Fletcher-8 of type, length and data
+  const uint8_t expected[] = {0xbc, 0xcf, 0x13, 0x03, 0x01, 0x02, 0x03, 0x1c, 0x75};
+
+  // Test
+  syslinkTxFrameEncode(&frame, &slp);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(sizeof(expected), frame.size);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, frame.data, sizeof(expected));
+}
+
+void testThatFrameWithMaxLengthFitsInFrame() {
+  // Fixture
+  SyslinkPacket slp = {.type = 0x00, .length = SYSLINK_MTU};
+  memset(slp.data, 0xff, SYSLINK_MTU);
+  syslinkTxFrame_t frame;
+
+  // Test
+  syslinkTxFrameEncode(&frame, &slp);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(SYSLINK_TX_FRAME_SIZE, frame.size);
+  TEST_ASSERT_EQUAL_UINT8(0xbc, frame.data[0]);
+  TEST_ASSERT_EQUAL_UINT8(0xff, frame.data[4 + SYSLINK_MTU - 1]);
+}
+
+// Helpers ////////////////////////////////////////////////////////////////////
+
+static void fillRing() {
+  for (int i = 0; i < SYSLINK_TX_RING_FRAME_COUNT; i++) {
+    syslinkTxRingAcquire(&ring);
+    syslinkTxRingCommit(&ring);
+  }
+}
@@ -0,0 +1,152 @@
+// File under test trace_ring.c
+#include "trace_ring.h"
+
+#include <string.h>
+
+#include "unity.h"
+
+#define RING_SIZE 16
+
+static uint32_t buffer[RING_SIZE];
+static traceRing_t ring;
+static uint32_t out[RING_SIZE];
+
+
+void setUp(void) {
+  memset(buffer, 0, sizeof(buffer));
+  memset(out, 0, sizeof(out));
+  ring = (traceRing_t)TRACE_RING_INIT(buffer, RING_SIZE);
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatEmptyRingReadsNothing() {
+  // Fixture
+  // Test
+  const uint32_t actual = traceRingRead(&ring, out, RING_SIZE);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(0, actual);
+}
+
+void testThatRecordIsReadWithHeader() {
+  // Fixture
+  const uint32_t words[] = {11, 22, 33};
+
+  // Test
+  const bool result = traceRingWrite(&ring, 0x123456, words, 3);
+  const uint32_t actual = traceRingRead(&ring, out, RING_SIZE);
+
+  // Assert
+  TEST_ASSERT_TRUE(result);
+  TEST_ASSERT_EQUAL_UINT32(4, actual);
+  TEST_ASSERT_EQUAL_HEX32(TRACE_RING_HEADER_VALID | (3 << TRACE_RING_LENGTH_SHIFT) | 0x123456, out[0]);
+  TEST_ASSERT_EQUAL_UINT32(4, traceRingRecordLength(out[0]));
+  TEST_ASSERT_EQUAL_UINT32(11, out[1]);
+  TEST_ASSERT_EQUAL_UINT32(22, out[2]);
+  TEST_ASSERT_EQUAL_UINT32(33, out[3]);
+}
+
+void testThatEmptyRecordCanBeWritten() {
+  // Fixture
+  // Test
+  traceRingWrite(&ring, 7, NULL, 0);
+  const uint32_t actual = traceRingRead(&ring, out, RING_SIZE);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(1, actual);
+  TEST_ASSERT_EQUAL_UINT32(7, out[0] & TRACE_RING_TAG_MASK);
+}
+
+void testThatRecordsAreReadInOrder() {
+  // Fixture
+  const uint32_t first[] = {1};
+  const uint32_t second[] = {2, 3};
+
+  // Test
+  traceRingWrite(&ring, 1, first, 1);
+  traceRingWrite(&ring, 2, second, 2);
+  const uint32_t actual = traceRingRead(&ring, out, RING_SIZE);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(5, actual);
+  TEST_ASSERT_EQUAL_UINT32(1, out[0] & TRACE_RING_TAG_MASK);
+  TEST_ASSERT_EQUAL_UINT32(1, out[1]);
+  TEST_ASSERT_EQUAL_UINT32(2, out[2] & TRACE_RING_TAG_MASK);
+  TEST_ASSERT_EQUAL_UINT32(2, out[3]);
+  TEST_ASSERT_EQUAL_UINT32(3, out[4]);
+}
+
+void testThatRecordThatDoesNotFitIsDropped() {
+  // Fixture
+  const uint32_t words[RING_SIZE] = {0};
+  traceRingWrite(&ring, 1, words, 10);
+
+  // Test
+  const bool result = traceRingWrite(&ring, 2, words, 5);
+
+  // Assert
+  TEST_ASSERT_FALSE(result);
+  TEST_ASSERT_EQUAL_UINT32(1, ring.dropCount);
+  TEST_ASSERT_EQUAL_UINT32(11, traceRingRead(&ring, out, RING_SIZE));
+}
+
+void testThatTooLongRecordIsDropped() {
+  // Fixture
+  // Test
+  const bool result = traceRingWrite(&ring, 1, NULL, TRACE_RING_MAX_LENGTH + 1);
+
+  // Assert
+  TEST_ASSERT_FALSE(result);
+  TEST_ASSERT_EQUAL_UINT32(1, ring.dropCount);
+}
+
+void testThatRecordsWrapAroundTheEnd() {
+  // Fixture
+  const uint32_t words[] = {1, 2, 3, 4, 5, 6};
+  for (int i = 0; i < 5; i++) {
+    traceRingWrite(&ring, i, words, 6);
+    traceRingRead(&ring, out, RING_SIZE);
+  }
+
+  // Test
+  traceRingWrite(&ring, 9, words, 6);
+  const uint32_t actual = traceRingRead(&ring, out, RING_SIZE);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(7, actual);
+  TEST_ASSERT_EQUAL_UINT32(9, out[0] & TRACE_RING_TAG_MASK);
+  TEST_ASSERT_EQUAL_UINT32_ARRAY(words, &out[1], 6);
+}
+
+void testThatReadStopsAtRecordNotYetPublished() {
+  // Fixture
+  const uint32_t words[] = {1};
+  // Reserve space like a writer that was interrupted before the header
+  ring.head += 2;
+  traceRingWrite(&ring, 2, words, 1);
+
+  // Test
+  const uint32_t actual = traceRingRead(&ring, out, RING_SIZE);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(0, actual);
+}
+
+void testThatOnlyCompleteRecordsAreRead() {
+  // Fixture
+  const uint32_t words[] = {1, 2, 3};
+  traceRingWrite(&ring, 1, words, 3);
+  traceRingWrite(&ring, 2, words, 3);
+
+  // Test
+  const uint32_t first = traceRingRead(&ring, out, 6);
+  const uint32_t second = traceRingRead(&ring, out, 6);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(4, first);
+  TEST_ASSERT_EQUAL_UINT32(4, second);
+  TEST_ASSERT_EQUAL_UINT32(2, out[0] & TRACE_RING_TAG_MASK);
+}
@@ -0,0 +1,157 @@
+// File under test usb_stream_ring.c
+#include "usb_stream_ring.h"
+
+#include <string.h>
+
+#include "unity.h"
+
+#define RING_SIZE 128
+#define PACKET_SIZE 16
+
+static usbStreamRing_t ring;
+static uint8_t buffer[RING_SIZE];
+
+// Helpers
+static void writeFrames(const int count, const uint8_t size);
+
+
+void setUp(void) {
+  memset(buffer, 0, sizeof(buffer));
+  usbStreamRingInit(&ring, buffer, RING_SIZE);
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatEmptyRingHasNothingToSend() {
+  // Fixture
+  uint8_t* data;
+
+  // Test
+  uint32_t actual = usbStreamRingPeek(&ring, &data, 64, PACKET_SIZE);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(0, actual);
+}
+
+void testThatFrameIsWrittenWithSizeAndHeader() {
+  // Fixture
+  const uint8_t payload[] = {1, 2, 3};
+  const uint8_t expected[] = {4, 0x5c, 1, 2, 3};
+  uint8_t* data;
+
+  // Test
+  usbStreamRingWriteFrame(&ring, 0x5c, payload, sizeof(payload));
+
+  // Assert
+  uint32_t actual = usbStreamRingPeek(&ring, &data, 64, PACKET_SIZE);
+  TEST_ASSERT_EQUAL_UINT32(sizeof(expected), actual);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, data, sizeof(expected));
+}
+
+void testThatManyFramesAreSentInOneBlock() {
+  // Fixture
+  writeFrames(3, 5);
+  uint8_t* data;
+
+  // Test
+  uint32_t actual = usbStreamRingPeek(&ring, &data, 64, PACKET_SIZE);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(3 * 7, actual);
+}
+
+void testThatBlockIsLimitedToMaxSize() {
+  // Fixture
+  writeFrames(10, 8);
+  uint8_t* data;
+
+  // Test
+  uint32_t actual = usbStreamRingPeek(&ring, &data, 64, PACKET_SIZE);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(64, actual);
+}
+
+void testThatShortBlockIsNotAMultipleOfThePacketSize() {
+  // Fixture
+  writeFrames(2, 14);
+  uint8_t* data;
+
+  // Test
+  uint32_t actual = usbStreamRingPeek(&ring, &data, 64, PACKET_SIZE);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(31, actual);
+}
+
+void testThatFrameThatDoesNotFitIsRejected() {
+  // Fixture
+  writeFrames(4, 30);
+  const uint8_t payload[30] = {0};
+
+  // Test
+  bool actual = usbStreamRingWriteFrame(&ring, 0, payload, sizeof(payload));
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+  TEST_ASSERT_EQUAL_UINT32(4 * 32, usbStreamRingUsed(&ring));
+}
+
+void testThatConsumedBlockFreesRoom() {
+  // Fixture
+  writeFrames(4, 30);
+  uint8_t* data;
+  const uint8_t payload[30] = {0};
+  uint32_t size = usbStreamRingPeek(&ring, &data, 64, PACKET_SIZE);
+
+  // Test
+  usbStreamRingConsume(&ring, size);
+
+  // Assert
+  TEST_ASSERT_TRUE(usbStreamRingWriteFrame(&ring, 0, payload, sizeof(payload)));
+}
+
+void testThatBlockStopsAtEndOfBufferAndContinuesAtStart() {
+  // Fixture
+  uint8_t* data;
+  writeFrames(3, 38);
+  usbStreamRingConsume(&ring, 3 * 40);
+  const uint8_t payload[18] = {7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7};
+  usbStreamRingWriteFrame(&ring, 0x12, payload, sizeof(payload));
+
+  // Test
+  uint32_t first = usbStreamRingPeek(&ring, &data, 64, PACKET_SIZE);
+  uint8_t* firstData = data;
+  usbStreamRingConsume(&ring, first);
+  uint32_t second = usbStreamRingPeek(&ring, &data, 64, PACKET_SIZE);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(RING_SIZE - 3 * 40, first);
+  TEST_ASSERT_EQUAL_PTR(&buffer[3 * 40], firstData);
+  TEST_ASSERT_EQUAL_UINT8(19, firstData[0]);
+  TEST_ASSERT_EQUAL_UINT32(20 - first, second);
+  TEST_ASSERT_EQUAL_PTR(buffer, data);
+  TEST_ASSERT_EQUAL_UINT8(7, data[0]);
+}
+
+void testThatDiscardEmptiesTheRing() {
+  // Fixture
+  writeFrames(3, 5);
+
+  // Test
+  usbStreamRingDiscard(&ring);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(0, usbStreamRingUsed(&ring));
+}
+
+// Helpers ////////////////////////////////////////////////////////////////////
+
+static void writeFrames(const int count, const uint8_t size) {
+  uint8_t payload[64] = {0};
+  for (int i = 0; i < count; i++) {
+    TEST_ASSERT_TRUE(usbStreamRingWriteFrame(&ring, 0, payload, size));
+  }
+}
@@ -0,0 +1,28 @@
+# Fit the motor thrust model used in motor_thrust_model.c
+#
+#   thrust = a * u^2 + b * u,  u = pwm * vbat / vNom
+#
+# from thrust stand measurements of one motor. The input is a csv file with
+# the columns pwm (0-65535), vbat (V) and thrust (g). The fitted values are
+# meant for the motorModel.a, motorModel.b and motorModel.vNom parameters.
+import argparse
+import numpy
+
+parser = argparse.ArgumentParser()
+parser.add_argument("filename")
+parser.add_argument("--vnom", type=float, default=4.0, help="nominal battery voltage (V)")
+args = parser.parse_args()
+
+data = numpy.genfromtxt(args.filename, delimiter=",", names=True)
+
+u = data["pwm"] / 65535.0 * data["vbat"] / args.vnom
+thrust = data["thrust"] * 9.81 / 1000.0
+
+A = numpy.column_stack((u * u, u))
+(a, b), residuals, _, _ = numpy.linalg.lstsq(A, thrust, rcond=None)
+rms = numpy.sqrt(numpy.mean((A.dot([a, b]) - thrust) ** 2))
+
+print("motorModel.a = {:.9f}".format(a))
+print("motorModel.b = {:.9f}".format(b))
+print("motorModel.vNom = {:.2f}".format(args.vnom))
+print("rms error: {:.5f} N".format(rms))
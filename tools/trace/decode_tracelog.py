@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+#
+# ,---------,       ____  _ __
+# |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+# | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+# | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+#    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+#
+# Copyright (C) 2021 Bitcraze AB
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, in version 3.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program. If not, see <http://www.gnu.org/licenses/>.
+"""
+Decode the binary trace log written by TRACE_PRINT(), see tracelog.h
+
+The format strings are read from the .trace_fmt section of the elf file that
+was flashed, so the elf file must match the firmware exactly.
+
+Usage:
+  decode_tracelog.py <elf> file <trace file>   Segger RTT dump or uSD trcNN file
+  decode_tracelog.py <elf> crtp <uri>          Live from a Crazyflie, needs cflib
+"""
+import re
+import struct
+import sys
+
+from elftools.elf.elffile import ELFFile
+
+TRACE_FMT_SECTION = '.trace_fmt'
+
+HEADER_VALID = 0x80000000
+LENGTH_SHIFT = 24
+MAX_LENGTH = 0x7f
+TAG_MASK = 0x00ffffff
+
+CRTP_PORT_TRACE = 0x0B
+CRTP_NO_RECORD_START = 0xff
+
+# printf conversion specification, flags/width/precision are kept and the
+# length modifiers are dropped since all arguments are 32 bit words
+SPEC = re.compile(r'%([-+ #0]*)(\*|\d+)?(\.\d+)?(hh|h|ll|l|j|z|t|L)?([diouxXeEfgGcsp%])')
+
+
+class Elf:
+    def __init__(self, path):
+        self._file = open(path, 'rb')
+        self._elf = ELFFile(self._file)
+
+        section = self._elf.get_section_by_name(TRACE_FMT_SECTION)
+        if section is None:
+            raise Exception('No {} section in {}'.format(TRACE_FMT_SECTION, path))
+        self._formats = section.data()
+
+        # Loaded sections, to resolve %s arguments that point to flash
+        self._loaded = []
+        for s in self._elf.iter_sections():
+            if s['sh_type'] == 'SHT_PROGBITS' and s['sh_flags'] & 0x2:
+                self._loaded.append((s['sh_addr'], s.data()))
+
+    def format(self, offset):
+        end = self._formats.find(b'\0', offset)
+        return self._formats[offset:end].decode('utf-8', errors='replace')
+
+    def string(self, address):
+        for start, data in self._loaded:
+            if start <= address < start + len(data):
+                end = data.find(b'\0', address - start)
+                return data[address - start:end].decode('utf-8', errors='replace')
+        return '<str@0x{:08x}>'.format(address)
+
+
+def render(elf, fmt, args):
+    args = list(args)
+
+    def replace(match):
+        flags, width, precision, _, conversion = match.groups()
+        if conversion == '%':
+            return '%'
+        if not args:
+            return '<missing>'
+        if width == '*':
+            width = str(struct.unpack('<i', struct.pack('<I', args.pop(0)))[0])
+        word = args.pop(0) if args else 0
+        spec = '%' + (flags or '') + (width or '') + (precision or '')
+
+        if conversion in 'eEfgG':
+            return (spec + conversion) % struct.unpack('<f', struct.pack('<I', word))[0]
+        if conversion in 'di':
+            return (spec + 'd') % struct.unpack('<i', struct.pack('<I', word))[0]
+        if conversion == 'c':
+            return (spec + 'c') % chr(word & 0xff)
+        if conversion == 's':
+            return (spec + 's') % elf.string(word)
+        if conversion == 'p':
+            return '0x{:08x}'.format(word)
+        return (spec + conversion) % word
+
+    return SPEC.sub(replace, fmt)
+
+
+def decode_records(elf, data):
+    """Decode the complete records at the start of data, returns the number of
+    bytes used"""
+    offset = 0
+    while offset + 4 <= len(data):
+        header, = struct.unpack_from('<I', data, offset)
+        if not header & HEADER_VALID:
+            # Not a record start, resynchronize on the next word
+            offset += 4
+            continue
+
+        length = 1 + ((header >> LENGTH_SHIFT) & MAX_LENGTH)
+        if offset + 4 * length > len(data):
+            break
+
+        words = struct.unpack_from('<{}I'.format(length), data, offset)
+        offset += 4 * length
+        if length < 2:
+            continue
+
+        timestamp = words[1]
+        text = render(elf, elf.format(header & TAG_MASK), words[2:])
+        sys.stdout.write('{:10.6f} {}'.format(timestamp / 1e6, text))
+        if not text.endswith('\n'):
+            sys.stdout.write('\n')
+
+    return offset
+
+
+def decode_file(elf, path):
+    with open(path, 'rb') as f:
+        decode_records(elf, f.read())
+
+
+class CrtpStream:
+    """Reassembles the byte stream from CRTP trace packets, see tracelog.h"""
+
+    def __init__(self, elf):
+        self._elf = elf
+        self._pending = b''
+        self._sequence = None
+
+    def packet(self, data):
+        sequence, start = data[0], data[1]
+        payload = bytes(data[2:])
+
+        if self._sequence is not None and sequence != (self._sequence + 1) & 0xff:
+            # Lost packet, drop until the next record start
+            sys.stdout.write('<lost {} packets>\n'.format((sequence - self._sequence - 1) & 0xff))
+            self._pending = None
+        self._sequence = sequence
+
+        if self._pending is None:
+            if start == CRTP_NO_RECORD_START:
+                return
+            payload = payload[start:]
+            self._pending = b''
+
+        self._pending += payload
+        used = decode_records(self._elf, self._pending)
+        self._pending = self._pending[used:]
+
+
+def decode_crtp(elf, uri):
+    import time
+
+    import cflib.crtp
+    from cflib.crazyflie import Crazyflie
+    from cflib.crazyflie.syncCrazyflie import SyncCrazyflie
+
+    stream = CrtpStream(elf)
+
+    cflib.crtp.init_drivers()
+    with SyncCrazyflie(uri, cf=Crazyflie(rw_cache='./cache')) as scf:
+        scf.cf.add_port_callback(CRTP_PORT_TRACE, lambda pk: stream.packet(pk.data))
+        try:
+            while True:
+                time.sleep(1)
+        except KeyboardInterrupt:
+            pass
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 4 or sys.argv[2] not in ('file', 'crtp'):
+        print(__doc__)
+        sys.exit(1)
+
+    elf = Elf(sys.argv[1])
+    if sys.argv[2] == 'file':
+        decode_file(elf, sys.argv[3])
+    else:
+        decode_crtp(elf, sys.argv[3])
@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+#
+# ,---------,       ____  _ __
+# |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+# | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+# | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+#    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+#
+# Copyright (C) 2021 Bitcraze AB
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, in version 3.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program. If not, see <http://www.gnu.org/licenses/>.
+"""
+Convert an event trace recording, see eventtrace.h, to a Chrome/Perfetto
+JSON trace that can be opened in https://ui.perfetto.dev or chrome://tracing
+
+The recording is either read from the event trace memory (MEM_TYPE_EVENT_TRACE)
+when recording is stopped, or is the stream from Segger RTT up buffer 2. The
+elf file must be the one that was flashed, interrupt and marker names are read
+from it.
+
+Usage:
+  events_to_perfetto.py <elf> <recording> <output.json>
+"""
+import json
+import struct
+import sys
+
+from decode_tracelog import Elf
+
+HEADER_VALID = 0x80000000
+LENGTH_SHIFT = 24
+MAX_LENGTH = 0x7f
+TYPE_SHIFT = 20
+TYPE_MASK = 0xf
+ID_MASK = 0xfffff
+
+TASK_SWITCHED_IN = 0
+TASK_READY = 1
+TASK_NAME = 2
+ISR_ENTER = 3
+ISR_EXIT = 4
+QUEUE_BLOCK_RECEIVE = 5
+QUEUE_BLOCK_SEND = 6
+MARK = 7
+BEGIN = 8
+END = 9
+START = 10
+
+PID = 1
+# Thread ids of the tracks that are not tasks
+TID_SCHEDULER = 1000
+TID_INTERRUPTS = 1001
+
+# Used until the start record is found
+DEFAULT_CYCLES_PER_US = 168
+
+
+def read_records(data):
+    offset = 0
+    while offset + 4 <= len(data):
+        header, = struct.unpack_from('<I', data, offset)
+        if not header & HEADER_VALID:
+            # Space that was reserved but not written when recording stopped
+            offset += 4
+            continue
+
+        length = 1 + ((header >> LENGTH_SHIFT) & MAX_LENGTH)
+        if offset + 4 * length > len(data):
+            break
+
+        words = struct.unpack_from('<{}I'.format(length), data, offset)
+        offset += 4 * length
+        if length >= 2:
+            yield (header >> TYPE_SHIFT) & TYPE_MASK, header & ID_MASK, words[1], words[2:]
+
+
+class Converter:
+    def __init__(self, elf):
+        self._elf = elf
+        self._events = []
+        self._task_names = {}
+        self._cycles_per_us = DEFAULT_CYCLES_PER_US
+        self._last_cycles = None
+        self._time = 0
+        self._running = None
+        self._running_since = 0
+
+    def _timestamp(self, cycles):
+        # The cycle counter wraps every 25 s at 168 MHz, events are much more
+        # frequent than that
+        if self._last_cycles is not None:
+            self._time += (cycles - self._last_cycles) & 0xffffffff
+        self._last_cycles = cycles
+        return self._time / self._cycles_per_us
+
+    def _task_name(self, number):
+        return self._task_names.get(number, 'task {}'.format(number))
+
+    def _end_running(self, ts):
+        if self._running is not None:
+            self._events.append({'name': self._task_name(self._running), 'ph': 'X', 'pid': PID,
+                                 'tid': TID_SCHEDULER, 'ts': self._running_since,
+                                 'dur': ts - self._running_since})
+
+    def record(self, event_type, event_id, cycles, extra):
+        ts = self._timestamp(cycles)
+        tid = self._running if self._running is not None else TID_SCHEDULER
+
+        if event_type == START:
+            self._cycles_per_us = extra[0] / 1e6
+            self._last_cycles = cycles
+            self._time = 0
+            self._running = None
+        elif event_type == TASK_NAME:
+            name = struct.pack('<{}I'.format(len(extra)), *extra).split(b'\0')[0].decode('utf-8', errors='replace')
+            self._task_names[event_id] = name
+        elif event_type == TASK_SWITCHED_IN:
+            if event_id != self._running:
+                self._end_running(ts)
+                self._running = event_id
+                self._running_since = ts
+        elif event_type == TASK_READY:
+            self._events.append({'name': 'ready', 'ph': 'i', 's': 't', 'pid': PID, 'tid': event_id, 'ts': ts})
+        elif event_type in (QUEUE_BLOCK_RECEIVE, QUEUE_BLOCK_SEND):
+            what = 'receive' if event_type == QUEUE_BLOCK_RECEIVE else 'send'
+            self._events.append({'name': 'block on {} queue {}'.format(what, event_id), 'ph': 'i', 's': 't',
+                                 'pid': PID, 'tid': tid, 'ts': ts})
+        elif event_type in (ISR_ENTER, ISR_EXIT):
+            self._events.append({'name': self._elf.format(event_id), 'ph': 'B' if event_type == ISR_ENTER else 'E',
+                                 'pid': PID, 'tid': TID_INTERRUPTS, 'ts': ts})
+        elif event_type in (BEGIN, END):
+            self._events.append({'name': self._elf.format(event_id), 'ph': 'B' if event_type == BEGIN else 'E',
+                                 'pid': PID, 'tid': tid, 'ts': ts})
+        elif event_type == MARK:
+            self._events.append({'name': self._elf.format(event_id), 'ph': 'i', 's': 't', 'pid': PID, 'tid': tid,
+                                 'ts': ts})
+
+    def finish(self):
+        self._end_running(self._time / self._cycles_per_us)
+
+        metadata = [
+            {'name': 'process_name', 'ph': 'M', 'pid': PID, 'args': {'name': 'Crazyflie'}},
+            {'name': 'thread_name', 'ph': 'M', 'pid': PID, 'tid': TID_SCHEDULER, 'args': {'name': 'Running task'}},
+            {'name': 'thread_name', 'ph': 'M', 'pid': PID, 'tid': TID_INTERRUPTS, 'args': {'name': 'Interrupts'}},
+        ]
+        for number, name in self._task_names.items():
+            metadata.append({'name': 'thread_name', 'ph': 'M', 'pid': PID, 'tid': number, 'args': {'name': name}})
+
+        return {'traceEvents': metadata + self._events, 'displayTimeUnit': 'ms'}
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 4:
+        print(__doc__)
+        sys.exit(1)
+
+    converter = Converter(Elf(sys.argv[1]))
+    with open(sys.argv[2], 'rb') as f:
+        for record in read_records(f.read()):
+            converter.record(*record)
+
+    with open(sys.argv[3], 'w') as f:
+        json.dump(converter.finish(), f)
@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+#
+# ,---------,       ____  _ __
+# |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+# | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+# | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+#    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+#
+# Copyright (C) 2021 Bitcraze AB
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, in version 3.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program. If not, see <http://www.gnu.org/licenses/>.
+"""
+Read the CRTP packets streamed over USB in streaming mode, see usb.h
+
+In streaming mode the Crazyflie batches the CRTP packets it sends as
+[size][header][data...] frames, size being the CRTP packet size including
+the header, in bulk transfers of up to 512 bytes. This lets full rate log
+data be streamed over USB.
+
+The log blocks can be set up with any client before streaming is turned on.
+Periods below 10 ms need the START_BLOCK_V2 log control command (period in
+ms), START_BLOCK is limited to 100 Hz. This script then turns on CRTP over USB and streaming mode, prints the
+throughput and the number of log packets per block every second, and
+optionally saves the raw stream to a file.
+
+Usage:
+  usb_stream.py [--raw <file>] [--seconds <s>]
+
+Needs pyusb.
+"""
+import argparse
+import time
+
+import usb.core
+import usb.util
+
+CRAZYFLIE_VID = 0x0483
+CRAZYFLIE_PID = 0x5740
+
+IN_EP = 0x81
+OUT_EP = 0x01
+
+# Same transfer size as the firmware, a read of this size always ends with
+# the end of a transfer
+MAX_TRANSFER = 512
+
+VENDOR_DEVICE_REQUEST = 0x40
+VENDOR_INTERFACE_REQUEST = 0x41
+REQUEST_CRTP_OVER_USB = 0x01
+REQUEST_STREAM = 0x02
+
+CRTP_PORT_LOG = 5
+CRTP_LOG_CHANNEL_DATA = 2
+
+
+def parse_frames(data):
+    """
+    Split a stream into CRTP packets
+
+    Returns a list of (header, payload) and the number of bytes used, a
+    frame that is not complete is left for the next call.
+    """
+    frames = []
+    index = 0
+    while index < len(data):
+        size = data[index]
+        if size == 0:
+            raise ValueError('Bad frame size at offset {}'.format(index))
+        if index + 1 + size > len(data):
+            break
+        header = data[index + 1]
+        frames.append((header, bytes(data[index + 2:index + 1 + size])))
+        index += 1 + size
+
+    return frames, index
+
+
+def crtp_port(header):
+    return (header >> 4) & 0x0f
+
+
+def crtp_channel(header):
+    return header & 0x03
+
+
+class UsbStream:
+    def __init__(self):
+        self._dev = usb.core.find(idVendor=CRAZYFLIE_VID, idProduct=CRAZYFLIE_PID)
+        if self._dev is None:
+            raise IOError('No Crazyflie found on USB')
+
+        self._dev.set_configuration()
+        self._pending = bytearray()
+
+    def __enter__(self):
+        self._dev.ctrl_transfer(VENDOR_DEVICE_REQUEST, REQUEST_CRTP_OVER_USB, 1, 1, None)
+        self._dev.ctrl_transfer(VENDOR_INTERFACE_REQUEST, REQUEST_STREAM, 1, 0, None)
+        return self
+
+    def __exit__(self, *args):
+        self._dev.ctrl_transfer(VENDOR_INTERFACE_REQUEST, REQUEST_STREAM, 0, 0, None)
+        usb.util.dispose_resources(self._dev)
+
+    def send(self, header, data=b''):
+        """Send a CRTP packet, the host to Crazyflie direction is not batched"""
+        self._dev.write(OUT_EP, bytes([header]) + bytes(data))
+
+    def read(self, timeout_ms=100):
+        """
+        Read one transfer
+
+        Returns the raw bytes and the list of complete (header, payload)
+        packets in them.
+        """
+        try:
+            raw = bytes(self._dev.read(IN_EP, MAX_TRANSFER, timeout_ms))
+        except usb.core.USBTimeoutError:
+            return b'', []
+
+        self._pending += raw
+        frames, used = parse_frames(self._pending)
+        del self._pending[:used]
+        return raw, frames
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Read CRTP packets streamed over USB')
+    parser.add_argument('--raw', help='Save the raw stream to this file')
+    parser.add_argument('--seconds', type=float, default=0, help='Stop after this time, 0 to run until Ctrl-C')
+    args = parser.parse_args()
+
+    raw_file = open(args.raw, 'wb') if args.raw else None
+    start = time.time()
+    report = start + 1.0
+    byte_count = 0
+    packet_count = 0
+    blocks = {}
+
+    with UsbStream() as stream:
+        try:
+            while args.seconds <= 0 or time.time() - start < args.seconds:
+                raw, frames = stream.read()
+                if raw_file:
+                    raw_file.write(raw)
+                byte_count += len(raw)
+                packet_count += len(frames)
+
+                for header, payload in frames:
+                    if crtp_port(header) == CRTP_PORT_LOG and crtp_channel(header) == CRTP_LOG_CHANNEL_DATA:
+                        block = payload[0]
+                        blocks[block] = blocks.get(block, 0) + 1
+
+                now = time.time()
+                if now >= report:
+                    elapsed = now - report + 1.0
+                    per_block = ' '.join('{}:{}'.format(b, n) for b, n in sorted(blocks.items()))
+                    print('{:8.1f} kB/s {:7.0f} packets/s  log blocks {}'.format(
+                        byte_count / elapsed / 1000, packet_count / elapsed, per_block))
+                    report = now + 1.0
+                    byte_count = 0
+                    packet_count = 0
+                    blocks = {}
+        except KeyboardInterrupt:
+            pass
+
+    if raw_file:
+        raw_file.close()
+
+
+if __name__ == '__main__':
+    main()